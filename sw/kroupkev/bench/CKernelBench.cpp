@@ -0,0 +1,80 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdint>
+
+#include "../src/database/CKernel.hpp"
+
+using namespace std;
+
+/**
+ * Microbenchmark of the predicate kernels (see CKernel). Every supported instruction set is measured
+ * against the scalar path and its bitmask is verified to be identical.
+ * Usage: kroupkev_bench [values]
+ */
+
+namespace {
+
+const char * g_OpNames [] = { "==", "!=", ">=", "<=", ">", "<" };
+
+template <typename T>
+double Measure ( const vector<T> & data, const CKernel::EOperator & op, const T & val, vector<uint64_t> & mask, const int & repeats ) {
+	auto start = chrono::steady_clock::now( );
+	for ( int i = 0; i < repeats; ++ i )
+		CKernel::Compare( data.data( ), data.size( ), op, val, mask );
+	chrono::duration<double, milli> elapsed = chrono::steady_clock::now( ) - start;
+	return elapsed.count( ) / repeats;
+}
+
+template <typename T>
+bool Run ( const string & type, const vector<T> & data, const T & val, const int & repeats ) {
+	bool correct = true;
+	vector<uint64_t> reference, mask;
+	CKernel::EIsa best = CKernel::Detect( );
+	for ( int op = CKernel::OP_EQ; op <= CKernel::OP_LT; ++ op ) {
+		CKernel::m_Isa = CKernel::ISA_SCALAR;
+		double scalar = Measure( data, static_cast<CKernel::EOperator>( op ), val, reference, repeats );
+		cout << setw( 8 ) << type << setw( 4 ) << g_OpNames[ op ] << "  SCALAR " << fixed << setprecision( 3 ) << setw( 9 ) << scalar << " ms";
+		for ( int isa = CKernel::ISA_SSE4; isa <= best; ++ isa ) {
+			CKernel::m_Isa = static_cast<CKernel::EIsa>( isa );
+			double vectorized = Measure( data, static_cast<CKernel::EOperator>( op ), val, mask, repeats );
+			cout << "  " << CKernel::GetIsaName( CKernel::m_Isa ) << " " << setw( 9 ) << vectorized << " ms (x" << setprecision( 2 ) << scalar / vectorized << setprecision( 3 ) << ")";
+			if ( mask != reference ) {
+				cout << " MISMATCH";
+				correct = false;
+			}
+		}
+		cout << endl;
+	}
+	CKernel::m_Isa = best;
+	return correct;
+}
+
+}
+
+int main ( int argc, char * argv [] ) {
+	size_t values = argc > 1 ? stoul( argv[ 1 ] ) : 1 << 22;
+	const int repeats = 10;
+
+	mt19937 gen ( 42 );
+	uniform_int_distribution<int32_t> ints ( -1000, 1000 );
+	uniform_real_distribution<double> doubles ( -1000.0, 1000.0 );
+
+	vector<int32_t> intData ( values );
+	vector<double> doubleData ( values );
+	for ( size_t i = 0; i < values; ++ i ) {
+		intData[ i ] = ints( gen );
+		// every 16th value is equal to the constant within the epsilon, NaN and zeros included
+		doubleData[ i ] = i % 16 == 0 ? 12.5 * ( 1.0 + 1e-16 ) : doubles( gen );
+	}
+	doubleData[ 1 ] = 0.0;
+	doubleData[ 2 ] = -0.0;
+	doubleData[ 3 ] = nan( "" );
+
+	cout << values << " values, best instruction set: " << CKernel::GetIsaName( CKernel::Detect( ) ) << endl;
+	bool correct = Run<int32_t>( "int", intData, 17, repeats );
+	correct = Run<double>( "double", doubleData, 12.5, repeats ) && correct;
+	return correct ? 0 : 1;
+}
@@ -1,11 +1,16 @@
 #include "CApplication.hpp"
 
-CApplication::CApplication ( const string & dbName, const string & srcName ) : m_Database( CDatabase { dbName } ), m_FileManager( srcName, m_Database ) { }
+CApplication::CApplication ( const string & dbName, const string & srcName ) : m_Database( dbName ), m_FileManager( srcName, m_Database ) { }
 
 int CApplication::Run ( ) {
 	try {
-		if ( ! m_FileManager.LoadTables( ) )
+		vector<pair<string, string>> queries;
+		if ( ! m_FileManager.LoadSnapshot( queries ) && ! m_FileManager.LoadTables( ) )
 			throw logic_error( CLog::FM_TABLE_PARSE_ERR );
+		CQueryParser parser { m_Database };
+		for ( const auto & i : queries )
+			if ( ! parser.RestoreQuery( i.first, i.second ) )
+				CLog::BoldMsg( CLog::FM, i.first, CLog::FM_QUERY_RESTORE );
 		m_Database.ListTables( );
 //		m_Database.PrintTables( );
 		return CConsole::Start( m_Database );
@@ -14,6 +14,7 @@ namespace CLog {
 	static constexpr int APP_PADDING ( ) { return 14; }
 	const string APP_DB_NAME        = "DATABASE";
 	const string APP_CFG_PATH       = "examples/sources.cfg";
+	const string APP_SNAPSHOT_PATH  = "examples/database.snap";
 
 	// console commands
 	const string TABLES             = "TABLES";
@@ -31,6 +32,35 @@ namespace CLog {
 	const string MINUS              = "MINUS";
 	const string CARTESIAN          = "CP";
 	const string EXPORT             = "EXPORT";
+	const string SET                = "SET";
+	const string SNAPSHOT           = "SNAPSHOT";
+	const string EXPLAIN            = "EXPLAIN";
+	const string CREATE_INDEX       = "CREATEINDEX";
+	const string INDEXES            = "INDEXES";
+	const string INSERT             = "INSERT";
+	const string CACHE              = "CACHE";
+	const string AGGREGATE          = "AGG";
+	const string ORDER              = "ORDER";
+
+	// aggregate functions
+	const string AGG_COUNT          = "COUNT";
+	const string AGG_SUM            = "SUM";
+	const string AGG_MIN            = "MIN";
+	const string AGG_MAX            = "MAX";
+	const string AGG_AVG            = "AVG";
+
+	// query settings
+	const string SETT_JOIN          = "JOIN";
+	const string SETT_AUTO          = "AUTO";
+	const string SETT_HASH          = "HASH";
+	const string SETT_MERGE         = "MERGE";
+	const string SETT_NESTED        = "NESTED";
+	const string SETT_SIMD          = "SIMD";
+	const string SETT_SETOP         = "SETOP";
+	const string SETT_SORT          = "SORT";
+	const string SETT_CACHE         = "CACHE";
+	const string SETT_AGGREGATE     = "AGGREGATE";
+	const string SETT_THREADS       = "THREADS";
 
 	// import types
 	const string TYPE_STRING        = "string";
@@ -56,6 +86,10 @@ namespace CLog {
 	const string FM_EXPORT_OK       = string( APP_COLOR_GOOD ).append( " successfully exported!" ).append( APP_COLOR_RESET );
 	const string FM_IMPORT_FAIL     = string( APP_COLOR_BAD ).append(" is in incorrect format or doesn't exist." ).append( APP_COLOR_RESET );
 	const string FM_EXPORT_FAIL     = string( APP_COLOR_BAD ).append(" export failed." ).append( APP_COLOR_RESET );
+	const string FM_SNAPSHOT_LOADED = string( APP_COLOR_GOOD ).append( "Tables were restored from the snapshot." ).append( APP_COLOR_RESET );
+	const string FM_SNAPSHOT_OK     = string( APP_COLOR_GOOD ).append( " snapshot was saved!" ).append( APP_COLOR_RESET );
+	const string FM_SNAPSHOT_FAIL   = string( APP_COLOR_BAD ).append( " snapshot could not be saved." ).append( APP_COLOR_RESET );
+	const string FM_QUERY_RESTORE   = string( APP_COLOR_BAD ).append( " saved query could not be restored." ).append( APP_COLOR_RESET );
 	const string FM_TABLE_PARSE_ERR = string( APP_COLOR_BAD ).append("Invalid formatting of the table files." ).append( APP_COLOR_RESET );
 	const string DP                 = "DATA PARSER";
 	const string DP_LINE_MISMATCH   = string( APP_COLOR_BAD ).append(" number of columns does not match at line " );
@@ -72,6 +106,9 @@ namespace CLog {
 	const string CON_PRINTING_CONT  = "Printing contents..";
 	const string CON_LISTING_T      = "Listing existing tables..";
 	const string CON_LISTING_Q      = "Listing saved queries..";
+	const string CON_LISTING_S      = "Listing query settings..";
+	const string CON_LISTING_I      = "Listing indexes..";
+	const string CON_LISTING_C      = "Listing cached query results..";
 	const string TAB_NO_BODY        = string( APP_COLOR_BAD ).append( "Unable to render - table body is missing." ).append( APP_COLOR_RESET );
 	const string TAB_NO_DATA        = "The table doesn't have any columns.";
 	const string QP                 = "QUERY PARSER";
@@ -82,6 +119,7 @@ namespace CLog {
 	const string QP_TABLE_EXISTS    =  string( APP_COLOR_BAD ).append(" name already taken." ).append( APP_COLOR_RESET );
 	const string QP_INVALID_CON     =  string( APP_COLOR_BAD ).append(" the condition clause is missing an operand." ).append( APP_COLOR_RESET );
 	const string QP_INVALID_REL     =  string( APP_COLOR_BAD ).append(" the condition clause is missing a relation operator." ).append( APP_COLOR_RESET );
+	const string QP_INVALID_EXPR    =  string( APP_COLOR_BAD ).append(" invalid part of the condition (&&, ||, !, ( ), { } or a column expected)." ).append( APP_COLOR_RESET );
 	const string QP_CON_PARSE_ERROR =  string( APP_COLOR_BAD ).append(" was unable to convert constant to a correct type." ).append( APP_COLOR_RESET );
 	const string QP_INVALID_OPER    =  string( APP_COLOR_BAD ).append(" invalid comparison operator was entered." ).append( APP_COLOR_RESET );
 	const string QP_EMPTY_RESULTS   =  string( APP_COLOR_BAD ).append( "The result is empty (column data types may vary)." ).append( APP_COLOR_RESET );
@@ -89,6 +127,21 @@ namespace CLog {
 	const string QP_NO_COMMON_COL   =  string( APP_COLOR_BAD ).append( "The tables do not share any columns." ).append( APP_COLOR_RESET );
 	const string QP_DIFF_HEADER     =  string( APP_COLOR_BAD ).append( "Unable to perform operation - the tables must have identical column names." ).append( APP_COLOR_RESET );
 	const string QP_DIFF_TYPE       =  string( APP_COLOR_BAD ).append( "Unable to perform operation - the tables must have identical data types." ).append( APP_COLOR_RESET );
+	const string QP_SETT_CHANGED    =  string( APP_COLOR_GOOD ).append(" setting was changed!" ).append( APP_COLOR_RESET );
+	const string QP_INVALID_SETT    =  string( APP_COLOR_BAD ).append(" unknown setting or invalid value." ).append( APP_COLOR_RESET );
+	const string QP_INDEX_CREATED   =  string( APP_COLOR_GOOD ).append(" index was created!" ).append( APP_COLOR_RESET );
+	const string QP_INDEX_EXISTS    =  string( APP_COLOR_BAD ).append(" index already exists." ).append( APP_COLOR_RESET );
+	const string QP_INDEX_NO_ROWS   =  string( APP_COLOR_BAD ).append( "Unable to create the index - the table has no rows." ).append( APP_COLOR_RESET );
+	const string QP_INVALID_INDEX   =  string( APP_COLOR_BAD ).append(" unknown index kind (SORTED, HASH)." ).append( APP_COLOR_RESET );
+	const string QP_ROW_APPENDED    =  string( APP_COLOR_GOOD ).append(" row was appended!" ).append( APP_COLOR_RESET );
+	const string QP_INVALID_ROW     =  string( APP_COLOR_BAD ).append(" the values don't match the table columns." ).append( APP_COLOR_RESET );
+	const string QP_INSERT_NO_ROWS  =  string( APP_COLOR_BAD ).append( "Unable to insert the row - the table has no rows, its column types are unknown." ).append( APP_COLOR_RESET );
+	const string QP_QUERY_REFRESHED =  string( APP_COLOR_GOOD ).append(" saved query was refreshed, the new rows were appended." ).append( APP_COLOR_RESET );
+	const string QP_QUERY_REPLACED  =  string( APP_COLOR_GOOD ).append(" saved query was refreshed, its result was replaced." ).append( APP_COLOR_RESET );
+	const string QP_INVALID_AGG     =  string( APP_COLOR_BAD ).append(" unknown aggregate function (COUNT, SUM, MIN, MAX, AVG)." ).append( APP_COLOR_RESET );
+	const string QP_AGG_NOT_NUMERIC =  string( APP_COLOR_BAD ).append(" can't be aggregated - the column isn't numeric." ).append( APP_COLOR_RESET );
+	const string QP_AGG_OVERFLOW    =  string( APP_COLOR_BAD ).append(" the aggregated value doesn't fit the int column." ).append( APP_COLOR_RESET );
+	const string QP_PLAN            =  string( APP_COLOR_GOOD ).append( "Query plan (optimized):" ).append( APP_COLOR_RESET );
 
 	/**
 	 * Standart message.
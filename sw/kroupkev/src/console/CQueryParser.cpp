@@ -75,6 +75,26 @@ bool CQueryParser::ReadQParenthesis ( const string & queryDetails, const char &
 	return false;
 }
 
+/**
+ * Reads a page of the query result, either "limit" or "offset, limit".
+ * @param[in] page content of the page parenthesis
+ * @param[out] offset number of rows to skip
+ * @param[out] limit maximum number of rows
+ * @return true if the page is valid (non-negative integers only, the limit has to be positive)
+ */
+bool CQueryParser::ReadQPage ( const string & page, size_t & offset, size_t & limit ) {
+	string tokens = page;
+	vector<string> values = CDataParser::Split( tokens, ',' );
+	if ( values.empty( ) || values.size( ) > 2 || count( page.begin( ), page.end( ), ',' ) + 1 != static_cast<long>( values.size( ) ) )
+		return false;
+	for ( const string & i : values )
+		if ( i.empty( ) || i.length( ) > 18 || i.find_first_not_of( "0123456789" ) != string::npos )
+			return false;
+	offset = values.size( ) == 2 ? stoull( values.front( ) ) : 0;
+	limit = stoull( values.back( ) );
+	return limit != 0;
+}
+
 /**
  * Validates the syntax of a query.
  * @param[in] queryName name of the query
@@ -88,6 +108,10 @@ int CQueryParser::ProcessQuery ( const string & basicString ) const {
 		return CConsole::INVALID_QUERY;
 	queryDetails = basicString.substr( queryName.length( ) );
 
+	// the query name is read together with the first word of the explained query
+	if ( queryName.length( ) > CLog::EXPLAIN.length( ) && ! queryName.compare( 0, CLog::EXPLAIN.length( ), CLog::EXPLAIN ) )
+		return ExplainQuery( basicString.substr( CLog::EXPLAIN.length( ) ) );
+
 	// interface commands
 	if ( queryDetails.empty( ) ) {
 		if ( queryName == CLog::TABLES ) {
@@ -110,26 +134,110 @@ int CQueryParser::ProcessQuery ( const string & basicString ) const {
 			m_Database.ExportQueries( );
 			return CConsole::VALID_QUERY;
 		}
+		if ( queryName == CLog::SET ) {
+			CQuerySett::Print( );
+			return CConsole::VALID_QUERY;
+		}
+		if ( queryName == CLog::INDEXES ) {
+			m_Database.ListIndexes( );
+			return CConsole::VALID_QUERY;
+		}
+		if ( queryName == CLog::CACHE ) {
+			m_Database.ListCache( );
+			return CConsole::VALID_QUERY;
+		}
+		if ( queryName == CLog::SNAPSHOT ) {
+			if ( CSnapshot::Save( m_Database, CLog::APP_SNAPSHOT_PATH ) )
+				CLog::BoldMsg( CLog::FM, CLog::APP_SNAPSHOT_PATH, CLog::FM_SNAPSHOT_OK );
+			else
+				CLog::BoldMsg( CLog::FM, CLog::APP_SNAPSHOT_PATH, CLog::FM_SNAPSHOT_FAIL );
+			return CConsole::VALID_QUERY;
+		}
 		if ( queryName == CLog::QUIT ) {
 			return CConsole::EXIT_CONSOLE;
 		}
 		return CConsole::INVALID_QUERY;
 	}
 
-	// relational algebra inputs
-	size_t stringProgress = 0;
-	CTableQuery * userQuery;
+	// query settings
+	if ( queryName == CLog::SET ) {
+		string setting;
+		size_t settingProgress = 0;
+		if ( ! ReadQParenthesis( queryDetails, '[', ']', settingProgress, setting ) || settingProgress != queryDetails.length( ) )
+			return CConsole::INVALID_QUERY;
 
-	if ( queryName == CLog::SELECTION ) {
-		string columns, table;
+		string tokens = setting;
+		vector<string> keyValue = CDataParser::Split( tokens, ',' );
+		if ( keyValue.size( ) != 2 || ! CQuerySett::Set( keyValue.at( 0 ), keyValue.at( 1 ) ) ) {
+			CLog::HighlightedMsg( CLog::QP, setting, CLog::QP_INVALID_SETT );
+			return CConsole::INVALID_QUERY;
+		}
+		// the cached results may have been evaluated differently (e.g. the order of a set operation)
+		m_Database.GetCache( ).Clear( );
+		CLog::BoldMsg( CLog::QP, keyValue.at( 0 ), CLog::QP_SETT_CHANGED );
+		return CConsole::VALID_QUERY;
+	}
+
+	// secondary indexes, the name is read together with the first word of the command (CREATE INDEX[ column, kind ]( table ))
+	if ( queryName == CLog::CREATE_INDEX ) {
+		string definition, table;
+		size_t indexProgress = 0;
 		if (
-				! ReadQParenthesis( queryDetails, '[', ']', stringProgress, columns ) ||
-				! ReadQParenthesis( queryDetails.substr( stringProgress ), '(', ')', stringProgress, table )
+				! ReadQParenthesis( queryDetails, '[', ']', indexProgress, definition ) ||
+				! ReadQParenthesis( queryDetails.substr( indexProgress ), '(', ')', indexProgress, table ) ||
+				indexProgress != queryDetails.length( )
+			)
+			return CConsole::INVALID_QUERY;
+
+		string tokens = definition;
+		vector<string> columnKind = CDataParser::Split( tokens, ',' );
+		CIndex::EKind kind = CIndex::INDEX_SORTED;
+		if ( columnKind.empty( ) || columnKind.size( ) > 2 )
+			return CConsole::INVALID_QUERY;
+		if ( columnKind.size( ) == 2 && ! CIndex::ParseKind( columnKind.at( 1 ), kind ) ) {
+			CLog::HighlightedMsg( CLog::QP, columnKind.at( 1 ), CLog::QP_INVALID_INDEX );
+			return CConsole::INVALID_QUERY;
+		}
+		return m_Database.CreateIndex( table, columnKind.at( 0 ), kind ) ? CConsole::VALID_QUERY : CConsole::INVALID_QUERY;
+	}
+
+	// appending a row to a table, the saved queries reading it are refreshed (INSERT[ values ]( table ))
+	if ( queryName == CLog::INSERT ) {
+		string values, table;
+		size_t insertProgress = 0;
+		if (
+				! ReadQParenthesis( queryDetails, '[', ']', insertProgress, values ) ||
+				! ReadQParenthesis( queryDetails.substr( insertProgress ), '(', ')', insertProgress, table ) ||
+				insertProgress != queryDetails.length( )
 			)
 			return CConsole::INVALID_QUERY;
-		userQuery = new CSelection ( m_Database, CDataParser::Split( columns, false, false, ',' ), table );
+
+		const CTable * tableRef = m_Database.GetTable( table );
+		if ( ! tableRef ) {
+			CLog::HighlightedMsg( CLog::QP, table, CLog::QP_NO_SUCH_TABLE );
+			return CConsole::INVALID_QUERY;
+		}
+		vector<CColumn::EType> types;
+		for ( size_t i = 0; i < tableRef->GetColumnCount( ); ++ i ) {
+			if ( ! tableRef->GetColumn( i ) ) {
+				CLog::Msg( CLog::QP, CLog::QP_INSERT_NO_ROWS );
+				return CConsole::INVALID_QUERY;
+			}
+			types.push_back( tableRef->GetColumn( i )->GetType( ) );
+		}
+		vector<unique_ptr<CColumn>> row;
+		string tokens = values;
+		if ( ! CDataParser::ParseRow( tokens, types, row ) ) {
+			CLog::HighlightedMsg( CLog::QP, values, CLog::QP_INVALID_ROW );
+			return CConsole::INVALID_QUERY;
+		}
+		CLog::BoldMsg( CLog::QP, table, CLog::QP_ROW_APPENDED );
+		return m_Database.AppendRows( table, row ) ? CConsole::VALID_QUERY : CConsole::INVALID_QUERY;
 	}
-	else if ( queryName == CLog::ALIAS ) {
+
+	// relational algebra inputs
+	size_t stringProgress = 0;
+	if ( queryName == CLog::ALIAS ) {
 		string table, colNames;
 		if (
 				! ReadQParenthesis( queryDetails, '[', ']', stringProgress, colNames ) ||
@@ -141,7 +249,7 @@ int CQueryParser::ProcessQuery ( const string & basicString ) const {
 		if ( tableNames.size( ) != 2 )
 			return CConsole::INVALID_QUERY;
 
-		userQuery = new CAlias ( m_Database, std::make_pair( tableNames.at( 0 ), tableNames.at( 1 ) ), table );
+		CTableQuery * userQuery = new CAlias ( m_Database, std::make_pair( tableNames.at( 0 ), tableNames.at( 1 ) ), table );
 		if ( ! userQuery->Evaluate( ) ) {
 			delete userQuery;
 			return CConsole::INVALID_QUERY;
@@ -149,6 +257,102 @@ int CQueryParser::ProcessQuery ( const string & basicString ) const {
 		delete userQuery;
 		return CConsole::VALID_QUERY;
 	}
+
+	CTableQuery * userQuery = CreateQuery( queryName, queryDetails, stringProgress );
+	if ( ! userQuery )
+		return CConsole::INVALID_QUERY;
+
+	// query save option scan, tilda with empty name is ignored
+	string querySaveName, definition = basicString.substr( 0, queryName.length( ) + stringProgress );
+	bool save = stringProgress != queryDetails.length( ) && ReadQSave( queryDetails.substr( stringProgress ), '~', querySaveName );
+
+	// a query, which isn't saved, is printed from the result cache if it was evaluated over the same tables before
+	string cacheKey;
+	vector<string> cacheTables;
+	if ( ! save && m_Database.CreateCacheKey( definition, * userQuery, cacheKey, cacheTables ) ) {
+		CTableQuery * cached = m_Database.GetCache( ).Find( cacheKey );
+		if ( cached ) {
+			delete userQuery;
+			cached->RenderResult( );
+			CLog::Msg( CLog::QP, cached->GetSQL( ) );
+			return CConsole::VALID_QUERY;
+		}
+	}
+
+	// evaluation process (existing tables, columns, valid conditions, ..)
+	if ( ! userQuery->Evaluate( ) ) {
+		delete userQuery;
+		return CConsole::INVALID_QUERY;
+	}
+
+	// generating the SQL equivalent
+	userQuery->RenderResult( );
+	CLog::Msg( CLog::QP, userQuery->GetSQL( ) );
+
+	if ( ! save ) {
+		if ( cacheKey.empty( ) )
+			delete userQuery;
+		else
+			m_Database.GetCache( ).Insert( cacheKey, definition, userQuery, cacheTables );
+		return CConsole::VALID_QUERY;
+	}
+	if ( ! m_Database.InsertQuery( querySaveName, userQuery, definition ) ) {
+		delete userQuery;
+		return CConsole::INVALID_QUERY;
+	}
+	userQuery->ArchiveQueryName( querySaveName );
+	CLog::BoldMsg( CLog::QP, querySaveName, CLog::QP_QUERY_ADDED );
+
+	// success
+	return CConsole::VALID_QUERY;
+}
+
+/**
+ * Prints the optimized plan of a query instead of its result, the query itself isn't evaluated (see CTableQuery::Plan).
+ * The query can't be saved.
+ * @param[in] basicString the explained query
+ * @return enum value for corresponding application state
+ */
+int CQueryParser::ExplainQuery ( const string & basicString ) const {
+	string queryName, queryDetails;
+	size_t stringProgress = 0;
+	if ( ! ReadQName( basicString, queryName ) )
+		return CConsole::INVALID_QUERY;
+	queryDetails = basicString.substr( queryName.length( ) );
+
+	CTableQuery * userQuery = CreateQuery( queryName, queryDetails, stringProgress );
+	if ( ! userQuery )
+		return CConsole::INVALID_QUERY;
+	if ( stringProgress != queryDetails.length( ) || ! userQuery->Plan( ) ) {
+		delete userQuery;
+		return CConsole::INVALID_QUERY;
+	}
+
+	CLog::Msg( CLog::QP, CLog::QP_PLAN, "" );
+	for ( const string & i : userQuery->GetPlan( ) )
+		CLog::Msg( CLog::QP, i, "" );
+	CLog::Msg( CLog::QP, userQuery->GetSQL( ) );
+	delete userQuery;
+	return CConsole::VALID_QUERY;
+}
+
+/**
+ * Creates the relational algebra query (except for the alias, which is not a query to be saved).
+ * @param[in] queryName name of the query
+ * @param[in] queryDetails details of the query
+ * @param[in, out] stringProgress current char position of the query details
+ * @return query to be evaluated (owned by the caller), nullptr if the syntax is invalid
+ */
+CTableQuery * CQueryParser::CreateQuery ( const string & queryName, const string & queryDetails, size_t & stringProgress ) const {
+	if ( queryName == CLog::SELECTION ) {
+		string columns, table;
+		if (
+				! ReadQParenthesis( queryDetails, '[', ']', stringProgress, columns ) ||
+				! ReadQParenthesis( queryDetails.substr( stringProgress ), '(', ')', stringProgress, table )
+			)
+			return nullptr;
+		return new CSelection ( m_Database, CDataParser::Split( columns, false, false, ',' ), table );
+	}
 	else if ( queryName == CLog::PROJECTION ) {
 		auto * conditionQuery = new CCondition;
 		string condition, table;
@@ -158,118 +362,332 @@ int CQueryParser::ProcessQuery ( const string & basicString ) const {
 				! ValidateConditionSyntax( condition, conditionQuery )
 			) {
 			delete conditionQuery;
-			return CConsole::INVALID_QUERY;
+			return nullptr;
+		}
+		return new CProjection ( m_Database, conditionQuery, table );
+	}
+	else if ( queryName == CLog::AGGREGATE ) {
+		// the group columns are followed by the aggregate functions after '|' (';' ends the command), AGG[ country | count, avg( points ) ]( a )
+		string definition, table;
+		if (
+				! ReadQParenthesis( queryDetails, '[', ']', stringProgress, definition ) ||
+				! ReadQParenthesis( queryDetails.substr( stringProgress ), '(', ')', stringProgress, table )
+			)
+			return nullptr;
+		size_t separator = definition.find( '|' );
+		if ( separator == string::npos )
+			return nullptr;
+
+		string groups = definition.substr( 0, separator ), functions = definition.substr( separator + 1 );
+		vector<string> groupNames = CDataParser::Split( groups, false, false, ',' );
+		if ( groupNames.size( ) == 1 && groupNames.front( ).empty( ) )
+			groupNames.clear( );
+		vector<CAggregate> aggregates;
+		for ( const string & i : CDataParser::Split( functions, false, false, ',' ) ) {
+			aggregates.emplace_back( );
+			if ( ! CAggregate::Parse( i, aggregates.back( ) ) ) {
+				CLog::HighlightedMsg( CLog::QP, i, CLog::QP_INVALID_AGG );
+				return nullptr;
+			}
+		}
+		return new CAggregation ( m_Database, groupNames, aggregates, table );
+	}
+	else if ( queryName == CLog::ORDER ) {
+		// descending keys are marked by '-' (the console removes the spaces), a page may follow after '|', ORDER[ -points, id | 10 ]( a )
+		string definition, table;
+		size_t offset = 0, limit = CProduct::NO_LIMIT;
+		if (
+				! ReadQParenthesis( queryDetails, '[', ']', stringProgress, definition ) ||
+				! ReadQParenthesis( queryDetails.substr( stringProgress ), '(', ')', stringProgress, table )
+			)
+			return nullptr;
+		size_t separator = definition.find( '|' );
+		if ( separator != string::npos && ! ReadQPage( definition.substr( separator + 1 ), offset, limit ) )
+			return nullptr;
+
+		string keys = definition.substr( 0, separator );
+		vector<string> keyNames;
+		vector<bool> descending;
+		for ( string & i : CDataParser::Split( keys, false, false, ',' ) ) {
+			descending.push_back( ! i.empty( ) && i[ 0 ] == '-' );
+			if ( ! i.empty( ) && ( i[ 0 ] == '-' || i[ 0 ] == '+' ) )
+				i.erase( 0, 1 );
+			if ( i.empty( ) )
+				return nullptr;
+			keyNames.push_back( i );
 		}
-		CDataParser::TrimAllSpaces( conditionQuery->m_Column, '"' );
-		CDataParser::TrimAllSpaces( conditionQuery->m_Constant, '"' );
-		userQuery = new CProjection ( m_Database, conditionQuery, table );
+		return new COrdering ( m_Database, keyNames, descending, offset, limit, table );
 	}
 	else if ( queryName == CLog::NJOIN ) {
 		string tables;
 		if ( ! ReadQParenthesis( queryDetails.substr( stringProgress ), '(', ')', stringProgress, tables ) )
-			return CConsole::INVALID_QUERY;
+			return nullptr;
 
 		vector<string> tableNames = CDataParser::Split( tables, ',' );
 		if ( tableNames.size( ) != 2 )
-			return CConsole::INVALID_QUERY;
+			return nullptr;
 
-		userQuery = new CNaturalJoin ( m_Database, std::make_pair( tableNames.at( 0 ), tableNames.at( 1 ) ) );
+		return new CNaturalJoin ( m_Database, std::make_pair( tableNames.at( 0 ), tableNames.at( 1 ) ) );
 	}
 	else if ( queryName == CLog::JOIN ) {
 		string tables, column;
 		if ( ! ReadQParenthesis( queryDetails, '[', ']', stringProgress, column ) || ! ReadQParenthesis( queryDetails.substr( stringProgress ), '(', ')', stringProgress, tables ) )
-			return CConsole::INVALID_QUERY;
+			return nullptr;
 
 		vector<string> tableNames = CDataParser::Split( tables, ',' );
 		if ( tableNames.size( ) != 2 )
-			return CConsole::INVALID_QUERY;
+			return nullptr;
 
-		userQuery = new CJoin ( m_Database, column, std::make_pair( tableNames.at( 0 ), tableNames.at( 1 ) ) );
+		return new CJoin ( m_Database, column, std::make_pair( tableNames.at( 0 ), tableNames.at( 1 ) ) );
 	}
 	else if ( queryName == CLog::UNION || queryName == CLog::INTERSECT || queryName == CLog::MINUS || queryName == CLog::CARTESIAN ) {
-		string tables;
+		// the cartesian product may be limited to a page of rows, CP[ limit ]( a, b ) or CP[ offset, limit ]( a, b )
+		string tables, page;
+		size_t offset = 0, limit = CProduct::NO_LIMIT;
+		if ( queryName == CLog::CARTESIAN && ! queryDetails.empty( ) && queryDetails[ 0 ] == '[' )
+			if ( ! ReadQParenthesis( queryDetails, '[', ']', stringProgress, page ) || ! ReadQPage( page, offset, limit ) )
+				return nullptr;
 		if ( ! ReadQParenthesis( queryDetails.substr( stringProgress ), '(', ')', stringProgress, tables ) )
-			return CConsole::INVALID_QUERY;
+			return nullptr;
 
 		vector<string> tableNames = CDataParser::Split( tables, ',' );
 		if ( tableNames.size( ) != 2 )
-			return CConsole::INVALID_QUERY;
+			return nullptr;
 
 		if ( queryName == CLog::UNION )
-			userQuery = new CUnion ( m_Database, std::make_pair( tableNames.at( 0 ), tableNames.at( 1 ) ) );
+			return new CUnion ( m_Database, std::make_pair( tableNames.at( 0 ), tableNames.at( 1 ) ) );
 		else if ( queryName == CLog::INTERSECT )
-			userQuery = new CIntersect ( m_Database, std::make_pair( tableNames.at( 0 ), tableNames.at( 1 ) ) );
+			return new CIntersect ( m_Database, std::make_pair( tableNames.at( 0 ), tableNames.at( 1 ) ) );
 		else if ( queryName == CLog::MINUS )
-			userQuery = new CMinus ( m_Database, std::make_pair( tableNames.at( 0 ), tableNames.at( 1 ) ) );
+			return new CMinus ( m_Database, std::make_pair( tableNames.at( 0 ), tableNames.at( 1 ) ) );
 		else
-			userQuery = new CCartesian ( m_Database, std::make_pair( tableNames.at( 0 ), tableNames.at( 1 ) ) );
-	}
-	else {
-		return CConsole::INVALID_QUERY;
+			return new CCartesian ( m_Database, std::make_pair( tableNames.at( 0 ), tableNames.at( 1 ) ), offset, limit );
 	}
+	return nullptr;
+}
 
-	// evaluation process (existing tables, columns, valid conditions, ..)
-	if ( ! userQuery->Evaluate( ) ) {
+/**
+ * Evaluates a saved query definition again (see CSnapshot) and saves it under its name.
+ * @param[in] querySaveName name of the saved query
+ * @param[in] definition query as it was entered (without the save name)
+ * @return true if the query is valid and was saved
+ */
+bool CQueryParser::RestoreQuery ( const string & querySaveName, const string & definition ) const {
+	string queryName;
+	size_t stringProgress = 0;
+	if ( ! ReadQName( definition, queryName ) )
+		return false;
+	string queryDetails = definition.substr( queryName.length( ) );
+	CTableQuery * userQuery = CreateQuery( queryName, queryDetails, stringProgress );
+	if ( ! userQuery )
+		return false;
+	if ( stringProgress != queryDetails.length( ) || ! userQuery->Evaluate( ) || ! m_Database.InsertQuery( querySaveName, userQuery, definition ) ) {
 		delete userQuery;
-		return CConsole::INVALID_QUERY;
+		return false;
 	}
+	userQuery->ArchiveQueryName( querySaveName );
+	return true;
+}
 
-	// generating the SQL equivalent
-	cout << * userQuery->GetQueryResult( );
-	CLog::Msg( CLog::QP, userQuery->GetSQL( ) );
+/**
+ * Validates condition syntax of a query. The comparisons may be joined by && (AND), || (OR) and ! (NOT), parenthesized,
+ * compare a column with a set of constants ( col == { 1, 2 } ) or with a range ( 1 <= col <= 2 ), see ParseComparison.
+ * @param[in] query condition expression of the query
+ * @param[out] output the condition tree
+ * @return true if condition is correct (in syntax sense only)
+ */
+bool CQueryParser::ValidateConditionSyntax ( const string & query, CCondition * output ) const {
+	size_t position = 0;
+	unique_ptr<CCondition> condition ( ParseCondition( query, position, 0 ) );
+	if ( ! condition )
+		return false;
+	if ( position != query.size( ) ) {
+		CLog::HighlightedMsg( CLog::QP, query.substr( position ), CLog::QP_INVALID_EXPR );
+		return false;
+	}
+	* output = std::move( * condition );
+	return true;
+}
 
-	// query save option scan
-	string querySaveName;
-	if ( stringProgress == queryDetails.length( ) )
-		delete userQuery;
-	else {
-		// tilda with empty name is ignored
-		if ( ReadQSave( queryDetails.substr( stringProgress ), '~', querySaveName ) ) {
-			if ( ! m_Database.InsertQuery( querySaveName, userQuery ) ) {
-				delete userQuery;
-				return CConsole::INVALID_QUERY;
-			}
-			userQuery->ArchiveQueryName( querySaveName );
-			CLog::BoldMsg( CLog::QP, querySaveName, CLog::QP_QUERY_ADDED );
-		} else {
-			delete userQuery;
+/**
+ * Parses a part of the condition - OR of the conditions (level 0), AND of them (level 1), which binds stronger,
+ * or a single one (level 2), which is negated, parenthesized or a comparison.
+ * @param[in] query condition expression of the query
+ * @param[in, out] position current char position of the condition
+ * @param[in] level the parsed part
+ * @return the condition (owned by the caller), nullptr if the syntax is invalid
+ */
+CCondition * CQueryParser::ParseCondition ( const string & query, size_t & position, const int & level ) const {
+	if ( level == 2 ) {
+		if ( query.compare( position, 1, "!" ) == 0 && query.compare( position, 2, "!=" ) != 0 ) {
+			unique_ptr<CCondition> negation ( new CCondition );
+			negation->m_Kind = CCondition::NOT;
+			negation->m_Children.emplace_back( ParseCondition( query, ++ position, 2 ) );
+			return negation->m_Children.back( ) ? negation.release( ) : nullptr;
 		}
+		if ( query.compare( position, 1, "(" ) != 0 )
+			return ParseComparison( query, position );
+		unique_ptr<CCondition> nested ( ParseCondition( query, ++ position, 0 ) );
+		if ( ! nested )
+			return nullptr;
+		if ( query.compare( position, 1, ")" ) != 0 ) {
+			CLog::HighlightedMsg( CLog::QP, query.substr( position ), CLog::QP_INVALID_EXPR );
+			return nullptr;
+		}
+		++ position;
+		return nested.release( );
 	}
 
-	// success
-	return CConsole::VALID_QUERY;
+	const string op = level ? "&&" : "||";
+	unique_ptr<CCondition> operand ( ParseCondition( query, position, level + 1 ) );
+	if ( ! operand || query.compare( position, 2, op ) != 0 )
+		return operand.release( );
+	unique_ptr<CCondition> output ( new CCondition );
+	output->m_Kind = level ? CCondition::AND : CCondition::OR;
+	output->m_Children.push_back( std::move( operand ) );
+	while ( query.compare( position, 2, op ) == 0 ) {
+		position += 2;
+		output->m_Children.emplace_back( ParseCondition( query, position, level + 1 ) );
+		if ( ! output->m_Children.back( ) )
+			return nullptr;
+	}
+	return output.release( );
 }
 
 /**
- * Validates condition syntax of a query.
+ * Parses a comparison of a column with a constant or with another column ( col > 5, 5 < col, col1 == col2 ), a set of constants
+ * ( col == { "a", "b" }, != for the values outside of it ) or a chain of two comparisons ( 1 <= col <= 5 is BETWEEN, other
+ * chains are AND of the comparisons). An unquoted operand, which isn't a number, is a column. If both operands are such,
+ * the input columns decide, which of them are columns and which are strings (see CCondition::Resolve).
  * @param[in] query condition expression of the query
- * @return true if condition is correct (in syntax sense only)
+ * @param[in, out] position current char position of the condition
+ * @return the condition (owned by the caller), nullptr if the syntax is invalid
  */
-bool CQueryParser::ValidateConditionSyntax ( const string & query, CCondition * output ) const {
-	string column, constant;
-	size_t found;
+CCondition * CQueryParser::ParseComparison ( const string & query, size_t & position ) const {
+	string operands[ 3 ], operators[ 2 ];
+	bool bare[ 3 ];
+	if ( ! ReadOperand( query, position, operands[ 0 ], bare[ 0 ] ) )
+		return nullptr;
+	if ( ! ReadOperator( query, position, operators[ 0 ] ) ) {
+		CLog::HighlightedMsg( CLog::QP, query, CLog::QP_INVALID_REL );
+		return nullptr;
+	}
+
+	// set of constants
+	if ( query.compare( position, 1, "{" ) == 0 ) {
+		unique_ptr<CCondition> in ( new CCondition );
+		in->m_Kind = CCondition::IN;
+		in->m_Column = operands[ 0 ];
+		in->m_Operator = operators[ 0 ];
+		bool word;
+		do {
+			in->m_Constants.emplace_back( );
+			if ( ! ReadOperand( query, ++ position, in->m_Constants.back( ), word ) )
+				return nullptr;
+		} while ( query.compare( position, 1, "," ) == 0 );
+		if ( query.compare( position, 1, "}" ) != 0 || ! bare[ 0 ] || ( in->m_Operator != "==" && in->m_Operator != "!=" ) ) {
+			CLog::HighlightedMsg( CLog::QP, query, CLog::QP_INVALID_EXPR );
+			return nullptr;
+		}
+		++ position;
+		return in.release( );
+	}
+
+	if ( ! ReadOperand( query, position, operands[ 1 ], bare[ 1 ] ) )
+		return nullptr;
+	if ( ! ReadOperator( query, position, operators[ 1 ] ) ) {
+		CCondition * comparison = CreateComparison( operands[ 0 ], bare[ 0 ], operators[ 0 ], operands[ 1 ], bare[ 1 ] );
+		if ( ! comparison )
+			CLog::HighlightedMsg( CLog::QP, query, CLog::QP_INVALID_EXPR );
+		return comparison;
+	}
+
+	// a chain of comparisons has to keep the direction
+	if ( ! ReadOperand( query, position, operands[ 2 ], bare[ 2 ] ) )
+		return nullptr;
+	bool ascending = operators[ 0 ][ 0 ] == '<' && operators[ 1 ][ 0 ] == '<', descending = operators[ 0 ][ 0 ] == '>' && operators[ 1 ][ 0 ] == '>';
+	if ( ( ! ascending && ! descending ) || ! bare[ 1 ] ) {
+		CLog::HighlightedMsg( CLog::QP, query, CLog::QP_INVALID_EXPR );
+		return nullptr;
+	}
+	unique_ptr<CCondition> output ( new CCondition );
+	if ( ! bare[ 0 ] && ! bare[ 2 ] && operators[ 0 ].size( ) == 2 && operators[ 1 ].size( ) == 2 ) {
+		output->m_Kind = CCondition::BETWEEN;
+		output->m_Column = operands[ 1 ];
+		output->m_Constants = { operands[ ascending ? 0 : 2 ], operands[ ascending ? 2 : 0 ] };
+		return output.release( );
+	}
+	output->m_Kind = CCondition::AND;
+	for ( size_t i = 0; i < 2; ++ i )
+		output->m_Children.emplace_back( CreateComparison( operands[ i ], bare[ i ], operators[ i ], operands[ i + 1 ], bare[ i + 1 ] ) );
+	return output.release( );
+}
+
+/**
+ * Reads a relation operator of the condition.
+ * @param[in, out] position current char position of the condition, moved past the operator
+ * @return true if an operator was read
+ */
+bool CQueryParser::ReadOperator ( const string & query, size_t & position, string & output ) const {
 	for ( const string & i : m_Operators ) {
-		if ( ( found = query.find( i ) ) != string::npos ) {
-			column = query.substr( 0, found );
-			if ( column.empty( ) ) {
-				CLog::HighlightedMsg( CLog::QP, query, CLog::QP_INVALID_CON );
-				return false;
-			}
-			constant = query.substr( found + i.size( ), query.size( ) );
-			if ( constant.empty( ) ) {
-				CLog::HighlightedMsg( CLog::QP, query, CLog::QP_INVALID_CON );
-				return false;
-			}
-			output->m_Column   = column;
-			output->m_Constant = constant;
-			output->m_Operator = i;
+		if ( query.compare( position, i.size( ), i ) == 0 ) {
+			output = i;
+			position += i.size( );
 			return true;
 		}
 	}
-	CLog::HighlightedMsg( CLog::QP, query, CLog::QP_INVALID_REL );
 	return false;
 }
 
+/**
+ * Reads an operand of the comparison - a quoted string, a number or an unquoted word (a column name or a string).
+ * @param[in, out] position current char position of the condition, moved past the operand
+ * @param[out] output the operand (without the quotes)
+ * @param[out] isBare true if the operand is neither quoted nor a number
+ * @return true if the operand isn't empty
+ */
+bool CQueryParser::ReadOperand ( const string & query, size_t & position, string & output, bool & isBare ) {
+	size_t end;
+	if ( query.compare( position, 1, "\"" ) == 0 ) {
+		if ( ( end = query.find( '"', position + 1 ) ) == string::npos ) {
+			CLog::HighlightedMsg( CLog::QP, query, CLog::QP_INVALID_CON );
+			return false;
+		}
+		output = query.substr( position + 1, end - position - 1 );
+		position = end + 1;
+		isBare = false;
+		return true;
+	}
+
+	end = min( query.find_first_of( "=!<>&|(){},\"", position ), query.size( ) );
+	output = query.substr( position, end - position );
+	if ( output.empty( ) ) {
+		CLog::HighlightedMsg( CLog::QP, query, CLog::QP_INVALID_CON );
+		return false;
+	}
+	position = end;
+	char * c;
+	strtod( output.c_str( ), & c );
+	isBare = * c || string( "0123456789+-." ).find( output[ 0 ] ) == string::npos;
+	return true;
+}
+
+/**
+ * Creates a comparison with the column on the left side, the operator of a constant on the left side is reversed ( 5 < col is col > 5 ).
+ * If both operands are unquoted words, the right one may be a column as well (see CCondition::Resolve).
+ * @return the comparison (owned by the caller), nullptr if neither of the operands is an unquoted word
+ */
+CCondition * CQueryParser::CreateComparison ( const string & left, const bool & leftBare, const string & op, const string & right, const bool & rightBare ) {
+	if ( ! leftBare && ! rightBare )
+		return nullptr;
+	auto * comparison = new CCondition;
+	comparison->m_Column = leftBare ? left : right;
+	comparison->m_Operator = leftBare ? op : CCondition::ReverseOperator( op );
+	comparison->m_Constant = leftBare ? right : left;
+	comparison->IsBareConstant = leftBare && rightBare;
+	return comparison;
+}
+
 /**
  * Constructor with application database reference.
  */
@@ -8,7 +8,9 @@
 #include "CLog.hpp"
 #include "CConsole.hpp"
 #include "../tool/CDataParser.hpp"
+#include "../tool/CSnapshot.hpp"
 #include "../database/CDatabase.hpp"
+#include "../database/CQuerySett.hpp"
 //
 #include "../query/CSelection.hpp"
 #include "../query/CAlias.hpp"
@@ -19,6 +21,8 @@
 #include "../query/CIntersect.hpp"
 #include "../query/CMinus.hpp"
 #include "../query/CCartesian.hpp"
+#include "../query/CAggregation.hpp"
+#include "../query/COrdering.hpp"
 
 using namespace std;
 
@@ -30,13 +34,23 @@ private:
 	CDatabase & m_Database;
 	vector<string> m_Operators;
 
+	CCondition * ParseCondition ( const string & query, size_t & position, const int & level ) const;
+	CCondition * ParseComparison ( const string & query, size_t & position ) const;
+	bool ReadOperator ( const string & query, size_t & position, string & output ) const;
+	static bool ReadOperand ( const string & query, size_t & position, string & output, bool & isBare );
+	static CCondition * CreateComparison ( const string & left, const bool & leftBare, const string & op, const string & right, const bool & rightBare );
+
 public:
 	explicit CQueryParser( CDatabase & ref );
 
 	static bool ReadQSave ( const string & queryDetails, const char & saveDelimiter, string & output );
 	static bool ReadQName ( const string & fullQuery, string & output );
 	static bool ReadQParenthesis ( const string & queryDetails, const char & delStart, const char & delEnd, size_t & stringPos, string & output );
+	static bool ReadQPage ( const string & page, size_t & offset, size_t & limit );
 
+	CTableQuery * CreateQuery ( const string & queryName, const string & queryDetails, size_t & stringProgress ) const;
 	int ProcessQuery ( const string & basicString) const;
+	int ExplainQuery ( const string & basicString ) const;
+	bool RestoreQuery ( const string & querySaveName, const string & definition ) const;
 	bool ValidateConditionSyntax ( const string & query, CCondition * output ) const;
 };
\ No newline at end of file
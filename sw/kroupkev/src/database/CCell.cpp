@@ -1,7 +1,8 @@
 #include "CCell.hpp"
+#include "CCellArena.hpp"
 
-CString * CString::Clone ( ) {
-	return new CString( * this );
+CString * CString::Clone ( CCellArena & arena ) const {
+	return arena.Create<CString>( * this );
 }
 
 size_t CString::GetLength ( ) const {
@@ -28,8 +29,8 @@ bool CString::Rename ( const string & str ) {
 
 //
 
-CDouble * CDouble::Clone ( ) {
-	return new CDouble( * this );
+CDouble * CDouble::Clone ( CCellArena & arena ) const {
+	return arena.Create<CDouble>( * this );
 }
 
 size_t CDouble::GetLength ( ) const {
@@ -56,8 +57,8 @@ bool CDouble::Rename ( const string & str ) {
 
 //
 
-CInt * CInt::Clone ( ) {
-	return new CInt( * this );
+CInt * CInt::Clone ( CCellArena & arena ) const {
+	return arena.Create<CInt>( * this );
 }
 
 size_t CInt::GetLength ( ) const {
@@ -9,6 +9,8 @@
 
 using namespace std;
 
+class CCellArena;
+
 /**
  * This module stores the data of the table itself.
  * Each cell is polymorphic, since we only get to know the column data types during runtime.
@@ -18,10 +20,12 @@ using namespace std;
  *
  * CString, CDouble, CInt are basically a primitive data type encapsulated objects.
  * There could also be any different (custom made) object with its own functionality.
+ *
+ * A cell can be copied into an arena (see CCellArena), so the cells of one owner are freed together.
  */
 class CCell {
 public:
-	virtual CCell * Clone ( ) = 0;
+	virtual CCell * Clone ( CCellArena & arena ) const = 0;
 	virtual size_t GetLength ( ) const = 0;
 	virtual ostream & Print ( ostream & ost = cout ) const = 0;
 	virtual string RetrieveMVal ( ) const = 0;
@@ -88,7 +92,7 @@ public:
 class CString : public ComparableCCell<CCell, CString> {
 public:
 	string m_Val;
-	virtual CString * Clone ( ) override;
+	virtual CString * Clone ( CCellArena & arena ) const override;
 	explicit CString ( string data ) : m_Val( std::move( data ) ) { }
 	~CString ( ) override = default;
 	virtual size_t GetLength ( ) const override;
@@ -118,20 +122,19 @@ public:
 };
 
 class CDouble : public ComparableCCell<CCell, CDouble> {
-private:
-	bool cmpEq ( double a, double b, double epsilon = DBL_EPSILON ) const {
+public:
+	static bool cmpEq ( double a, double b, double epsilon = DBL_EPSILON ) {
 		return fabs( a - b ) <= ( ( fabs( a ) > fabs( b ) ? fabs( b ) : fabs( a ) ) * epsilon );
 	}
-	bool cmpGt ( double a, double b, double epsilon = DBL_EPSILON ) const {
+	static bool cmpGt ( double a, double b, double epsilon = DBL_EPSILON ) {
 		return ( a - b ) > ( ( fabs( a ) < fabs( b ) ? fabs( b ) : fabs( a ) ) * epsilon );
 	}
-	bool cmpLt ( double a, double b, double epsilon = DBL_EPSILON ) const {
+	static bool cmpLt ( double a, double b, double epsilon = DBL_EPSILON ) {
 		return ( b - a ) > ( ( fabs( a ) < fabs( b ) ? fabs( b ) : fabs( a ) ) * epsilon );
 	}
 
-public:
 	double m_Val;
-	virtual CDouble * Clone ( ) override;
+	virtual CDouble * Clone ( CCellArena & arena ) const override;
 	explicit CDouble ( const double & data ) : m_Val( data ) { }
 	~ CDouble ( ) override = default;
 	virtual size_t GetLength ( ) const override;
@@ -163,7 +166,7 @@ public:
 class CInt : public ComparableCCell<CCell, CInt> {
 public:
 	int m_Val;
-	virtual CInt * Clone ( ) override;
+	virtual CInt * Clone ( CCellArena & arena ) const override;
 	explicit CInt ( const int & data ) : m_Val( data ) { }
 	~CInt ( ) = default;
 	virtual size_t GetLength ( ) const override;
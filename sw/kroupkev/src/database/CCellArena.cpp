@@ -0,0 +1,53 @@
+#include "CCellArena.hpp"
+
+const size_t CCellArena::MIN_BLOCK_SIZE = 256;
+
+CCellArena::~CCellArena ( ) {
+	Clear( );
+}
+
+/**
+ * @param[in] size size in bytes
+ * @return given size rounded up to the alignment of any cell type
+ */
+size_t CCellArena::Slot ( const size_t & size ) {
+	const size_t align = alignof( max_align_t );
+	return ( size + align - 1 ) / align * align;
+}
+
+/**
+ * Starts a new block, the rest of the current one stays unused.
+ * @param[in] size size of the block
+ */
+void CCellArena::AddBlock ( const size_t & size ) {
+	m_Blocks.emplace_back( new char[ size ] );
+	m_Capacity = size;
+	m_Used = 0;
+}
+
+/**
+ * Reserves memory for a cell in the current block, a new block is started once the current one is full.
+ * @param[in] size size of the cell
+ * @return memory aligned for any cell type
+ */
+void * CCellArena::Allocate ( const size_t & size ) {
+	size_t begin = Slot( m_Used );
+	if ( m_Blocks.empty( ) || begin + size > m_Capacity ) {
+		AddBlock( max( Slot( size ), max( MIN_BLOCK_SIZE, 2 * m_Capacity ) ) );
+		begin = 0;
+	}
+	m_Used = begin + size;
+	return m_Blocks.back( ).get( ) + begin;
+}
+
+/**
+ * Destroys all the cells and releases the blocks.
+ */
+void CCellArena::Clear ( ) {
+	for ( CCell * i : m_Cells )
+		i->~CCell( );
+	m_Cells.clear( );
+	m_Blocks.clear( );
+	m_Capacity = 0;
+	m_Used = 0;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <new>
+#include <utility>
+#include <cstddef>
+#include <algorithm>
+
+#include "CCell.hpp"
+
+using namespace std;
+
+/**
+ * This module allocates the cells of a single owner (the header of a table) in blocks.
+ * The cells are constructed one after another in the current block and all of them are destroyed at once with the arena,
+ * so the owner doesn't allocate and free each cell separately. A cell can't be freed alone.
+ *
+ * The owner reserves the space for the cells it knows of (see Reserve), so a header takes a single block of its own size.
+ * Cells created over the reservation start a new block, twice as large as the previous one.
+ */
+class CCellArena {
+private:
+	static const size_t MIN_BLOCK_SIZE;
+
+	vector<unique_ptr<char[]>> m_Blocks;
+	size_t m_Capacity = 0;
+	size_t m_Used = 0;
+	vector<CCell *> m_Cells;
+
+	static size_t Slot ( const size_t & size );
+	void AddBlock ( const size_t & size );
+	void * Allocate ( const size_t & size );
+
+public:
+	CCellArena ( ) = default;
+	CCellArena ( const CCellArena & ) = delete;
+	CCellArena & operator = ( const CCellArena & ) = delete;
+	~CCellArena ( );
+
+	/** Constructs a cell in the arena, the cell is owned by the arena. */
+	template <typename T, typename ... TArgs>
+	T * Create ( TArgs && ... args ) {
+		T * cell = new ( Allocate( sizeof( T ) ) ) T( std::forward<TArgs>( args ) ... );
+		m_Cells.push_back( cell );
+		return cell;
+	}
+
+	/** Makes room for count more cells of given type, so creating them doesn't start another block. */
+	template <typename T>
+	void Reserve ( const size_t & count ) {
+		if ( Slot( m_Used ) + count * Slot( sizeof( T ) ) > m_Capacity )
+			AddBlock( count * Slot( sizeof( T ) ) );
+		m_Cells.reserve( m_Cells.size( ) + count );
+	}
+
+	void Clear ( );
+	size_t GetSize ( ) const { return m_Cells.size( ); }
+};
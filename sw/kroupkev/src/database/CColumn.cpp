@@ -0,0 +1,678 @@
+#include "CColumn.hpp"
+#include "CRowHash.hpp"
+
+#include <cstring>
+#include <algorithm>
+
+/**
+ * Creates an empty column of a given type.
+ */
+CColumn * CColumn::Create ( const EType & type ) {
+	switch ( type ) {
+		case TYPE_INT:
+			return new CIntColumn;
+		case TYPE_DOUBLE:
+			return new CDoubleColumn;
+		default:
+			return new CStringColumn;
+	}
+}
+
+/**
+ * Creates an empty column able to hold the value of a given cell.
+ */
+CColumn * CColumn::Create ( const CCell & cell ) {
+	if ( dynamic_cast<const CInt *>( & cell ) )
+		return new CIntColumn;
+	if ( dynamic_cast<const CDouble *>( & cell ) )
+		return new CDoubleColumn;
+	return new CStringColumn;
+}
+
+/**
+ * Returns the same type identifier as CCell::GetType does for the cells of this column.
+ */
+string CColumn::GetTypeName ( ) const {
+	switch ( GetType( ) ) {
+		case TYPE_INT:
+			return typeid( int ).name( );
+		case TYPE_DOUBLE:
+			return typeid( double ).name( );
+		default:
+			return typeid( string ).name( );
+	}
+}
+
+//
+
+CIntColumn * CIntColumn::Clone ( ) const {
+	auto * out = new CIntColumn;
+	out->m_Data = m_Data;
+	out->m_Sorted = m_Sorted;
+	return out;
+}
+
+CColumn::EType CIntColumn::GetType ( ) const {
+	return TYPE_INT;
+}
+
+size_t CIntColumn::GetSize ( ) const {
+	return m_Data.size( );
+}
+
+size_t CIntColumn::GetMemorySize ( ) const {
+	return m_Data.capacity( ) * sizeof( m_Data.front( ) );
+}
+
+void CIntColumn::Reserve ( const size_t & size ) {
+	m_Data.reserve( size );
+}
+
+void CIntColumn::Append ( const int32_t & val ) {
+	if ( m_Sorted && ! m_Data.empty( ) && val < m_Data.back( ) )
+		m_Sorted = false;
+	m_Data.push_back( val );
+}
+
+/**
+ * Replaces the values of the column by a copy of an array (e.g. a page of the snapshot).
+ * @param[in] data the values
+ * @param[in] size number of the values
+ * @param[in] sorted whether the values are in ascending order
+ */
+void CIntColumn::Assign ( const int32_t * data, const size_t & size, const bool & sorted ) {
+	m_Data.assign( data, data + size );
+	m_Sorted = sorted;
+}
+
+bool CIntColumn::AppendCell ( const CCell & cell ) {
+	const auto * src = dynamic_cast<const CInt *>( & cell );
+	if ( ! src )
+		return false;
+	Append( src->m_Val );
+	return true;
+}
+
+bool CIntColumn::AppendRow ( const CColumn & src, const size_t & row ) {
+	if ( src.GetType( ) != TYPE_INT )
+		return false;
+	Append( static_cast<const CIntColumn &>( src ).m_Data[ row ] );
+	return true;
+}
+
+/**
+ * Appends all the rows of another column of the same type.
+ * @param[in] src column to append
+ * @return false if the column types differ
+ */
+bool CIntColumn::AppendColumn ( const CColumn & src ) {
+	if ( src.GetType( ) != TYPE_INT )
+		return false;
+	const auto & ref = static_cast<const CIntColumn &>( src );
+	if ( ! ref.m_Sorted || ( ! m_Data.empty( ) && ! ref.m_Data.empty( ) && ref.m_Data.front( ) < m_Data.back( ) ) )
+		m_Sorted = false;
+	m_Data.insert( m_Data.end( ), ref.m_Data.begin( ), ref.m_Data.end( ) );
+	return true;
+}
+
+/**
+ * Creates a new column from the given rows (in the given order, rows may repeat).
+ * @param[in] rows row indexes
+ * @return new column
+ */
+CIntColumn * CIntColumn::Gather ( const vector<size_t> & rows ) const {
+	auto * out = new CIntColumn;
+	out->Reserve( rows.size( ) );
+	for ( const size_t & i : rows )
+		out->Append( m_Data[ i ] );
+	return out;
+}
+
+size_t CIntColumn::GetLength ( const size_t & row ) const {
+	return ::to_string( m_Data[ row ] ).length( );
+}
+
+ostream & CIntColumn::Print ( const size_t & row, ostream & ost ) const {
+	ost << m_Data[ row ];
+	return ost;
+}
+
+string CIntColumn::RetrieveMVal ( const size_t & row ) const {
+	return to_string( m_Data[ row ] );
+}
+
+bool CIntColumn::Equal ( const size_t & row, const CColumn & other, const size_t & otherRow ) const {
+	if ( other.GetType( ) != TYPE_INT )
+		return false;
+	return m_Data[ row ] == static_cast<const CIntColumn &>( other ).m_Data[ otherRow ];
+}
+
+bool CIntColumn::Less ( const size_t & row, const CColumn & other, const size_t & otherRow ) const {
+	if ( other.GetType( ) != TYPE_INT )
+		return false;
+	return m_Data[ row ] < static_cast<const CIntColumn &>( other ).m_Data[ otherRow ];
+}
+
+bool CIntColumn::Greater ( const size_t & row, const CColumn & other, const size_t & otherRow ) const {
+	if ( other.GetType( ) != TYPE_INT )
+		return false;
+	return m_Data[ row ] > static_cast<const CIntColumn &>( other ).m_Data[ otherRow ];
+}
+
+//
+
+CDoubleColumn * CDoubleColumn::Clone ( ) const {
+	auto * out = new CDoubleColumn;
+	out->m_Data = m_Data;
+	out->m_Sorted = m_Sorted;
+	return out;
+}
+
+CColumn::EType CDoubleColumn::GetType ( ) const {
+	return TYPE_DOUBLE;
+}
+
+size_t CDoubleColumn::GetSize ( ) const {
+	return m_Data.size( );
+}
+
+size_t CDoubleColumn::GetMemorySize ( ) const {
+	return m_Data.capacity( ) * sizeof( m_Data.front( ) );
+}
+
+void CDoubleColumn::Reserve ( const size_t & size ) {
+	m_Data.reserve( size );
+}
+
+void CDoubleColumn::Append ( const double & val ) {
+	if ( m_Sorted && ! m_Data.empty( ) && val < m_Data.back( ) )
+		m_Sorted = false;
+	m_Data.push_back( val );
+}
+
+/**
+ * Replaces the values of the column by a copy of an array (see CIntColumn::Assign).
+ */
+void CDoubleColumn::Assign ( const double * data, const size_t & size, const bool & sorted ) {
+	m_Data.assign( data, data + size );
+	m_Sorted = sorted;
+}
+
+bool CDoubleColumn::AppendCell ( const CCell & cell ) {
+	const auto * src = dynamic_cast<const CDouble *>( & cell );
+	if ( ! src )
+		return false;
+	Append( src->m_Val );
+	return true;
+}
+
+bool CDoubleColumn::AppendRow ( const CColumn & src, const size_t & row ) {
+	if ( src.GetType( ) != TYPE_DOUBLE )
+		return false;
+	Append( static_cast<const CDoubleColumn &>( src ).m_Data[ row ] );
+	return true;
+}
+
+bool CDoubleColumn::AppendColumn ( const CColumn & src ) {
+	if ( src.GetType( ) != TYPE_DOUBLE )
+		return false;
+	const auto & ref = static_cast<const CDoubleColumn &>( src );
+	if ( ! ref.m_Sorted || ( ! m_Data.empty( ) && ! ref.m_Data.empty( ) && ref.m_Data.front( ) < m_Data.back( ) ) )
+		m_Sorted = false;
+	m_Data.insert( m_Data.end( ), ref.m_Data.begin( ), ref.m_Data.end( ) );
+	return true;
+}
+
+CDoubleColumn * CDoubleColumn::Gather ( const vector<size_t> & rows ) const {
+	auto * out = new CDoubleColumn;
+	out->Reserve( rows.size( ) );
+	for ( const size_t & i : rows )
+		out->Append( m_Data[ i ] );
+	return out;
+}
+
+size_t CDoubleColumn::GetLength ( const size_t & row ) const {
+	return ::to_string( m_Data[ row ] ).length( );
+}
+
+ostream & CDoubleColumn::Print ( const size_t & row, ostream & ost ) const {
+	ost.precision( 2 );
+	ost << fixed << m_Data[ row ];
+	return ost;
+}
+
+string CDoubleColumn::RetrieveMVal ( const size_t & row ) const {
+	return to_string( m_Data[ row ] );
+}
+
+bool CDoubleColumn::Equal ( const size_t & row, const CColumn & other, const size_t & otherRow ) const {
+	if ( other.GetType( ) != TYPE_DOUBLE )
+		return false;
+	return CDouble::cmpEq( m_Data[ row ], static_cast<const CDoubleColumn &>( other ).m_Data[ otherRow ] );
+}
+
+bool CDoubleColumn::Less ( const size_t & row, const CColumn & other, const size_t & otherRow ) const {
+	if ( other.GetType( ) != TYPE_DOUBLE )
+		return false;
+	return CDouble::cmpLt( m_Data[ row ], static_cast<const CDoubleColumn &>( other ).m_Data[ otherRow ] );
+}
+
+bool CDoubleColumn::Greater ( const size_t & row, const CColumn & other, const size_t & otherRow ) const {
+	if ( other.GetType( ) != TYPE_DOUBLE )
+		return false;
+	return CDouble::cmpGt( m_Data[ row ], static_cast<const CDoubleColumn &>( other ).m_Data[ otherRow ] );
+}
+
+//
+
+const uint32_t CStringDictionary::NO_CODE = UINT32_MAX;
+
+/**
+ * Bytes taken by the values, their hashes and the lookup table.
+ */
+size_t CStringDictionary::GetMemorySize ( ) const {
+	size_t size = m_Values.capacity( ) * sizeof( string ) + m_Hashes.capacity( ) * sizeof( uint64_t ) + m_Slots.capacity( ) * sizeof( uint32_t );
+	for ( const string & i : m_Values )
+		size += i.capacity( );
+	return size;
+}
+
+/**
+ * Searches for the code of a value.
+ * @param[in] str beginning of the value
+ * @param[in] len length of the value
+ * @param[in] hash hash of the value (CRowHash::HashBytes)
+ * @return code of the value, NO_CODE if it isn't in the dictionary
+ */
+uint32_t CStringDictionary::Find ( const char * str, const size_t & len, const uint64_t & hash ) const {
+	if ( m_Slots.empty( ) )
+		return NO_CODE;
+	size_t mask = m_Slots.size( ) - 1;
+	for ( size_t i = hash & mask; m_Slots[ i ] != NO_CODE; i = ( i + 1 ) & mask ) {
+		uint32_t code = m_Slots[ i ];
+		if ( m_Hashes[ code ] == hash && m_Values[ code ].size( ) == len && memcmp( m_Values[ code ].data( ), str, len ) == 0 )
+			return code;
+	}
+	return NO_CODE;
+}
+
+uint32_t CStringDictionary::Find ( const string & val ) const {
+	return Find( val.data( ), val.size( ), CRowHash::HashBytes( val.data( ), val.size( ) ) );
+}
+
+/**
+ * Appends a value missing in the dictionary. The lookup table is kept at most half full.
+ * @return code of the new value
+ */
+uint32_t CStringDictionary::Insert ( const char * str, const size_t & len, const uint64_t & hash ) {
+	uint32_t code = static_cast<uint32_t>( m_Values.size( ) );
+	m_Values.emplace_back( str, len );
+	m_Hashes.push_back( hash );
+	if ( m_Slots.size( ) < 2 * m_Values.size( ) ) {
+		m_Slots.assign( max( static_cast<size_t>( 16 ), 2 * m_Slots.size( ) ), NO_CODE );
+		for ( uint32_t i = 0; i < m_Values.size( ); ++ i ) {
+			size_t slot = m_Hashes[ i ] & ( m_Slots.size( ) - 1 );
+			while ( m_Slots[ slot ] != NO_CODE )
+				slot = ( slot + 1 ) & ( m_Slots.size( ) - 1 );
+			m_Slots[ slot ] = i;
+		}
+		return code;
+	}
+	size_t slot = hash & ( m_Slots.size( ) - 1 );
+	while ( m_Slots[ slot ] != NO_CODE )
+		slot = ( slot + 1 ) & ( m_Slots.size( ) - 1 );
+	m_Slots[ slot ] = code;
+	return code;
+}
+
+/**
+ * Maps the codes of this dictionary onto the codes of the same values in another one.
+ * @param[in] other the other dictionary
+ * @return code in the other dictionary for each code of this one, NO_CODE if the value is missing there
+ */
+vector<uint32_t> CStringDictionary::Translate ( const CStringDictionary & other ) const {
+	vector<uint32_t> out;
+	out.reserve( m_Values.size( ) );
+	for ( const string & i : m_Values )
+		out.push_back( other.Find( i ) );
+	return out;
+}
+
+//
+
+/**
+ * A column is dictionary encoded, if it has at most DICTIONARY_RATIO distinct values per row (see CTable::EncodeColumns).
+ * Below it a row code (4 bytes) and the dictionary entries take less than the offset and the length of each row.
+ */
+const double CStringColumn::DICTIONARY_RATIO = 0.05;
+
+CStringColumn * CStringColumn::Clone ( ) const {
+	auto * out = new CStringColumn;
+	out->m_Offsets = m_Offsets;
+	out->m_Lengths = m_Lengths;
+	out->m_Blob = m_Blob;
+	out->m_External = m_External;
+	out->m_ExternalSize = m_ExternalSize;
+	out->m_Dictionary = m_Dictionary;
+	out->m_Codes = m_Codes;
+	out->m_Sorted = m_Sorted;
+	return out;
+}
+
+CColumn::EType CStringColumn::GetType ( ) const {
+	return TYPE_STRING;
+}
+
+size_t CStringColumn::GetSize ( ) const {
+	return m_Dictionary ? m_Codes.size( ) : m_Offsets.size( );
+}
+
+/**
+ * Bytes taken by the column data, the external data isn't counted (it's shared with the table it was imported for).
+ * The dictionary is counted whole, even though it may be shared with other columns.
+ */
+size_t CStringColumn::GetMemorySize ( ) const {
+	return m_Offsets.capacity( ) * sizeof( size_t ) + m_Lengths.capacity( ) * sizeof( uint32_t ) + m_Blob.capacity( )
+	       + m_Codes.capacity( ) * sizeof( uint32_t ) + ( m_Dictionary ? m_Dictionary->GetMemorySize( ) : 0 );
+}
+
+void CStringColumn::Reserve ( const size_t & size ) {
+	if ( m_Dictionary )
+		m_Codes.reserve( size );
+	else {
+		m_Offsets.reserve( size );
+		m_Lengths.reserve( size );
+	}
+}
+
+/**
+ * Replaces the values of the column by their codes in a new dictionary. The column is left as it is,
+ * if it has more than DICTIONARY_RATIO distinct values per row.
+ * @return true if the column is dictionary encoded
+ */
+bool CStringColumn::Encode ( ) {
+	if ( m_Dictionary )
+		return true;
+	size_t rows = GetSize( );
+	auto dictionary = make_shared<CStringDictionary>( );
+	vector<uint32_t> codes;
+	codes.reserve( rows );
+	for ( size_t i = 0; i < rows; ++ i ) {
+		const char * str = GetStr( i );
+		size_t len = GetStrLen( i );
+		uint64_t hash = CRowHash::HashBytes( str, len );
+		uint32_t code = dictionary->Find( str, len, hash );
+		if ( code == CStringDictionary::NO_CODE ) {
+			if ( dictionary->GetSize( ) + 1 > rows * DICTIONARY_RATIO )
+				return false;
+			code = dictionary->Insert( str, len, hash );
+		}
+		codes.push_back( code );
+	}
+
+	m_Dictionary = dictionary;
+	m_Codes.swap( codes );
+	vector<size_t> ( ).swap( m_Offsets );
+	vector<uint32_t> ( ).swap( m_Lengths );
+	string ( ).swap( m_Blob );
+	m_External.reset( );
+	m_ExternalSize = 0;
+	return true;
+}
+
+/**
+ * Clears the sorted flag if the value to be appended is lower than the last one.
+ */
+void CStringColumn::UpdateSorted ( const char * str, const size_t & len ) {
+	if ( m_Sorted && GetSize( ) > 0 ) {
+		size_t last = GetSize( ) - 1, lastLen = GetStrLen( last );
+		int res = memcmp( GetStr( last ), str, lastLen < len ? lastLen : len );
+		if ( res > 0 || ( res == 0 && lastLen > len ) )
+			m_Sorted = false;
+	}
+}
+
+void CStringColumn::AppendOffset ( const size_t & offset, const size_t & len ) {
+	m_Offsets.push_back( offset );
+	m_Lengths.push_back( static_cast<uint32_t>( len ) );
+}
+
+/**
+ * Appends a row of a dictionary encoded column.
+ * @param[in] code code of the value in the column dictionary
+ */
+void CStringColumn::AppendCode ( const uint32_t & code ) {
+	const string & val = m_Dictionary->GetValue( code );
+	UpdateSorted( val.data( ), val.size( ) );
+	m_Codes.push_back( code );
+}
+
+/**
+ * Lets the column reference external data. Allowed only while the column is empty and not dictionary encoded.
+ * @param[in] data beginning of the data (owned by the shared pointer)
+ * @param[in] size size of the data
+ */
+void CStringColumn::BindExternal ( const shared_ptr<const char> & data, const size_t & size ) {
+	if ( GetSize( ) > 0 || ! m_Blob.empty( ) || m_Dictionary )
+		return;
+	m_External = data;
+	m_ExternalSize = data ? size : 0;
+}
+
+/**
+ * Appends a value without copying it, if it lies inside of the external data (copies it otherwise).
+ * @param[in] str beginning of the value
+ * @param[in] len length of the value
+ */
+void CStringColumn::AppendExternal ( const char * str, const size_t & len ) {
+	const char * base = m_External.get( );
+	if ( ! base || str < base || str + len > base + m_ExternalSize ) {
+		Append( str, len );
+		return;
+	}
+	UpdateSorted( str, len );
+	AppendOffset( static_cast<size_t>( str - base ), len );
+}
+
+/**
+ * Replaces the rows of the column by the values of the external data (see BindExternal) at the given offsets.
+ * The offsets have to lie inside of the external data, they're not checked.
+ * @param[in] offsets offsets of the values in the external data
+ * @param[in] lengths lengths of the values
+ * @param[in] size number of the rows
+ * @param[in] sorted whether the values are in ascending order
+ */
+void CStringColumn::AssignExternal ( const uint64_t * offsets, const uint32_t * lengths, const size_t & size, const bool & sorted ) {
+	if ( m_Dictionary )
+		return;
+	m_Offsets.assign( offsets, offsets + size );
+	m_Lengths.assign( lengths, lengths + size );
+	m_Blob.clear( );
+	m_Sorted = sorted;
+}
+
+/**
+ * Replaces the rows of the column by the codes of an existing dictionary (the column becomes dictionary encoded).
+ * The codes have to be valid in the dictionary, they're not checked.
+ * @param[in] dictionary the dictionary
+ * @param[in] codes code of each row
+ * @param[in] size number of the rows
+ * @param[in] sorted whether the values are in ascending order
+ */
+void CStringColumn::AssignEncoded ( const shared_ptr<CStringDictionary> & dictionary, const uint32_t * codes, const size_t & size, const bool & sorted ) {
+	m_Dictionary = dictionary;
+	m_Codes.assign( codes, codes + size );
+	vector<size_t> ( ).swap( m_Offsets );
+	vector<uint32_t> ( ).swap( m_Lengths );
+	string ( ).swap( m_Blob );
+	m_External.reset( );
+	m_ExternalSize = 0;
+	m_Sorted = sorted;
+}
+
+/**
+ * Appends a copy of a value. A value missing in the dictionary of an encoded column is inserted into it,
+ * a dictionary shared with other columns is copied first.
+ */
+void CStringColumn::Append ( const char * str, const size_t & len ) {
+	if ( m_Dictionary ) {
+		uint64_t hash = CRowHash::HashBytes( str, len );
+		uint32_t code = m_Dictionary->Find( str, len, hash );
+		if ( code == CStringDictionary::NO_CODE ) {
+			if ( m_Dictionary.use_count( ) > 1 )
+				m_Dictionary = make_shared<CStringDictionary>( * m_Dictionary );
+			code = m_Dictionary->Insert( str, len, hash );
+		}
+		AppendCode( code );
+		return;
+	}
+	UpdateSorted( str, len );
+	AppendOffset( m_ExternalSize + m_Blob.size( ), len );
+	m_Blob.append( str, len );
+}
+
+void CStringColumn::Append ( const string & str ) {
+	Append( str.data( ), str.size( ) );
+}
+
+bool CStringColumn::AppendCell ( const CCell & cell ) {
+	const auto * src = dynamic_cast<const CString *>( & cell );
+	if ( ! src )
+		return false;
+	Append( src->m_Val );
+	return true;
+}
+
+bool CStringColumn::AppendRow ( const CColumn & src, const size_t & row ) {
+	if ( src.GetType( ) != TYPE_STRING )
+		return false;
+	const auto & ref = static_cast<const CStringColumn &>( src );
+	if ( SharesDictionary( ref ) )
+		AppendCode( ref.m_Codes[ row ] );
+	else if ( ! ref.m_Dictionary && ref.m_Offsets[ row ] < ref.m_ExternalSize && ref.m_External == m_External )
+		AppendExternal( ref.GetStr( row ), ref.GetStrLen( row ) );
+	else
+		Append( ref.GetStr( row ), ref.GetStrLen( row ) );
+	return true;
+}
+
+/**
+ * Appends all the values of another column. An empty column adopts the external data or the dictionary of the source,
+ * values referencing the same external data (or codes of the same dictionary) are then not copied.
+ */
+bool CStringColumn::AppendColumn ( const CColumn & src ) {
+	if ( src.GetType( ) != TYPE_STRING )
+		return false;
+	const auto & ref = static_cast<const CStringColumn &>( src );
+	if ( ref.GetSize( ) == 0 )
+		return true;
+	if ( ref.m_Dictionary && GetSize( ) == 0 && ! m_Dictionary ) {
+		m_Blob.clear( );
+		m_External.reset( );
+		m_ExternalSize = 0;
+		m_Dictionary = ref.m_Dictionary;
+	}
+	if ( SharesDictionary( ref ) ) {
+		UpdateSorted( ref.GetStr( 0 ), ref.GetStrLen( 0 ) );
+		if ( ! ref.m_Sorted )
+			m_Sorted = false;
+		m_Codes.insert( m_Codes.end( ), ref.m_Codes.begin( ), ref.m_Codes.end( ) );
+		return true;
+	}
+	if ( ! m_Dictionary && ! ref.m_Dictionary )
+		BindExternal( ref.m_External, ref.m_ExternalSize );
+	if ( m_Dictionary || ref.m_Dictionary || ( ref.m_ExternalSize != 0 && ref.m_External != m_External ) ) {
+		for ( size_t i = 0; i < ref.GetSize( ); ++ i )
+			AppendRow( ref, i );
+		return true;
+	}
+
+	UpdateSorted( ref.GetStr( 0 ), ref.GetStrLen( 0 ) );
+	if ( ! ref.m_Sorted )
+		m_Sorted = false;
+	size_t shift = m_ExternalSize + m_Blob.size( );
+	m_Blob.append( ref.m_Blob );
+	m_Offsets.reserve( m_Offsets.size( ) + ref.GetSize( ) );
+	for ( const size_t & i : ref.m_Offsets )
+		m_Offsets.push_back( i < ref.m_ExternalSize ? i : i - ref.m_ExternalSize + shift );
+	m_Lengths.insert( m_Lengths.end( ), ref.m_Lengths.begin( ), ref.m_Lengths.end( ) );
+	return true;
+}
+
+/**
+ * The gathered column references the same external data (or shares the dictionary), only the values from the blob are copied.
+ */
+CStringColumn * CStringColumn::Gather ( const vector<size_t> & rows ) const {
+	auto * out = new CStringColumn;
+	if ( m_Dictionary ) {
+		out->m_Dictionary = m_Dictionary;
+		out->Reserve( rows.size( ) );
+		for ( const size_t & i : rows )
+			out->AppendCode( m_Codes[ i ] );
+		return out;
+	}
+	out->Reserve( rows.size( ) );
+	out->BindExternal( m_External, m_ExternalSize );
+	for ( const size_t & i : rows ) {
+		if ( m_Offsets[ i ] < m_ExternalSize )
+			out->AppendExternal( GetStr( i ), GetStrLen( i ) );
+		else
+			out->Append( GetStr( i ), GetStrLen( i ) );
+	}
+	return out;
+}
+
+/**
+ * Hash of a value, the same as CRowHash::HashBytes of it. The hashes of the encoded values are kept in the dictionary.
+ */
+uint64_t CStringColumn::Hash ( const size_t & row ) const {
+	return m_Dictionary ? m_Dictionary->GetHash( m_Codes[ row ] ) : CRowHash::HashBytes( GetStr( row ), GetStrLen( row ) );
+}
+
+size_t CStringColumn::GetLength ( const size_t & row ) const {
+	return GetStrLen( row );
+}
+
+ostream & CStringColumn::Print ( const size_t & row, ostream & ost ) const {
+	ost << RetrieveMVal( row );
+	return ost;
+}
+
+string CStringColumn::RetrieveMVal ( const size_t & row ) const {
+	return string( GetStr( row ), GetStrLen( row ) );
+}
+
+/**
+ * Lexicographical comparison, identical to the one of std::string. Equal codes of a shared dictionary are equal values.
+ * @return negative, zero or positive number (same as strcmp)
+ */
+int CStringColumn::CompareTo ( const size_t & row, const CStringColumn & other, const size_t & otherRow ) const {
+	if ( SharesDictionary( other ) && m_Codes[ row ] == other.m_Codes[ otherRow ] )
+		return 0;
+	size_t lenA = GetStrLen( row ), lenB = other.GetStrLen( otherRow );
+	int res = memcmp( GetStr( row ), other.GetStr( otherRow ), lenA < lenB ? lenA : lenB );
+	if ( res != 0 )
+		return res;
+	return lenA < lenB ? -1 : ( lenA > lenB ? 1 : 0 );
+}
+
+bool CStringColumn::Equal ( const size_t & row, const CColumn & other, const size_t & otherRow ) const {
+	if ( other.GetType( ) != TYPE_STRING )
+		return false;
+	const auto & ref = static_cast<const CStringColumn &>( other );
+	if ( SharesDictionary( ref ) )
+		return m_Codes[ row ] == ref.m_Codes[ otherRow ];
+	return GetStrLen( row ) == ref.GetStrLen( otherRow ) && CompareTo( row, ref, otherRow ) == 0;
+}
+
+bool CStringColumn::Less ( const size_t & row, const CColumn & other, const size_t & otherRow ) const {
+	if ( other.GetType( ) != TYPE_STRING )
+		return false;
+	return CompareTo( row, static_cast<const CStringColumn &>( other ), otherRow ) < 0;
+}
+
+bool CStringColumn::Greater ( const size_t & row, const CColumn & other, const size_t & otherRow ) const {
+	if ( other.GetType( ) != TYPE_STRING )
+		return false;
+	return CompareTo( row, static_cast<const CStringColumn &>( other ), otherRow ) > 0;
+}
@@ -0,0 +1,214 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include "CCell.hpp"
+
+using namespace std;
+
+/**
+ * This module stores the data of a single table column in a typed, contiguous form.
+ * Integers and doubles are kept in plain arrays, strings in an offset + blob layout,
+ * so a value costs only its payload (no vtable, no pointer, no allocation per value).
+ *
+ * The comparison methods follow the semantics of CCell operators exactly:
+ * values of different types never match and doubles are compared with an epsilon.
+ *
+ * Each column also tracks, whether its values were appended in ascending order,
+ * so the join can pick a merge of the sorted inputs instead of a hash table.
+ */
+class CColumn {
+public:
+	enum EType { TYPE_INT, TYPE_DOUBLE, TYPE_STRING };
+
+	CColumn ( ) = default;
+	CColumn ( const CColumn & src ) = delete;
+	CColumn & operator = ( const CColumn & src ) = delete;
+	virtual ~CColumn ( ) = default;
+
+	static CColumn * Create ( const EType & type );
+	static CColumn * Create ( const CCell & cell );
+
+	virtual CColumn * Clone ( ) const = 0;
+	virtual EType GetType ( ) const = 0;
+	virtual size_t GetSize ( ) const = 0;
+	virtual size_t GetMemorySize ( ) const = 0;
+	virtual void Reserve ( const size_t & size ) = 0;
+
+	virtual bool AppendCell ( const CCell & cell ) = 0;
+	virtual bool AppendRow ( const CColumn & src, const size_t & row ) = 0;
+	virtual bool AppendColumn ( const CColumn & src ) = 0;
+	virtual CColumn * Gather ( const vector<size_t> & rows ) const = 0;
+
+	virtual size_t GetLength ( const size_t & row ) const = 0;
+	virtual ostream & Print ( const size_t & row, ostream & ost = cout ) const = 0;
+	virtual string RetrieveMVal ( const size_t & row ) const = 0;
+	string GetTypeName ( ) const;
+	bool IsSorted ( ) const { return m_Sorted; }
+
+	virtual bool Equal ( const size_t & row, const CColumn & other, const size_t & otherRow ) const = 0;
+	virtual bool Less ( const size_t & row, const CColumn & other, const size_t & otherRow ) const = 0;
+	virtual bool Greater ( const size_t & row, const CColumn & other, const size_t & otherRow ) const = 0;
+
+protected:
+	bool m_Sorted = true;
+};
+
+class CIntColumn : public CColumn {
+private:
+	vector<int32_t> m_Data;
+
+public:
+	virtual CIntColumn * Clone ( ) const override;
+	virtual EType GetType ( ) const override;
+	virtual size_t GetSize ( ) const override;
+	virtual size_t GetMemorySize ( ) const override;
+	virtual void Reserve ( const size_t & size ) override;
+
+	void Append ( const int32_t & val );
+	void Assign ( const int32_t * data, const size_t & size, const bool & sorted );
+	virtual bool AppendCell ( const CCell & cell ) override;
+	virtual bool AppendRow ( const CColumn & src, const size_t & row ) override;
+	virtual bool AppendColumn ( const CColumn & src ) override;
+	virtual CIntColumn * Gather ( const vector<size_t> & rows ) const override;
+	const int32_t * GetData ( ) const { return m_Data.data( ); }
+	int32_t GetVal ( const size_t & row ) const { return m_Data[ row ]; }
+
+	virtual size_t GetLength ( const size_t & row ) const override;
+	virtual ostream & Print ( const size_t & row, ostream & ost = cout ) const override;
+	virtual string RetrieveMVal ( const size_t & row ) const override;
+
+	virtual bool Equal ( const size_t & row, const CColumn & other, const size_t & otherRow ) const override;
+	virtual bool Less ( const size_t & row, const CColumn & other, const size_t & otherRow ) const override;
+	virtual bool Greater ( const size_t & row, const CColumn & other, const size_t & otherRow ) const override;
+};
+
+class CDoubleColumn : public CColumn {
+private:
+	vector<double> m_Data;
+
+public:
+	virtual CDoubleColumn * Clone ( ) const override;
+	virtual EType GetType ( ) const override;
+	virtual size_t GetSize ( ) const override;
+	virtual size_t GetMemorySize ( ) const override;
+	virtual void Reserve ( const size_t & size ) override;
+
+	void Append ( const double & val );
+	void Assign ( const double * data, const size_t & size, const bool & sorted );
+	virtual bool AppendCell ( const CCell & cell ) override;
+	virtual bool AppendRow ( const CColumn & src, const size_t & row ) override;
+	virtual bool AppendColumn ( const CColumn & src ) override;
+	virtual CDoubleColumn * Gather ( const vector<size_t> & rows ) const override;
+	const double * GetData ( ) const { return m_Data.data( ); }
+	double GetVal ( const size_t & row ) const { return m_Data[ row ]; }
+
+	virtual size_t GetLength ( const size_t & row ) const override;
+	virtual ostream & Print ( const size_t & row, ostream & ost = cout ) const override;
+	virtual string RetrieveMVal ( const size_t & row ) const override;
+
+	virtual bool Equal ( const size_t & row, const CColumn & other, const size_t & otherRow ) const override;
+	virtual bool Less ( const size_t & row, const CColumn & other, const size_t & otherRow ) const override;
+	virtual bool Greater ( const size_t & row, const CColumn & other, const size_t & otherRow ) const override;
+};
+
+/**
+ * Distinct values of dictionary encoded string columns (see CStringColumn::Encode), a value is identified by its code.
+ * The dictionary is shared by the columns gathered from the same column, the values are only ever appended to it,
+ * so the codes stay valid in all of them. The hash of each value is kept (it's the same as CRowHash::HashBytes of the value),
+ * the codes are looked up by it in an open addressing table.
+ */
+class CStringDictionary {
+private:
+	vector<string> m_Values;
+	vector<uint64_t> m_Hashes;
+	vector<uint32_t> m_Slots;
+
+public:
+	static const uint32_t NO_CODE;
+
+	size_t GetSize ( ) const { return m_Values.size( ); }
+	size_t GetMemorySize ( ) const;
+	const string & GetValue ( const uint32_t & code ) const { return m_Values[ code ]; }
+	uint64_t GetHash ( const uint32_t & code ) const { return m_Hashes[ code ]; }
+
+	uint32_t Find ( const char * str, const size_t & len, const uint64_t & hash ) const;
+	uint32_t Find ( const string & val ) const;
+	uint32_t Insert ( const char * str, const size_t & len, const uint64_t & hash );
+	vector<uint32_t> Translate ( const CStringDictionary & other ) const;
+};
+
+/**
+ * Strings are stored back to back in a single blob, the value of row i starts at m_Offsets[ i ]
+ * and is m_Lengths[ i ] characters long.
+ *
+ * The column can also reference external data (e.g. a memory mapped file) instead of copying it.
+ * Offsets below the external data size point into the external data, the rest of them into the blob
+ * (shifted by the external data size). The column shares the ownership of the external data,
+ * so it stays valid for as long as any column referencing it lives.
+ *
+ * A column with few distinct values can be dictionary encoded instead - each row keeps only the code of its value
+ * in the dictionary (see CStringDictionary), the offsets and the blob are then empty. Rows of the columns sharing
+ * a dictionary are compared by their codes.
+ */
+class CStringColumn : public CColumn {
+private:
+	vector<size_t> m_Offsets;
+	vector<uint32_t> m_Lengths;
+	string m_Blob;
+	shared_ptr<const char> m_External;
+	size_t m_ExternalSize = 0;
+	shared_ptr<CStringDictionary> m_Dictionary;
+	vector<uint32_t> m_Codes;
+
+	void UpdateSorted ( const char * str, const size_t & len );
+	void AppendOffset ( const size_t & offset, const size_t & len );
+	void AppendCode ( const uint32_t & code );
+	bool SharesDictionary ( const CStringColumn & other ) const { return m_Dictionary && m_Dictionary == other.m_Dictionary; }
+	int CompareTo ( const size_t & row, const CStringColumn & other, const size_t & otherRow ) const;
+
+public:
+	static const double DICTIONARY_RATIO;
+
+	virtual CStringColumn * Clone ( ) const override;
+	virtual EType GetType ( ) const override;
+	virtual size_t GetSize ( ) const override;
+	virtual size_t GetMemorySize ( ) const override;
+	virtual void Reserve ( const size_t & size ) override;
+
+	bool Encode ( );
+	bool IsEncoded ( ) const { return m_Dictionary != nullptr; }
+	const CStringDictionary * GetDictionary ( ) const { return m_Dictionary.get( ); }
+	const uint32_t * GetCodes ( ) const { return m_Codes.data( ); }
+	uint32_t GetCode ( const size_t & row ) const { return m_Codes[ row ]; }
+
+	void BindExternal ( const shared_ptr<const char> & data, const size_t & size );
+	void AppendExternal ( const char * str, const size_t & len );
+	void AssignExternal ( const uint64_t * offsets, const uint32_t * lengths, const size_t & size, const bool & sorted );
+	void AssignEncoded ( const shared_ptr<CStringDictionary> & dictionary, const uint32_t * codes, const size_t & size, const bool & sorted );
+	void Append ( const char * str, const size_t & len );
+	void Append ( const string & str );
+	virtual bool AppendCell ( const CCell & cell ) override;
+	virtual bool AppendRow ( const CColumn & src, const size_t & row ) override;
+	virtual bool AppendColumn ( const CColumn & src ) override;
+	virtual CStringColumn * Gather ( const vector<size_t> & rows ) const override;
+	const char * GetStr ( const size_t & row ) const {
+		if ( m_Dictionary )
+			return m_Dictionary->GetValue( m_Codes[ row ] ).data( );
+		return m_Offsets[ row ] < m_ExternalSize ? m_External.get( ) + m_Offsets[ row ] : m_Blob.data( ) + ( m_Offsets[ row ] - m_ExternalSize );
+	}
+	size_t GetStrLen ( const size_t & row ) const { return m_Dictionary ? m_Dictionary->GetValue( m_Codes[ row ] ).size( ) : m_Lengths[ row ]; }
+	uint64_t Hash ( const size_t & row ) const;
+
+	virtual size_t GetLength ( const size_t & row ) const override;
+	virtual ostream & Print ( const size_t & row, ostream & ost = cout ) const override;
+	virtual string RetrieveMVal ( const size_t & row ) const override;
+
+	virtual bool Equal ( const size_t & row, const CColumn & other, const size_t & otherRow ) const override;
+	virtual bool Less ( const size_t & row, const CColumn & other, const size_t & otherRow ) const override;
+	virtual bool Greater ( const size_t & row, const CColumn & other, const size_t & otherRow ) const override;
+};
@@ -0,0 +1,126 @@
+#include "CCondition.hpp"
+#include "../console/CLog.hpp"
+
+#include <algorithm>
+
+/**
+ * The operator of the comparison with the swapped operands ( 5 < col is col > 5 ).
+ */
+string CCondition::ReverseOperator ( const string & op ) {
+	if ( op == "==" || op == "!=" )
+		return op;
+	return string( op[ 0 ] == '<' ? ">" : "<" ) + op.substr( 1 );
+}
+
+/**
+ * Decides, whether the unquoted constants are columns - a constant is a column, if the input has a column of that name,
+ * otherwise it's a string constant. If only the constant is an input column, the operands of the comparison are swapped.
+ * The constants compared with a string column are then marked as strings (the same way the evaluation types them, see CTable::CreatePredicate),
+ * so the condition is printed the same before it's evaluated.
+ * @param[in] header names of the input columns
+ * @param[in] types data types of the input columns
+ */
+void CCondition::Resolve ( const vector<string> & header, const vector<CColumn::EType> & types ) {
+	if ( ! IsLeaf( ) ) {
+		for ( unique_ptr<CCondition> & i : m_Children )
+			i->Resolve( header, types );
+		return;
+	}
+	auto exists = [ & header ] ( const string & name ) { return find( header.begin( ), header.end( ), name ) != header.end( ); };
+	if ( IsBareConstant ) {
+		if ( ! exists( m_Column ) && exists( m_Constant ) ) {
+			swap( m_Column, m_Constant );
+			m_Operator = ReverseOperator( m_Operator );
+		}
+		IsColumnOperand = exists( m_Constant );
+	}
+	size_t column = find( header.begin( ), header.end( ), m_Column ) - header.begin( );
+	if ( ! IsColumnOperand && column < types.size( ) && types[ column ] == CColumn::TYPE_STRING )
+		IsStringConstant = true;
+}
+
+/**
+ * Names of the columns the condition reads, in the order of the tree (a column may be listed more times).
+ */
+vector<string> CCondition::GetColumns ( ) const {
+	vector<string> columns;
+	CollectColumns( columns );
+	return columns;
+}
+
+void CCondition::CollectColumns ( vector<string> & columns ) const {
+	if ( ! IsLeaf( ) ) {
+		for ( const unique_ptr<CCondition> & i : m_Children )
+			i->CollectColumns( columns );
+		return;
+	}
+	columns.push_back( m_Column );
+	if ( IsColumnOperand )
+		columns.push_back( m_Constant );
+}
+
+/**
+ * Conditions, which all have to be met - the children of AND, otherwise the condition itself.
+ * @return the conditions (owned by this condition)
+ */
+vector<CCondition *> CCondition::GetConjuncts ( ) {
+	if ( m_Kind != AND )
+		return { this };
+	vector<CCondition *> conjuncts;
+	for ( unique_ptr<CCondition> & i : m_Children )
+		for ( CCondition * j : i->GetConjuncts( ) )
+			conjuncts.push_back( j );
+	return conjuncts;
+}
+
+/**
+ * The condition in SQL, with the column names of the condition.
+ */
+string CCondition::GetSQL ( ) const {
+	return GetSQL( GetColumns( ) );
+}
+
+/**
+ * The condition in SQL.
+ * @param[in] columns names of the condition columns in the order of the tree (see GetColumns)
+ */
+string CCondition::GetSQL ( const vector<string> & columns ) const {
+	size_t position = 0;
+	return Print( columns, position, false );
+}
+
+string CCondition::PrintConstant ( const string & constant ) const {
+	return string( CLog::APP_COLOR_RESULT )
+	.append( IsStringConstant ? string( "\"" ).append( constant ).append( "\"" ) : constant )
+	.append( CLog::APP_COLOR_RESET );
+}
+
+/**
+ * @param[in] columns names of the condition columns
+ * @param[in, out] position index of the first column of this condition in the names
+ * @param[in] nested true if the condition is a part of another one (AND and OR are then parenthesized)
+ */
+string CCondition::Print ( const vector<string> & columns, size_t & position, const bool & nested ) const {
+	if ( m_Kind == NOT )
+		return "NOT ( " + m_Children.front( )->Print( columns, position, false ) + " )";
+	if ( m_Kind == AND || m_Kind == OR ) {
+		string output;
+		for ( size_t i = 0; i < m_Children.size( ); ++ i )
+			output += ( i ? ( m_Kind == AND ? " AND " : " OR " ) : "" ) + m_Children[ i ]->Print( columns, position, true );
+		return nested ? "( " + output + " )" : output;
+	}
+
+	string output = string( CLog::APP_COLOR_RESULT ).append( columns[ position ++ ] ).append( CLog::APP_COLOR_RESET );
+	if ( m_Kind == BETWEEN )
+		return output + " BETWEEN " + PrintConstant( m_Constants.front( ) ) + " AND " + PrintConstant( m_Constants.back( ) );
+	if ( m_Kind == IN ) {
+		output += m_Operator == "!=" ? " NOT IN ( " : " IN ( ";
+		for ( size_t i = 0; i < m_Constants.size( ); ++ i )
+			output += ( i ? ", " : "" ) + PrintConstant( m_Constants[ i ] );
+		return output + " )";
+	}
+	output += " " + m_Operator + " ";
+	if ( IsColumnOperand )
+		return output + string( CLog::APP_COLOR_RESULT ).append( columns[ position ++ ] ).append( CLog::APP_COLOR_RESET );
+	return output + PrintConstant( m_Constant );
+}
@@ -1,13 +1,49 @@
 #pragma once
 
 #include <string>
+#include <vector>
+#include <memory>
+
+#include "CColumn.hpp"
 
 using namespace std;
 
+/**
+ * Condition of a PRO query. A leaf condition compares a column with a constant (COMPARE), with another column
+ * (COMPARE with IsColumnOperand), with a set of constants (IN) or with a range of them (BETWEEN, bounds included).
+ * The leaves are joined by the logical operators (AND, OR, NOT) into a tree, which owns its children.
+ *
+ * The columns of the condition are listed in the order of the tree (see GetColumns), the stages, which evaluate
+ * the condition under other column names, keep the names in the same order.
+ *
+ * A constant written without quotes, which isn't a number, (IsBareConstant) may also name a column. It's decided once
+ * the input columns are known (see Resolve), the constants compared with the string columns are marked then as well.
+ */
 class CCondition {
 public:
+	enum EKind { COMPARE, IN, BETWEEN, AND, OR, NOT };
+
+	EKind m_Kind = COMPARE;
 	string m_Column;
 	string m_Operator;
 	string m_Constant;
+	vector<string> m_Constants;
+	vector<unique_ptr<CCondition>> m_Children;
 	bool IsStringConstant = false;
+	bool IsColumnOperand = false;
+	bool IsBareConstant = false;
+
+	static string ReverseOperator ( const string & op );
+
+	bool IsLeaf ( ) const { return m_Kind == COMPARE || m_Kind == IN || m_Kind == BETWEEN; }
+	void Resolve ( const vector<string> & header, const vector<CColumn::EType> & types );
+	vector<string> GetColumns ( ) const;
+	vector<CCondition *> GetConjuncts ( );
+	string GetSQL ( ) const;
+	string GetSQL ( const vector<string> & columns ) const;
+
+private:
+	void CollectColumns ( vector<string> & columns ) const;
+	string PrintConstant ( const string & constant ) const;
+	string Print ( const vector<string> & columns, size_t & position, const bool & nested ) const;
 };
\ No newline at end of file
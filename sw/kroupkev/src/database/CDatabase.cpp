@@ -9,32 +9,231 @@ CDatabase::CDatabase ( string name ) : m_Name( std::move( name ) ) {
 }
 
 CDatabase::~CDatabase ( ) {
+	m_Cache.Clear( );
 	for ( const auto & i : m_TableData ) delete i.second;
 	for ( const auto & i : m_QueryData ) delete i.second;
+	for ( const auto & i : m_Indexes )
+		for ( CIndex * j : i.second ) delete j;
 }
 
 /**
- * Table insertion.
+ * Table insertion. The string columns with few distinct values are dictionary encoded and the statistics of the table columns
+ * are collected, so the query plans can be optimized by them. A table restored with its statistics (see CSnapshot)
+ * is already encoded, it's inserted as it is.
  * @param[in] tableName name of the new table
  * @param[in] tableRef reference to the table itself
  * @return true if table was inserted into database without any errors.
  */
 bool CDatabase::InsertTable ( const string & tableName, CTable * tableRef ) {
-	return m_TableData.insert( pair<string, CTable *>( tableName, tableRef ) ).second;
+	if ( ! m_TableData.insert( pair<string, CTable *>( tableName, tableRef ) ).second )
+		return false;
+	if ( ! tableRef->GetStatistics( ) ) {
+		tableRef->EncodeColumns( );
+		tableRef->CollectStatistics( );
+	}
+	return true;
 }
 
 /**
  * Query insertion.
  * @param[in] queryName query save name
  * @param[in] ctqRef reference to the query itself
+ * @param[in] definition query as it was entered (without the save name), kept for the snapshot
  * @return true if query was inserted into database without any errors.
  */
-bool CDatabase::InsertQuery ( const string & queryName, CTableQuery * ctqRef ) {
+bool CDatabase::InsertQuery ( const string & queryName, CTableQuery * ctqRef, const string & definition ) {
 	if ( TableExists( queryName ) || QueryExists ( queryName ) ) {
 		CLog::BoldMsg( CLog::QP, queryName, CLog::QP_TABLE_EXISTS );
 		return false;
 	}
-	return m_QueryData.insert( pair<string, CTableQuery *>( queryName, ctqRef ) ).second;
+	if ( ! m_QueryData.insert( pair<string, CTableQuery *>( queryName, ctqRef ) ).second )
+		return false;
+	m_QueryDefinitions.emplace_back( queryName, definition );
+	return true;
+}
+
+/**
+ * Index insertion. The index is built over all the rows of the table column.
+ * @param[in] tableName name of the table
+ * @param[in] position index of the column in the table
+ * @param[in] kind kind of the index
+ * @return true if the index was built, false if there is no such column (or it has no rows) or the same index already exists
+ */
+bool CDatabase::InsertIndex ( const string & tableName, const size_t & position, const CIndex::EKind & kind ) {
+	CTable * table = GetTable( tableName );
+	const CColumn * column;
+	if ( ! table || ! ( column = table->GetColumn( position ) ) )
+		return false;
+	vector<CIndex *> & indexes = m_Indexes[ tableName ];
+	for ( const CIndex * i : indexes )
+		if ( i->GetPosition( ) == position && i->GetKind( ) == kind )
+			return false;
+	indexes.push_back( CIndex::Create( kind, * column, position ) );
+	return true;
+}
+
+/**
+ * Creates an index over a table column (CREATE INDEX), the result is reported.
+ * @param[in] tableName name of the table (saved queries can't be indexed)
+ * @param[in] column name of the column
+ * @param[in] kind kind of the index
+ * @return true if the index was created
+ */
+bool CDatabase::CreateIndex ( const string & tableName, const string & column, const CIndex::EKind & kind ) {
+	CTable * table = GetTable( tableName );
+	size_t position;
+	if ( ! table ) {
+		CLog::HighlightedMsg( CLog::QP, tableName, CLog::QP_NO_SUCH_TABLE );
+		return false;
+	}
+	if ( ! table->VerifyColumn( column, position, true ) )
+		return false;
+	if ( ! table->GetColumn( position ) ) {
+		CLog::Msg( CLog::QP, CLog::QP_INDEX_NO_ROWS );
+		return false;
+	}
+	if ( ! InsertIndex( tableName, position, kind ) ) {
+		CLog::BoldMsg( CLog::QP, tableName + "." + column, CLog::QP_INDEX_EXISTS );
+		return false;
+	}
+	CLog::BoldMsg( CLog::QP, tableName + "." + column, CLog::QP_INDEX_CREATED );
+	return true;
+}
+
+/**
+ * Indexes over the columns of a table, in the order of creation.
+ */
+vector<const CIndex *> CDatabase::GetIndexes ( const string & tableName ) const {
+	auto tmp = m_Indexes.find( tableName );
+	return tmp == m_Indexes.end( ) ? vector<const CIndex *>( ) : vector<const CIndex *>( tmp->second.begin( ), tmp->second.end( ) );
+}
+
+/**
+ * Appends rows to a table (INSERT). The new rows are added to the indexes of the table (the column encoding and the statistics
+ * are created again once the statistics are stale), then the saved queries reading the table are refreshed.
+ * @param[in] tableName name of the table
+ * @param[in] rows columns with the appended rows (a column per table column)
+ * @return true if the rows were appended
+ */
+bool CDatabase::AppendRows ( const string & tableName, const vector<unique_ptr<CColumn>> & rows ) {
+	CTable * table = GetTable( tableName );
+	if ( ! table )
+		return false;
+	// the cached results would keep the old columns alive (copied on write)
+	m_Cache.Invalidate( tableName );
+	size_t before = table->GetDataRowCount( );
+	if ( ! table->AppendRows( rows ) )
+		return false;
+	if ( ! table->GetStatistics( ) || table->GetStatistics( )->IsStale( table->GetDataRowCount( ) ) ) {
+		table->EncodeColumns( );
+		table->CollectStatistics( );
+	}
+
+	// the indexes refer to the old columns
+	for ( CIndex * i : m_Indexes[ tableName ] )
+		i->Append( * table->GetColumn( i->GetPosition( ) ) );
+	++ m_TableVersions[ tableName ];
+	RefreshQueries( { { tableName, before } } );
+	return true;
+}
+
+/**
+ * Refreshes the saved queries reading the changed tables or queries, in the order of saving, so a query reads the refreshed
+ * results of the earlier ones. The queries evaluated before a column was renamed aren't refreshed, they keep their results.
+ * @param[in] changes changed tables (see CTableQuery::Refresh)
+ */
+void CDatabase::RefreshQueries ( CTableQuery::TChanges changes ) {
+	for ( const auto & i : m_QueryDefinitions ) {
+		CTableQuery * query = GetTableQ( i.first );
+		if ( ! query || query->GetSchemaVersion( ) != m_SchemaVersion )
+			continue;
+		vector<string> operands = query->GetOperands( );
+		if ( none_of( operands.begin( ), operands.end( ), [ & changes ] ( const string & name ) { return changes.count( name ) != 0; } ) )
+			continue;
+
+		size_t rows = query->Refresh( changes );
+		if ( rows == CTableQuery::REWRITTEN ) {
+			changes[ i.first ] = rows;
+			CLog::BoldMsg( CLog::QP, i.first, CLog::QP_QUERY_REPLACED );
+			continue;
+		}
+		if ( rows != query->GetQueryResult( )->GetDataRowCount( ) )
+			changes[ i.first ] = rows;
+		CLog::BoldMsg( CLog::QP, i.first, CLog::QP_QUERY_REFRESHED );
+	}
+}
+
+/**
+ * Creates the key of a query in the result cache (see CResultCache) - its definition with the versions of the tables
+ * it reads, directly or through the saved queries, and the schema version.
+ * @param[in] definition query as it was entered (without the save name)
+ * @param[in] query the query (it doesn't have to be evaluated)
+ * @param[out] key the key
+ * @param[out] tables names of the tables the query reads
+ * @return false if an operand doesn't exist
+ */
+bool CDatabase::CreateCacheKey ( const string & definition, const CTableQuery & query, string & key, vector<string> & tables ) const {
+	vector<string> operands = query.GetOperands( );
+	CTableQuery * saved;
+	tables.clear( );
+	while ( ! operands.empty( ) ) {
+		string name = operands.back( );
+		operands.pop_back( );
+		if ( TableExists( name ) )
+			tables.push_back( name );
+		else if ( ( saved = GetTableQ( name ) ) != nullptr ) {
+			vector<string> savedOperands = saved->GetOperands( );
+			operands.insert( operands.end( ), savedOperands.begin( ), savedOperands.end( ) );
+		} else
+			return false;
+	}
+	sort( tables.begin( ), tables.end( ) );
+	tables.erase( unique( tables.begin( ), tables.end( ) ), tables.end( ) );
+
+	key = definition;
+	for ( const string & i : tables ) {
+		auto version = m_TableVersions.find( i );
+		key.append( "\n" ).append( i ).append( "@" ).append( to_string( version == m_TableVersions.end( ) ? 0 : version->second ) );
+	}
+	key.append( "\n@" ).append( to_string( m_SchemaVersion ) );
+	return true;
+}
+
+vector<string> CDatabase::GetTableNames ( ) const {
+	vector<string> names;
+	for ( const auto & i : m_TableData )
+		names.push_back( i.first );
+	return names;
+}
+
+/**
+ * Saved query names with their definitions, in the order of saving (a query may depend on the earlier ones only).
+ */
+const vector<pair<string, string>> & CDatabase::GetQueryDefinitions ( ) const {
+	return m_QueryDefinitions;
+}
+
+const vector<CDatabase::CSource> & CDatabase::GetSources ( ) const {
+	return m_Sources;
+}
+
+void CDatabase::SetSources ( const vector<CSource> & sources ) {
+	m_Sources = sources;
+}
+
+/**
+ * Creates a pipeline stage reading a table (with its indexes) or a saved query.
+ * @param[in] tableName name of the table or the saved query
+ * @return the stage (owned by the caller), nullptr if there is no such table
+ */
+COperator * CDatabase::CreateOperator ( const string & tableName ) const {
+	CTable * table;
+	CTableQuery * query;
+	if ( ( table = GetTable( tableName ) ) != nullptr )
+		return new CScanOperator( * table, tableName, GetIndexes( tableName ) );
+	if ( ( query = GetTableQ( tableName ) ) != nullptr )
+		return query->CreateOperator( tableName );
+	return nullptr;
 }
 
 /**
@@ -67,6 +266,19 @@ CTableQuery * CDatabase::GetTableQ ( const string & tableName ) const {
 	return tmp == m_QueryData.end( ) ? nullptr : tmp->second;
 }
 
+/**
+ * Searches trough the tables and the saved queries with given name, the data of the table (or the query result) is returned.
+ */
+const CTable * CDatabase::GetContents ( const string & tableName ) const {
+	CTable * table;
+	CTableQuery * query;
+	if ( ( table = GetTable( tableName ) ) != nullptr )
+		return table;
+	if ( ( query = GetTableQ( tableName ) ) != nullptr )
+		return query->GetQueryResult( );
+	return nullptr;
+}
+
 void CDatabase::ListTables ( ) const {
 	if ( ! m_TableData.empty( ) )
 		CLog::Msg( m_Name, CLog::CON_LISTING_T, "\n" );
@@ -106,6 +318,21 @@ void CDatabase::ListQueries ( ) const {
 		CLog::BoldMsg( m_Name, to_string( ++ queryCounter ).append( ". " ).append( i.first ), "" );
 }
 
+void CDatabase::ListIndexes ( ) const {
+	size_t indexCounter = 0;
+	for ( const auto & i : m_Indexes ) {
+		vector<string> tableColumns = GetTable( i.first )->GetColumnNames( );
+		for ( const CIndex * j : i.second ) {
+			if ( ! indexCounter )
+				CLog::Msg( m_Name, CLog::CON_LISTING_I, "\n" );
+			CLog::BoldMsg( m_Name, to_string( ++ indexCounter ).append( ". " ).append( i.first ).append( "." ).append( tableColumns[ j->GetPosition( ) ] )
+			               .append( " (" ).append( CIndex::GetKindName( j->GetKind( ) ) ).append( ")" ), "" );
+		}
+	}
+	if ( ! indexCounter )
+		CLog::Msg( m_Name, CLog::CON_LIST_EMPTY, "\n" );
+}
+
 void CDatabase::PrintTables ( ) const {
 	if ( ! m_TableData.empty( ) )
 		CLog::Msg( m_Name, CLog::CON_PRINTING, "\n" );
@@ -128,7 +355,8 @@ void CDatabase::PrintQueryContents ( ) const {
 	}
 	for ( const auto & i : m_QueryData ) {
 		CLog::Msg( i.first, "Listing contents..", "" );
-		cout << * i.second->GetQueryResult( ) << endl;
+		i.second->RenderResult( );
+		cout << endl;
 	}
 }
 
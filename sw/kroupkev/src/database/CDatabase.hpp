@@ -6,20 +6,52 @@
 #include <fstream>
 #include <string>
 #include <map>
+#include <vector>
+#include <cstdint>
 
 #include "CTable.hpp"
+#include "CIndex.hpp"
+#include "CResultCache.hpp"
 #include "../console/CLog.hpp"
 #include "../query/CTableQuery.hpp"
 #include "../query/CQueryOperand.hpp"
 
 /**
  * This module is the upper layer of data storage, containing all the loaded data.
+ *
+ * Besides the tables and the saved queries, the database keeps the definitions of the saved queries
+ * (in the order of saving) and the stamps of the files the tables were imported from, so it can be saved into a snapshot.
+ * The schema version is changed whenever a column is renamed, the saved queries evaluated before that are no longer
+ * expanded into their definitions (see CTableQuery::CreateOperator).
+ *
+ * The indexes over the table columns (CREATE INDEX) are kept by the table name, each scan of the table gets them,
+ * so the queries can look up the rows instead of scanning them (see COptimizer, CJoinOperator).
+ *
+ * The saved queries depend on the tables and the earlier saved queries they read (see CTableQuery::GetOperands).
+ * Once rows are appended to a table (INSERT), the saved queries reading it are refreshed in the order of saving.
+ * Each table has a version, which changes with its rows, the results of the other queries are cached by it (see CResultCache).
  */
 class CDatabase {
+public:
+	/**
+	 * Source file of the tables at the moment of the import (size -1 if it didn't exist).
+	 */
+	struct CSource {
+		string m_Path;
+		int64_t m_Size;
+		int64_t m_Modified;
+	};
+
 private:
 	string m_Name;
 	map<string, CTable *> m_TableData;
 	map<string, CTableQuery *> m_QueryData;
+	map<string, vector<CIndex *>> m_Indexes;
+	vector<pair<string, string>> m_QueryDefinitions;
+	vector<CSource> m_Sources;
+	size_t m_SchemaVersion = 0;
+	map<string, size_t> m_TableVersions;
+	CResultCache m_Cache;
 
 public:
 	explicit CDatabase ( string name );
@@ -27,14 +59,32 @@ public:
 
 	CTable * GetTable ( const string & tableName ) const;
 	CTableQuery * GetTableQ ( const string & tableName ) const;
+	const CTable * GetContents ( const string & tableName ) const;
 
 	bool TableExists ( const string & tableName ) const;
 	bool QueryExists ( const string & tableName ) const;
 	bool InsertTable ( const string & tableName, CTable * tableRef );
-	bool InsertQuery ( const string & queryName, CTableQuery * ctqRef );
+	bool InsertQuery ( const string & queryName, CTableQuery * ctqRef, const string & definition = "" );
+	bool InsertIndex ( const string & tableName, const size_t & position, const CIndex::EKind & kind );
+	bool CreateIndex ( const string & tableName, const string & column, const CIndex::EKind & kind );
+	vector<const CIndex *> GetIndexes ( const string & tableName ) const;
+	bool AppendRows ( const string & tableName, const vector<unique_ptr<CColumn>> & rows );
+	void RefreshQueries ( CTableQuery::TChanges changes );
+
+	vector<string> GetTableNames ( ) const;
+	const vector<pair<string, string>> & GetQueryDefinitions ( ) const;
+	const vector<CSource> & GetSources ( ) const;
+	void SetSources ( const vector<CSource> & sources );
+	COperator * CreateOperator ( const string & tableName ) const;
+	size_t GetSchemaVersion ( ) const { return m_SchemaVersion; }
+	void ChangeSchema ( ) { ++ m_SchemaVersion; m_Cache.Clear( ); }
+	CResultCache & GetCache ( ) { return m_Cache; }
+	bool CreateCacheKey ( const string & definition, const CTableQuery & query, string & key, vector<string> & tables ) const;
 
 	void ListTables ( ) const;
 	void ListQueries ( ) const;
+	void ListIndexes ( ) const;
+	void ListCache ( ) const { m_Cache.List( m_Name ); }
 	void PrintTables ( ) const;
 	void PrintQueryContents ( ) const;
 	bool ExportQueries( ) const;
@@ -0,0 +1,438 @@
+#include "CExpression.hpp"
+#include "CTable.hpp"
+#include "CRowHash.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <atomic>
+#include <cstring>
+
+const size_t CExpression::MORSEL_ROWS = 1 << 16;
+
+/**
+ * Compiles a condition for the columns of a batch (or a table).
+ * @param[in, out] condition the condition (its constants are marked, if they are strings)
+ * @param[in] columns index of each condition column (in the order of CCondition::GetColumns)
+ * @param[in] types types of the batch columns
+ * @return the compiled condition (owned by the caller), nullptr if a constant or an operator is invalid
+ */
+CExpression * CExpression::Compile ( CCondition & condition, const vector<size_t> & columns, const vector<CColumn::EType> & types ) {
+	size_t position = 0;
+	return Compile( condition, columns, position, types );
+}
+
+/**
+ * Compiles the conditions, which all have to be met (e.g. of a filter), into a single tree.
+ * @param[in] columns indexes of the columns for each condition
+ */
+CExpression * CExpression::Compile ( const vector<CCondition *> & conditions, const vector<vector<size_t>> & columns, const vector<CColumn::EType> & types ) {
+	if ( conditions.size( ) == 1 )
+		return Compile( * conditions.front( ), columns.front( ), types );
+	vector<unique_ptr<CExpression>> children;
+	for ( size_t i = 0; i < conditions.size( ); ++ i ) {
+		children.emplace_back( Compile( * conditions[ i ], columns[ i ], types ) );
+		if ( ! children.back( ) )
+			return nullptr;
+	}
+	return new CLogicalExpression( CCondition::AND, children );
+}
+
+/**
+ * @param[in, out] position index of the first column of the condition in the columns
+ */
+CExpression * CExpression::Compile ( CCondition & condition, const vector<size_t> & columns, size_t & position, const vector<CColumn::EType> & types ) {
+	if ( ! condition.IsLeaf( ) ) {
+		vector<unique_ptr<CExpression>> children;
+		for ( unique_ptr<CCondition> & i : condition.m_Children ) {
+			children.emplace_back( Compile( * i, columns, position, types ) );
+			if ( ! children.back( ) )
+				return nullptr;
+		}
+		return new CLogicalExpression( condition.m_Kind, children );
+	}
+
+	size_t column = columns[ position ++ ];
+	CColumn::EType type = types[ column ];
+	if ( condition.m_Kind == CCondition::COMPARE && condition.IsColumnOperand ) {
+		EOperator op;
+		if ( ! CPredicate::ParseOperator( condition.m_Operator, op ) ) {
+			CLog::Msg( CLog::QP, CLog::QP_INVALID_OPER );
+			return nullptr;
+		}
+		return new CColumnExpression( column, columns[ position ++ ], op );
+	}
+	if ( condition.m_Kind == CCondition::COMPARE ) {
+		CPredicate * predicate = CTable::CreatePredicate( & condition, type );
+		return predicate ? new CConstantExpression( column, predicate ) : nullptr;
+	}
+
+	condition.IsStringConstant = type == CColumn::TYPE_STRING;
+	if ( condition.m_Kind == CCondition::BETWEEN ) {
+		unique_ptr<CBetweenExpression> between ( new CBetweenExpression( column, type ) );
+		return between->SetBounds( condition.m_Constants.front( ), condition.m_Constants.back( ) ) ? between.release( ) : nullptr;
+	}
+	unique_ptr<CInExpression> in ( new CInExpression( column, type, condition.m_Operator == "!=" ) );
+	for ( const string & i : condition.m_Constants )
+		if ( ! in->Insert( i ) )
+			return nullptr;
+	return in.release( );
+}
+
+/**
+ * Evaluates the condition over all the rows of the columns.
+ * @param[in] columns the batch columns
+ * @param[out] out indexes of the matching rows (ascending)
+ */
+void CExpression::Select ( const vector<const CColumn *> & columns, vector<size_t> & out ) const {
+	Select( columns, nullptr, out );
+}
+
+/**
+ * Evaluates the condition over all the rows of the columns on a pool of threads. The rows are split into morsels of consecutive
+ * rows, a thread takes the next morsel once it's done with the previous one, so the threads with the cheaper morsels
+ * (e.g. an OR decided by its first child) evaluate more of them. The selections of the morsels are concatenated in their order,
+ * the result is the same as of the serial evaluation.
+ * @param[in] columns the table columns (read by several threads at once)
+ * @param[out] out indexes of the matching rows (ascending)
+ * @param[in] threads maximum number of threads
+ */
+void CExpression::Select ( const vector<const CColumn *> & columns, vector<size_t> & out, const size_t & threads ) const {
+	size_t size = columns.empty( ) ? 0 : columns.front( )->GetSize( );
+	size_t morsels = ( size + MORSEL_ROWS - 1 ) / MORSEL_ROWS;
+	size_t workers = min( threads, morsels );
+	if ( workers < 2 ) {
+		Select( columns, out );
+		return;
+	}
+
+	vector<vector<size_t>> selections ( morsels );
+	atomic<size_t> next ( 0 );
+	{
+		CThreadPool pool ( workers );
+		vector<future<void>> done;
+		for ( size_t i = 0; i < workers; ++ i )
+			done.push_back( pool.Submit( [ this, & columns, & selections, & next, size, morsels ] ( ) {
+				vector<size_t> rows;
+				for ( size_t j; ( j = next ++ ) < morsels; ) {
+					rows.resize( min( MORSEL_ROWS, size - j * MORSEL_ROWS ) );
+					iota( rows.begin( ), rows.end( ), j * MORSEL_ROWS );
+					Select( columns, & rows, selections[ j ] );
+				}
+			} ) );
+		for ( future<void> & i : done )
+			i.get( );
+	}
+
+	size_t total = 0;
+	for ( const vector<size_t> & i : selections )
+		total += i.size( );
+	out.clear( );
+	out.reserve( total );
+	for ( const vector<size_t> & i : selections )
+		out.insert( out.end( ), i.begin( ), i.end( ) );
+}
+
+/**
+ * Converts a constant to the column type (strings are kept), the same way as CTable::CreatePredicate.
+ * @return true if the constant is valid
+ */
+bool CExpression::Convert ( const string & constant, const CColumn::EType & type, int32_t & integer, double & real ) {
+	try {
+		if ( type == CColumn::TYPE_STRING )
+			return true;
+		if ( type == CColumn::TYPE_INT ) {
+			integer = static_cast<int32_t>( stoi( constant ) );
+			return true;
+		}
+		char * c;
+		real = strtod( constant.c_str( ), & c );
+		if ( c != constant.c_str( ) )
+			return true;
+	} catch ( const logic_error & ) { }
+	CLog::BoldMsg( CLog::QP, constant, CLog::QP_CON_PARSE_ERROR );
+	return false;
+}
+
+/**
+ * Keeps the rows meeting the test.
+ * @param[in] size number of the column rows
+ * @param[in] rows indexes of the selected rows, nullptr for all of them
+ */
+template <typename TTest>
+void CExpression::Keep ( const size_t & size, const vector<size_t> * rows, TTest test, vector<size_t> & out ) {
+	size_t count = rows ? rows->size( ) : size;
+	const size_t * selected = rows ? rows->data( ) : nullptr;
+	for ( size_t k = 0, i; k < count; ++ k )
+		if ( test( i = selected ? selected[ k ] : k ) )
+			out.push_back( i );
+}
+
+/**
+ * The selected rows, which are not matching (both are ascending).
+ * @param[in] size number of the column rows
+ * @param[in] rows indexes of the selected rows, nullptr for all of them
+ * @param[in] matching the matching selected rows
+ * @param[out] out the other selected rows
+ */
+void CExpression::SelectOthers ( const size_t & size, const vector<size_t> * rows, const vector<size_t> & matching, vector<size_t> & out ) {
+	out.clear( );
+	size_t next = 0;
+	Keep( size, rows, [ & matching, & next ] ( const size_t & i ) {
+		if ( next < matching.size( ) && matching[ next ] == i ) {
+			++ next;
+			return false;
+		}
+		return true;
+	}, out );
+}
+
+//
+
+CConstantExpression::CConstantExpression ( const size_t & column, CPredicate * predicate )
+: m_Column( column ), m_Predicate( predicate ) { }
+
+void CConstantExpression::Select ( const vector<const CColumn *> & columns, const vector<size_t> * rows, vector<size_t> & out ) const {
+	if ( rows )
+		m_Predicate->Select( * columns[ m_Column ], * rows, out );
+	else
+		m_Predicate->Select( * columns[ m_Column ], out );
+}
+
+//
+
+CColumnExpression::CColumnExpression ( const size_t & left, const size_t & right, const EOperator & op )
+: m_Left( left ), m_Right( right ), m_Operator( op ) { }
+
+/**
+ * Tests the rows by the row comparisons of the columns, the operator is resolved outside the loop.
+ */
+template <typename TEq, typename TLt, typename TGt>
+void CColumnExpression::Scan ( const size_t & size, const vector<size_t> * rows, TEq eq, TLt lt, TGt gt, vector<size_t> & out ) const {
+	switch ( m_Operator ) {
+		case CKernel::OP_EQ:
+			Keep( size, rows, eq, out );
+			break;
+		case CKernel::OP_NE:
+			Keep( size, rows, [ & eq ] ( const size_t & i ) { return ! eq( i ); }, out );
+			break;
+		case CKernel::OP_GE:
+			Keep( size, rows, [ & eq, & gt ] ( const size_t & i ) { return eq( i ) || gt( i ); }, out );
+			break;
+		case CKernel::OP_LE:
+			Keep( size, rows, [ & eq, & lt ] ( const size_t & i ) { return eq( i ) || lt( i ); }, out );
+			break;
+		case CKernel::OP_GT:
+			Keep( size, rows, gt, out );
+			break;
+		default:
+			Keep( size, rows, lt, out );
+	}
+}
+
+/**
+ * Numbers of the same type are compared directly, other columns by the row comparisons of CColumn.
+ */
+void CColumnExpression::Select ( const vector<const CColumn *> & columns, const vector<size_t> * rows, vector<size_t> & out ) const {
+	out.clear( );
+	const CColumn & left = * columns[ m_Left ], & right = * columns[ m_Right ];
+	size_t size = left.GetSize( );
+	if ( left.GetType( ) == CColumn::TYPE_INT && right.GetType( ) == CColumn::TYPE_INT ) {
+		const int32_t * a = static_cast<const CIntColumn &>( left ).GetData( ), * b = static_cast<const CIntColumn &>( right ).GetData( );
+		Scan( size, rows,
+			[ a, b ] ( const size_t & i ) { return a[ i ] == b[ i ]; },
+			[ a, b ] ( const size_t & i ) { return a[ i ] < b[ i ]; },
+			[ a, b ] ( const size_t & i ) { return a[ i ] > b[ i ]; },
+			out );
+	} else if ( left.GetType( ) == CColumn::TYPE_DOUBLE && right.GetType( ) == CColumn::TYPE_DOUBLE ) {
+		const double * a = static_cast<const CDoubleColumn &>( left ).GetData( ), * b = static_cast<const CDoubleColumn &>( right ).GetData( );
+		Scan( size, rows,
+			[ a, b ] ( const size_t & i ) { return CDouble::cmpEq( a[ i ], b[ i ] ); },
+			[ a, b ] ( const size_t & i ) { return CDouble::cmpLt( a[ i ], b[ i ] ); },
+			[ a, b ] ( const size_t & i ) { return CDouble::cmpGt( a[ i ], b[ i ] ); },
+			out );
+	} else
+		Scan( size, rows,
+			[ & left, & right ] ( const size_t & i ) { return left.Equal( i, right, i ); },
+			[ & left, & right ] ( const size_t & i ) { return left.Less( i, right, i ); },
+			[ & left, & right ] ( const size_t & i ) { return left.Greater( i, right, i ); },
+			out );
+}
+
+//
+
+CInExpression::CInExpression ( const size_t & column, const CColumn::EType & type, const bool & negated )
+: m_Column( column ), m_Type( type ), m_Negated( negated ) { }
+
+/**
+ * Adds a constant to the set.
+ * @return false if the constant can't be converted to the column type
+ */
+bool CInExpression::Insert ( const string & constant ) {
+	int32_t integer;
+	double real;
+	if ( ! Convert( constant, m_Type, integer, real ) )
+		return false;
+	if ( m_Type == CColumn::TYPE_INT )
+		m_Integers.insert( integer );
+	else if ( m_Type == CColumn::TYPE_DOUBLE )
+		m_Doubles.insert( upper_bound( m_Doubles.begin( ), m_Doubles.end( ), real ), real );
+	else if ( m_Strings.Find( constant ) == CStringDictionary::NO_CODE )
+		m_Strings.Insert( constant.data( ), constant.size( ), CRowHash::HashBytes( constant.data( ), constant.size( ) ) );
+	return true;
+}
+
+/**
+ * An equal double may only be the nearest smaller or bigger constant.
+ */
+bool CInExpression::Contains ( const double & val ) const {
+	auto found = lower_bound( m_Doubles.begin( ), m_Doubles.end( ), val );
+	return ( found != m_Doubles.end( ) && CDouble::cmpEq( * found, val ) ) || ( found != m_Doubles.begin( ) && CDouble::cmpEq( * ( found - 1 ), val ) );
+}
+
+/**
+ * The constants are looked up in the dictionary of an encoded column once, its rows are then tested by their codes.
+ */
+void CInExpression::Select ( const vector<const CColumn *> & columns, const vector<size_t> * rows, vector<size_t> & out ) const {
+	out.clear( );
+	const CColumn & column = * columns[ m_Column ];
+	size_t size = column.GetSize( );
+	bool keep = ! m_Negated;
+
+	// values of different types never match
+	if ( column.GetType( ) != m_Type ) {
+		if ( m_Negated )
+			Keep( size, rows, [ ] ( const size_t & ) { return true; }, out );
+		return;
+	}
+
+	if ( m_Type == CColumn::TYPE_INT ) {
+		const int32_t * data = static_cast<const CIntColumn &>( column ).GetData( );
+		Keep( size, rows, [ this, data, keep ] ( const size_t & i ) { return ( m_Integers.count( data[ i ] ) != 0 ) == keep; }, out );
+	} else if ( m_Type == CColumn::TYPE_DOUBLE ) {
+		const double * data = static_cast<const CDoubleColumn &>( column ).GetData( );
+		Keep( size, rows, [ this, data, keep ] ( const size_t & i ) { return Contains( data[ i ] ) == keep; }, out );
+	} else {
+		const CStringColumn & strings = static_cast<const CStringColumn &>( column );
+		if ( ! strings.IsEncoded( ) ) {
+			Keep( size, rows, [ this, & strings, keep ] ( const size_t & i ) {
+				const char * str = strings.GetStr( i );
+				size_t len = strings.GetStrLen( i );
+				return ( m_Strings.Find( str, len, CRowHash::HashBytes( str, len ) ) != CStringDictionary::NO_CODE ) == keep;
+			}, out );
+			return;
+		}
+		const CStringDictionary & dictionary = * strings.GetDictionary( );
+		const uint32_t * codes = strings.GetCodes( );
+		vector<char> matching ( dictionary.GetSize( ), ! keep );
+		for ( uint32_t i = 0; i < m_Strings.GetSize( ); ++ i ) {
+			const string & val = m_Strings.GetValue( i );
+			uint32_t code = dictionary.Find( val.data( ), val.size( ), m_Strings.GetHash( i ) );
+			if ( code != CStringDictionary::NO_CODE )
+				matching[ code ] = keep;
+		}
+		Keep( size, rows, [ & matching, codes ] ( const size_t & i ) { return matching[ codes[ i ] ] != 0; }, out );
+	}
+}
+
+//
+
+CBetweenExpression::CBetweenExpression ( const size_t & column, const CColumn::EType & type )
+: m_Column( column ), m_Type( type ) { }
+
+/**
+ * @return false if a bound can't be converted to the column type
+ */
+bool CBetweenExpression::SetBounds ( const string & low, const string & high ) {
+	m_Strings[ 0 ] = low;
+	m_Strings[ 1 ] = high;
+	return Convert( low, m_Type, m_Integers[ 0 ], m_Doubles[ 0 ] ) && Convert( high, m_Type, m_Integers[ 1 ], m_Doubles[ 1 ] );
+}
+
+/**
+ * Both bounds are tested in a single loop, with the same semantics as two comparisons (see CPredicate).
+ * The values of an encoded column are tested once, its rows by their codes.
+ */
+void CBetweenExpression::Select ( const vector<const CColumn *> & columns, const vector<size_t> * rows, vector<size_t> & out ) const {
+	out.clear( );
+	const CColumn & column = * columns[ m_Column ];
+	size_t size = column.GetSize( );
+	if ( column.GetType( ) != m_Type )
+		return;
+
+	if ( m_Type == CColumn::TYPE_INT ) {
+		const int32_t * data = static_cast<const CIntColumn &>( column ).GetData( );
+		int32_t low = m_Integers[ 0 ], high = m_Integers[ 1 ];
+		Keep( size, rows, [ data, low, high ] ( const size_t & i ) { return low <= data[ i ] && data[ i ] <= high; }, out );
+	} else if ( m_Type == CColumn::TYPE_DOUBLE ) {
+		const double * data = static_cast<const CDoubleColumn &>( column ).GetData( );
+		double low = m_Doubles[ 0 ], high = m_Doubles[ 1 ];
+		Keep( size, rows, [ data, low, high ] ( const size_t & i ) {
+			return ( CDouble::cmpEq( data[ i ], low ) || CDouble::cmpGt( data[ i ], low ) ) && ( CDouble::cmpEq( data[ i ], high ) || CDouble::cmpLt( data[ i ], high ) );
+		}, out );
+	} else {
+		const CStringColumn & strings = static_cast<const CStringColumn &>( column );
+		const string & low = m_Strings[ 0 ], & high = m_Strings[ 1 ];
+		if ( ! strings.IsEncoded( ) ) {
+			Keep( size, rows, [ & strings, & low, & high ] ( const size_t & i ) {
+				const char * str = strings.GetStr( i );
+				size_t len = strings.GetStrLen( i );
+				return low.compare( 0, low.size( ), str, len ) <= 0 && high.compare( 0, high.size( ), str, len ) >= 0;
+			}, out );
+			return;
+		}
+		const CStringDictionary & dictionary = * strings.GetDictionary( );
+		const uint32_t * codes = strings.GetCodes( );
+		vector<char> matching ( dictionary.GetSize( ) );
+		for ( uint32_t i = 0; i < dictionary.GetSize( ); ++ i )
+			matching[ i ] = low.compare( dictionary.GetValue( i ) ) <= 0 && high.compare( dictionary.GetValue( i ) ) >= 0;
+		Keep( size, rows, [ & matching, codes ] ( const size_t & i ) { return matching[ codes[ i ] ] != 0; }, out );
+	}
+}
+
+//
+
+CLogicalExpression::CLogicalExpression ( const CCondition::EKind & kind, vector<unique_ptr<CExpression>> & children )
+: m_Kind( kind ), m_Children( std::move( children ) ) { }
+
+/**
+ * AND passes the rows matching a child to the next one, OR passes the rows not matching it, NOT keeps the rows its child doesn't match.
+ * The evaluation stops once no row is left for the next child.
+ */
+void CLogicalExpression::Select ( const vector<const CColumn *> & columns, const vector<size_t> * rows, vector<size_t> & out ) const {
+	size_t size = columns.front( )->GetSize( );
+	vector<size_t> matching, remaining, others;
+	if ( m_Kind == CCondition::NOT ) {
+		m_Children.front( )->Select( columns, rows, matching );
+		SelectOthers( size, rows, matching, out );
+		return;
+	}
+
+	const vector<size_t> * current = rows;
+	if ( m_Kind == CCondition::AND ) {
+		for ( size_t i = 0; i < m_Children.size( ); ++ i ) {
+			m_Children[ i ]->Select( columns, current, out );
+			if ( out.empty( ) || i + 1 == m_Children.size( ) )
+				return;
+			remaining.swap( out );
+			current = & remaining;
+		}
+		return;
+	}
+
+	out.clear( );
+	for ( size_t i = 0; i < m_Children.size( ); ++ i ) {
+		m_Children[ i ]->Select( columns, current, matching );
+		if ( matching.empty( ) )
+			continue;
+		others.clear( );
+		merge( out.begin( ), out.end( ), matching.begin( ), matching.end( ), back_inserter( others ) );
+		out.swap( others );
+		if ( i + 1 == m_Children.size( ) )
+			return;
+		SelectOthers( size, current, matching, others );
+		remaining.swap( others );
+		current = & remaining;
+		if ( remaining.empty( ) )
+			return;
+	}
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_set>
+#include <cstdint>
+
+#include "CColumn.hpp"
+#include "CCondition.hpp"
+#include "CPredicate.hpp"
+#include "../tool/CThreadPool.hpp"
+
+using namespace std;
+
+/**
+ * This module is a PRO condition tree (see CCondition) compiled for the types of its columns. The comparisons with a constant
+ * are the typed predicates (see CPredicate), IN looks the values up in a hash set of the constants and BETWEEN tests
+ * both bounds in a single loop. The constants are converted to the column types once.
+ *
+ * A node only tests the rows selected by the nodes before it - the child of AND gets the rows, which met the previous children,
+ * the child of OR the rows, which didn't meet them. The tree thus evaluates a batch in one pass, the batch columns aren't copied
+ * and a row isn't tested by a condition, which can't change the result. The tree doesn't change, once it's compiled,
+ * so a large table may be evaluated by several threads at once - each of them evaluates a morsel of the rows at a time.
+ */
+class CExpression {
+public:
+	typedef CKernel::EOperator EOperator;
+
+	virtual ~CExpression ( ) = default;
+
+	static CExpression * Compile ( CCondition & condition, const vector<size_t> & columns, const vector<CColumn::EType> & types );
+	static CExpression * Compile ( const vector<CCondition *> & conditions, const vector<vector<size_t>> & columns, const vector<CColumn::EType> & types );
+
+	static const size_t MORSEL_ROWS;
+
+	void Select ( const vector<const CColumn *> & columns, vector<size_t> & out ) const;
+	void Select ( const vector<const CColumn *> & columns, vector<size_t> & out, const size_t & threads ) const;
+	virtual void Select ( const vector<const CColumn *> & columns, const vector<size_t> * rows, vector<size_t> & out ) const = 0;
+
+protected:
+	static bool Convert ( const string & constant, const CColumn::EType & type, int32_t & integer, double & real );
+	template <typename TTest>
+	static void Keep ( const size_t & size, const vector<size_t> * rows, TTest test, vector<size_t> & out );
+	static void SelectOthers ( const size_t & size, const vector<size_t> * rows, const vector<size_t> & matching, vector<size_t> & out );
+
+private:
+	static CExpression * Compile ( CCondition & condition, const vector<size_t> & columns, size_t & position, const vector<CColumn::EType> & types );
+};
+
+/**
+ * Comparison of a column with a constant.
+ */
+class CConstantExpression : public CExpression {
+private:
+	size_t m_Column;
+	unique_ptr<CPredicate> m_Predicate;
+
+public:
+	CConstantExpression ( const size_t & column, CPredicate * predicate );
+	virtual void Select ( const vector<const CColumn *> & columns, const vector<size_t> * rows, vector<size_t> & out ) const override;
+};
+
+/**
+ * Comparison of two columns of a row. Values of different types never match.
+ */
+class CColumnExpression : public CExpression {
+private:
+	size_t m_Left;
+	size_t m_Right;
+	EOperator m_Operator;
+
+	template <typename TEq, typename TLt, typename TGt>
+	void Scan ( const size_t & size, const vector<size_t> * rows, TEq eq, TLt lt, TGt gt, vector<size_t> & out ) const;
+
+public:
+	CColumnExpression ( const size_t & left, const size_t & right, const EOperator & op );
+	virtual void Select ( const vector<const CColumn *> & columns, const vector<size_t> * rows, vector<size_t> & out ) const override;
+};
+
+/**
+ * Membership of the column values in a set of constants (IN), or the absence from it. Ints are kept in a hash set, strings
+ * in a dictionary (probed by the dictionary codes of an encoded column), doubles are sorted, since they are compared with an epsilon.
+ */
+class CInExpression : public CExpression {
+private:
+	size_t m_Column;
+	CColumn::EType m_Type;
+	bool m_Negated;
+	unordered_set<int32_t> m_Integers;
+	vector<double> m_Doubles;
+	CStringDictionary m_Strings;
+
+	bool Contains ( const double & val ) const;
+
+public:
+	CInExpression ( const size_t & column, const CColumn::EType & type, const bool & negated );
+	bool Insert ( const string & constant );
+	virtual void Select ( const vector<const CColumn *> & columns, const vector<size_t> * rows, vector<size_t> & out ) const override;
+};
+
+/**
+ * Range of the column values, both bounds are included (BETWEEN).
+ */
+class CBetweenExpression : public CExpression {
+private:
+	size_t m_Column;
+	CColumn::EType m_Type;
+	int32_t m_Integers[ 2 ] = { 0, 0 };
+	double m_Doubles[ 2 ] = { 0, 0 };
+	string m_Strings[ 2 ];
+
+public:
+	CBetweenExpression ( const size_t & column, const CColumn::EType & type );
+	bool SetBounds ( const string & low, const string & high );
+	virtual void Select ( const vector<const CColumn *> & columns, const vector<size_t> * rows, vector<size_t> & out ) const override;
+};
+
+/**
+ * Logical operator over the child conditions (AND, OR, NOT), the children are evaluated in their order.
+ */
+class CLogicalExpression : public CExpression {
+private:
+	CCondition::EKind m_Kind;
+	vector<unique_ptr<CExpression>> m_Children;
+
+public:
+	CLogicalExpression ( const CCondition::EKind & kind, vector<unique_ptr<CExpression>> & children );
+	virtual void Select ( const vector<const CColumn *> & columns, const vector<size_t> * rows, vector<size_t> & out ) const override;
+};
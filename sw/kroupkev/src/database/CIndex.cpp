@@ -0,0 +1,134 @@
+#include "CIndex.hpp"
+
+#include <algorithm>
+
+/**
+ * Builds an index over a column.
+ * @param[in] kind kind of the index
+ * @param[in] column indexed column (it has to outlive the index)
+ * @param[in] position index of the column in its table
+ * @return the index (owned by the caller)
+ */
+CIndex * CIndex::Create ( const EKind & kind, const CColumn & column, const size_t & position ) {
+	if ( kind == INDEX_HASH )
+		return new CHashIndex( column, position );
+	return new CSortedIndex( column, position );
+}
+
+/**
+ * Translates the kind of an index entered by the user (SORTED, HASH - case insensitive).
+ */
+bool CIndex::ParseKind ( const string & name, EKind & out ) {
+	string kind = name;
+	transform( kind.begin( ), kind.end( ), kind.begin( ), ::toupper );
+	if ( kind == "SORTED" )
+		out = INDEX_SORTED;
+	else if ( kind == "HASH" )
+		out = INDEX_HASH;
+	else
+		return false;
+	return true;
+}
+
+string CIndex::GetKindName ( const EKind & kind ) {
+	return kind == INDEX_HASH ? "HASH" : "SORTED";
+}
+
+CSortedIndex::CSortedIndex ( const CColumn & column, const size_t & position ) : CIndex( column, position ) {
+	m_Order.resize( column.GetSize( ) );
+	for ( size_t i = 0; i < m_Order.size( ); ++ i )
+		m_Order[ i ] = static_cast<uint32_t>( i );
+	stable_sort( m_Order.begin( ), m_Order.end( ), [ & column ] ( const uint32_t & a, const uint32_t & b ) { return column.Less( a, column, b ); } );
+}
+
+/**
+ * Finds the ordered rows equal to a value - those, which are neither lower nor greater.
+ * @param[in] other column with the value
+ * @param[in] otherRow row of the value
+ * @param[out] begin position of the first equal row in the order
+ * @param[out] end position past the last equal row in the order
+ */
+void CSortedIndex::Range ( const CColumn & other, const size_t & otherRow, size_t & begin, size_t & end ) const {
+	begin = partition_point( m_Order.begin( ), m_Order.end( ), [ & ] ( const uint32_t & i ) { return m_Column->Less( i, other, otherRow ); } ) - m_Order.begin( );
+	end = partition_point( m_Order.begin( ) + begin, m_Order.end( ), [ & ] ( const uint32_t & i ) { return ! m_Column->Greater( i, other, otherRow ); } ) - m_Order.begin( );
+}
+
+CJoinEngine::TMatches CSortedIndex::Join ( const CColumn & outer ) const {
+	CJoinEngine::TMatches matches;
+	if ( outer.GetType( ) != m_Column->GetType( ) )
+		return matches;
+	size_t begin, end;
+	vector<uint32_t> rows;
+	for ( size_t i = 0; i < outer.GetSize( ); ++ i ) {
+		Range( outer, i, begin, end );
+		rows.assign( m_Order.begin( ) + begin, m_Order.begin( ) + end );
+		sort( rows.begin( ), rows.end( ) );
+		for ( const uint32_t & j : rows )
+			matches.emplace_back( i, j );
+	}
+	return matches;
+}
+
+/**
+ * Lower values precede the equal ones, which precede the greater ones - each operator (except for !=) selects
+ * a continuous part of the order.
+ */
+bool CSortedIndex::Select ( const CKernel::EOperator & op, const CColumn & constant, vector<size_t> & out ) const {
+	if ( op == CKernel::OP_NE || constant.GetType( ) != m_Column->GetType( ) )
+		return false;
+	size_t begin, end;
+	Range( constant, 0, begin, end );
+	if ( op == CKernel::OP_LT || op == CKernel::OP_LE )
+		end = op == CKernel::OP_LT ? begin : end, begin = 0;
+	else if ( op == CKernel::OP_GT || op == CKernel::OP_GE )
+		begin = op == CKernel::OP_GT ? end : begin, end = m_Order.size( );
+	out.assign( m_Order.begin( ) + begin, m_Order.begin( ) + end );
+	sort( out.begin( ), out.end( ) );
+	return true;
+}
+
+/**
+ * The appended rows are sorted alone and merged into the order, the previous rows precede the new ones with equal values.
+ */
+void CSortedIndex::Append ( const CColumn & column ) {
+	m_Column = & column;
+	size_t before = m_Order.size( );
+	m_Order.resize( column.GetSize( ) );
+	for ( size_t i = before; i < m_Order.size( ); ++ i )
+		m_Order[ i ] = static_cast<uint32_t>( i );
+	auto less = [ & column ] ( const uint32_t & a, const uint32_t & b ) { return column.Less( a, column, b ); };
+	stable_sort( m_Order.begin( ) + before, m_Order.end( ), less );
+	inplace_merge( m_Order.begin( ), m_Order.begin( ) + before, m_Order.end( ), less );
+}
+
+CHashIndex::CHashIndex ( const CColumn & column, const size_t & position ) : CIndex( column, position ), m_Table( CRowHash( { & column } ) ) { }
+
+CJoinEngine::TMatches CHashIndex::Join ( const CColumn & outer ) const {
+	CJoinEngine::TMatches matches;
+	CRowHash probe ( { & outer } ), build ( { m_Column } );
+	if ( ! probe.IsCompatible( build ) )
+		return matches;
+	probe.MapCodes( build );
+	vector<size_t> found;
+	for ( size_t i = 0; i < outer.GetSize( ); ++ i ) {
+		m_Table.Probe( probe, i, found );
+		sort( found.begin( ), found.end( ) );
+		for ( const size_t & j : found )
+			matches.emplace_back( i, j );
+	}
+	return matches;
+}
+
+bool CHashIndex::Select ( const CKernel::EOperator & op, const CColumn & constant, vector<size_t> & out ) const {
+	if ( op != CKernel::OP_EQ || constant.GetType( ) != m_Column->GetType( ) )
+		return false;
+	CRowHash probe ( { & constant } );
+	m_Table.Probe( probe, 0, out );
+	sort( out.begin( ), out.end( ) );
+	return true;
+}
+
+void CHashIndex::Append ( const CColumn & column ) {
+	m_Column = & column;
+	m_Table.Append( CRowHash( { m_Column } ) );
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "CColumn.hpp"
+#include "CRowHash.hpp"
+#include "CKernel.hpp"
+#include "CJoinEngine.hpp"
+
+using namespace std;
+
+/**
+ * This module is a secondary index over a column of a database table (see CDatabase::CreateIndex), so the rows
+ * matching a condition (PRO) or a join key can be looked up instead of scanning the whole column.
+ * The index is built over all the rows of the column, once rows are appended to the table (INSERT), only the new rows
+ * are added to it (see CDatabase::AppendRows).
+ *
+ * The index refers to the column by its position in the table, the column may be renamed (ALIAS).
+ * The rows are always returned in ascending order, so a result doesn't depend on whether an index was used.
+ */
+class CIndex {
+public:
+	enum EKind { INDEX_SORTED, INDEX_HASH };
+
+	CIndex ( const CColumn & column, const size_t & position ) : m_Column( & column ), m_Position( position ) { }
+	virtual ~CIndex ( ) = default;
+
+	static CIndex * Create ( const EKind & kind, const CColumn & column, const size_t & position );
+	static bool ParseKind ( const string & name, EKind & out );
+	static string GetKindName ( const EKind & kind );
+
+	virtual EKind GetKind ( ) const = 0;
+	size_t GetPosition ( ) const { return m_Position; }
+
+	/** Finds the rows equal to each row of another column, the pairs ( row of the other column, indexed row ) are ordered by the other row. */
+	virtual CJoinEngine::TMatches Join ( const CColumn & outer ) const = 0;
+
+	/** Finds the rows matching a comparison with a constant (a column with a single row), false is returned if the index can't compare by the operator. */
+	virtual bool Select ( const CKernel::EOperator & op, const CColumn & constant, vector<size_t> & out ) const = 0;
+
+	/** Indexes the rows appended to the column, the index then refers to the given column (with the previous rows followed by the new ones). */
+	virtual void Append ( const CColumn & column ) = 0;
+
+protected:
+	const CColumn * m_Column;
+	size_t m_Position;
+};
+
+/**
+ * The rows ordered by their values (a bulk loaded B+-tree without the inner nodes - the index is only modified by appending,
+ * so a binary search over the ordered rows replaces them). Equal values keep the order of their rows.
+ * Evaluates both equality and ranges.
+ */
+class CSortedIndex : public CIndex {
+private:
+	vector<uint32_t> m_Order;
+
+	void Range ( const CColumn & other, const size_t & otherRow, size_t & begin, size_t & end ) const;
+
+public:
+	CSortedIndex ( const CColumn & column, const size_t & position );
+
+	virtual EKind GetKind ( ) const override { return INDEX_SORTED; }
+	virtual CJoinEngine::TMatches Join ( const CColumn & outer ) const override;
+	virtual bool Select ( const CKernel::EOperator & op, const CColumn & constant, vector<size_t> & out ) const override;
+	virtual void Append ( const CColumn & column ) override;
+};
+
+/**
+ * Chained hash table over the rows (see CRowHashTable). Evaluates equality only.
+ */
+class CHashIndex : public CIndex {
+private:
+	CRowHashTable m_Table;
+
+public:
+	CHashIndex ( const CColumn & column, const size_t & position );
+
+	virtual EKind GetKind ( ) const override { return INDEX_HASH; }
+	virtual CJoinEngine::TMatches Join ( const CColumn & outer ) const override;
+	virtual bool Select ( const CKernel::EOperator & op, const CColumn & constant, vector<size_t> & out ) const override;
+	virtual void Append ( const CColumn & column ) override;
+};
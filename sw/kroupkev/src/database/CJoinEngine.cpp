@@ -0,0 +1,179 @@
+#include "CJoinEngine.hpp"
+
+#include <algorithm>
+
+/**
+ * Compares every left row with every right row. O(n * m), kept for comparison with the other algorithms.
+ * @param[in] left key columns of the left table
+ * @param[in] right key columns of the right table (same count as the left ones)
+ * @return matched row indexes
+ */
+CJoinEngine::TMatches CJoinEngine::NestedLoopJoin ( const vector<const CColumn *> & left, const vector<const CColumn *> & right ) {
+	TMatches matches;
+	if ( left.empty( ) || left.size( ) != right.size( ) )
+		return matches;
+
+	bool equal;
+	size_t columnCnt = left.size( );
+	size_t rowsLeft = left[ 0 ]->GetSize( );
+	size_t rowsRight = right[ 0 ]->GetSize( );
+	for ( size_t i = 0; i < rowsLeft; ++ i ) {
+		for ( size_t j = 0; j < rowsRight; ++ j ) {
+			equal = true;
+			for ( size_t k = 0; k < columnCnt && equal; ++ k )
+				if ( ! left[ k ]->Equal( i, * right[ k ], j ) )
+					equal = false;
+			if ( equal )
+				matches.emplace_back( i, j );
+		}
+	}
+	return matches;
+}
+
+/**
+ * Build and probe hash join. The smaller table is hashed, the bigger one probes it.
+ * If the left table is the smaller one, the matches are reordered (counting sort) to keep the left row order.
+ * @param[in] left key columns of the left table
+ * @param[in] right key columns of the right table (same count as the left ones)
+ * @return matched row indexes
+ */
+CJoinEngine::TMatches CJoinEngine::HashJoin ( const vector<const CColumn *> & left, const vector<const CColumn *> & right ) {
+	TMatches matches;
+	if ( left.empty( ) || left.size( ) != right.size( ) )
+		return matches;
+
+	CRowHash hashLeft ( left ), hashRight ( right );
+	if ( ! hashLeft.IsCompatible( hashRight ) )
+		return matches;
+
+	size_t rowsLeft = hashLeft.GetSize( );
+	size_t rowsRight = hashRight.GetSize( );
+	vector<size_t> found;
+
+	// right side is hashed, left rows are probed in order
+	if ( rowsRight <= rowsLeft ) {
+		CRowHashTable table ( hashRight );
+		hashLeft.MapCodes( hashRight );
+		for ( size_t i = 0; i < rowsLeft; ++ i ) {
+			table.Probe( hashLeft, i, found );
+			for ( const size_t & j : found )
+				matches.emplace_back( i, j );
+		}
+		return matches;
+	}
+
+	// left side is hashed, matches are bucketed by the left row afterwards
+	CRowHashTable table ( hashLeft );
+	hashRight.MapCodes( hashLeft );
+	TMatches unordered;
+	vector<size_t> counts ( rowsLeft + 1, 0 );
+	for ( size_t j = 0; j < rowsRight; ++ j ) {
+		table.Probe( hashRight, j, found );
+		for ( const size_t & i : found ) {
+			unordered.emplace_back( i, j );
+			++ counts[ i + 1 ];
+		}
+	}
+	for ( size_t i = 1; i <= rowsLeft; ++ i )
+		counts[ i ] += counts[ i - 1 ];
+	matches.resize( unordered.size( ) );
+	for ( const auto & i : unordered )
+		matches[ counts[ i.first ] ++ ] = i;
+	return matches;
+}
+
+/**
+ * Searches for a key column the tables can be merged on.
+ * @param[in] left key columns of the left table
+ * @param[in] right key columns of the right table
+ * @param[in] presorted only accept a column, which is already sorted in both tables
+ * @param[out] key index of the merge key column
+ * @return true if such a column exists
+ */
+bool CJoinEngine::FindMergeKey ( const vector<const CColumn *> & left, const vector<const CColumn *> & right, const bool & presorted, size_t & key ) {
+	if ( left.empty( ) || left.size( ) != right.size( ) )
+		return false;
+
+	bool found = false;
+	for ( size_t i = 0; i < left.size( ); ++ i ) {
+		if ( left[ i ]->GetType( ) == CColumn::TYPE_DOUBLE || left[ i ]->GetType( ) != right[ i ]->GetType( ) )
+			continue;
+		bool sorted = left[ i ]->IsSorted( ) && right[ i ]->IsSorted( );
+		if ( sorted || ( ! presorted && ! found ) ) {
+			key = i;
+			found = true;
+		}
+		if ( sorted )
+			return true;
+	}
+	return found;
+}
+
+/**
+ * Row order of a column sorted by its values. Equal values keep their row order.
+ * @param[in] column column to sort
+ * @param[out] order row indexes
+ */
+void CJoinEngine::SortedOrder ( const CColumn & column, vector<size_t> & order ) {
+	order.resize( column.GetSize( ) );
+	for ( size_t i = 0; i < order.size( ); ++ i )
+		order[ i ] = i;
+	if ( column.IsSorted( ) )
+		return;
+	stable_sort( order.begin( ), order.end( ), [ & column ] ( const size_t & a, const size_t & b ) {
+		return column.Less( a, column, b );
+	} );
+}
+
+/**
+ * Sort-merge join. Presorted tables are merged in O(n + m) with no extra memory,
+ * otherwise the row orders are sorted first and the matches reordered afterwards.
+ * If there is no key column to merge on, the hash join is used instead.
+ * @param[in] left key columns of the left table
+ * @param[in] right key columns of the right table (same count as the left ones)
+ * @return matched row indexes
+ */
+CJoinEngine::TMatches CJoinEngine::MergeJoin ( const vector<const CColumn *> & left, const vector<const CColumn *> & right ) {
+	size_t key;
+	if ( ! FindMergeKey( left, right, false, key ) )
+		return HashJoin( left, right );
+
+	const CColumn & keyLeft = * left[ key ], & keyRight = * right[ key ];
+	vector<size_t> orderLeft, orderRight;
+	SortedOrder( keyLeft, orderLeft );
+	SortedOrder( keyRight, orderRight );
+
+	TMatches matches;
+	size_t i = 0, j = 0, groupEnd, columnCnt = left.size( );
+	bool equal;
+	while ( i < orderLeft.size( ) && j < orderRight.size( ) ) {
+		if ( keyLeft.Less( orderLeft[ i ], keyRight, orderRight[ j ] ) ) {
+			++ i;
+			continue;
+		}
+		if ( keyLeft.Greater( orderLeft[ i ], keyRight, orderRight[ j ] ) ) {
+			++ j;
+			continue;
+		}
+
+		// group of equal right rows, each equal left row is paired with all of them
+		groupEnd = j + 1;
+		while ( groupEnd < orderRight.size( ) && keyRight.Equal( orderRight[ j ], keyRight, orderRight[ groupEnd ] ) )
+			++ groupEnd;
+		for ( ; i < orderLeft.size( ) && keyLeft.Equal( orderLeft[ i ], keyRight, orderRight[ j ] ); ++ i ) {
+			for ( size_t g = j; g < groupEnd; ++ g ) {
+				equal = true;
+				for ( size_t k = 0; k < columnCnt && equal; ++ k )
+					if ( k != key && ! left[ k ]->Equal( orderLeft[ i ], * right[ k ], orderRight[ g ] ) )
+						equal = false;
+				if ( equal )
+					matches.emplace_back( orderLeft[ i ], orderRight[ g ] );
+			}
+		}
+		j = groupEnd;
+	}
+
+	if ( ! keyLeft.IsSorted( ) || ! keyRight.IsSorted( ) )
+		sort( matches.begin( ), matches.end( ) );
+	return matches;
+}
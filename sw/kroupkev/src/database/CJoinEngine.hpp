@@ -0,0 +1,31 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+
+#include "CColumn.hpp"
+#include "CRowHash.hpp"
+
+using namespace std;
+
+/**
+ * This module finds the pairs of rows of two tables, which have equal values in all the key columns.
+ * All algorithms return the pairs in the same order - sorted by the left row, then by the right row.
+ * Row indexes are zero-based (data rows only).
+ *
+ * The merge join walks both tables along one key column at once. Doubles can't be merged on,
+ * because the epsilon equality is not transitive - such keys are only verified.
+ */
+class CJoinEngine {
+private:
+	static void SortedOrder ( const CColumn & column, vector<size_t> & order );
+
+public:
+	typedef vector<pair<size_t, size_t>> TMatches;
+
+	static bool FindMergeKey ( const vector<const CColumn *> & left, const vector<const CColumn *> & right, const bool & presorted, size_t & key );
+
+	static TMatches NestedLoopJoin ( const vector<const CColumn *> & left, const vector<const CColumn *> & right );
+	static TMatches HashJoin ( const vector<const CColumn *> & left, const vector<const CColumn *> & right );
+	static TMatches MergeJoin ( const vector<const CColumn *> & left, const vector<const CColumn *> & right );
+};
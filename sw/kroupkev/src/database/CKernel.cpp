@@ -0,0 +1,242 @@
+#include "CKernel.hpp"
+
+#include <cfloat>
+#include <cmath>
+
+#include "CCell.hpp"
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#define KERNEL_X86
+#include <immintrin.h>
+#endif
+
+CKernel::EIsa CKernel::m_Isa = CKernel::Detect( );
+
+/**
+ * Detects the best instruction set supported by the CPU.
+ */
+CKernel::EIsa CKernel::Detect ( ) {
+#ifdef KERNEL_X86
+	__builtin_cpu_init( );
+	if ( __builtin_cpu_supports( "avx2" ) )
+		return ISA_AVX2;
+	if ( __builtin_cpu_supports( "sse4.1" ) )
+		return ISA_SSE4;
+#endif
+	return ISA_SCALAR;
+}
+
+const char * CKernel::GetIsaName ( const EIsa & isa ) {
+	switch ( isa ) {
+		case ISA_AVX2:
+			return "AVX2";
+		case ISA_SSE4:
+			return "SSE4";
+		default:
+			return "SCALAR";
+	}
+}
+
+namespace {
+
+/**
+ * Single value comparison, the reference semantics for all the kernels.
+ */
+inline bool MatchScalar ( const int32_t & a, const CKernel::EOperator & op, const int32_t & b ) {
+	switch ( op ) {
+		case CKernel::OP_EQ: return a == b;
+		case CKernel::OP_NE: return a != b;
+		case CKernel::OP_GE: return a >= b;
+		case CKernel::OP_LE: return a <= b;
+		case CKernel::OP_GT: return a > b;
+		default:             return a < b;
+	}
+}
+
+inline bool MatchScalar ( const double & a, const CKernel::EOperator & op, const double & b ) {
+	switch ( op ) {
+		case CKernel::OP_EQ: return CDouble::cmpEq( a, b );
+		case CKernel::OP_NE: return ! CDouble::cmpEq( a, b );
+		case CKernel::OP_GE: return CDouble::cmpEq( a, b ) || CDouble::cmpGt( a, b );
+		case CKernel::OP_LE: return CDouble::cmpEq( a, b ) || CDouble::cmpLt( a, b );
+		case CKernel::OP_GT: return CDouble::cmpGt( a, b );
+		default:             return CDouble::cmpLt( a, b );
+	}
+}
+
+/**
+ * Scalar kernel, also used for the tails the vector kernels leave.
+ */
+template <typename T>
+void CompareScalar ( const T * data, const size_t & from, const size_t & rows, const CKernel::EOperator & op, const T & val, vector<uint64_t> & mask ) {
+	for ( size_t i = from; i < rows; ++ i )
+		if ( MatchScalar( data[ i ], op, val ) )
+			mask[ i >> 6 ] |= uint64_t( 1 ) << ( i & 63 );
+}
+
+/**
+ * Combines the equal / greater / less lane masks into the mask of an operator.
+ * The vector kernels only compute the lane masks the operator needs.
+ */
+inline uint64_t CombineMask ( const CKernel::EOperator & op, const uint64_t & eq, const uint64_t & gt, const uint64_t & lt, const uint64_t & lanes ) {
+	switch ( op ) {
+		case CKernel::OP_EQ: return eq;
+		case CKernel::OP_NE: return ~ eq & lanes;
+		case CKernel::OP_GE: return eq | gt;
+		case CKernel::OP_LE: return eq | lt;
+		case CKernel::OP_GT: return gt;
+		default:             return lt;
+	}
+}
+
+#ifdef KERNEL_X86
+
+__attribute__ (( target ( "avx2" ) ))
+void CompareAvx2 ( const int32_t * data, const size_t & rows, const CKernel::EOperator & op, const int32_t & val, vector<uint64_t> & mask ) {
+	const __m256i constant = _mm256_set1_epi32( val );
+	const bool needEq = op == CKernel::OP_EQ || op == CKernel::OP_NE || op == CKernel::OP_GE || op == CKernel::OP_LE;
+	const bool needGt = op == CKernel::OP_GE || op == CKernel::OP_GT;
+	const bool needLt = op == CKernel::OP_LE || op == CKernel::OP_LT;
+	size_t i = 0;
+	for ( ; i + 8 <= rows; i += 8 ) {
+		__m256i block = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( data + i ) );
+		uint64_t eq = ! needEq ? 0 : static_cast<uint32_t>( _mm256_movemask_ps( _mm256_castsi256_ps( _mm256_cmpeq_epi32( block, constant ) ) ) );
+		uint64_t gt = ! needGt ? 0 : static_cast<uint32_t>( _mm256_movemask_ps( _mm256_castsi256_ps( _mm256_cmpgt_epi32( block, constant ) ) ) );
+		uint64_t lt = ! needLt ? 0 : static_cast<uint32_t>( _mm256_movemask_ps( _mm256_castsi256_ps( _mm256_cmpgt_epi32( constant, block ) ) ) );
+		mask[ i >> 6 ] |= CombineMask( op, eq, gt, lt, 0xFF ) << ( i & 63 );
+	}
+	CompareScalar( data, i, rows, op, val, mask );
+}
+
+__attribute__ (( target ( "sse4.1" ) ))
+void CompareSse4 ( const int32_t * data, const size_t & rows, const CKernel::EOperator & op, const int32_t & val, vector<uint64_t> & mask ) {
+	const __m128i constant = _mm_set1_epi32( val );
+	const bool needEq = op == CKernel::OP_EQ || op == CKernel::OP_NE || op == CKernel::OP_GE || op == CKernel::OP_LE;
+	const bool needGt = op == CKernel::OP_GE || op == CKernel::OP_GT;
+	const bool needLt = op == CKernel::OP_LE || op == CKernel::OP_LT;
+	size_t i = 0;
+	for ( ; i + 4 <= rows; i += 4 ) {
+		__m128i block = _mm_loadu_si128( reinterpret_cast<const __m128i *>( data + i ) );
+		uint64_t eq = ! needEq ? 0 : static_cast<uint32_t>( _mm_movemask_ps( _mm_castsi128_ps( _mm_cmpeq_epi32( block, constant ) ) ) );
+		uint64_t gt = ! needGt ? 0 : static_cast<uint32_t>( _mm_movemask_ps( _mm_castsi128_ps( _mm_cmpgt_epi32( block, constant ) ) ) );
+		uint64_t lt = ! needLt ? 0 : static_cast<uint32_t>( _mm_movemask_ps( _mm_castsi128_ps( _mm_cmplt_epi32( block, constant ) ) ) );
+		mask[ i >> 6 ] |= CombineMask( op, eq, gt, lt, 0xF ) << ( i & 63 );
+	}
+	CompareScalar( data, i, rows, op, val, mask );
+}
+
+/**
+ * cmpEq:  |a - b| <= min( |a|, |b| ) * eps
+ * cmpGt:  ( a - b ) > max( |a|, |b| ) * eps
+ * cmpLt:  ( b - a ) > max( |a|, |b| ) * eps
+ * min( |b|, |a| ) and max( |b|, |a| ) return |a| for NaN exactly as the ternary operators of CDouble do.
+ */
+__attribute__ (( target ( "avx2" ) ))
+void CompareAvx2 ( const double * data, const size_t & rows, const CKernel::EOperator & op, const double & val, vector<uint64_t> & mask ) {
+	const __m256d constant = _mm256_set1_pd( val );
+	const __m256d absConstant = _mm256_set1_pd( fabs( val ) );
+	const __m256d epsilon = _mm256_set1_pd( DBL_EPSILON );
+	const __m256d signMask = _mm256_set1_pd( -0.0 );
+	const bool needEq = op == CKernel::OP_EQ || op == CKernel::OP_NE || op == CKernel::OP_GE || op == CKernel::OP_LE;
+	const bool needGt = op == CKernel::OP_GE || op == CKernel::OP_GT;
+	const bool needLt = op == CKernel::OP_LE || op == CKernel::OP_LT;
+	size_t i = 0;
+	for ( ; i + 4 <= rows; i += 4 ) {
+		__m256d a = _mm256_loadu_pd( data + i );
+		__m256d absA = _mm256_andnot_pd( signMask, a );
+		__m256d diff = _mm256_sub_pd( a, constant );
+		__m256d eqBound = _mm256_mul_pd( _mm256_min_pd( absConstant, absA ), epsilon );
+		__m256d ordBound = _mm256_mul_pd( _mm256_max_pd( absConstant, absA ), epsilon );
+		uint64_t eq = ! needEq ? 0 : static_cast<uint32_t>( _mm256_movemask_pd( _mm256_cmp_pd( _mm256_andnot_pd( signMask, diff ), eqBound, _CMP_LE_OQ ) ) );
+		uint64_t gt = ! needGt ? 0 : static_cast<uint32_t>( _mm256_movemask_pd( _mm256_cmp_pd( diff, ordBound, _CMP_GT_OQ ) ) );
+		uint64_t lt = ! needLt ? 0 : static_cast<uint32_t>( _mm256_movemask_pd( _mm256_cmp_pd( _mm256_sub_pd( constant, a ), ordBound, _CMP_GT_OQ ) ) );
+		mask[ i >> 6 ] |= CombineMask( op, eq, gt, lt, 0xF ) << ( i & 63 );
+	}
+	CompareScalar( data, i, rows, op, val, mask );
+}
+
+__attribute__ (( target ( "sse4.1" ) ))
+void CompareSse4 ( const double * data, const size_t & rows, const CKernel::EOperator & op, const double & val, vector<uint64_t> & mask ) {
+	const __m128d constant = _mm_set1_pd( val );
+	const __m128d absConstant = _mm_set1_pd( fabs( val ) );
+	const __m128d epsilon = _mm_set1_pd( DBL_EPSILON );
+	const __m128d signMask = _mm_set1_pd( -0.0 );
+	const bool needEq = op == CKernel::OP_EQ || op == CKernel::OP_NE || op == CKernel::OP_GE || op == CKernel::OP_LE;
+	const bool needGt = op == CKernel::OP_GE || op == CKernel::OP_GT;
+	const bool needLt = op == CKernel::OP_LE || op == CKernel::OP_LT;
+	size_t i = 0;
+	for ( ; i + 2 <= rows; i += 2 ) {
+		__m128d a = _mm_loadu_pd( data + i );
+		__m128d absA = _mm_andnot_pd( signMask, a );
+		__m128d diff = _mm_sub_pd( a, constant );
+		__m128d eqBound = _mm_mul_pd( _mm_min_pd( absConstant, absA ), epsilon );
+		__m128d ordBound = _mm_mul_pd( _mm_max_pd( absConstant, absA ), epsilon );
+		uint64_t eq = ! needEq ? 0 : static_cast<uint32_t>( _mm_movemask_pd( _mm_cmple_pd( _mm_andnot_pd( signMask, diff ), eqBound ) ) );
+		uint64_t gt = ! needGt ? 0 : static_cast<uint32_t>( _mm_movemask_pd( _mm_cmpgt_pd( diff, ordBound ) ) );
+		uint64_t lt = ! needLt ? 0 : static_cast<uint32_t>( _mm_movemask_pd( _mm_cmpgt_pd( _mm_sub_pd( constant, a ), ordBound ) ) );
+		mask[ i >> 6 ] |= CombineMask( op, eq, gt, lt, 0x3 ) << ( i & 63 );
+	}
+	CompareScalar( data, i, rows, op, val, mask );
+}
+
+#endif
+
+}
+
+/**
+ * Compares the int values with a constant.
+ * @param[in] data values
+ * @param[in] rows number of values
+ * @param[in] op relation operator
+ * @param[in] val constant
+ * @param[out] mask bitmask of the matching values
+ */
+void CKernel::Compare ( const int32_t * data, const size_t & rows, const EOperator & op, const int32_t & val, vector<uint64_t> & mask ) {
+	mask.assign( ( rows + 63 ) / 64, 0 );
+#ifdef KERNEL_X86
+	if ( m_Isa == ISA_AVX2 )
+		return CompareAvx2( data, rows, op, val, mask );
+	if ( m_Isa == ISA_SSE4 )
+		return CompareSse4( data, rows, op, val, mask );
+#endif
+	CompareScalar( data, 0, rows, op, val, mask );
+}
+
+/**
+ * Compares the double values with a constant (epsilon comparison, see CDouble).
+ * @param[in] data values
+ * @param[in] rows number of values
+ * @param[in] op relation operator
+ * @param[in] val constant
+ * @param[out] mask bitmask of the matching values
+ */
+void CKernel::Compare ( const double * data, const size_t & rows, const EOperator & op, const double & val, vector<uint64_t> & mask ) {
+	mask.assign( ( rows + 63 ) / 64, 0 );
+#ifdef KERNEL_X86
+	if ( m_Isa == ISA_AVX2 )
+		return CompareAvx2( data, rows, op, val, mask );
+	if ( m_Isa == ISA_SSE4 )
+		return CompareSse4( data, rows, op, val, mask );
+#endif
+	CompareScalar( data, 0, rows, op, val, mask );
+}
+
+/**
+ * Converts a bitmask into a selection vector.
+ * @param[in] mask bitmask
+ * @param[in] rows number of values covered by the mask
+ * @param[out] out indexes of the set bits (ascending)
+ */
+void CKernel::MaskToSelection ( const vector<uint64_t> & mask, const size_t & rows, vector<size_t> & out ) {
+	out.clear( );
+	for ( size_t w = 0; w < mask.size( ); ++ w ) {
+		uint64_t bits = mask[ w ];
+		while ( bits ) {
+			size_t i = ( w << 6 ) + __builtin_ctzll( bits );
+			if ( i >= rows )
+				return;
+			out.push_back( i );
+			bits &= bits - 1;
+		}
+	}
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * This module compares contiguous int and double data with a constant.
+ * The result is a bitmask with one bit per value (bit i % 64 of word i / 64).
+ *
+ * The comparisons run as AVX2 (8 ints / 4 doubles at once) or SSE4 (4 ints / 2 doubles) kernels,
+ * with a scalar fallback. The instruction set is detected at runtime, so the binary runs on any x86 CPU
+ * (and on the other architectures with the scalar kernels only).
+ *
+ * The double kernels are exact equivalents of CDouble::cmpEq, cmpGt and cmpLt - including the epsilon
+ * relative to the smaller (equality) or bigger (ordering) absolute value and the NaN behaviour.
+ */
+class CKernel {
+public:
+	enum EOperator { OP_EQ, OP_NE, OP_GE, OP_LE, OP_GT, OP_LT };
+	enum EIsa { ISA_SCALAR, ISA_SSE4, ISA_AVX2 };
+
+	static EIsa m_Isa;
+
+	static EIsa Detect ( );
+	static const char * GetIsaName ( const EIsa & isa );
+
+	static void Compare ( const int32_t * data, const size_t & rows, const EOperator & op, const int32_t & val, vector<uint64_t> & mask );
+	static void Compare ( const double * data, const size_t & rows, const EOperator & op, const double & val, vector<uint64_t> & mask );
+	static void MaskToSelection ( const vector<uint64_t> & mask, const size_t & rows, vector<size_t> & out );
+};
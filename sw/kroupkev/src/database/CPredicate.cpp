@@ -0,0 +1,243 @@
+#include "CPredicate.hpp"
+
+#include <cstring>
+
+const size_t CPredicate::DENSE_RATIO = 4;
+
+CPredicate::CPredicate ( const EOperator & op, const int32_t & constant )
+: m_Operator( op ), m_Type( CColumn::TYPE_INT ), m_Int( constant ) { }
+
+CPredicate::CPredicate ( const EOperator & op, const double & constant )
+: m_Operator( op ), m_Type( CColumn::TYPE_DOUBLE ), m_Double( constant ) { }
+
+CPredicate::CPredicate ( const EOperator & op, const string & constant )
+: m_Operator( op ), m_Type( CColumn::TYPE_STRING ), m_String( constant ) { }
+
+/**
+ * Translates the relation operator of a condition.
+ * @param[in] op operator string
+ * @param[out] out operator
+ * @return true if the operator is known
+ */
+bool CPredicate::ParseOperator ( const string & op, EOperator & out ) {
+	if ( op == "==" )
+		out = CKernel::OP_EQ;
+	else if ( op == "!=" )
+		out = CKernel::OP_NE;
+	else if ( op == ">=" )
+		out = CKernel::OP_GE;
+	else if ( op == "<=" )
+		out = CKernel::OP_LE;
+	else if ( op == ">" )
+		out = CKernel::OP_GT;
+	else if ( op == "<" )
+		out = CKernel::OP_LT;
+	else
+		return false;
+	return true;
+}
+
+/**
+ * Scans all the rows (or the selected ones) with the row comparisons against the constant. The operator is resolved outside the loop.
+ * @param[in] rows indexes of the selected rows, nullptr for all of them
+ * @param[in] size number of the column rows
+ */
+template <typename TEq, typename TLt, typename TGt>
+void CPredicate::Scan ( const vector<size_t> * rows, const size_t & size, TEq eq, TLt lt, TGt gt, vector<size_t> & out ) const {
+	size_t count = rows ? rows->size( ) : size;
+	const size_t * selected = rows ? rows->data( ) : nullptr;
+	switch ( m_Operator ) {
+		case CKernel::OP_EQ:
+			for ( size_t k = 0, i; k < count; ++ k )
+				if ( eq( i = selected ? selected[ k ] : k ) )
+					out.push_back( i );
+			break;
+		case CKernel::OP_NE:
+			for ( size_t k = 0, i; k < count; ++ k )
+				if ( ! eq( i = selected ? selected[ k ] : k ) )
+					out.push_back( i );
+			break;
+		case CKernel::OP_GE:
+			for ( size_t k = 0, i; k < count; ++ k )
+				if ( eq( i = selected ? selected[ k ] : k ) || gt( i ) )
+					out.push_back( i );
+			break;
+		case CKernel::OP_LE:
+			for ( size_t k = 0, i; k < count; ++ k )
+				if ( eq( i = selected ? selected[ k ] : k ) || lt( i ) )
+					out.push_back( i );
+			break;
+		case CKernel::OP_GT:
+			for ( size_t k = 0, i; k < count; ++ k )
+				if ( gt( i = selected ? selected[ k ] : k ) )
+					out.push_back( i );
+			break;
+		default:
+			for ( size_t k = 0, i; k < count; ++ k )
+				if ( lt( i = selected ? selected[ k ] : k ) )
+					out.push_back( i );
+	}
+}
+
+/**
+ * Evaluates the predicate over a column.
+ * @param[in] column column of the condition
+ * @param[out] out indexes of the matching rows (ascending)
+ */
+void CPredicate::Select ( const CColumn & column, vector<size_t> & out ) const {
+	Select( column, nullptr, out );
+}
+
+/**
+ * Evaluates the predicate over the selected rows of a column.
+ * @param[in] column column of the condition
+ * @param[in] rows indexes of the selected rows (ascending)
+ * @param[out] out indexes of the matching selected rows (ascending)
+ */
+void CPredicate::Select ( const CColumn & column, const vector<size_t> & rows, vector<size_t> & out ) const {
+	Select( column, & rows, out );
+}
+
+/**
+ * Numbers are compared by the SIMD kernels, unless only a small part of the column is selected -
+ * the selected rows are then compared one by one (with the same semantics, see CKernel). The kernels only compare
+ * the range from the first to the last selected row (e.g. a morsel of the rows, see CExpression::Select).
+ * @param[in] rows indexes of the selected rows, nullptr for all of them
+ */
+void CPredicate::Select ( const CColumn & column, const vector<size_t> * rows, vector<size_t> & out ) const {
+	out.clear( );
+	size_t size = column.GetSize( );
+
+	// values of different types never match
+	if ( column.GetType( ) != m_Type ) {
+		if ( m_Operator == CKernel::OP_NE ) {
+			for ( size_t i = 0; i < ( rows ? rows->size( ) : size ); ++ i )
+				out.push_back( rows ? ( * rows )[ i ] : i );
+		}
+		return;
+	}
+	if ( m_Type == CColumn::TYPE_STRING ) {
+		SelectStrings( static_cast<const CStringColumn &>( column ), rows, out );
+		return;
+	}
+
+	if ( rows && rows->empty( ) )
+		return;
+	size_t first = rows ? rows->front( ) : 0;
+	size_t span = rows ? rows->back( ) - first + 1 : size;
+	if ( ! rows || rows->size( ) * DENSE_RATIO >= span ) {
+		vector<uint64_t> mask;
+		if ( m_Type == CColumn::TYPE_INT )
+			CKernel::Compare( static_cast<const CIntColumn &>( column ).GetData( ) + first, span, m_Operator, m_Int, mask );
+		else
+			CKernel::Compare( static_cast<const CDoubleColumn &>( column ).GetData( ) + first, span, m_Operator, m_Double, mask );
+		if ( ! rows || rows->size( ) == span ) {
+			// all the rows of the range are selected
+			CKernel::MaskToSelection( mask, span, out );
+			if ( first )
+				for ( size_t & i : out )
+					i += first;
+			return;
+		}
+		for ( const size_t & i : * rows )
+			if ( ( mask[ ( i - first ) / 64 ] >> ( ( i - first ) % 64 ) ) & 1 )
+				out.push_back( i );
+		return;
+	}
+
+	if ( m_Type == CColumn::TYPE_INT ) {
+		const int32_t * data = static_cast<const CIntColumn &>( column ).GetData( );
+		const int32_t & val = m_Int;
+		Scan( rows, size,
+			[ data, & val ] ( const size_t & i ) { return data[ i ] == val; },
+			[ data, & val ] ( const size_t & i ) { return data[ i ] < val; },
+			[ data, & val ] ( const size_t & i ) { return data[ i ] > val; },
+			out );
+	} else {
+		const double * data = static_cast<const CDoubleColumn &>( column ).GetData( );
+		const double & val = m_Double;
+		Scan( rows, size,
+			[ data, & val ] ( const size_t & i ) { return CDouble::cmpEq( data[ i ], val ); },
+			[ data, & val ] ( const size_t & i ) { return CDouble::cmpLt( data[ i ], val ); },
+			[ data, & val ] ( const size_t & i ) { return CDouble::cmpGt( data[ i ], val ); },
+			out );
+	}
+}
+
+/**
+ * String columns are compared in place (same ordering as std::string, see CStringColumn::CompareTo).
+ * @param[in] strings column of the condition
+ * @param[in] rows indexes of the selected rows, nullptr for all of them
+ * @param[out] out indexes of the matching rows (ascending)
+ */
+void CPredicate::SelectStrings ( const CStringColumn & strings, const vector<size_t> * rows, vector<size_t> & out ) const {
+	if ( strings.IsEncoded( ) ) {
+		SelectCodes( strings, rows, out );
+		return;
+	}
+	const string & val = m_String;
+	auto compare = [ & strings, & val ] ( const size_t & i ) {
+		size_t len = strings.GetStrLen( i );
+		int res = memcmp( strings.GetStr( i ), val.data( ), len < val.size( ) ? len : val.size( ) );
+		if ( res != 0 )
+			return res;
+		return len < val.size( ) ? -1 : ( len > val.size( ) ? 1 : 0 );
+	};
+	Scan( rows, strings.GetSize( ),
+		[ & strings, & val ] ( const size_t & i ) { return strings.GetStrLen( i ) == val.size( ) && memcmp( strings.GetStr( i ), val.data( ), val.size( ) ) == 0; },
+		[ & compare ] ( const size_t & i ) { return compare( i ) < 0; },
+		[ & compare ] ( const size_t & i ) { return compare( i ) > 0; },
+		out );
+}
+
+/**
+ * Dictionary encoded columns are compared by the codes. An equality compares the row codes with the code of the constant,
+ * the other operators are evaluated for each value of the dictionary and the rows are then selected by their codes.
+ * @param[in] strings dictionary encoded column of the condition
+ * @param[in] rows indexes of the selected rows, nullptr for all of them
+ * @param[out] out indexes of the matching rows (ascending)
+ */
+void CPredicate::SelectCodes ( const CStringColumn & strings, const vector<size_t> * rows, vector<size_t> & out ) const {
+	const CStringDictionary & dictionary = * strings.GetDictionary( );
+	const uint32_t * codes = strings.GetCodes( );
+	size_t count = rows ? rows->size( ) : strings.GetSize( );
+	const size_t * selected = rows ? rows->data( ) : nullptr;
+	if ( m_Operator == CKernel::OP_EQ || m_Operator == CKernel::OP_NE ) {
+		uint32_t code = dictionary.Find( m_String );
+		bool equal = m_Operator == CKernel::OP_EQ;
+		for ( size_t k = 0, i; k < count; ++ k )
+			if ( ( codes[ i = selected ? selected[ k ] : k ] == code ) == equal )
+				out.push_back( i );
+		return;
+	}
+
+	vector<char> matching ( dictionary.GetSize( ) );
+	for ( uint32_t i = 0; i < dictionary.GetSize( ); ++ i ) {
+		int res = dictionary.GetValue( i ).compare( m_String );
+		matching[ i ] = m_Operator == CKernel::OP_LT ? res < 0 : m_Operator == CKernel::OP_LE ? res <= 0
+		                : m_Operator == CKernel::OP_GT ? res > 0 : res >= 0;
+	}
+	for ( size_t k = 0, i; k < count; ++ k )
+		if ( matching[ codes[ i = selected ? selected[ k ] : k ] ] )
+			out.push_back( i );
+}
+
+/**
+ * Stores the constant as a column with a single row, so it can be compared with the rows of other columns (see CIndex).
+ * @return the column (owned by the caller)
+ */
+CColumn * CPredicate::CreateConstant ( ) const {
+	if ( m_Type == CColumn::TYPE_INT ) {
+		auto column = new CIntColumn( );
+		column->Append( m_Int );
+		return column;
+	}
+	if ( m_Type == CColumn::TYPE_DOUBLE ) {
+		auto column = new CDoubleColumn( );
+		column->Append( m_Double );
+		return column;
+	}
+	auto column = new CStringColumn( );
+	column->Append( m_String );
+	return column;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "CColumn.hpp"
+#include "CKernel.hpp"
+
+using namespace std;
+
+/**
+ * This module is a PRO condition compiled for a single column type.
+ * The operator and the constant are resolved once, the column is then scanned in a typed loop
+ * (int and double columns by the SIMD kernels, see CKernel) and the matching rows are returned as a selection vector.
+ * Dictionary encoded string columns are compared by their codes, the constant is looked up in the dictionary once.
+ * The predicate may also test only the selected rows of a column (the rows, which met the previous conditions).
+ * The comparison semantics are identical to the CCell operators (doubles are compared with an epsilon).
+ */
+class CPredicate {
+public:
+	typedef CKernel::EOperator EOperator;
+
+private:
+	static const size_t DENSE_RATIO;
+
+	EOperator m_Operator;
+	CColumn::EType m_Type;
+	int32_t m_Int = 0;
+	double m_Double = 0;
+	string m_String;
+
+	template <typename TEq, typename TLt, typename TGt>
+	void Scan ( const vector<size_t> * rows, const size_t & size, TEq eq, TLt lt, TGt gt, vector<size_t> & out ) const;
+	void Select ( const CColumn & column, const vector<size_t> * rows, vector<size_t> & out ) const;
+	void SelectStrings ( const CStringColumn & column, const vector<size_t> * rows, vector<size_t> & out ) const;
+	void SelectCodes ( const CStringColumn & column, const vector<size_t> * rows, vector<size_t> & out ) const;
+
+public:
+	CPredicate ( const EOperator & op, const int32_t & constant );
+	CPredicate ( const EOperator & op, const double & constant );
+	CPredicate ( const EOperator & op, const string & constant );
+
+	static bool ParseOperator ( const string & op, EOperator & out );
+
+	void Select ( const CColumn & column, vector<size_t> & out ) const;
+	void Select ( const CColumn & column, const vector<size_t> & rows, vector<size_t> & out ) const;
+	EOperator GetOperator ( ) const { return m_Operator; }
+	CColumn * CreateConstant ( ) const;
+};
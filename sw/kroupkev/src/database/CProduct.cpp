@@ -0,0 +1,174 @@
+#include "CProduct.hpp"
+
+const size_t CProduct::NO_LIMIT = static_cast<size_t>( -1 );
+const size_t CProduct::BATCH_SIZE = 1024;
+
+/**
+ * Creates a product of all the rows of two tables.
+ * @param[in] left left table (its columns come first)
+ * @param[in] right right table
+ */
+CProduct::CProduct ( const CTable & left, const CTable & right )
+	: m_Left( left ), m_Right( right ), m_LeftRows( left.GetDataRowCount( ) ), m_RightRows( right.GetDataRowCount( ) ) { }
+
+/**
+ * Generates the next pairs of the page.
+ * @param[out] left left rows of the pairs
+ * @param[out] right right rows of the pairs
+ * @param[in] count maximum number of pairs to generate
+ * @return number of pairs generated, zero once the page is exhausted
+ */
+size_t CProduct::CCursor::Next ( vector<size_t> & left, vector<size_t> & right, const size_t & count ) {
+	left.clear( );
+	right.clear( );
+	size_t size = m_Product.GetSize( );
+	if ( m_Position >= size )
+		return 0;
+	size_t n = min( count, size - m_Position );
+	left.reserve( n );
+	right.reserve( n );
+
+	// the page position is turned into a row of each side once, then the right side just wraps around
+	size_t pos = m_Product.m_Offset + m_Position, rightRows = m_Product.m_RightRows;
+	size_t i = pos / rightRows, j = pos % rightRows;
+	for ( size_t k = 0; k < n; ++ k ) {
+		left.push_back( i );
+		right.push_back( j );
+		if ( ++ j == rightRows ) {
+			j = 0;
+			++ i;
+		}
+	}
+	m_Position += n;
+	return n;
+}
+
+/**
+ * Limits the product to a page of its pairs.
+ * @param[in] offset number of pairs to skip
+ * @param[in] limit maximum number of pairs (NO_LIMIT for all of them)
+ */
+void CProduct::SetPage ( const size_t & offset, const size_t & limit ) {
+	m_Offset = offset;
+	m_Limit = limit;
+}
+
+/**
+ * @return number of pairs of the page
+ */
+size_t CProduct::GetSize ( ) const {
+	size_t size = m_LeftRows * m_RightRows;
+	if ( m_Offset >= size )
+		return 0;
+	return min( size - m_Offset, m_Limit );
+}
+
+/**
+ * Product column getter, the left columns come first.
+ */
+const CColumn * CProduct::GetColumn ( const size_t & index ) const {
+	bool right;
+	size_t sideIndex;
+	return FindColumn( index, right, sideIndex );
+}
+
+/**
+ * Finds the table column, which a product column comes from.
+ * @param[in] index index of the product column
+ * @param[out] right true if the column belongs to the right table
+ * @param[out] sideIndex index of the column in its table
+ * @return the column (nullptr if the table has no rows)
+ */
+const CColumn * CProduct::FindColumn ( const size_t & index, bool & right, size_t & sideIndex ) const {
+	right = index >= m_Left.GetColumnCount( );
+	sideIndex = right ? index - m_Left.GetColumnCount( ) : index;
+	return right ? m_Right.GetColumn( sideIndex ) : m_Left.GetColumn( sideIndex );
+}
+
+/**
+ * Creates a table with all the pairs of the page. The columns are filled batch by batch.
+ * @param[in] header names of the product columns
+ * @return the table (owned by the caller)
+ */
+CTable * CProduct::Materialize ( const vector<string> & header ) const {
+	size_t size = GetSize( );
+	if ( ! size )
+		return new CTable { header };
+
+	vector<CColumn *> columns;
+	for ( size_t i = 0; i < header.size( ); ++ i ) {
+		columns.push_back( CColumn::Create( GetColumn( i )->GetType( ) ) );
+		columns.back( )->Reserve( size );
+	}
+
+	CCursor cursor ( * this );
+	vector<size_t> left, right;
+	while ( cursor.Next( left, right ) ) {
+		for ( size_t i = 0; i < columns.size( ); ++ i ) {
+			bool isRight;
+			size_t sideIndex;
+			const CColumn * column = FindColumn( i, isRight, sideIndex );
+			CColumn * batch = column->Gather( isRight ? right : left );
+			columns[ i ]->AppendColumn( * batch );
+			delete batch;
+		}
+	}
+	return new CTable { header, columns };
+}
+
+/**
+ * Renders the pairs of the page the same way CTable::Render does, without storing them.
+ * The pairs are generated twice, first to measure the column widths, then to print them.
+ * @param[in] header names of the product columns
+ * @param[in,out] ost output stream
+ */
+void CProduct::Render ( const vector<string> & header, ostream & ost ) const {
+	if ( header.empty( ) || GetSize( ) == 0 )
+		throw logic_error( CLog::TAB_NO_BODY );
+
+	vector<const CColumn *> columns;
+	vector<bool> sides;
+	vector<size_t> paddings;
+	for ( size_t i = 0; i < header.size( ); ++ i ) {
+		bool right;
+		size_t sideIndex;
+		columns.push_back( FindColumn( i, right, sideIndex ) );
+		sides.push_back( right );
+		paddings.push_back( header[ i ].length( ) );
+	}
+
+	vector<size_t> left, right;
+	CCursor measure ( * this );
+	while ( measure.Next( left, right ) )
+		for ( size_t i = 0; i < columns.size( ); ++ i )
+			for ( const size_t & row : sides[ i ] ? right : left )
+				paddings[ i ] = max( paddings[ i ], columns[ i ]->GetLength( row ) );
+
+	size_t rowLen = ( columns.size( ) * CRenderSett::m_SpacePad.size( ) ) + 1;
+	for ( const size_t & i : paddings )
+		rowLen += i;
+	size_t tmp = rowLen;
+
+	// header
+	CTable::RenderSeparator( rowLen, tmp, ost );
+	ost << CRenderSett::m_SpacePad;
+	for ( size_t i = 0; i < header.size( ); ++ i )
+		ost << setw( paddings[ i ] ) << std::left << header[ i ] << CRenderSett::m_SpacePad;
+	ost << endl;
+
+	// body
+	CTable::RenderSeparator( rowLen, tmp, ost );
+	CCursor print ( * this );
+	while ( print.Next( left, right ) ) {
+		for ( size_t k = 0; k < left.size( ); ++ k ) {
+			ost << CRenderSett::m_SpacePad;
+			for ( size_t i = 0; i < columns.size( ); ++ i ) {
+				ost << setw( paddings[ i ] ) << std::left;
+				columns[ i ]->Print( sides[ i ] ? right[ k ] : left[ k ], ost ) << CRenderSett::m_SpacePad;
+			}
+			ost << endl;
+		}
+	}
+
+	CTable::RenderSeparator( rowLen, tmp, ost );
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include "CTable.hpp"
+#include "CColumn.hpp"
+
+using namespace std;
+
+/**
+ * This module is a lazy cartesian product of two tables. The product itself is never stored,
+ * the pairs of rows are generated on demand by a cursor, in batches - each left row is paired with all the right rows in turn.
+ *
+ * The product can be limited to a page (offset and a row limit), so only the requested pairs are ever generated.
+ * The product pairs all the rows of both tables, a filter over the columns of one side is placed below it (see CProductOperator).
+ *
+ * Row indexes are zero-based (data rows only). The tables have to outlive the product.
+ */
+class CProduct {
+public:
+	static const size_t NO_LIMIT;
+	static const size_t BATCH_SIZE;
+
+	/**
+	 * Position in the product, generates the pairs of the page in order.
+	 */
+	class CCursor {
+	private:
+		const CProduct & m_Product;
+		size_t m_Position = 0;
+
+	public:
+		explicit CCursor ( const CProduct & product ) : m_Product( product ) { }
+		size_t Next ( vector<size_t> & left, vector<size_t> & right, const size_t & count = BATCH_SIZE );
+	};
+
+private:
+	const CTable & m_Left;
+	const CTable & m_Right;
+	size_t m_LeftRows;
+	size_t m_RightRows;
+	size_t m_Offset = 0;
+	size_t m_Limit = NO_LIMIT;
+
+	const CColumn * GetColumn ( const size_t & index ) const;
+
+public:
+	CProduct ( const CTable & left, const CTable & right );
+
+	void SetPage ( const size_t & offset, const size_t & limit );
+	size_t GetSize ( ) const;
+	const CColumn * FindColumn ( const size_t & index, bool & right, size_t & sideIndex ) const;
+
+	CTable * Materialize ( const vector<string> & header ) const;
+	void Render ( const vector<string> & header, ostream & ost = cout ) const;
+};
@@ -0,0 +1,123 @@
+#include "CQuerySett.hpp"
+
+CQuerySett::EJoin CQuerySett::m_JoinAlgorithm = CQuerySett::JOIN_AUTO;
+CQuerySett::ESetOp CQuerySett::m_SetAlgorithm = CQuerySett::SETOP_HASH;
+size_t CQuerySett::m_CacheBudget = 64;
+size_t CQuerySett::m_AggregateBudget = 64;
+size_t CQuerySett::m_Threads = 0;
+
+/**
+ * Number of threads evaluating a query (filtering and sorting of large tables), 0 stands for the number of cores.
+ */
+size_t CQuerySett::GetThreads ( ) {
+	return m_Threads ? m_Threads : CThreadPool::GetDefaultSize( );
+}
+
+/**
+ * @param[in] key name of the setting (case insensitive)
+ * @return true if a setting of that name exists
+ */
+bool CQuerySett::IsSetting ( const string & key ) {
+	string k = key;
+	transform( k.begin( ), k.end( ), k.begin( ), ::toupper );
+	return k == CLog::SETT_JOIN || k == CLog::SETT_SETOP || k == CLog::SETT_CACHE || k == CLog::SETT_AGGREGATE
+	       || k == CLog::SETT_THREADS || k == CLog::SETT_SIMD;
+}
+
+/**
+ * Changes a setting.
+ * @param[in] key name of the setting (case insensitive)
+ * @param[in] value new value of the setting (case insensitive)
+ * @return true if the setting exists and the value is valid
+ */
+bool CQuerySett::Set ( const string & key, const string & value ) {
+	string k = key, v = value;
+	transform( k.begin( ), k.end( ), k.begin( ), ::toupper );
+	transform( v.begin( ), v.end( ), v.begin( ), ::toupper );
+
+	if ( k == CLog::SETT_JOIN ) {
+		if ( v == CLog::SETT_AUTO )
+			m_JoinAlgorithm = JOIN_AUTO;
+		else if ( v == CLog::SETT_HASH )
+			m_JoinAlgorithm = JOIN_HASH;
+		else if ( v == CLog::SETT_MERGE )
+			m_JoinAlgorithm = JOIN_MERGE;
+		else if ( v == CLog::SETT_NESTED )
+			m_JoinAlgorithm = JOIN_NESTED;
+		else
+			return false;
+		return true;
+	}
+	if ( k == CLog::SETT_SETOP ) {
+		if ( v == CLog::SETT_HASH )
+			m_SetAlgorithm = SETOP_HASH;
+		else if ( v == CLog::SETT_SORT )
+			m_SetAlgorithm = SETOP_SORT;
+		else
+			return false;
+		return true;
+	}
+	if ( k == CLog::SETT_CACHE ) {
+		// megabytes of the result cache (see CResultCache), 0 disables it
+		if ( v.empty( ) || v.length( ) > 9 || v.find_first_not_of( "0123456789" ) != string::npos )
+			return false;
+		m_CacheBudget = stoul( v );
+		return true;
+	}
+	if ( k == CLog::SETT_AGGREGATE ) {
+		// megabytes of the groups aggregated by the hash table (see CAggregateOperator), 0 sorts the rows always
+		if ( v.empty( ) || v.length( ) > 9 || v.find_first_not_of( "0123456789" ) != string::npos )
+			return false;
+		m_AggregateBudget = stoul( v );
+		return true;
+	}
+	if ( k == CLog::SETT_THREADS ) {
+		// AUTO (or 0) uses a thread per core
+		if ( v == CLog::SETT_AUTO ) {
+			m_Threads = 0;
+			return true;
+		}
+		if ( v.empty( ) || v.length( ) > 3 || v.find_first_not_of( "0123456789" ) != string::npos )
+			return false;
+		m_Threads = stoul( v );
+		return true;
+	}
+	if ( k == CLog::SETT_SIMD ) {
+		// the instruction set can only be lowered below the one the CPU supports
+		for ( int i = CKernel::ISA_SCALAR; i <= CKernel::Detect( ); ++ i ) {
+			if ( v == CKernel::GetIsaName( static_cast<CKernel::EIsa>( i ) ) ) {
+				CKernel::m_Isa = static_cast<CKernel::EIsa>( i );
+				return true;
+			}
+		}
+		return false;
+	}
+	return false;
+}
+
+/**
+ * Lists all settings with their current values.
+ */
+void CQuerySett::Print ( ) {
+	CLog::Msg( CLog::QP, CLog::CON_LISTING_S, "" );
+	const string * join;
+	switch ( m_JoinAlgorithm ) {
+		case JOIN_AUTO:
+			join = & CLog::SETT_AUTO;
+			break;
+		case JOIN_HASH:
+			join = & CLog::SETT_HASH;
+			break;
+		case JOIN_MERGE:
+			join = & CLog::SETT_MERGE;
+			break;
+		default:
+			join = & CLog::SETT_NESTED;
+	}
+	CLog::BoldMsg( CLog::QP, CLog::SETT_JOIN, string( " = " ).append( * join ) );
+	CLog::BoldMsg( CLog::QP, CLog::SETT_SETOP, string( " = " ).append( m_SetAlgorithm == SETOP_HASH ? CLog::SETT_HASH : CLog::SETT_SORT ) );
+	CLog::BoldMsg( CLog::QP, CLog::SETT_SIMD, string( " = " ).append( CKernel::GetIsaName( CKernel::m_Isa ) ) );
+	CLog::BoldMsg( CLog::QP, CLog::SETT_CACHE, string( " = " ).append( to_string( m_CacheBudget ) ).append( " MB" ) );
+	CLog::BoldMsg( CLog::QP, CLog::SETT_AGGREGATE, string( " = " ).append( to_string( m_AggregateBudget ) ).append( " MB" ) );
+	CLog::BoldMsg( CLog::QP, CLog::SETT_THREADS, string( " = " ).append( m_Threads ? to_string( m_Threads ) : CLog::SETT_AUTO + " (" + to_string( GetThreads( ) ) + ")" ) );
+}
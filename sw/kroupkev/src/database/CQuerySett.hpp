@@ -0,0 +1,33 @@
+#pragma once
+
+#include <iostream>
+#include <algorithm>
+#include <string>
+
+#include "CKernel.hpp"
+#include "../tool/CThreadPool.hpp"
+#include "../console/CLog.hpp"
+
+using namespace std;
+
+/**
+ * This module stores the query evaluation settings. They can be changed from the console (SET command) or the config file.
+ * Each application instance may only have one since the members are all static.
+ */
+class CQuerySett {
+public:
+	enum EJoin { JOIN_AUTO, JOIN_HASH, JOIN_MERGE, JOIN_NESTED };
+	enum ESetOp { SETOP_HASH, SETOP_SORT };
+
+	static EJoin m_JoinAlgorithm;
+	static ESetOp m_SetAlgorithm;
+	static size_t m_CacheBudget;
+	static size_t m_AggregateBudget;
+	static size_t m_Threads;
+	static const size_t CACHE_UNIT = 1 << 20;
+
+	static size_t GetThreads ( );
+	static bool IsSetting ( const string & key );
+	static bool Set ( const string & key, const string & value );
+	static void Print ( );
+};
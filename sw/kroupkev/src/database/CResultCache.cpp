@@ -0,0 +1,93 @@
+#include "CResultCache.hpp"
+#include "CQuerySett.hpp"
+#include "../query/CTableQuery.hpp"
+
+#include <algorithm>
+
+CResultCache::~CResultCache ( ) {
+	Clear( );
+}
+
+void CResultCache::Erase ( const list<CEntry>::iterator & entry ) {
+	m_Size -= entry->m_Size;
+	m_Keys.erase( entry->m_Key );
+	delete entry->m_Query;
+	m_Entries.erase( entry );
+}
+
+/**
+ * Searches for an evaluated query, the query becomes the most recently used one.
+ * @param[in] key definition of the query with the versions of its tables
+ * @return the evaluated query (owned by the cache), nullptr if it isn't cached
+ */
+CTableQuery * CResultCache::Find ( const string & key ) {
+	auto tmp = m_Keys.find( key );
+	if ( tmp == m_Keys.end( ) )
+		return nullptr;
+	m_Entries.splice( m_Entries.begin( ), m_Entries, tmp->second );
+	return tmp->second->m_Query;
+}
+
+/**
+ * Keeps an evaluated query, the least recently used ones are dropped if the results exceed the budget.
+ * A query larger than the budget isn't kept.
+ * @param[in] key definition of the query with the versions of its tables
+ * @param[in] definition query as it was entered
+ * @param[in] query the evaluated query (taken over by the cache)
+ * @param[in] tables names of the tables the query reads
+ */
+void CResultCache::Insert ( const string & key, const string & definition, CTableQuery * query, const vector<string> & tables ) {
+	size_t size = query->GetResultSize( );
+	auto tmp = m_Keys.find( key );
+	if ( tmp != m_Keys.end( ) )
+		Erase( tmp->second );
+	if ( size > CQuerySett::m_CacheBudget * CQuerySett::CACHE_UNIT ) {
+		delete query;
+		return;
+	}
+	m_Entries.push_front( CEntry { key, definition, query, tables, size } );
+	m_Keys[ key ] = m_Entries.begin( );
+	m_Size += size;
+	Shrink( );
+}
+
+/**
+ * Drops the results of the queries reading a table.
+ */
+void CResultCache::Invalidate ( const string & table ) {
+	for ( auto i = m_Entries.begin( ); i != m_Entries.end( ); ) {
+		auto following = next( i );
+		if ( find( i->m_Tables.begin( ), i->m_Tables.end( ), table ) != i->m_Tables.end( ) )
+			Erase( i );
+		i = following;
+	}
+}
+
+/**
+ * Drops the least recently used results until the results fit the budget.
+ */
+void CResultCache::Shrink ( ) {
+	while ( ! m_Entries.empty( ) && m_Size > CQuerySett::m_CacheBudget * CQuerySett::CACHE_UNIT )
+		Erase( prev( m_Entries.end( ) ) );
+}
+
+void CResultCache::Clear ( ) {
+	while ( ! m_Entries.empty( ) )
+		Erase( m_Entries.begin( ) );
+}
+
+/**
+ * Lists the cached queries from the most recently used one, with the size of their results.
+ */
+void CResultCache::List ( const string & branch ) const {
+	if ( m_Entries.empty( ) ) {
+		CLog::Msg( branch, CLog::CON_LIST_EMPTY, "\n" );
+		return;
+	}
+	CLog::Msg( branch, CLog::CON_LISTING_C, "\n" );
+	size_t counter = 0;
+	for ( const CEntry & i : m_Entries )
+		CLog::BoldMsg( branch, to_string( ++ counter ).append( ". " ).append( i.m_Definition ), string( " (" ).append( to_string( ( i.m_Size + 1023 ) / 1024 ) ).append( " kB)" ) );
+	CLog::Msg( branch, string( "Total: " ).append( to_string( ( m_Size + 1023 ) / 1024 ) ).append( " kB of " )
+	           .append( to_string( CQuerySett::m_CacheBudget ) ).append( " MB" ), "\n" );
+}
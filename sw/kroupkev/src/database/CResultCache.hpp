@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_map>
+
+using namespace std;
+
+class CTableQuery;
+
+/**
+ * This module keeps the evaluated queries, which weren't saved, so a repeated query is printed without being evaluated again
+ * (see CQueryParser::ProcessQuery). A query is identified by its definition as it was entered - the console removes the spaces
+ * outside the quotes, so equal queries have equal definitions - and by the versions of the tables it reads, directly
+ * or through the saved queries (see CDatabase::CreateCacheKey).
+ *
+ * The results of a table are dropped once rows are appended to it, all of them once a column is renamed or a setting is changed.
+ * The least recently used results are dropped once the results take more memory than the budget (SET[ CACHE, megabytes ]).
+ */
+class CResultCache {
+private:
+	struct CEntry {
+		string m_Key;
+		string m_Definition;
+		CTableQuery * m_Query;
+		vector<string> m_Tables;
+		size_t m_Size;
+	};
+
+	list<CEntry> m_Entries;
+	unordered_map<string, list<CEntry>::iterator> m_Keys;
+	size_t m_Size = 0;
+
+	void Erase ( const list<CEntry>::iterator & entry );
+
+public:
+	CResultCache ( ) = default;
+	CResultCache ( const CResultCache & ) = delete;
+	CResultCache & operator = ( const CResultCache & ) = delete;
+	~CResultCache ( );
+
+	CTableQuery * Find ( const string & key );
+	void Insert ( const string & key, const string & definition, CTableQuery * query, const vector<string> & tables );
+	void Invalidate ( const string & table );
+	void Shrink ( );
+	void Clear ( );
+	void List ( const string & branch ) const;
+};
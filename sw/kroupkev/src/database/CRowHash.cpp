@@ -0,0 +1,264 @@
+#include "CRowHash.hpp"
+
+#include <cstring>
+#include <algorithm>
+
+/**
+ * Selects the key columns which take part in the hash.
+ * @param[in] keys key columns (all of them must have the same number of rows)
+ */
+CRowHash::CRowHash ( const vector<const CColumn *> & keys ) : m_Keys( keys ) {
+	for ( size_t i = 0; i < m_Keys.size( ); ++ i )
+		if ( m_Keys[ i ]->GetType( ) != CColumn::TYPE_DOUBLE )
+			m_Hashed.push_back( i );
+	if ( m_Hashed.empty( ) && ! m_Keys.empty( ) ) {
+		m_Hashed.push_back( 0 );
+		m_Fuzzy = true;
+	}
+}
+
+/**
+ * Bit mixing finalizer (splitmix64).
+ */
+uint64_t CRowHash::Mix ( uint64_t x ) {
+	x ^= x >> 30;
+	x *= 0xbf58476d1ce4e5b9ULL;
+	x ^= x >> 27;
+	x *= 0x94d049bb133111ebULL;
+	x ^= x >> 31;
+	return x;
+}
+
+/**
+ * FNV-1a hash of a byte sequence.
+ */
+uint64_t CRowHash::HashBytes ( const char * str, const size_t & len ) {
+	uint64_t h = 0xcbf29ce484222325ULL;
+	for ( size_t i = 0; i < len; ++ i ) {
+		h ^= static_cast<unsigned char>( str[ i ] );
+		h *= 0x100000001b3ULL;
+	}
+	return h;
+}
+
+/**
+ * Maps a double to an unsigned number with the same ordering.
+ * Neighbouring doubles (including -0 and +0) are mapped to neighbouring numbers.
+ */
+uint64_t CRowHash::OrderedBits ( const double & val ) {
+	uint64_t bits;
+	memcpy( & bits, & val, sizeof( bits ) );
+	const uint64_t sign = 0x8000000000000000ULL;
+	return ( bits & sign ) ? ~ bits : ( bits | sign );
+}
+
+size_t CRowHash::GetSize ( ) const {
+	return m_Keys.empty( ) ? 0 : m_Keys[ 0 ]->GetSize( );
+}
+
+/**
+ * Returns true if the neighbouring hashes have to be probed too (see the module description).
+ */
+bool CRowHash::IsFuzzy ( ) const {
+	return m_Fuzzy;
+}
+
+/**
+ * Rows of two hashers can only match if their key columns have the same types.
+ */
+bool CRowHash::IsCompatible ( const CRowHash & other ) const {
+	if ( m_Keys.size( ) != other.m_Keys.size( ) )
+		return false;
+	for ( size_t i = 0; i < m_Keys.size( ); ++ i )
+		if ( m_Keys[ i ]->GetType( ) != other.m_Keys[ i ]->GetType( ) )
+			return false;
+	return true;
+}
+
+/**
+ * Maps the codes of the dictionary encoded keys onto the codes of the build side keys with a different dictionary,
+ * so the probe rows are compared with the build rows by the codes (see Equal).
+ * @param[in] build build side hasher (must be compatible)
+ */
+void CRowHash::MapCodes ( const CRowHash & build ) {
+	m_CodeMaps.assign( m_Keys.size( ), vector<uint32_t>( ) );
+	for ( size_t i = 0; i < m_Keys.size( ); ++ i ) {
+		if ( m_Keys[ i ]->GetType( ) != CColumn::TYPE_STRING )
+			continue;
+		const CStringDictionary * dictionary = static_cast<const CStringColumn *>( m_Keys[ i ] )->GetDictionary( );
+		const CStringDictionary * other = static_cast<const CStringColumn *>( build.m_Keys[ i ] )->GetDictionary( );
+		if ( dictionary && other && dictionary != other )
+			m_CodeMaps[ i ] = dictionary->Translate( * other );
+	}
+}
+
+/**
+ * Hashes the key of a row.
+ * @param[in] row row index
+ * @param[in] shift ordered bit pattern shift of the fuzzy column (-1, 0, 1)
+ * @return hash of the row key
+ */
+uint64_t CRowHash::Hash ( const size_t & row, const int & shift ) const {
+	uint64_t h = 0x9e3779b97f4a7c15ULL;
+	for ( const size_t & i : m_Hashed ) {
+		const CColumn * col = m_Keys[ i ];
+		uint64_t v;
+		switch ( col->GetType( ) ) {
+			case CColumn::TYPE_INT:
+				v = static_cast<uint64_t>( static_cast<const CIntColumn *>( col )->GetVal( row ) );
+				break;
+			case CColumn::TYPE_DOUBLE:
+				v = OrderedBits( static_cast<const CDoubleColumn *>( col )->GetVal( row ) ) + shift;
+				break;
+			default:
+				v = static_cast<const CStringColumn *>( col )->Hash( row );
+		}
+		h = Mix( h ^ ( v + 0x9e3779b97f4a7c15ULL + ( h << 6 ) + ( h >> 2 ) ) );
+	}
+	return h;
+}
+
+/**
+ * Compares the keys of two rows (all key columns must be equal). The mapped codes (see MapCodes) are compared
+ * with the codes of the other side.
+ */
+bool CRowHash::Equal ( const size_t & row, const CRowHash & other, const size_t & otherRow ) const {
+	for ( size_t i = 0; i < m_Keys.size( ); ++ i ) {
+		if ( ! m_CodeMaps.empty( ) && ! m_CodeMaps[ i ].empty( ) ) {
+			if ( m_CodeMaps[ i ][ static_cast<const CStringColumn *>( m_Keys[ i ] )->GetCode( row ) ]
+			     != static_cast<const CStringColumn *>( other.m_Keys[ i ] )->GetCode( otherRow ) )
+				return false;
+		} else if ( ! m_Keys[ i ]->Equal( row, * other.m_Keys[ i ], otherRow ) )
+			return false;
+	}
+	return true;
+}
+
+//
+
+/**
+ * Builds the hash table over all the rows of the build side.
+ * Rows are inserted from the last one, so each chain ends up in ascending order.
+ */
+CRowHashTable::CRowHashTable ( const CRowHash & build ) : m_Build( build ) {
+	m_Hashes.resize( m_Build.GetSize( ) );
+	for ( size_t i = 0; i < m_Hashes.size( ); ++ i )
+		m_Hashes[ i ] = m_Build.Hash( i );
+	Link( );
+}
+
+/**
+ * Chains the rows by their hashes, the table has at least twice as many buckets as rows.
+ */
+void CRowHashTable::Link ( ) {
+	size_t rows = m_Hashes.size( );
+	size_t buckets = 16;
+	while ( buckets < rows * 2 )
+		buckets <<= 1;
+	m_Mask = buckets - 1;
+	m_Heads.assign( buckets, 0 );
+	m_Next.assign( rows, 0 );
+	m_Tails.clear( );
+	for ( size_t i = rows; i -- > 0; ) {
+		uint32_t & head = m_Heads[ m_Hashes[ i ] & m_Mask ];
+		m_Next[ i ] = head;
+		head = static_cast<uint32_t>( i + 1 );
+	}
+}
+
+/**
+ * Inserts the rows appended to the build side (e.g. by INSERT, see CIndex::Append), the build side has to keep its previous rows.
+ * The new rows are added at the ends of their chains, so the chains stay ascending - the ends are found once and then kept.
+ * The rows are chained again once there are more than half as many of them as buckets (only the new rows are hashed).
+ * @param[in] build the build side with the appended rows
+ */
+void CRowHashTable::Append ( const CRowHash & build ) {
+	size_t before = m_Hashes.size( ), rows = build.GetSize( );
+	m_Build = build;
+	m_Hashes.resize( rows );
+	for ( size_t i = before; i < rows; ++ i )
+		m_Hashes[ i ] = m_Build.Hash( i );
+	if ( rows * 2 > m_Heads.size( ) ) {
+		Link( );
+		return;
+	}
+
+	if ( m_Tails.empty( ) ) {
+		m_Tails.assign( m_Heads.size( ), 0 );
+		for ( size_t i = 0; i < before; ++ i )
+			m_Tails[ m_Hashes[ i ] & m_Mask ] = static_cast<uint32_t>( i + 1 );
+	}
+	m_Next.resize( rows, 0 );
+	for ( size_t i = before; i < rows; ++ i ) {
+		uint64_t bucket = m_Hashes[ i ] & m_Mask;
+		if ( m_Tails[ bucket ] )
+			m_Next[ m_Tails[ bucket ] - 1 ] = static_cast<uint32_t>( i + 1 );
+		else
+			m_Heads[ bucket ] = static_cast<uint32_t>( i + 1 );
+		m_Tails[ bucket ] = static_cast<uint32_t>( i + 1 );
+	}
+}
+
+/**
+ * Searches for the build rows matching a probe row.
+ * @param[in] probe probe side hasher (must be compatible with the build side)
+ * @param[in] row probe row index
+ * @param[in, out] out matching build rows in ascending order
+ */
+void CRowHashTable::Probe ( const CRowHash & probe, const size_t & row, vector<size_t> & out ) const {
+	out.clear( );
+	if ( ! m_Build.IsFuzzy( ) ) {
+		uint64_t h = probe.Hash( row );
+		for ( uint32_t i = m_Heads[ h & m_Mask ]; i; i = m_Next[ i - 1 ] )
+			if ( m_Hashes[ i - 1 ] == h && probe.Equal( row, m_Build, i - 1 ) )
+				out.push_back( i - 1 );
+		return;
+	}
+
+	// the neighbouring patterns may fall into the same bucket, each bucket is visited once
+	uint64_t visited[ 3 ];
+	size_t visitedCnt = 0;
+	for ( int shift = -1; shift <= 1; ++ shift ) {
+		uint64_t bucket = probe.Hash( row, shift ) & m_Mask;
+		if ( find( visited, visited + visitedCnt, bucket ) != visited + visitedCnt )
+			continue;
+		visited[ visitedCnt ++ ] = bucket;
+		for ( uint32_t i = m_Heads[ bucket ]; i; i = m_Next[ i - 1 ] )
+			if ( probe.Equal( row, m_Build, i - 1 ) )
+				out.push_back( i - 1 );
+	}
+	if ( visitedCnt > 1 )
+		sort( out.begin( ), out.end( ) );
+}
+
+/**
+ * Searches for the first (lowest) build row matching a probe row.
+ * @param[in] probe probe side hasher (must be compatible with the build side)
+ * @param[in] row probe row index
+ * @param[out] out matching build row
+ * @return false if no build row matches
+ */
+bool CRowHashTable::ProbeFirst ( const CRowHash & probe, const size_t & row, size_t & out ) const {
+	if ( ! m_Build.IsFuzzy( ) ) {
+		uint64_t h = probe.Hash( row );
+		for ( uint32_t i = m_Heads[ h & m_Mask ]; i; i = m_Next[ i - 1 ] )
+			if ( m_Hashes[ i - 1 ] == h && probe.Equal( row, m_Build, i - 1 ) ) {
+				out = i - 1;
+				return true;
+			}
+		return false;
+	}
+
+	// the first match of each neighbouring bucket is a candidate
+	bool found = false;
+	for ( int shift = -1; shift <= 1; ++ shift ) {
+		for ( uint32_t i = m_Heads[ probe.Hash( row, shift ) & m_Mask ]; i; i = m_Next[ i - 1 ] )
+			if ( probe.Equal( row, m_Build, i - 1 ) ) {
+				if ( ! found || i - 1 < out )
+					out = i - 1;
+				found = true;
+				break;
+			}
+	}
+	return found;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "CColumn.hpp"
+
+using namespace std;
+
+/**
+ * This module hashes table rows over a set of key columns, so the rows can be matched
+ * without comparing every pair of them.
+ *
+ * Doubles are compared with an epsilon (see CDouble::cmpEq), so two equal doubles don't have to share a hash.
+ * Such key columns are left out of the hash and only verified. If all the key columns are doubles,
+ * the first one is hashed by its ordered bit pattern instead - equal doubles differ in it by one at most,
+ * so the neighbouring patterns are probed as well.
+ *
+ * Dictionary encoded strings are hashed by the hashes kept in their dictionary and compared by their codes.
+ * The codes of a probe side are mapped onto the build side dictionary first, unless both sides share it (see MapCodes).
+ */
+class CRowHash {
+private:
+	vector<const CColumn *> m_Keys;
+	vector<size_t> m_Hashed;
+	vector<vector<uint32_t>> m_CodeMaps;
+	bool m_Fuzzy = false;
+
+public:
+	explicit CRowHash ( const vector<const CColumn *> & keys );
+
+	static uint64_t Mix ( uint64_t x );
+	static uint64_t HashBytes ( const char * str, const size_t & len );
+	static uint64_t OrderedBits ( const double & val );
+
+	size_t GetSize ( ) const;
+	bool IsFuzzy ( ) const;
+	bool IsCompatible ( const CRowHash & other ) const;
+	void MapCodes ( const CRowHash & build );
+
+	uint64_t Hash ( const size_t & row, const int & shift = 0 ) const;
+	bool Equal ( const size_t & row, const CRowHash & other, const size_t & otherRow ) const;
+};
+
+/**
+ * Chained hash table over all rows of the build side. Chains keep the rows in ascending order.
+ */
+class CRowHashTable {
+private:
+	CRowHash m_Build;
+	vector<uint32_t> m_Heads;
+	vector<uint32_t> m_Next;
+	vector<uint64_t> m_Hashes;
+	vector<uint32_t> m_Tails;
+	uint64_t m_Mask = 0;
+
+	void Link ( );
+
+public:
+	explicit CRowHashTable ( const CRowHash & build );
+	void Append ( const CRowHash & build );
+	void Probe ( const CRowHash & probe, const size_t & row, vector<size_t> & out ) const;
+	bool ProbeFirst ( const CRowHash & probe, const size_t & row, size_t & out ) const;
+};
@@ -0,0 +1,173 @@
+#include "CSetEngine.hpp"
+
+/**
+ * Counts the occurrences of each row of the build side. Equal rows are counted at the first one of them.
+ * @param[in] build build side hasher
+ * @param[in] table hash table of the build side
+ * @param[out] counts number of occurrences of each row (zero for the repeated ones)
+ */
+void CSetEngine::CountRows ( const CRowHash & build, const CRowHashTable & table, vector<size_t> & counts ) {
+	size_t first = 0;
+	counts.assign( build.GetSize( ), 0 );
+	for ( size_t i = 0; i < build.GetSize( ); ++ i )
+		if ( table.ProbeFirst( build, i, first ) )
+			++ counts[ first ];
+}
+
+/**
+ * Pairs a probe row with one of the equal build rows, which were not paired yet.
+ * @return true if such build row was found
+ */
+bool CSetEngine::Consume ( const CRowHash & probe, const size_t & row, const CRowHashTable & table, vector<size_t> & counts ) {
+	size_t first;
+	if ( ! table.ProbeFirst( probe, row, first ) || counts[ first ] == 0 )
+		return false;
+	-- counts[ first ];
+	return true;
+}
+
+/**
+ * Union of two tables. All the left rows belong to the result.
+ * @param[in] left columns of the left table
+ * @param[in] right aligned columns of the right table
+ * @return right rows to be appended to the left ones
+ */
+vector<size_t> CSetEngine::Union ( const vector<const CColumn *> & left, const vector<const CColumn *> & right ) {
+	vector<size_t> out, counts;
+	CRowHash hashLeft ( left ), hashRight ( right );
+	if ( left.empty( ) || ! hashLeft.IsCompatible( hashRight ) ) {
+		for ( size_t i = 0; i < hashRight.GetSize( ); ++ i )
+			out.push_back( i );
+		return out;
+	}
+	CRowHashTable table ( hashLeft );
+	CountRows( hashLeft, table, counts );
+	hashRight.MapCodes( hashLeft );
+	for ( size_t i = 0; i < hashRight.GetSize( ); ++ i )
+		if ( ! Consume( hashRight, i, table, counts ) )
+			out.push_back( i );
+	return out;
+}
+
+/**
+ * Intersection of two tables.
+ * @param[in] left columns of the left table
+ * @param[in] right aligned columns of the right table
+ * @return left rows present in the right table
+ */
+vector<size_t> CSetEngine::Intersect ( const vector<const CColumn *> & left, const vector<const CColumn *> & right ) {
+	vector<size_t> out, counts;
+	CRowHash hashLeft ( left ), hashRight ( right );
+	if ( left.empty( ) || ! hashLeft.IsCompatible( hashRight ) )
+		return out;
+	CRowHashTable table ( hashRight );
+	CountRows( hashRight, table, counts );
+	hashLeft.MapCodes( hashRight );
+	for ( size_t i = 0; i < hashLeft.GetSize( ); ++ i )
+		if ( Consume( hashLeft, i, table, counts ) )
+			out.push_back( i );
+	return out;
+}
+
+/**
+ * Difference of two tables.
+ * @param[in] left columns of the left table
+ * @param[in] right aligned columns of the right table
+ * @return left rows missing in the right table
+ */
+vector<size_t> CSetEngine::Minus ( const vector<const CColumn *> & left, const vector<const CColumn *> & right ) {
+	vector<size_t> out, counts;
+	CRowHash hashLeft ( left ), hashRight ( right );
+	if ( left.empty( ) || ! hashLeft.IsCompatible( hashRight ) ) {
+		for ( size_t i = 0; i < hashLeft.GetSize( ); ++ i )
+			out.push_back( i );
+		return out;
+	}
+	CRowHashTable table ( hashRight );
+	CountRows( hashRight, table, counts );
+	hashLeft.MapCodes( hashRight );
+	for ( size_t i = 0; i < hashLeft.GetSize( ); ++ i )
+		if ( ! Consume( hashLeft, i, table, counts ) )
+			out.push_back( i );
+	return out;
+}
+
+/**
+ * Compares two rows, the first different column decides.
+ * @return true if the row a precedes the row b
+ */
+bool CSetEngine::CRowOrder::operator ( ) ( const TRowRef & a, const TRowRef & b ) const {
+	const vector<const CColumn *> & colsA = a.first ? m_Right : m_Left;
+	const vector<const CColumn *> & colsB = b.first ? m_Right : m_Left;
+	for ( size_t i = 0; i < colsA.size( ); ++ i ) {
+		if ( colsA[ i ]->Equal( a.second, * colsB[ i ], b.second ) )
+			continue;
+		return colsA[ i ]->Less( a.second, * colsB[ i ], b.second );
+	}
+	return false;
+}
+
+/**
+ * Sorts the row indexes of one table.
+ * @param[in] columns key columns of the table
+ * @param[in] right true for the right table
+ * @param[in] order row order
+ * @return references of all the table rows, sorted
+ */
+vector<CSetEngine::TRowRef> CSetEngine::SortedRows ( const vector<const CColumn *> & columns, const bool & right, const CRowOrder & order ) {
+	vector<TRowRef> rows;
+	size_t size = columns.empty( ) ? 0 : columns.front( )->GetSize( );
+	rows.reserve( size );
+	for ( size_t i = 0; i < size; ++ i )
+		rows.emplace_back( right, i );
+	sort( rows.begin( ), rows.end( ), order );
+	return rows;
+}
+
+/**
+ * Union of two tables, ordered. Of the equal rows, the left ones are preferred.
+ * @param[in] left key columns of the left table
+ * @param[in] right aligned key columns of the right table
+ * @return rows of the result
+ */
+vector<CSetEngine::TRowRef> CSetEngine::SortedUnion ( const vector<const CColumn *> & left, const vector<const CColumn *> & right ) {
+	CRowOrder order ( left, right );
+	vector<TRowRef> rowsA = SortedRows( left, false, order ), rowsB = SortedRows( right, true, order ), out;
+	out.reserve( max( rowsA.size( ), rowsB.size( ) ) );
+	set_union( rowsA.begin( ), rowsA.end( ), rowsB.begin( ), rowsB.end( ), back_inserter( out ), order );
+	return out;
+}
+
+/**
+ * Intersection of two tables, ordered.
+ * @param[in] left key columns of the left table
+ * @param[in] right aligned key columns of the right table
+ * @return left rows present in the right table
+ */
+vector<size_t> CSetEngine::SortedIntersect ( const vector<const CColumn *> & left, const vector<const CColumn *> & right ) {
+	CRowOrder order ( left, right );
+	vector<TRowRef> rowsA = SortedRows( left, false, order ), rowsB = SortedRows( right, true, order ), res;
+	set_intersection( rowsA.begin( ), rowsA.end( ), rowsB.begin( ), rowsB.end( ), back_inserter( res ), order );
+	vector<size_t> out;
+	out.reserve( res.size( ) );
+	for ( const TRowRef & i : res )
+		out.push_back( i.second );
+	return out;
+}
+
+/**
+ * Difference of two tables, ordered.
+ * @param[in] left key columns of the left table
+ * @param[in] right aligned key columns of the right table
+ * @return left rows missing in the right table
+ */
+vector<size_t> CSetEngine::SortedMinus ( const vector<const CColumn *> & left, const vector<const CColumn *> & right ) {
+	CRowOrder order ( left, right );
+	vector<TRowRef> rowsA = SortedRows( left, false, order ), rowsB = SortedRows( right, true, order ), res;
+	set_difference( rowsA.begin( ), rowsA.end( ), rowsB.begin( ), rowsB.end( ), back_inserter( res ), order );
+	vector<size_t> out;
+	out.reserve( res.size( ) );
+	for ( const TRowRef & i : res )
+		out.push_back( i.second );
+	return out;
+}
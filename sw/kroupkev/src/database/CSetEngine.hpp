@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <iterator>
+
+#include "CColumn.hpp"
+#include "CRowHash.hpp"
+
+using namespace std;
+
+/**
+ * This module evaluates the set operations over the rows of two tables with a hash table (see CRowHash) in O(n + m),
+ * or by sorting the rows of both tables and merging them (std::set_union etc.), if the result has to be ordered.
+ *
+ * The tables are treated as multisets, same as the sort based evaluation (std::set_union etc.) treats them -
+ * a row present m times in the left table and n times in the right one is kept max( m, n ) times by the union,
+ * min( m, n ) times by the intersection and max( m - n, 0 ) times by the difference.
+ * The hash based result keeps the order of the left rows, the right rows added by the union follow in their own order.
+ * The sort based result is ordered by the key columns, their order is given by the caller.
+ * Neither of them modifies the columns, rows are only referenced by their indexes.
+ *
+ * Row indexes are zero-based (data rows only). The columns of the right table have to be aligned
+ * with the left ones (same order and types).
+ */
+class CSetEngine {
+public:
+	/** Row of the left ( false ) or the right ( true ) table. */
+	typedef pair<bool, size_t> TRowRef;
+
+private:
+	/** Lexicographic order of rows of both tables, compares the key columns with CColumn::Equal / CColumn::Less. */
+	class CRowOrder {
+	private:
+		const vector<const CColumn *> & m_Left;
+		const vector<const CColumn *> & m_Right;
+
+	public:
+		CRowOrder ( const vector<const CColumn *> & left, const vector<const CColumn *> & right ) : m_Left( left ), m_Right( right ) { }
+		bool operator ( ) ( const TRowRef & a, const TRowRef & b ) const;
+	};
+
+	static vector<TRowRef> SortedRows ( const vector<const CColumn *> & columns, const bool & right, const CRowOrder & order );
+	static void CountRows ( const CRowHash & build, const CRowHashTable & table, vector<size_t> & counts );
+	static bool Consume ( const CRowHash & probe, const size_t & row, const CRowHashTable & table, vector<size_t> & counts );
+
+public:
+	static vector<size_t> Union ( const vector<const CColumn *> & left, const vector<const CColumn *> & right );
+	static vector<size_t> Intersect ( const vector<const CColumn *> & left, const vector<const CColumn *> & right );
+	static vector<size_t> Minus ( const vector<const CColumn *> & left, const vector<const CColumn *> & right );
+
+	static vector<TRowRef> SortedUnion ( const vector<const CColumn *> & left, const vector<const CColumn *> & right );
+	static vector<size_t> SortedIntersect ( const vector<const CColumn *> & left, const vector<const CColumn *> & right );
+	static vector<size_t> SortedMinus ( const vector<const CColumn *> & left, const vector<const CColumn *> & right );
+};
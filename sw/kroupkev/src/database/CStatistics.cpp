@@ -0,0 +1,226 @@
+#include "CStatistics.hpp"
+#include "CTable.hpp"
+#include "CRowHash.hpp"
+
+#include <cmath>
+
+const int CHyperLogLog::PRECISION = 10;
+const size_t CColumnStats::BUCKETS = 32;
+const double CStatistics::STALE_GROWTH = 0.1;
+
+CHyperLogLog::CHyperLogLog ( ) : m_Registers( size_t( 1 ) << PRECISION, 0 ) { }
+
+/**
+ * Adds a hashed value. The register is chosen by the top bits of the hash,
+ * it keeps the longest run of leading zeros seen in the rest of them.
+ */
+void CHyperLogLog::Add ( const uint64_t & hash ) {
+	size_t index = hash >> ( 64 - PRECISION );
+	uint64_t rest = hash << PRECISION;
+	uint8_t rank = rest ? __builtin_clzll( rest ) + 1 : 64 - PRECISION + 1;
+	if ( m_Registers[ index ] < rank )
+		m_Registers[ index ] = rank;
+}
+
+/**
+ * Harmonic mean of the registers, small cardinalities are counted by the empty registers instead (linear counting).
+ */
+double CHyperLogLog::Estimate ( ) const {
+	double m = m_Registers.size( ), sum = 0;
+	size_t empty = 0;
+	for ( const uint8_t & i : m_Registers ) {
+		sum += ldexp( 1.0, - i );
+		empty += ! i;
+	}
+	double estimate = 0.7213 / ( 1 + 1.079 / m ) * m * m / sum;
+	if ( estimate <= 2.5 * m && empty )
+		return m * log( m / empty );
+	return estimate;
+}
+
+/**
+ * Scans the column once - hashes its values into the sketch and builds the histogram of the numeric ones.
+ * @param[in] column column data
+ */
+CColumnStats::CColumnStats ( const CColumn & column ) : m_Count( column.GetSize( ) ) {
+	CHyperLogLog sketch;
+	if ( column.GetType( ) == CColumn::TYPE_STRING ) {
+		const CStringColumn & strings = static_cast<const CStringColumn &>( column );
+		for ( size_t i = 0; i < m_Count; ++ i )
+			sketch.Add( CRowHash::Mix( strings.Hash( i ) ) );
+	} else if ( column.GetType( ) == CColumn::TYPE_INT )
+		CollectNumbers( static_cast<const CIntColumn &>( column ).GetData( ), sketch );
+	else
+		CollectNumbers( static_cast<const CDoubleColumn &>( column ).GetData( ), sketch );
+	m_Distinct = m_Count ? max( 1.0, min( sketch.Estimate( ), double( m_Count ) ) ) : 0;
+}
+
+/**
+ * Hashes the numbers into the sketch, finds their range and builds the histogram of it.
+ * Only the finite values make up the range, an infinity (or NaN) is counted in the first or the last bucket.
+ * If the range itself isn't finite, all the values fall into a single bucket.
+ * @param[in] data values of the column (m_Count of them)
+ * @param[in, out] sketch distinct values sketch
+ */
+template <typename T>
+void CColumnStats::CollectNumbers ( const T * data, CHyperLogLog & sketch ) {
+	m_Numeric = true;
+	if ( ! m_Count )
+		return;
+	bool found = false;
+	T low = 0, high = 0;
+	for ( size_t i = 0; i < m_Count; ++ i ) {
+		sketch.Add( CRowHash::Mix( CRowHash::OrderedBits( data[ i ] ) ) );
+		if ( ! isfinite( double( data[ i ] ) ) )
+			continue;
+		if ( ! found || data[ i ] < low )
+			low = data[ i ];
+		if ( ! found || data[ i ] > high )
+			high = data[ i ];
+		found = true;
+	}
+	m_Min = low;
+	m_Max = high;
+	m_Histogram.assign( BUCKETS, 0 );
+	double width = ( m_Max - m_Min ) / BUCKETS;
+	if ( width <= 0 || ! isfinite( width ) ) {
+		m_Histogram[ 0 ] = m_Count;
+		return;
+	}
+	for ( size_t i = 0; i < m_Count; ++ i ) {
+		if ( isfinite( double( data[ i ] ) ) )
+			++ m_Histogram[ min( BUCKETS - 1, size_t( ( data[ i ] - m_Min ) / width ) ) ];
+		else
+			++ m_Histogram[ data[ i ] < m_Min ? 0 : BUCKETS - 1 ];
+	}
+}
+
+/**
+ * Estimated fraction of the values lower than the given one (values within a bucket are assumed to be uniform).
+ */
+double CColumnStats::FractionBelow ( const double & value ) const {
+	if ( value <= m_Min )
+		return 0;
+	if ( value > m_Max )
+		return 1;
+	double width = ( m_Max - m_Min ) / BUCKETS, below = 0;
+	if ( width <= 0 || ! isfinite( width ) )
+		return 0;
+	size_t bucket = min( BUCKETS - 1, size_t( ( value - m_Min ) / width ) );
+	for ( size_t i = 0; i < bucket; ++ i )
+		below += m_Histogram[ i ];
+	below += m_Histogram[ bucket ] * ( ( value - m_Min ) / width - bucket );
+	return below / m_Count;
+}
+
+/**
+ * Estimated fraction of the values equal to the given one.
+ */
+double CColumnStats::FractionEqual ( const double & value ) const {
+	return ( value < m_Min || value > m_Max ) ? 0 : 1 / m_Distinct;
+}
+
+/**
+ * @return true if the whole constant is a number
+ */
+bool CColumnStats::ParseNumber ( const string & constant, double & value ) {
+	try {
+		size_t length;
+		value = stod( constant, & length );
+		return length == constant.length( ) && ! isnan( value );
+	} catch ( ... ) {
+		return false;
+	}
+}
+
+/**
+ * Estimates the fraction of the rows matching a leaf condition over the column (see CCondition).
+ * Equality is estimated by the number of distinct values, ranges of numbers by the histogram.
+ * A set of constants (IN) is estimated as the equalities with each of them.
+ * @param[in] condition condition with a constant (a comparison with another column is estimated without the statistics)
+ * @return selectivity (0 - 1)
+ */
+double CColumnStats::Selectivity ( const CCondition & condition ) const {
+	if ( ! m_Count )
+		return 0;
+	if ( ! m_Numeric || condition.IsColumnOperand )
+		return DefaultSelectivity( condition, m_Distinct );
+
+	double value, high;
+	if ( condition.m_Kind == CCondition::IN ) {
+		double equal = 0;
+		for ( const string & i : condition.m_Constants ) {
+			if ( ! ParseNumber( i, value ) )
+				return DefaultSelectivity( condition, m_Distinct );
+			equal += FractionEqual( value );
+		}
+		equal = min( 1.0, equal );
+		return condition.m_Operator == "!=" ? 1 - equal : equal;
+	}
+	if ( condition.m_Kind == CCondition::BETWEEN ) {
+		if ( ! ParseNumber( condition.m_Constants.front( ), value ) || ! ParseNumber( condition.m_Constants.back( ), high ) )
+			return DefaultSelectivity( condition, m_Distinct );
+		return max( 0.0, min( 1.0, FractionBelow( high ) + FractionEqual( high ) - FractionBelow( value ) ) );
+	}
+	if ( ! ParseNumber( condition.m_Constant, value ) )
+		return DefaultSelectivity( condition, m_Distinct );
+
+	double equal = FractionEqual( value );
+	const string & op = condition.m_Operator;
+	if ( op == "==" )
+		return equal;
+	if ( op == "!=" )
+		return 1 - equal;
+	if ( op == "<" )
+		return FractionBelow( value );
+	if ( op == "<=" )
+		return min( 1.0, FractionBelow( value ) + equal );
+	if ( op == ">" )
+		return max( 0.0, 1 - FractionBelow( value ) - equal );
+	if ( op == ">=" )
+		return 1 - FractionBelow( value );
+	return DefaultSelectivity( condition, m_Distinct );
+}
+
+/**
+ * Selectivity of a leaf condition over a column without the statistics (or a non-numeric range).
+ * A range is estimated as a third of the rows, the range with both bounds (BETWEEN) as a ninth of them.
+ * @param[in] condition leaf condition
+ * @param[in] distinct number of distinct values in the column (estimate)
+ */
+double CColumnStats::DefaultSelectivity ( const CCondition & condition, const double & distinct ) {
+	double equal = distinct >= 1 ? 1 / distinct : 1;
+	if ( condition.m_Kind == CCondition::IN ) {
+		equal = min( 1.0, equal * condition.m_Constants.size( ) );
+		return condition.m_Operator == "!=" ? 1 - equal : equal;
+	}
+	if ( condition.m_Kind == CCondition::BETWEEN )
+		return 1.0 / 9;
+	if ( condition.m_Operator == "==" )
+		return equal;
+	if ( condition.m_Operator == "!=" )
+		return 1 - equal;
+	return 1.0 / 3;
+}
+
+/**
+ * Collects the statistics of all the table columns.
+ * @param[in] table the table
+ */
+CStatistics::CStatistics ( const CTable & table ) : m_Rows( table.GetDataRowCount( ) ) {
+	for ( size_t i = 0; i < table.GetColumnCount( ); ++ i ) {
+		const CColumn * column = table.GetColumn( i );
+		if ( ! column ) {
+			m_Columns.clear( );
+			return;
+		}
+		m_Columns.emplace_back( * column );
+	}
+}
+
+/**
+ * Statistics of a column, nullptr if the table has no data.
+ */
+const CColumnStats * CStatistics::GetColumn ( const size_t & index ) const {
+	return index < m_Columns.size( ) ? & m_Columns[ index ] : nullptr;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "CColumn.hpp"
+#include "CCondition.hpp"
+
+using namespace std;
+
+class CTable;
+
+/**
+ * HyperLogLog sketch - estimates the number of distinct values from their hashes in a fixed amount of memory
+ * (2^PRECISION one byte registers, the standard error is about 3 %).
+ */
+class CHyperLogLog {
+private:
+	static const int PRECISION;
+	vector<uint8_t> m_Registers;
+
+public:
+	CHyperLogLog ( );
+	void Add ( const uint64_t & hash );
+	double Estimate ( ) const;
+};
+
+/**
+ * Statistics of a single column - the number of distinct values and, for the numeric columns,
+ * the value range with an equi-width histogram of it. They are used to estimate the selectivity of a condition.
+ */
+class CColumnStats {
+private:
+	static const size_t BUCKETS;
+
+	double m_Distinct = 0;
+	bool m_Numeric = false;
+	double m_Min = 0;
+	double m_Max = 0;
+	vector<size_t> m_Histogram;
+	size_t m_Count = 0;
+
+	CColumnStats ( ) = default;
+	template <typename T>
+	void CollectNumbers ( const T * data, CHyperLogLog & sketch );
+	double FractionBelow ( const double & value ) const;
+	double FractionEqual ( const double & value ) const;
+	static bool ParseNumber ( const string & constant, double & value );
+	friend class CSnapshot;
+
+public:
+	explicit CColumnStats ( const CColumn & column );
+
+	double GetDistinct ( ) const { return m_Distinct; }
+	bool IsNumeric ( ) const { return m_Numeric; }
+	double GetMin ( ) const { return m_Min; }
+	double GetMax ( ) const { return m_Max; }
+
+	double Selectivity ( const CCondition & condition ) const;
+	static double DefaultSelectivity ( const CCondition & condition, const double & distinct );
+};
+
+/**
+ * Statistics of a table, collected once the table is inserted into the database (see CDatabase::InsertTable).
+ * The query optimizer estimates the sizes of the intermediate results by them (see COperator::EstimateRows).
+ * Appended rows (see CDatabase::AppendRows) are only collected once the table grew by STALE_GROWTH of its rows.
+ * The statistics of the tables are saved into the snapshot as well (see CSnapshot).
+ */
+class CStatistics {
+public:
+	static const double STALE_GROWTH;
+
+private:
+	size_t m_Rows = 0;
+	vector<CColumnStats> m_Columns;
+
+	CStatistics ( ) = default;
+	friend class CSnapshot;
+
+public:
+	explicit CStatistics ( const CTable & table );
+
+	size_t GetRows ( ) const { return m_Rows; }
+	bool IsStale ( const size_t & rows ) const { return rows > m_Rows * ( 1 + STALE_GROWTH ); }
+	const CColumnStats * GetColumn ( const size_t & index ) const;
+};
@@ -1,28 +1,25 @@
 #include "CTable.hpp"
 
-CTable::CTable ( const vector<CCell *> & header ) {
-	m_Data.reserve( header.size( ) );
-	for ( const auto & i : header )
-		m_Data.push_back( vector<CCell *> { i } );
-}
-
-CTable::CTable ( const vector<string> & header ) {
-	m_Data.reserve( header.size( ) );
+CTable::CTable ( const vector<string> & header ) : m_Columns( header.size( ) ) {
+	m_Header.reserve( header.size( ) );
+	m_HeaderCells.Reserve<CString>( header.size( ) );
 	for ( const string & i : header )
-		m_Data.push_back( vector<CCell *> { new CString( i ) } );
+		m_Header.push_back( m_HeaderCells.Create<CString>( i ) );
 }
 
-CTable::CTable ( const vector<pair<string, int>> & header ) {
-	m_Data.reserve( header.size( ) );
-	for ( const auto & i : header )
-		m_Data.push_back( vector<CCell *> { new CString( i.first ) } );
+/**
+ * Creates a table from already filled columns. The table takes ownership of the columns.
+ * @param[in] header column names
+ * @param[in] columns column data, must be of the same size as the header
+ */
+CTable::CTable ( const vector<string> & header, const vector<CColumn *> & columns ) : m_Columns( columns.begin( ), columns.end( ) ) {
+	m_Header.reserve( header.size( ) );
+	m_HeaderCells.Reserve<CString>( header.size( ) );
+	for ( const string & i : header )
+		m_Header.push_back( m_HeaderCells.Create<CString>( i ) );
 }
 
-CTable::~CTable ( ) {
-	for ( auto & i : m_Data )
-		for ( auto & j : i )
-			delete j;
-}
+CTable::~CTable ( ) = default;
 
 /**
  * Verifies if given column is present in the table.
@@ -42,41 +39,13 @@ bool CTable::VerifyColumn ( const string & col, size_t & index, const bool & msg
 	return true;
 }
 
-/**
- * This method will sort columns based on their header.
- */
-void CTable::SortColumns ( ) {
-	std::sort( m_Data.begin(), m_Data.end(), [ ] ( const vector<CCell *> & a, const std::vector<CCell *> & b) { return ( * a.at( 0 ) ) < ( * b.at( 0 ) ); } );
-}
-
-/**
- * This method will sort its columns based on the pairs provided.
- * First of the two represents which index, second the position in the new order.
- * The columns must have equal number of rows, if not, exception is thrown.
- */
-void CTable::SortColumns ( vector<pair<size_t, size_t>> & columnOrders ) {
-	vector<vector<CCell *>> newColumnOrder ( m_Data.size( ), vector<CCell *>( m_Data.at( 0 ).size( ) ) );
-	for ( const auto & i : columnOrders )
-		newColumnOrder.at( i.first ) = std::move( m_Data.at( i.second ) );
-	m_Data.clear( );
-	m_Data = std::move( newColumnOrder );
-}
-
-/**
- * Row sorting. Works only on transformed tables (they're normally stored by columns).
- * @param[in, out] dataRef reference to transformed table rows
- */
-void CTable::SortRows ( vector<vector<CCell *>> & dataRef ) {
-	sort( dataRef.begin(), dataRef.end(), RowComparator( ) );
-}
-
 /**
  * Verifies if table has any duplicate columns.
  */
 bool CTable::HasDuplicateColumns ( ) const {
 	std::map<std::string, int> countMap;
-	for ( const auto & elem : m_Data ) {
-		auto result = countMap.insert( pair<string, int>( elem.at( 0 )->RetrieveMVal( ), 1 ) );
+	for ( const auto & elem : m_Header ) {
+		auto result = countMap.insert( pair<string, int>( elem->RetrieveMVal( ), 1 ) );
 		if ( ! result.second )
 			return true;
 	}
@@ -84,167 +53,174 @@ bool CTable::HasDuplicateColumns ( ) const {
 }
 
 /**
- * Verifies if two tables have identical headers.
- * @param[in]: tableRef table to compare header with
+ * Makes the column data exclusive to this table, so it can be modified (copy on write).
+ * @param[in] index index of the column
  */
-bool CTable::HasIdenticalHeader ( const CTable * tableRef ) const {
-	if ( ! tableRef )
-		return false;
-	auto j = tableRef->m_Data.begin( );
-	for ( const auto & i : m_Data ) {
-		if ( (* i.at( 0 )) != ( * j->at( 0 )) )
-			return false;
-		if ( j != tableRef->m_Data.end( ) )
-			++j;
-		else
-			break;
-	}
-	return true;
+void CTable::DetachColumn ( const size_t & index ) {
+	Materialize( );
+	if ( m_Columns[ index ] && ! m_Columns[ index ].unique( ) )
+		m_Columns[ index ].reset( m_Columns[ index ]->Clone( ) );
 }
 
 /**
- * Table row insertion. References are copied, not reallocated!
+ * Table row insertion. The values are copied into the typed columns, the cells stay owned by the caller.
  * @param[in] row Row to be inserted
  * @return true if row was inserted without errors
  */
-bool CTable::InsertShallowRow ( const vector<CCell *> & row ) {
-	if ( ( m_Data.begin( )->empty( ) ) || m_Data.size( ) != row.size( ) )
+bool CTable::InsertRow ( const vector<CCell *> & row ) {
+	if ( m_Header.empty( ) || m_Header.size( ) != row.size( ) )
 		return false;
-	auto d = m_Data.begin( );
-	auto r = row.begin( );
-	while ( d != m_Data.end( ) ) {
-		d->push_back( * r );
-		++ d;
-		++ r;
+	for ( size_t i = 0; i < row.size( ); ++ i )
+		if ( m_Columns[ i ] && m_Columns[ i ]->GetTypeName( ) != row[ i ]->GetType( ) )
+			return false;
+	for ( size_t i = 0; i < row.size( ); ++ i ) {
+		if ( ! m_Columns[ i ] )
+			m_Columns[ i ].reset( CColumn::Create( * row[ i ] ) );
+		DetachColumn( i );
+		m_Columns[ i ]->AppendCell( * row[ i ] );
 	}
 	return true;
 }
 
 /**
- * Table column insertion ~ deep copy is made (for queries).
- * @param[in] col Column reference to be inserted
- * @return true if col was inserted without errors and column name is not taken.
+ * Appends the rows of the columns (a column per table column) to the table, the shared column data is copied first.
+ * @param[in] rows columns with the appended rows, each of the same type as the table column
+ * @return true if the rows were appended
  */
-bool CTable::InsertDeepCol ( const vector<CCell *> & col ) {
-	size_t elementCount = 0;
-	if ( ! m_Data.empty( ) ) {
-		elementCount = m_Data.at( 0 ).size( );
-		if ( elementCount != col.size( ) || * col.begin( ) == * m_Data.at( 0 ).begin( ) )
+bool CTable::AppendRows ( const vector<unique_ptr<CColumn>> & rows ) {
+	if ( m_Header.empty( ) || m_Header.size( ) != rows.size( ) )
+		return false;
+	Materialize( );
+	for ( size_t i = 0; i < rows.size( ); ++ i )
+		if ( ! rows[ i ] || ( m_Columns[ i ] && m_Columns[ i ]->GetType( ) != rows[ i ]->GetType( ) ) )
 			return false;
+	for ( size_t i = 0; i < rows.size( ); ++ i ) {
+		if ( ! m_Columns[ i ] ) {
+			m_Columns[ i ].reset( rows[ i ]->Clone( ) );
+			continue;
+		}
+		DetachColumn( i );
+		m_Columns[ i ]->AppendColumn( * rows[ i ] );
 	}
-	vector<CCell *> newColumn;
-	newColumn.reserve( elementCount );
-	for ( const auto & i : col )
-		newColumn.push_back( i->Clone( ) );
-	m_Data.push_back( std::move( newColumn ) );
 	return true;
 }
 
 /**
- * Table row insertion ~ deep copy is made (for queries).
- * @param[in] index index of a row to be duplicated
- * @param[in, out] outPtr table pointer to save to
- * @return true if the deep copy of a row was created and inserted correctly
+ * Inserts a new column. The column data may be shared.
+ * @param[in] header header cell of the column (allocated in the arena of the table)
+ * @param[in] col column data (or nullptr, if the column has no rows)
+ * @return true if the column has the same number of rows as the table
  */
-bool CTable::InsertDeepRow ( const size_t & index, CTable * outPtr ) const {
-	vector<CCell *> newRow;
-	GetDeepRow( index, newRow );
-	if ( ! outPtr || ! outPtr->InsertShallowRow( newRow ) )
+bool CTable::InsertColumn ( CCell * header, const shared_ptr<CColumn> & col ) {
+	if ( ! m_Header.empty( ) && GetDataRowCount( ) != ( col ? col->GetSize( ) : 0 ) )
 		return false;
-	newRow.clear( );
+	m_Header.push_back( header );
+	m_Columns.push_back( col );
+	if ( ! m_Pending.empty( ) )
+		m_Pending.emplace_back( );
 	return true;
 }
 
 /**
- * Changes column header element's name.
- * @param[in] index index of a column to be edited
- * @param[in] str new name.
+ * Column data getter. A column pending a selection is copied on the first access.
+ * @param[in] index index of the column
  */
-bool CTable::ChangeColumnName ( const size_t & index, const string & s ) const {
-	return ( index < m_Data.size( ) && ! s.empty( ) && m_Data.at( index ).at( 0 )->Rename( s ) );
+const shared_ptr<CColumn> & CTable::Data ( const size_t & index ) const {
+	if ( ! m_Pending.empty( ) && m_Pending[ index ] ) {
+		m_Columns[ index ].reset( m_Pending[ index ]->Gather( * m_Selection ) );
+		m_Pending[ index ].reset( );
+	}
+	return m_Columns[ index ];
 }
 
 /**
- * Merges two rows together. Shallow copy is made.
+ * Column data getter, which doesn't copy the pending selection.
+ * @param[in] index index of the column
+ * @param[out] rows selected rows of the returned column, nullptr if all the rows belong to the table
+ * @return column data
  */
-vector<CCell *> CTable::MergeRows ( const vector<CCell *> & rowA, const vector<CCell *> & rowB ) {
-	vector<CCell *> output;
-	output.reserve( rowA.size( ) + rowB.size( ) );
-	for ( const auto & i : rowA )
-		output.push_back( i );
-	for ( const auto & i : rowB )
-		output.push_back( i );
-	return output;
-}
-
-bool CTable::GetShallowCol ( const string & name, vector<CCell *> & outRef ) const {
-	for ( const auto & i : m_Data ) {
-		if ( i.at( 0 )->RetrieveMVal( ) == name )
-			outRef = i;
+const CColumn * CTable::DataView ( const size_t & index, const vector<size_t> * & rows ) const {
+	if ( ! m_Pending.empty( ) && m_Pending[ index ] ) {
+		rows = m_Selection.get( );
+		return m_Pending[ index ].get( );
 	}
-	return true;
+	rows = nullptr;
+	return m_Columns[ index ].get( );
 }
 
 /**
- * Creates a deep copy of a table row.
- * @param[in] index index of a row
- * @param[in, out] outRef out row save pointer
- * @return true if the row was exported without errors
+ * Copies all the columns pending a selection.
  */
-bool CTable::GetDeepRow ( const size_t & index, vector<CCell *> & outRef ) const {
-	outRef.clear( );
-	for ( const auto & i : m_Data )
-		outRef.push_back( i.at( index )->Clone( ) );
-	return true;
+void CTable::Materialize ( ) const {
+	for ( size_t i = 0; i < m_Pending.size( ); ++ i )
+		Data( i );
+	m_Pending.clear( );
 }
 
 /**
- * Creates a deep copy of a table row with specified columns.
- * @param[in] index index of a row
- * @param[in] selectedColumns sequence of colums to include
- * @param[in, out] outRef out row save pointer
- * @return true if the row was exported without errors
+ * Dictionary encodes the string columns with few distinct values (see CStringColumn::Encode).
+ * Encoding of a column with many of them stops once the dictionary is full, so all the string columns can be tried.
  */
-bool CTable::GetDeepRow ( const size_t & index, vector<string> & selectedColumns, vector<CCell *> & outRef ) const {
-	if ( selectedColumns.empty( ) )
-		return false;
-
-	vector<size_t> columnSequence;
-	size_t tmp;
-	for ( const string & i : selectedColumns ) {
-		if ( ! VerifyColumn( i, tmp ) )
-			return false;
-		columnSequence.push_back( tmp );
+void CTable::EncodeColumns ( ) {
+	Materialize( );
+	for ( auto & i : m_Columns ) {
+		if ( ! i || i->GetType( ) != CColumn::TYPE_STRING || static_cast<const CStringColumn &>( * i ).IsEncoded( ) )
+			continue;
+		shared_ptr<CColumn> column = i.unique( ) ? i : shared_ptr<CColumn>( i->Clone( ) );
+		if ( static_cast<CStringColumn &>( * column ).Encode( ) )
+			i = column;
 	}
+}
 
-	outRef.clear( );
-	for ( const size_t & i : columnSequence )
-		outRef.push_back( m_Data.at( i ).at( index )->Clone( ) );
-	return true;
+/**
+ * Changes column header element's name.
+ * @param[in] index index of a column to be edited
+ * @param[in] str new name.
+ */
+bool CTable::ChangeColumnName ( const size_t & index, const string & s ) const {
+	return ( index < m_Header.size( ) && ! s.empty( ) && m_Header.at( index )->Rename( s ) );
 }
 
 /**
- * Creates a deep copy of a provided row.
- * @param[in, out] outRef row to copy from
- * @return duplicated row with new cells.
+ * Copies the given rows of the selected columns into another table (for joins).
+ * @param[in] cols columns to copy
+ * @param[in] rows row indexes in the order of the new table (rows may repeat)
+ * @param[in] outPtr pointer to a table to append the columns to
+ * @return true if all columns exist and were inserted
  */
-vector<CCell *> CTable::GetDeepRow ( const vector<CCell *> & outRef ) {
-	vector<CCell *> out;
-	for ( const auto & i : outRef )
-		out.push_back( i->Clone( ) );
-	return out;
+bool CTable::GetGatheredCols ( const vector<string> & cols, const vector<size_t> & rows, CTable * outPtr ) const {
+	vector<size_t> dataRows ( rows.size( ) );
+	for ( size_t i = 0; i < rows.size( ); ++ i ) {
+		if ( rows[ i ] == 0 || rows[ i ] > GetDataRowCount( ) )
+			return false;
+		dataRows[ i ] = rows[ i ] - 1;
+	}
+
+	size_t index;
+	outPtr->m_HeaderCells.Reserve<CString>( cols.size( ) );
+	for ( const string & i : cols ) {
+		if ( ! VerifyColumn( i, index ) || ( ! Data( index ) && ! dataRows.empty( ) ) )
+			return false;
+		shared_ptr<CColumn> data;
+		if ( Data( index ) )
+			data.reset( Data( index )->Gather( dataRows ) );
+		if ( ! outPtr->InsertColumn( m_Header[ index ]->Clone( outPtr->m_HeaderCells ), data ) )
+			return false;
+	}
+	return true;
 }
 
 /**
- * Returns a table clone with origin data, but only with some columns.
+ * Returns a table with origin data, but only with some columns. The column data is shared.
  * @param[in] cols columns to create new table with
  * @param[in] outPtr pointer to a new table to save
  * @return true if columns provided were correct, and subtable was generated
  */
 bool CTable::GetSubTable ( const vector<string> & cols, CTable * outPtr ) const {
 	if ( cols.size( ) == 1 && ( * cols.begin( ) == "*" ) ) {
-		for ( const auto & i : m_Data )
-			if ( ! outPtr->InsertDeepCol( i ) )
+		outPtr->m_HeaderCells.Reserve<CString>( m_Header.size( ) );
+		for ( size_t i = 0; i < m_Header.size( ); ++ i )
+			if ( ! outPtr->InsertColumn( m_Header[ i ]->Clone( outPtr->m_HeaderCells ), Data( i ) ) )
 				return false;
 		return true;
 	}
@@ -263,9 +239,10 @@ bool CTable::GetSubTable ( const vector<string> & cols, CTable * outPtr ) const
 		}
 	}
 
-	// create a deep copy of all those columns
+	// share all those columns
+	outPtr->m_HeaderCells.Reserve<CString>( columnIndexes.size( ) );
 	for ( const size_t & i : columnIndexes )
-		if ( ! outPtr->InsertDeepCol( m_Data.at( i ) ) )
+		if ( ! outPtr->InsertColumn( m_Header[ i ]->Clone( outPtr->m_HeaderCells ), Data( i ) ) )
 			return false;
 	return true;
 }
@@ -274,209 +251,244 @@ bool CTable::GetSubTable ( const vector<string> & cols, CTable * outPtr ) const
  * Returns the data type of a column for a given index.
  */
 string CTable::GetColumnType ( const size_t & index ) const {
-	if ( m_Data.empty( ) || index >= m_Data.size( ) || m_Data.at( index ).empty( ) )
+	const vector<size_t> * rows;
+	if ( index >= m_Columns.size( ) || ! DataView( index, rows ) )
 		return "";
-	return m_Data.at( index ).at( 1 )->GetType( );
+	return DataView( index, rows )->GetTypeName( );
 }
 
 /**
- * Creates a deep copy of current object. The rows must meet the condition to be copied.
- * @param[in] condition the condition object
- * @param[in] outPtr pointer to a new table to save
- * @return true if table was successfully created
+ * Compiles a condition into a typed predicate for a column of the given type. The constant is converted to the column type.
+ * @param[in, out] condition the condition object (marked, if the constant is a string)
+ * @param[in] type data type of the condition column
+ * @return the predicate (owned by the caller), nullptr if the constant or the operator is invalid
  */
-bool CTable::GetDeepTable ( CCondition * condition, CTable * outPtr ) const {
-	if ( ! outPtr || outPtr->GetColumnCount( ) == 0 || m_Data.empty( ) )
-		return false;
-
-	// column projection verification
-	size_t index;
-	if ( ! VerifyColumn( condition->m_Column, index ) )
-		return false;
+CPredicate * CTable::CreatePredicate ( CCondition * condition, const CColumn::EType & type ) {
+	// relation operator
+	CPredicate::EOperator op;
+	bool validOperator = CPredicate::ParseOperator( condition->m_Operator, op );
 
 	// constant type conversion
-	string colType = m_Data.at( index ).at( 1 )->GetType( );
-	CCell * criterionCell;
+	CPredicate * predicate = nullptr;
 	try {
-		if ( colType == typeid( string ).name( ) ) {
-			criterionCell = new CString( condition->m_Constant );
+		if ( type == CColumn::TYPE_STRING ) {
+			predicate = new CPredicate ( op, condition->m_Constant );
 			condition->IsStringConstant = true;
-		} else if ( colType == ( typeid( int ).name( ) ) )
-			criterionCell = new CInt( std::stoi( condition->m_Constant ) );
+		} else if ( type == CColumn::TYPE_INT )
+			predicate = new CPredicate ( op, static_cast<int32_t>( std::stoi( condition->m_Constant ) ) );
 		else {
 			char * c;
 			double output = std::strtod( condition->m_Constant.c_str( ), & c );
-			criterionCell = new CDouble( output );
 			if ( c == condition->m_Constant.c_str( ) ) {
 				CLog::BoldMsg( CLog::QP, condition->m_Constant, CLog::QP_CON_PARSE_ERROR );
-				delete criterionCell;
-				return false;
+				return nullptr;
 			}
+			predicate = new CPredicate ( op, output );
 		}
 	} catch ( std::logic_error const & e ) {
 		CLog::BoldMsg( CLog::QP, condition->m_Constant, CLog::QP_CON_PARSE_ERROR );
-		return false;
+		return nullptr;
 	};
 
-	// filtering data
-	size_t rcnt = 0;
-	size_t rows = m_Data.begin( )->size( );
-	size_t cols = m_Data.size( );
-	bool rowMatchFound = false;
-	for ( size_t i = 1; i < rows; ++ i ) {
-		for ( size_t j = 0; j < cols; ++ j ) {
-			if ( j == index ) {
-				if ( condition->m_Operator == "==" ) {
-					if ( ( * m_Data.at( j ).at( i ) == * criterionCell ) )
-						rowMatchFound = true;
-				} else if ( condition->m_Operator == "!=" ) {
-					if ( ( * m_Data.at( j ).at( i ) != * criterionCell ) )
-						rowMatchFound = true;
-				} else if ( condition->m_Operator == ">=" ) {
-					if ( ( * m_Data.at( j ).at( i ) >= * criterionCell ) )
-						rowMatchFound = true;
-				} else if ( condition->m_Operator == "<=" ) {
-					if ( ( * m_Data.at( j ).at( i ) <= * criterionCell ) )
-						rowMatchFound = true;
-				} else if ( condition->m_Operator == ">" ) {
-					if ( ( * m_Data.at( j ).at( i ) > * criterionCell ) )
-						rowMatchFound = true;
-				} else if ( condition->m_Operator == "<" ) {
-					if ( ( * m_Data.at( j ).at( i ) < * criterionCell ) )
-						rowMatchFound = true;
-				} else {
-					CLog::Msg( CLog::QP, CLog::QP_INVALID_OPER );
+	if ( ! validOperator ) {
+		CLog::Msg( CLog::QP, CLog::QP_INVALID_OPER );
+		delete predicate;
+		return nullptr;
+	}
+
+	return predicate;
+}
+
+/**
+ * Creates a table with the rows meeting all the conditions. The conditions are compiled into a tree of typed predicates
+ * (see CExpression), which only scans the condition columns - a large table by several threads (see CQuerySett::m_Threads).
+ * The other columns are copied lazily (see the module description), if all the rows match, the column data is shared.
+ * @param[in, out] conditions the condition objects (their string constants are marked)
+ * @param[in] columns names of the columns of each condition (in the order of CCondition::GetColumns)
+ * @param[in] outPtr pointer to a new (empty) table to save
+ * @return true if table was successfully created
+ */
+bool CTable::GetFilteredTable ( const vector<CCondition *> & conditions, const vector<vector<string>> & columns, CTable * outPtr ) const {
+	if ( ! outPtr || outPtr->GetColumnCount( ) != 0 || m_Header.empty( ) )
+		return false;
+
+	// column projection verification, only the condition columns are passed to the predicates
+	vector<vector<size_t>> indexes;
+	vector<size_t> used;
+	vector<const CColumn *> data;
+	vector<CColumn::EType> types;
+	for ( const vector<string> & i : columns ) {
+		indexes.emplace_back( );
+		for ( const string & j : i ) {
+			size_t index;
+			if ( ! VerifyColumn( j, index, true ) )
+				return false;
+			size_t position = find( used.begin( ), used.end( ), index ) - used.begin( );
+			if ( position == used.size( ) ) {
+				const CColumn * column = Data( index ).get( );
+				if ( ! column ) {
+					CLog::Msg( CLog::QP, CLog::QP_EMPTY_RESULTS );
 					return false;
 				}
-				//
-				//
-				if ( rowMatchFound ) {
-					++ rcnt;
-					if ( ! InsertDeepRow( i, outPtr ) ) {
-						delete criterionCell;
-						return false;
-					}
-					rowMatchFound = false;
-				}
+				used.push_back( index );
+				data.push_back( column );
+				types.push_back( column->GetType( ) );
 			}
+			indexes.back( ).push_back( position );
 		}
 	}
 
-	delete criterionCell;
-	if ( rcnt < 1 ) {
+	unique_ptr<CExpression> expression ( CExpression::Compile( conditions, indexes, types ) );
+	if ( ! expression )
+		return false;
+
+	// filtering data, the morsels of the rows are evaluated in parallel
+	shared_ptr<vector<size_t>> selected = make_shared<vector<size_t>>( );
+	expression->Select( data, * selected, CQuerySett::GetThreads( ) );
+	return GetSelectedTable( selected, outPtr );
+}
+
+/**
+ * Creates a table with a range of the data rows (e.g. the rows appended to a table, see CTableQuery::Refresh).
+ * @param[in] begin index of the first data row
+ * @param[in] end index past the last data row
+ * @param[in] outPtr pointer to a new (empty) table to save
+ * @return true if table was successfully created, false if the range is empty
+ */
+bool CTable::GetRowRange ( const size_t & begin, const size_t & end, CTable * outPtr ) const {
+	if ( begin >= end || end > GetDataRowCount( ) )
+		return false;
+	auto selected = make_shared<vector<size_t>>( end - begin );
+	iota( selected->begin( ), selected->end( ), begin );
+	return GetSelectedTable( selected, outPtr );
+}
+
+/**
+ * Creates a table with the selected rows (e.g. found by an index, see CIndex). The columns are copied lazily,
+ * if all the rows are selected, the column data is shared.
+ * @param[in] selected indexes of the selected data rows (ascending)
+ * @param[in] outPtr pointer to a new (empty) table to save
+ * @return true if table was successfully created, false if no row is selected
+ */
+bool CTable::GetSelectedTable ( const shared_ptr<vector<size_t>> & selected, CTable * outPtr ) const {
+	if ( ! outPtr || outPtr->GetColumnCount( ) != 0 || m_Header.empty( ) )
+		return false;
+	if ( selected->empty( ) ) {
 		CLog::Msg( CLog::QP, CLog::QP_EMPTY_RESULTS );
 		return false;
 	}
+	outPtr->m_HeaderCells.Reserve<CString>( m_Header.size( ) );
+
+	// all rows match, nothing to copy
+	if ( selected->size( ) == GetDataRowCount( ) ) {
+		for ( size_t i = 0; i < m_Header.size( ); ++ i )
+			if ( ! outPtr->InsertColumn( m_Header[ i ]->Clone( outPtr->m_HeaderCells ), Data( i ) ) )
+				return false;
+		return true;
+	}
+
+	// the selection is kept, the columns are copied once they are needed
+	for ( size_t i = 0; i < m_Header.size( ); ++ i ) {
+		outPtr->m_Header.push_back( m_Header[ i ]->Clone( outPtr->m_HeaderCells ) );
+		outPtr->m_Columns.emplace_back( );
+		outPtr->m_Pending.push_back( Data( i ) );
+	}
+	outPtr->m_Selection = selected;
 	return true;
 }
 
 /**
- * This method will find occurrences of given rows in given columns.
- * It will scan trough all rows in the table, searching for a match.
- * If it succeeds, corresponding row indexes of each objects are copied to the output.
- * @param[in] columnsRef source for data filtering
- * @return vector of matched row indexes (source + current table)
+ * This method will find occurrences of source table rows in the current table.
+ * Rows match if they have equal values in all the given columns.
+ * The join algorithm is chosen by the query settings - by default, tables sorted on a key column are merged, others hashed.
+ * @param[in] source source table for data filtering
+ * @param[in] columns names of the columns to match (both tables must have them)
+ * @return vector of matched row indexes (source + current table), ordered by the source row
  */
-vector<pair<size_t, size_t>> CTable::FindOccurences ( vector<vector<CCell *>> & columnsRef ) const {
-	vector<pair<size_t, size_t>> matches;
-
-	// find equivalent indexes of the columns in current table
-	vector<size_t> columnIndexes;
-	size_t currentIndex = 0;
-	size_t cnt = 0;
-	for ( const auto & item : columnsRef )
-		if ( ! VerifyColumn( item.at( 0 )->RetrieveMVal( ), currentIndex ) )
+vector<pair<size_t, size_t>> CTable::FindOccurences ( const CTable & source, const vector<string> & columns ) const {
+	// find equivalent indexes of the columns in both tables
+	vector<const CColumn *> keysSource, keysCurrent;
+	size_t sourceIndex = 0, currentIndex = 0;
+	for ( const string & i : columns ) {
+		if ( ! source.VerifyColumn( i, sourceIndex ) || ! VerifyColumn( i, currentIndex ) )
 			return vector<pair<size_t, size_t>>( );
-		else {
-			columnIndexes.push_back( currentIndex );
-			++ cnt;
-		}
+		if ( ! source.Data( sourceIndex ) || ! Data( currentIndex ) )
+			return vector<pair<size_t, size_t>>( );
+		keysSource.push_back( source.Data( sourceIndex ).get( ) );
+		keysCurrent.push_back( Data( currentIndex ).get( ) );
+	}
 
-	// scan for for occurrences
-	bool equal;
-	size_t columnCnt = columnsRef.size( );
-	size_t rowRefCount = columnsRef.at( 0 ).size( );
-	size_t rowDataCount = m_Data.at( 0 ).size( );
-	for ( size_t i = 1; i < rowRefCount; ++ i ) {
-		for ( size_t j = 1; j < rowDataCount; ++ j ) {
-			equal = true;
-			for ( size_t k = 0; k < columnCnt; ++ k )
-				if ( * columnsRef.at( k ).at( i ) != * m_Data.at( columnIndexes.at( k ) ).at( j ) )
-					equal = false;
-			if ( equal )
-				matches.emplace_back( i, j );
-		}
+	// scan for occurrences, sorted tables are merged unless the algorithm is forced
+	vector<pair<size_t, size_t>> matches;
+	size_t mergeKey;
+	switch ( CQuerySett::m_JoinAlgorithm ) {
+		case CQuerySett::JOIN_NESTED:
+			matches = CJoinEngine::NestedLoopJoin( keysSource, keysCurrent );
+			break;
+		case CQuerySett::JOIN_HASH:
+			matches = CJoinEngine::HashJoin( keysSource, keysCurrent );
+			break;
+		case CQuerySett::JOIN_MERGE:
+			matches = CJoinEngine::MergeJoin( keysSource, keysCurrent );
+			break;
+		default:
+			if ( CJoinEngine::FindMergeKey( keysSource, keysCurrent, true, mergeKey ) )
+				matches = CJoinEngine::MergeJoin( keysSource, keysCurrent );
+			else
+				matches = CJoinEngine::HashJoin( keysSource, keysCurrent );
+	}
+
+	// header is the row 0
+	for ( auto & i : matches ) {
+		++ i.first;
+		++ i.second;
 	}
 	return matches;
 }
 
 /**
- * Small alternative for occurence searching. Forked from identical method but accepts single column.
- * @param[in] columnRef source for data filtering
- * @return vector of matched row indexes (source + current table)
+ * Typed column data getter. Nullptr is returned if the column doesn't exist or has no rows yet.
  */
-vector<pair<size_t, size_t>> CTable::FindOccurences ( vector<CCell *> & columnRef ) const {
-	// find equivalent index of the column in current table
-	size_t tableColIndex = 0;
-	if ( ! VerifyColumn( columnRef.at( 0 )->RetrieveMVal( ), tableColIndex ) )
-		return vector<pair<size_t, size_t>>( );
-	size_t rowRefCount  = columnRef.size( );
-	size_t rowDataCount = m_Data.at( 0 ).size( );
-
-	// scan for for occurrences
-	vector<pair<size_t, size_t>> matches;
-	for ( size_t i = 1; i < rowRefCount; ++ i )
-		for ( size_t j = 1; j < rowDataCount; ++ j )
-			if ( * columnRef.at( i ) == * m_Data.at( tableColIndex ).at( j ) )
-				matches.emplace_back( i, j );
-
-	return matches;
+const CColumn * CTable::GetColumn ( const size_t & index ) const {
+	return index < m_Columns.size( ) ? Data( index ).get( ) : nullptr;
 }
 
 /**
  * Column count getter.
  */
 size_t CTable::GetColumnCount ( ) const {
-	return m_Data.size( );
+	return m_Header.size( );
 }
 
 /**
- * Row count getter.
+ * Row count getter (header row included).
  */
 size_t CTable::GetRowCount ( ) const {
-	if ( m_Data.empty( ) || m_Data.at( 0 ).empty( ) )
+	if ( m_Header.empty( ) )
 		return 0;
-	return m_Data.at( 0 ).size( );
+	return GetDataRowCount( ) + 1;
 }
 
 /**
- * This method will transform existing data into row format.
- * Note: Only pointers are copied.
- * @return vector of rows
+ * Row count getter (header row excluded).
  */
-vector<vector<CCell *>> CTable::Transform ( ) const {
-	vector<vector<CCell *>> out;
-	size_t rowCnt = m_Data.at( 0 ).size( );
-	size_t colCnt = m_Data.size( );
-	vector<CCell *> tmp;
-	for ( size_t i = 1; i < rowCnt; ++i ) {
-		for ( size_t j = 0; j < colCnt; ++j )
-			tmp.push_back( m_Data.at( j ).at( i ) );
-		out.push_back( std::move( tmp ) );
-	}
-	return out;
+size_t CTable::GetDataRowCount ( ) const {
+	if ( m_Selection && ! m_Pending.empty( ) )
+		return m_Selection->size( );
+	if ( m_Columns.empty( ) || ! m_Columns.at( 0 ) )
+		return 0;
+	return m_Columns.at( 0 )->GetSize( );
 }
 
 /**
- * Duplicates a table header with duplicated CCells.
+ * Bytes taken by the table data - the columns (including the ones shared with other tables) and the pending selection.
  */
-vector<CCell *> CTable::GetDeepHeader ( ) const {
-	if ( m_Data.empty( ) )
-		return vector<CCell *> { };
-	vector<CCell *> out;
-	for ( const auto & i : m_Data )
-		out.push_back( i.at( 0 )->Clone( ) );
-	return out;
+size_t CTable::GetMemorySize ( ) const {
+	size_t size = m_Selection && ! m_Pending.empty( ) ? m_Selection->capacity( ) * sizeof( size_t ) : 0;
+	for ( const auto & i : m_Columns )
+		if ( i )
+			size += i->GetMemorySize( );
+	return size;
 }
 
 /**
@@ -484,10 +496,10 @@ vector<CCell *> CTable::GetDeepHeader ( ) const {
  */
 vector<string> CTable::GetColumnNames ( ) const {
 	vector<string> res;
-	if ( m_Data.empty( ) )
+	if ( m_Header.empty( ) )
 		throw logic_error( CLog::TAB_NO_DATA );
-	for ( const auto & i : m_Data )
-		res.push_back( i.at( 0 )->RetrieveMVal( ) );
+	for ( const auto & i : m_Header )
+		res.push_back( i->RetrieveMVal( ) );
 	return res;
 }
 
@@ -496,15 +508,17 @@ vector<string> CTable::GetColumnNames ( ) const {
  * @return vector of cell sizes for each column
  */
 vector<size_t> CTable::GetCellPadding ( ) const {
-	vector<size_t> result( m_Data.size( ), 0 );
-	size_t counter = 0;
-	for ( const auto & j : m_Data ) {
-		for ( const CCell * k : j ) {
-			size_t k_len = k->GetLength( );
+	vector<size_t> result( m_Header.size( ), 0 );
+	for ( size_t counter = 0; counter < m_Header.size( ); ++ counter ) {
+		result.at( counter ) = m_Header[ counter ]->GetLength( );
+		const vector<size_t> * selection;
+		const CColumn * column = DataView( counter, selection );
+		size_t rows = column ? GetDataRowCount( ) : 0;
+		for ( size_t k = 0; k < rows; ++ k ) {
+			size_t k_len = column->GetLength( selection ? ( * selection )[ k ] : k );
 			if ( k_len > result.at( counter ) )
 				result.at( counter ) = k_len;
 		}
-		counter ++;
 	}
 	return result;
 }
@@ -514,7 +528,7 @@ vector<size_t> CTable::GetCellPadding ( ) const {
  * @param[in,out] ost output stream.
  */
 void CTable::Render ( ostream & ost ) const {
-	if ( m_Data.empty( ) || m_Data.begin( )->size( ) == 1 )
+	if ( m_Header.empty( ) || GetDataRowCount( ) == 0 )
 		throw logic_error( CLog::TAB_NO_BODY );
 
 	vector<size_t> paddings = GetCellPadding( );
@@ -527,21 +541,25 @@ void CTable::Render ( ostream & ost ) const {
 	RenderSeparator( rowLen, tmp );
 	int currentColumn = 0;
 	ost << CRenderSett::m_SpacePad;
-	for ( const auto & columnName : m_Data ) {
+	for ( const auto & columnName : m_Header ) {
 		ost << setw( paddings.at( currentColumn ++ ) ) << left;
-		columnName.at( 0 )->Print( ) << CRenderSett::m_SpacePad;
+		columnName->Print( ost ) << CRenderSett::m_SpacePad;
 	}
 	ost << endl;
 
-	// body
+	// body (pending selections are printed without copying the columns)
 	RenderSeparator( rowLen, tmp );
 	currentColumn = 0;
-	size_t colSize = m_Data.begin( )->size( );
-	for ( size_t i = 1; i < colSize; ++ i ) {
+	size_t colSize = GetDataRowCount( );
+	vector<const CColumn *> columns ( m_Columns.size( ) );
+	vector<const vector<size_t> *> selections ( m_Columns.size( ) );
+	for ( size_t j = 0; j < columns.size( ); ++ j )
+		columns[ j ] = DataView( j, selections[ j ] );
+	for ( size_t i = 0; i < colSize; ++ i ) {
 		ost << CRenderSett::m_SpacePad;
-		for ( const auto & j : m_Data ) {
+		for ( size_t j = 0; j < columns.size( ); ++ j ) {
 			ost << setw( paddings[ currentColumn ++ ] ) << left;
-			j.at( i )->Print( ) << CRenderSett::m_SpacePad;
+			columns[ j ]->Print( selections[ j ] ? ( * selections[ j ] )[ i ] : i, ost ) << CRenderSett::m_SpacePad;
 		}
 		currentColumn = 0;
 		ost << endl;
@@ -556,16 +574,20 @@ void CTable::Render ( ostream & ost ) const {
  */
 void CTable::Render ( vector<string> & out ) const {
 	out.clear( );
-	if ( m_Data.empty( ) || m_Data.at( 0 ).empty( ) )
+	if ( m_Header.empty( ) )
 		return;
 	string line;
-	size_t rows = m_Data.at( 0 ).size( );
-	size_t cols = m_Data.size( );
+	size_t rows = GetRowCount( );
+	size_t cols = m_Header.size( );
+	vector<const CColumn *> columns ( cols );
+	vector<const vector<size_t> *> selections ( cols );
+	for ( size_t i = 0; i < cols; ++ i )
+		columns[ i ] = DataView( i, selections[ i ] );
 	for ( size_t j = 0; j < rows; ++j ) {
 		if ( j == 0 ) {
 			string type;
 			for ( size_t i = 0; i < cols; ++i ) {
-				type = m_Data.at( i ).at( 1 )->GetType( );
+				type = GetColumnType( i );
 				if ( type == typeid( string ).name( ) )
 					type = CLog::TYPE_STRING;
 				else if ( type == typeid( int ).name( ) )
@@ -577,7 +599,7 @@ void CTable::Render ( vector<string> & out ) const {
 			line += "\n";
 		}
 		for ( size_t i = 0; i < cols; ++i )
-			line += string( m_Data.at( i ).at( j )->RetrieveMVal( ) ).append( ( i != ( cols - 1 ) ) ? ", " : "" );
+			line += string( j == 0 ? m_Header[ i ]->RetrieveMVal( ) : columns[ i ]->RetrieveMVal( selections[ i ] ? ( * selections[ i ] )[ j - 1 ] : j - 1 ) ).append( ( i != ( cols - 1 ) ) ? ", " : "" );
 		line += "\n";
 		out.emplace_back( std::move( line ) );
 		line.clear( );
@@ -1,76 +1,95 @@
 #pragma once
 
 #include "CCell.hpp"
+#include "CCellArena.hpp"
+#include "CColumn.hpp"
+#include "CJoinEngine.hpp"
+#include "CQuerySett.hpp"
 #include "CRenderSett.hpp"
 #include "../console/CLog.hpp"
 #include "CCondition.hpp"
+#include "CPredicate.hpp"
+#include "CExpression.hpp"
+#include "CStatistics.hpp"
 
 #include <iostream>
 #include <algorithm>
+#include <numeric>
 #include <iomanip>
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
 
 using namespace std;
 
 /**
  * This module is the most essential part for the database. Forms tables with their respective cells.
+ *
+ * The data is stored by columns (see CColumn), the header row is kept as a row of string cells (allocated in the arena of the table).
+ * The row indexes of the public interface treat the header as the row 0, so the data rows start at 1.
+ * Column data type is known once the first row is inserted, until then the column slot is empty.
+ *
+ * Column data is reference counted and shared between the tables - query results, which only select
+ * or filter whole columns, point to the source data instead of copying it. The header is never shared,
+ * so renaming a column (CAlias) doesn't affect the other tables. A shared column is copied before it's modified.
+ *
+ * A filtered table (PRO) doesn't copy its rows right away. It keeps the source columns with a selection
+ * vector and copies each column only once it's accessed - a filter over a wide table touches the predicate column only.
+ *
+ * The tables of the database keep the statistics of their columns (see CStatistics), the query results don't.
+ * Their string columns with few distinct values are dictionary encoded (see CStringColumn::Encode).
  */
 class CTable {
 private:
-	vector<vector<CCell *>> m_Data;
+	vector<CCell *> m_Header;
+	CCellArena m_HeaderCells;
+	mutable vector<shared_ptr<CColumn>> m_Columns;
+	mutable vector<shared_ptr<CColumn>> m_Pending;
+	shared_ptr<vector<size_t>> m_Selection;
+	shared_ptr<const CStatistics> m_Statistics;
+
+	bool InsertColumn ( CCell * header, const shared_ptr<CColumn> & col );
+	void DetachColumn ( const size_t & index );
+	const shared_ptr<CColumn> & Data ( const size_t & index ) const;
+	const CColumn * DataView ( const size_t & index, const vector<size_t> * & rows ) const;
+	void Materialize ( ) const;
 
 public:
-	explicit CTable ( const vector<CCell *> & header );
 	explicit CTable ( const vector<string> & header );
-	explicit CTable ( const vector<pair<string, int>> & header );
+	explicit CTable ( const vector<string> & header, const vector<CColumn *> & columns );
 	explicit CTable ( ) = default;
 	~CTable ( );
 
-	struct RowComparator {
-		bool operator ( ) ( const vector<CCell *> & v1, const vector<CCell *> & v2 ) const {
-			for ( size_t i = 0; i < v1.size( ); ++i ) {
-				if ( * v1[ i ] == * v2[ i ] )
-					continue;
-				else
-					return * v1[ i ] < * v2[ i ];
-			}
-			return false;
-		};
-	};
-
 	bool VerifyColumn ( const string & col, size_t & index, const bool & msg = false ) const;
 
-	void SortColumns ( );
-	void SortColumns ( vector<pair<size_t, size_t>> & columnOrders );
 
-	static void SortRows ( vector<vector<CCell *>> & dataRef );
 	bool HasDuplicateColumns ( ) const;
-	bool HasIdenticalHeader ( const CTable * tableRef ) const;
 
-	bool InsertShallowRow ( const vector<CCell *> & row );
-	bool InsertDeepCol ( const vector<CCell *> & col );
-	bool InsertDeepRow ( const size_t & index, CTable * outPtr ) const;
+	bool InsertRow ( const vector<CCell *> & row );
+	bool AppendRows ( const vector<unique_ptr<CColumn>> & rows );
 	bool ChangeColumnName ( const size_t & index, const string & s ) const;
-	static vector<CCell *> MergeRows ( const vector<CCell *> & rowA, const vector<CCell *> & rowB );
 
-	vector<vector<CCell *>> Transform ( ) const;
-	vector<CCell *> GetDeepHeader ( ) const;
-	bool GetShallowCol ( const string & name, vector<CCell *> & outRef ) const;
-	bool GetDeepTable ( CCondition * condition, CTable * outPtr ) const;
-	bool GetDeepRow ( const size_t & index, vector<CCell *> & outRef ) const;
-	bool GetDeepRow ( const size_t & index, vector<string> & selectedColumns, vector<CCell *> & outRef ) const;
-	static vector<CCell *> GetDeepRow ( const vector<CCell *> & outRef );
+	static CPredicate * CreatePredicate ( CCondition * condition, const CColumn::EType & type );
+	bool GetFilteredTable ( const vector<CCondition *> & conditions, const vector<vector<string>> & columns, CTable * outPtr ) const;
+	bool GetSelectedTable ( const shared_ptr<vector<size_t>> & selected, CTable * outPtr ) const;
+	bool GetRowRange ( const size_t & begin, const size_t & end, CTable * outPtr ) const;
+	bool GetGatheredCols ( const vector<string> & cols, const vector<size_t> & rows, CTable * outPtr ) const;
 	bool GetSubTable ( const vector<string> & row, CTable * outPtr ) const;
 	string GetColumnType ( const size_t & index ) const;
 
-	vector<pair<size_t, size_t>> FindOccurences ( vector<vector<CCell *>> & columnsRef ) const;
-	vector<pair<size_t, size_t>> FindOccurences ( vector<CCell *> & columnRef ) const;
+	vector<pair<size_t, size_t>> FindOccurences ( const CTable & source, const vector<string> & columns ) const;
 
+	const CColumn * GetColumn ( const size_t & index ) const;
 	size_t GetColumnCount ( ) const;
 	size_t GetRowCount( ) const;
+	size_t GetDataRowCount ( ) const;
+	size_t GetMemorySize ( ) const;
 	vector<string> GetColumnNames ( ) const;
+	const CStatistics * GetStatistics ( ) const { return m_Statistics.get( ); }
+	void CollectStatistics ( ) { m_Statistics = make_shared<const CStatistics>( * this ); }
+	void SetStatistics ( const shared_ptr<const CStatistics> & statistics ) { m_Statistics = statistics; }
+	void EncodeColumns ( );
 	vector<size_t> GetCellPadding ( ) const;
 
 	void Render ( ostream & ost = cout ) const;
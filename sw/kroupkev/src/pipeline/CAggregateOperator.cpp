@@ -0,0 +1,500 @@
+#include "CAggregateOperator.hpp"
+
+#include <numeric>
+
+/**
+ * Reads an aggregate function, e.g. "count" or "avg(points)". The function name is case insensitive.
+ * @param[in] definition the aggregate function (without spaces)
+ * @param[out] output the parsed function
+ * @return true if the function exists and has a column (COUNT doesn't need one)
+ */
+bool CAggregate::Parse ( const string & definition, CAggregate & output ) {
+	size_t open = definition.find( '(' );
+	string name = definition.substr( 0, open );
+	transform( name.begin( ), name.end( ), name.begin( ), ::toupper );
+	output.m_Column.clear( );
+	if ( open != string::npos ) {
+		if ( definition.back( ) != ')' || definition.length( ) < open + 3 )
+			return false;
+		output.m_Column = definition.substr( open + 1, definition.length( ) - open - 2 );
+	}
+
+	if ( name == CLog::AGG_COUNT )
+		output.m_Function = AGG_COUNT;
+	else if ( name == CLog::AGG_SUM )
+		output.m_Function = AGG_SUM;
+	else if ( name == CLog::AGG_MIN )
+		output.m_Function = AGG_MIN;
+	else if ( name == CLog::AGG_MAX )
+		output.m_Function = AGG_MAX;
+	else if ( name == CLog::AGG_AVG )
+		output.m_Function = AGG_AVG;
+	else
+		return false;
+	return output.m_Function == AGG_COUNT || ! output.m_Column.empty( );
+}
+
+/**
+ * Name of the output column, e.g. "count" or "avg(points)".
+ */
+string CAggregate::GetName ( ) const {
+	string name = GetSQL( );
+	transform( name.begin( ), name.end( ), name.begin( ), ::tolower );
+	if ( m_Column.empty( ) )
+		return name.substr( 0, name.find( '(' ) );
+	return name.substr( 0, name.find( '(' ) + 1 ).append( m_Column ).append( ")" );
+}
+
+/**
+ * The function as written in SQL, e.g. "COUNT(*)" or "AVG(points)".
+ */
+string CAggregate::GetSQL ( ) const {
+	const string * name;
+	switch ( m_Function ) {
+		case AGG_COUNT:
+			name = & CLog::AGG_COUNT;
+			break;
+		case AGG_SUM:
+			name = & CLog::AGG_SUM;
+			break;
+		case AGG_MIN:
+			name = & CLog::AGG_MIN;
+			break;
+		case AGG_MAX:
+			name = & CLog::AGG_MAX;
+			break;
+		default:
+			name = & CLog::AGG_AVG;
+	}
+	return string( * name ).append( "(" ).append( m_Column.empty( ) ? "*" : m_Column ).append( ")" );
+}
+
+//
+
+/**
+ * @param[in] input input stage (owned by the aggregation)
+ * @param[in] groups names of the group columns, the input is aggregated as a single group if there are none
+ * @param[in] aggregates aggregate functions
+ */
+CAggregateOperator::CAggregateOperator ( COperator * input, const vector<string> & groups, const vector<CAggregate> & aggregates )
+: m_Input( input ), m_Groups( groups ), m_Aggregates( aggregates ), m_Budget( CQuerySett::m_AggregateBudget ) {
+	FindColumns( );
+}
+
+/**
+ * Finds the group and aggregated columns in the input header, a missing column gets the index past the end of the header.
+ * The output types follow the input ones (see the module description).
+ */
+void CAggregateOperator::FindColumns ( ) {
+	const vector<string> & header = m_Input->GetHeader( );
+	const vector<CColumn::EType> & types = m_Input->GetTypes( );
+	m_GroupIndexes.clear( );
+	m_AggregateIndexes.clear( );
+	m_Header.clear( );
+	m_Types.clear( );
+	for ( const string & i : m_Groups ) {
+		m_GroupIndexes.push_back( find( header.begin( ), header.end( ), i ) - header.begin( ) );
+		m_Header.push_back( i );
+		m_Types.push_back( m_GroupIndexes.back( ) < header.size( ) ? types[ m_GroupIndexes.back( ) ] : CColumn::TYPE_STRING );
+	}
+	for ( const CAggregate & i : m_Aggregates ) {
+		m_AggregateIndexes.push_back( i.m_Column.empty( ) ? header.size( ) : find( header.begin( ), header.end( ), i.m_Column ) - header.begin( ) );
+		m_Header.push_back( i.GetName( ) );
+		if ( i.m_Function == CAggregate::AGG_COUNT )
+			m_Types.push_back( CColumn::TYPE_INT );
+		else if ( i.m_Function == CAggregate::AGG_SUM || i.m_Function == CAggregate::AGG_AVG )
+			m_Types.push_back( CColumn::TYPE_DOUBLE );
+		else
+			m_Types.push_back( m_AggregateIndexes.back( ) < header.size( ) ? types[ m_AggregateIndexes.back( ) ] : CColumn::TYPE_INT );
+	}
+}
+
+/**
+ * Verifies the columns exist and the sums and averages are numeric, each error is reported.
+ */
+bool CAggregateOperator::Validate ( ) const {
+	size_t columns = m_Input->GetHeader( ).size( );
+	for ( size_t i = 0; i < m_Groups.size( ); ++ i ) {
+		if ( m_GroupIndexes[ i ] == columns ) {
+			CLog::HighlightedMsg( CLog::QP, m_Groups[ i ], CLog::QP_NO_SUCH_COL );
+			return false;
+		}
+	}
+	for ( size_t i = 0; i < m_Aggregates.size( ); ++ i ) {
+		const CAggregate & aggregate = m_Aggregates[ i ];
+		if ( aggregate.m_Column.empty( ) )
+			continue;
+		if ( m_AggregateIndexes[ i ] == columns ) {
+			CLog::HighlightedMsg( CLog::QP, aggregate.m_Column, CLog::QP_NO_SUCH_COL );
+			return false;
+		}
+		if ( ( aggregate.m_Function == CAggregate::AGG_SUM || aggregate.m_Function == CAggregate::AGG_AVG )
+		     && m_Input->GetTypes( )[ m_AggregateIndexes[ i ] ] == CColumn::TYPE_STRING ) {
+			CLog::HighlightedMsg( CLog::QP, aggregate.GetName( ), CLog::QP_AGG_NOT_NUMERIC );
+			return false;
+		}
+	}
+	if ( HasDuplicateColumns( ) ) {
+		CLog::Msg( CLog::QP, CLog::QP_DUP_COL );
+		return false;
+	}
+	return true;
+}
+
+/**
+ * The rows are sorted, if the keys and the running aggregates of the estimated groups don't fit the memory budget.
+ * A group takes its hash, two slots of the hash table and its count, then its key and its aggregates (strings are estimated).
+ */
+bool CAggregateOperator::IsSortBased ( ) const {
+	double groupSize = sizeof( uint64_t ) + 2 * sizeof( uint32_t ) + sizeof( int64_t );
+	for ( size_t i = 0; i < m_Header.size( ); ++ i )
+		groupSize += m_Types[ i ] == CColumn::TYPE_STRING ? sizeof( string ) : sizeof( int64_t );
+	return EstimateRows( ) * groupSize > static_cast<double>( m_Budget ) * CQuerySett::CACHE_UNIT;
+}
+
+bool CAggregateOperator::Open ( ) {
+	Close( );
+	if ( ! Validate( ) )
+		return false;
+
+	vector<const CColumn *> keys;
+	for ( size_t i = 0; i < m_Groups.size( ); ++ i ) {
+		m_Keys.emplace_back( CColumn::Create( m_Types[ i ] ) );
+		keys.push_back( m_Keys.back( ).get( ) );
+	}
+	m_KeyHash.reset( new CRowHash( keys ) );
+	m_Integers.assign( m_Aggregates.size( ), vector<int64_t>( ) );
+	m_Doubles.assign( m_Aggregates.size( ), vector<double>( ) );
+	m_Strings.assign( m_Aggregates.size( ), vector<string>( ) );
+
+	if ( ! ( IsSortBased( ) ? AggregateSorted( ) : AggregateHashed( ) ) )
+		return false;
+	return Finish( );
+}
+
+/**
+ * Aggregates the input batches as they are read, the groups of their rows are looked up in the hash table.
+ */
+bool CAggregateOperator::AggregateHashed ( ) {
+	m_Slots.assign( 16, 0 );
+	m_Mask = m_Slots.size( ) - 1;
+	if ( ! m_Input->Open( ) ) {
+		m_Input->Close( );
+		return false;
+	}
+	CBatch batch;
+	vector<const CColumn *> columns;
+	vector<uint32_t> groups;
+	while ( m_Input->NextBatch( batch ) ) {
+		columns.clear( );
+		for ( const unique_ptr<CColumn> & i : batch.m_Columns )
+			columns.push_back( i.get( ) );
+		FindGroups( columns, groups );
+		Accumulate( columns, groups );
+	}
+	m_Input->Close( );
+	m_Slots.clear( );
+	m_Slots.shrink_to_fit( );
+	m_Hashes.clear( );
+	m_Hashes.shrink_to_fit( );
+	return true;
+}
+
+/**
+ * Stores the input and sorts its rows by the group columns, the runs of equal rows are the groups. The groups are created
+ * in the order of their first rows (the sort is stable, so the first row of a run is its first input row) and then aggregated at once.
+ */
+bool CAggregateOperator::AggregateSorted ( ) {
+	unique_ptr<CTable> input ( Materialize( * m_Input ) );
+	if ( ! input )
+		return false;
+	size_t rows = input->GetDataRowCount( );
+	if ( ! rows )
+		return true;
+
+	vector<const CColumn *> columns, keys;
+	for ( size_t i = 0; i < input->GetColumnCount( ); ++ i )
+		columns.push_back( input->GetColumn( i ) );
+	for ( const size_t & i : m_GroupIndexes )
+		keys.push_back( columns[ i ] );
+	auto equal = [ & keys ] ( const size_t & a, const size_t & b ) {
+		for ( const CColumn * i : keys )
+			if ( ! i->Equal( a, * i, b ) )
+				return false;
+		return true;
+	};
+	auto less = [ & keys ] ( const size_t & a, const size_t & b ) {
+		for ( const CColumn * i : keys )
+			if ( ! i->Equal( a, * i, b ) )
+				return i->Less( a, * i, b );
+		return false;
+	};
+	vector<size_t> order ( rows );
+	iota( order.begin( ), order.end( ), 0 );
+	stable_sort( order.begin( ), order.end( ), less );
+
+	// runs are numbered in the sorted order first, then renumbered by their first rows
+	vector<size_t> firsts;
+	vector<uint32_t> groups ( rows );
+	for ( size_t i = 0; i < rows; ++ i ) {
+		if ( ! i || ! equal( order[ i - 1 ], order[ i ] ) )
+			firsts.push_back( order[ i ] );
+		groups[ order[ i ] ] = static_cast<uint32_t>( firsts.size( ) - 1 );
+	}
+	vector<uint32_t> runs ( firsts.size( ) ), renumbered ( firsts.size( ) );
+	iota( runs.begin( ), runs.end( ), 0 );
+	sort( runs.begin( ), runs.end( ), [ & firsts ] ( const uint32_t & a, const uint32_t & b ) { return firsts[ a ] < firsts[ b ]; } );
+	for ( const uint32_t & i : runs )
+		renumbered[ i ] = CreateGroup( columns, firsts[ i ] );
+	for ( uint32_t & i : groups )
+		i = renumbered[ i ];
+	Accumulate( columns, groups );
+	return true;
+}
+
+/**
+ * Finds the group of each row of a batch, a group is created for each row with a new key.
+ * @param[in] columns input columns of the batch
+ * @param[out] groups group of each row
+ */
+void CAggregateOperator::FindGroups ( const vector<const CColumn *> & columns, vector<uint32_t> & groups ) {
+	vector<const CColumn *> keys;
+	for ( const size_t & i : m_GroupIndexes )
+		keys.push_back( columns[ i ] );
+	CRowHash probe ( keys );
+	probe.MapCodes( * m_KeyHash );
+
+	// the neighbouring patterns of the fuzzy keys are probed after the exact one (see CRowHash)
+	const int shifts[ ] = { 0, -1, 1 };
+	size_t shiftCnt = m_KeyHash->IsFuzzy( ) ? 3 : 1;
+	size_t rows = columns.empty( ) ? 0 : columns.front( )->GetSize( );
+	groups.resize( rows );
+	for ( size_t i = 0; i < rows; ++ i ) {
+		bool found = false;
+		for ( size_t j = 0; j < shiftCnt && ! found; ++ j ) {
+			uint64_t h = probe.Hash( i, shifts[ j ] );
+			for ( uint64_t slot = h & m_Mask; m_Slots[ slot ] && ! found; slot = ( slot + 1 ) & m_Mask ) {
+				uint32_t group = m_Slots[ slot ] - 1;
+				if ( m_Hashes[ group ] == h && probe.Equal( i, * m_KeyHash, group ) ) {
+					groups[ i ] = group;
+					found = true;
+				}
+			}
+		}
+		if ( found )
+			continue;
+		groups[ i ] = CreateGroup( columns, i );
+		m_Hashes.push_back( probe.Hash( i ) );
+		InsertSlot( groups[ i ] );
+	}
+}
+
+/**
+ * Creates a group with the key of an input row. Its sums start at zero, its minimums and maximums at the value of the row.
+ * @param[in] columns input columns
+ * @param[in] row the first row of the group
+ * @return index of the group
+ */
+uint32_t CAggregateOperator::CreateGroup ( const vector<const CColumn *> & columns, const size_t & row ) {
+	for ( size_t i = 0; i < m_Keys.size( ); ++ i )
+		m_Keys[ i ]->AppendRow( * columns[ m_GroupIndexes[ i ] ], row );
+	m_Counts.push_back( 0 );
+	for ( size_t i = 0; i < m_Aggregates.size( ); ++ i ) {
+		if ( m_Aggregates[ i ].m_Function == CAggregate::AGG_COUNT )
+			continue;
+		bool sum = m_Aggregates[ i ].m_Function == CAggregate::AGG_SUM || m_Aggregates[ i ].m_Function == CAggregate::AGG_AVG;
+		const CColumn * column = columns[ m_AggregateIndexes[ i ] ];
+		switch ( column->GetType( ) ) {
+			case CColumn::TYPE_INT:
+				m_Integers[ i ].push_back( sum ? 0 : static_cast<const CIntColumn *>( column )->GetVal( row ) );
+				break;
+			case CColumn::TYPE_DOUBLE:
+				m_Doubles[ i ].push_back( sum ? 0 : static_cast<const CDoubleColumn *>( column )->GetVal( row ) );
+				break;
+			default: {
+				const auto * strings = static_cast<const CStringColumn *>( column );
+				m_Strings[ i ].emplace_back( strings->GetStr( row ), strings->GetStrLen( row ) );
+			}
+		}
+	}
+	return static_cast<uint32_t>( m_Counts.size( ) - 1 );
+}
+
+/**
+ * Places a new group into the hash table (linear probing), the table is doubled once it's half full.
+ */
+void CAggregateOperator::InsertSlot ( const uint32_t & group ) {
+	if ( ( group + 1 ) * 2 > m_Slots.size( ) ) {
+		m_Slots.assign( m_Slots.size( ) * 2, 0 );
+		m_Mask = m_Slots.size( ) - 1;
+		for ( uint32_t i = 0; i < group; ++ i )
+			InsertSlot( i );
+	}
+	uint64_t slot = m_Hashes[ group ] & m_Mask;
+	while ( m_Slots[ slot ] )
+		slot = ( slot + 1 ) & m_Mask;
+	m_Slots[ slot ] = group + 1;
+}
+
+/**
+ * Adds the input rows to the running aggregates of their groups, a typed loop per aggregate function.
+ * @param[in] columns input columns
+ * @param[in] groups group of each row
+ */
+void CAggregateOperator::Accumulate ( const vector<const CColumn *> & columns, const vector<uint32_t> & groups ) {
+	size_t rows = groups.size( );
+	for ( size_t i = 0; i < rows; ++ i )
+		++ m_Counts[ groups[ i ] ];
+
+	for ( size_t i = 0; i < m_Aggregates.size( ); ++ i ) {
+		CAggregate::EFunction function = m_Aggregates[ i ].m_Function;
+		if ( function == CAggregate::AGG_COUNT )
+			continue;
+		bool sum = function == CAggregate::AGG_SUM || function == CAggregate::AGG_AVG, min = function == CAggregate::AGG_MIN;
+		const CColumn * column = columns[ m_AggregateIndexes[ i ] ];
+		switch ( column->GetType( ) ) {
+			case CColumn::TYPE_INT: {
+				const int32_t * data = static_cast<const CIntColumn *>( column )->GetData( );
+				int64_t * state = m_Integers[ i ].data( );
+				if ( sum )
+					for ( size_t j = 0; j < rows; ++ j )
+						state[ groups[ j ] ] += data[ j ];
+				else if ( min )
+					for ( size_t j = 0; j < rows; ++ j )
+						state[ groups[ j ] ] = std::min<int64_t>( state[ groups[ j ] ], data[ j ] );
+				else
+					for ( size_t j = 0; j < rows; ++ j )
+						state[ groups[ j ] ] = std::max<int64_t>( state[ groups[ j ] ], data[ j ] );
+				break;
+			}
+			case CColumn::TYPE_DOUBLE: {
+				const double * data = static_cast<const CDoubleColumn *>( column )->GetData( );
+				double * state = m_Doubles[ i ].data( );
+				if ( sum )
+					for ( size_t j = 0; j < rows; ++ j )
+						state[ groups[ j ] ] += data[ j ];
+				else if ( min )
+					for ( size_t j = 0; j < rows; ++ j )
+						state[ groups[ j ] ] = std::min( state[ groups[ j ] ], data[ j ] );
+				else
+					for ( size_t j = 0; j < rows; ++ j )
+						state[ groups[ j ] ] = std::max( state[ groups[ j ] ], data[ j ] );
+				break;
+			}
+			default: {
+				// strings are compared as CStringColumn::Less compares them (bytewise)
+				const auto * strings = static_cast<const CStringColumn *>( column );
+				vector<string> & state = m_Strings[ i ];
+				for ( size_t j = 0; j < rows; ++ j ) {
+					int res = state[ groups[ j ] ].compare( 0, string::npos, strings->GetStr( j ), strings->GetStrLen( j ) );
+					if ( min ? res > 0 : res < 0 )
+						state[ groups[ j ] ].assign( strings->GetStr( j ), strings->GetStrLen( j ) );
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Creates the output columns from the group keys and the running aggregates, which are released.
+ * @return false (and reported) if a count doesn't fit the int column
+ */
+bool CAggregateOperator::Finish ( ) {
+	size_t groups = m_Counts.size( );
+	for ( unique_ptr<CColumn> & i : m_Keys )
+		m_Output.emplace_back( i.release( ) );
+	m_Keys.clear( );
+	m_KeyHash.reset( );
+
+	for ( size_t i = 0; i < m_Aggregates.size( ); ++ i ) {
+		CAggregate::EFunction function = m_Aggregates[ i ].m_Function;
+		CColumn::EType type = m_Types[ m_Groups.size( ) + i ];
+		CColumn * output = CColumn::Create( type );
+		m_Output.emplace_back( output );
+		output->Reserve( groups );
+
+		if ( function == CAggregate::AGG_SUM || function == CAggregate::AGG_AVG ) {
+			// the sums of ints are kept in 64 bits, the column holds them exactly up to 2^53
+			bool integers = ! m_Integers[ i ].empty( );
+			for ( size_t j = 0; j < groups; ++ j ) {
+				double sum = integers ? static_cast<double>( m_Integers[ i ][ j ] ) : m_Doubles[ i ][ j ];
+				static_cast<CDoubleColumn *>( output )->Append( function == CAggregate::AGG_SUM ? sum : sum / m_Counts[ j ] );
+			}
+		} else if ( type == CColumn::TYPE_INT ) {
+			const vector<int64_t> & values = function == CAggregate::AGG_COUNT ? m_Counts : m_Integers[ i ];
+			for ( size_t j = 0; j < groups; ++ j ) {
+				if ( values[ j ] < INT32_MIN || values[ j ] > INT32_MAX ) {
+					CLog::HighlightedMsg( CLog::QP, m_Aggregates[ i ].GetName( ), CLog::QP_AGG_OVERFLOW );
+					return false;
+				}
+				static_cast<CIntColumn *>( output )->Append( static_cast<int32_t>( values[ j ] ) );
+			}
+		} else if ( type == CColumn::TYPE_DOUBLE )
+			for ( size_t j = 0; j < groups; ++ j )
+				static_cast<CDoubleColumn *>( output )->Append( m_Doubles[ i ][ j ] );
+		else
+			for ( size_t j = 0; j < groups; ++ j )
+				static_cast<CStringColumn *>( output )->Append( m_Strings[ i ][ j ] );
+		m_Integers[ i ].clear( );
+		m_Doubles[ i ].clear( );
+		m_Strings[ i ].clear( );
+	}
+	m_Counts.clear( );
+	return true;
+}
+
+bool CAggregateOperator::NextBatch ( CBatch & batch ) {
+	batch.Clear( );
+	size_t size = m_Output.empty( ) ? 0 : m_Output.front( )->GetSize( );
+	if ( m_Position >= size )
+		return false;
+
+	vector<size_t> rows;
+	for ( size_t i = m_Position; i < size && rows.size( ) < BATCH_SIZE; ++ i )
+		rows.push_back( i );
+	m_Position += rows.size( );
+	for ( const unique_ptr<CColumn> & i : m_Output )
+		batch.m_Columns.emplace_back( i->Gather( rows ) );
+	return true;
+}
+
+void CAggregateOperator::Close ( ) {
+	m_Keys.clear( );
+	m_KeyHash.reset( );
+	m_Slots.clear( );
+	m_Hashes.clear( );
+	m_Counts.clear( );
+	m_Integers.clear( );
+	m_Doubles.clear( );
+	m_Strings.clear( );
+	m_Output.clear( );
+	m_Position = 0;
+}
+
+string CAggregateOperator::Describe ( ) const {
+	vector<string> names;
+	for ( const CAggregate & i : m_Aggregates )
+		names.push_back( i.GetName( ) );
+	string output = "AGGREGATE " + ListColumns( names );
+	if ( ! m_Groups.empty( ) )
+		output.append( " BY " ).append( ListColumns( m_Groups ) );
+	return output.append( IsSortBased( ) ? " (sort)" : " (hash)" );
+}
+
+/**
+ * A group per combination of the distinct values of the group columns, at most a group per input row.
+ */
+double CAggregateOperator::EstimateRows ( ) const {
+	double groups = 1;
+	for ( const size_t & i : m_GroupIndexes )
+		if ( i < m_Input->GetHeader( ).size( ) )
+			groups *= m_Input->EstimateDistinct( i );
+	return min( groups, m_Input->EstimateRows( ) );
+}
+
+/**
+ * The group columns keep the distinct values of the input columns.
+ */
+const CColumnStats * CAggregateOperator::GetColumnStats ( const size_t & column ) const {
+	return column < m_GroupIndexes.size( ) && m_GroupIndexes[ column ] < m_Input->GetHeader( ).size( ) ? m_Input->GetColumnStats( m_GroupIndexes[ column ] ) : nullptr;
+}
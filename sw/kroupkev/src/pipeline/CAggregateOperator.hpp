@@ -0,0 +1,79 @@
+#pragma once
+
+#include "COperator.hpp"
+#include "../database/CRowHash.hpp"
+#include "../database/CQuerySett.hpp"
+
+/**
+ * Aggregate function over a column of the aggregated rows (AGG), COUNT doesn't need the column.
+ */
+class CAggregate {
+public:
+	enum EFunction { AGG_COUNT, AGG_SUM, AGG_MIN, AGG_MAX, AGG_AVG };
+
+	EFunction m_Function = AGG_COUNT;
+	string m_Column;
+
+	static bool Parse ( const string & definition, CAggregate & output );
+	string GetName ( ) const;
+	string GetSQL ( ) const;
+};
+
+/**
+ * Groups the rows of its input by the group columns and aggregates each group (AGG). The output has the group columns,
+ * followed by a column per aggregate function, with a row per group in the order of the first input row of each group.
+ *
+ * The groups are found by a hash table over their keys (see CRowHash) and the input batches are aggregated as they are read,
+ * the stage keeps only the keys and the running aggregates of the groups. If they are estimated to exceed the memory budget
+ * (see CQuerySett::m_AggregateBudget), the input is stored and its rows are sorted by the group columns instead, a group
+ * is then a run of equal rows. Both ways produce the same output. The stage is blocking - the output is produced once it's opened.
+ *
+ * COUNT produces the int column, SUM and AVG the double column (the sums of ints are accumulated in 64 bits, so they don't overflow),
+ * MIN and MAX keep the type of their column.
+ */
+class CAggregateOperator : public COperator {
+private:
+	unique_ptr<COperator> m_Input;
+	vector<string> m_Groups;
+	vector<CAggregate> m_Aggregates;
+	vector<size_t> m_GroupIndexes;
+	vector<size_t> m_AggregateIndexes;
+	size_t m_Budget;
+
+	vector<unique_ptr<CColumn>> m_Keys;
+	unique_ptr<CRowHash> m_KeyHash;
+	vector<uint32_t> m_Slots;
+	vector<uint64_t> m_Hashes;
+	uint64_t m_Mask = 0;
+	vector<int64_t> m_Counts;
+	vector<vector<int64_t>> m_Integers;
+	vector<vector<double>> m_Doubles;
+	vector<vector<string>> m_Strings;
+
+	vector<unique_ptr<CColumn>> m_Output;
+	size_t m_Position = 0;
+
+	friend class COptimizer;
+
+	void FindColumns ( );
+	bool Validate ( ) const;
+	bool IsSortBased ( ) const;
+	bool AggregateHashed ( );
+	bool AggregateSorted ( );
+	void FindGroups ( const vector<const CColumn *> & columns, vector<uint32_t> & groups );
+	uint32_t CreateGroup ( const vector<const CColumn *> & columns, const size_t & row );
+	void InsertSlot ( const uint32_t & group );
+	void Accumulate ( const vector<const CColumn *> & columns, const vector<uint32_t> & groups );
+	bool Finish ( );
+
+public:
+	CAggregateOperator ( COperator * input, const vector<string> & groups, const vector<CAggregate> & aggregates );
+
+	virtual bool Open ( ) override;
+	virtual bool NextBatch ( CBatch & batch ) override;
+	virtual void Close ( ) override;
+	virtual string Describe ( ) const override;
+	virtual vector<const COperator *> GetInputs ( ) const override { return { m_Input.get( ) }; }
+	virtual double EstimateRows ( ) const override;
+	virtual const CColumnStats * GetColumnStats ( const size_t & column ) const override;
+};
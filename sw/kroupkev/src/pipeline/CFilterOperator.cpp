@@ -0,0 +1,140 @@
+#include "CFilterOperator.hpp"
+
+/**
+ * The conditions joined by AND are kept separately, so the optimizer can move each of them on its own.
+ * The constants of the condition are resolved by the input columns first (see CCondition::Resolve).
+ * @param[in] input input stage (owned by the filter)
+ * @param[in] condition the condition object
+ */
+CFilterOperator::CFilterOperator ( COperator * input, CCondition * condition )
+: m_Input( input ), m_Conditions( condition->GetConjuncts( ) ) {
+	m_Header = input->GetHeader( );
+	m_Types = input->GetTypes( );
+	condition->Resolve( m_Header, m_Types );
+	for ( const CCondition * i : m_Conditions )
+		m_Columns.push_back( i->GetColumns( ) );
+}
+
+/**
+ * @param[in] input input stage (owned by the filter)
+ * @param[in] conditions the condition objects, all of them have to be met
+ * @param[in] columns names of the input columns for each condition
+ */
+CFilterOperator::CFilterOperator ( COperator * input, const vector<CCondition *> & conditions, const vector<vector<string>> & columns )
+: m_Input( input ), m_Conditions( conditions ), m_Columns( columns ) {
+	m_Header = input->GetHeader( );
+	m_Types = input->GetTypes( );
+}
+
+bool CFilterOperator::Open ( ) {
+	if ( ! m_Input->Open( ) )
+		return false;
+
+	vector<vector<size_t>> indexes;
+	for ( const vector<string> & i : m_Columns ) {
+		indexes.emplace_back( );
+		for ( const string & j : i ) {
+			indexes.back( ).push_back( find( m_Header.begin( ), m_Header.end( ), j ) - m_Header.begin( ) );
+			if ( indexes.back( ).back( ) == m_Header.size( ) ) {
+				CLog::HighlightedMsg( CLog::QP, j, CLog::QP_NO_SUCH_COL );
+				return false;
+			}
+		}
+	}
+	m_Expression.reset( CExpression::Compile( m_Conditions, indexes, m_Types ) );
+	return m_Expression != nullptr;
+}
+
+bool CFilterOperator::NextBatch ( CBatch & batch ) {
+	vector<size_t> rows;
+	vector<const CColumn *> columns;
+	while ( m_Input->NextBatch( batch ) ) {
+		columns.clear( );
+		for ( const unique_ptr<CColumn> & i : batch.m_Columns )
+			columns.push_back( i.get( ) );
+		m_Expression->Select( columns, rows );
+		if ( rows.size( ) != batch.GetSize( ) )
+			for ( auto & j : batch.m_Columns )
+				j.reset( j->Gather( rows ) );
+		if ( batch.GetSize( ) )
+			return true;
+	}
+	return false;
+}
+
+void CFilterOperator::Close ( ) {
+	m_Input->Close( );
+	m_Expression.reset( );
+}
+
+/**
+ * A filter over a shared table keeps a selection of its rows (see CTable::GetFilteredTable).
+ */
+bool CFilterOperator::Share ( CTable * & output ) {
+	if ( ! m_Input->Share( output ) )
+		return false;
+	if ( ! output )
+		return true;
+
+	CTable * filtered = new CTable { };
+	if ( ! output->GetFilteredTable( m_Conditions, m_Columns, filtered ) ) {
+		delete filtered;
+		filtered = nullptr;
+	}
+	delete output;
+	output = filtered;
+	return true;
+}
+
+string CFilterOperator::Describe ( ) const {
+	string output = "FILTER ";
+	for ( size_t i = 0; i < m_Conditions.size( ); ++ i ) {
+		bool nested = m_Conditions.size( ) > 1 && m_Conditions[ i ]->m_Kind == CCondition::OR;
+		output += string( i ? " AND " : "" ) + ( nested ? "( " : "" ) + m_Conditions[ i ]->GetSQL( m_Columns[ i ] ) + ( nested ? " )" : "" );
+	}
+	return output;
+}
+
+/**
+ * Estimates the fraction of the rows matching a condition. The leaves are estimated by the statistics of their columns
+ * (see CColumnStats::Selectivity) and assumed to be independent.
+ * @param[in] columns names of the input columns of the condition
+ * @param[in, out] position index of the first column of the condition in the names
+ */
+double CFilterOperator::Selectivity ( const CCondition & condition, const vector<string> & columns, size_t & position ) const {
+	if ( condition.m_Kind == CCondition::NOT )
+		return 1 - Selectivity( * condition.m_Children.front( ), columns, position );
+	if ( condition.m_Kind == CCondition::AND || condition.m_Kind == CCondition::OR ) {
+		double none = 1, all = 1;
+		for ( const unique_ptr<CCondition> & i : condition.m_Children ) {
+			double selectivity = Selectivity( * i, columns, position );
+			all *= selectivity;
+			none *= 1 - selectivity;
+		}
+		return condition.m_Kind == CCondition::AND ? all : 1 - none;
+	}
+
+	const vector<string> & header = m_Input->GetHeader( );
+	size_t index = find( header.begin( ), header.end( ), columns[ position ] ) - header.begin( );
+	position += condition.IsColumnOperand ? 2 : 1;
+	if ( index == header.size( ) )
+		return 1;
+	const CColumnStats * stats = m_Input->GetColumnStats( index );
+	return stats ? stats->Selectivity( condition ) : CColumnStats::DefaultSelectivity( condition, m_Input->EstimateDistinct( index ) );
+}
+
+/**
+ * Conditions are assumed to be independent.
+ */
+double CFilterOperator::EstimateRows ( ) const {
+	double rows = m_Input->EstimateRows( );
+	for ( size_t i = 0; i < m_Conditions.size( ); ++ i ) {
+		size_t position = 0;
+		rows *= Selectivity( * m_Conditions[ i ], m_Columns[ i ], position );
+	}
+	return rows;
+}
+
+const CColumnStats * CFilterOperator::GetColumnStats ( const size_t & column ) const {
+	return m_Input->GetColumnStats( column );
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "COperator.hpp"
+#include "../database/CExpression.hpp"
+
+/**
+ * Keeps the rows of its input meeting all of its PRO conditions. The conditions are compiled into a single tree once the stage
+ * is opened (see CExpression), each batch is then evaluated in one pass and the matching rows are gathered at once.
+ *
+ * A condition may refer to its columns by names, which the columns have above the stage (e.g. "a.id" above a join),
+ * so the stage keeps the names of the input columns for each condition (in the order of CCondition::GetColumns).
+ * The conditions are owned by the queries.
+ */
+class CFilterOperator : public COperator {
+private:
+	unique_ptr<COperator> m_Input;
+	vector<CCondition *> m_Conditions;
+	vector<vector<string>> m_Columns;
+	unique_ptr<CExpression> m_Expression;
+
+	friend class COptimizer;
+
+	double Selectivity ( const CCondition & condition, const vector<string> & columns, size_t & position ) const;
+
+public:
+	CFilterOperator ( COperator * input, CCondition * condition );
+	CFilterOperator ( COperator * input, const vector<CCondition *> & conditions, const vector<vector<string>> & columns );
+
+	virtual bool Open ( ) override;
+	virtual bool NextBatch ( CBatch & batch ) override;
+	virtual void Close ( ) override;
+	virtual bool Share ( CTable * & output ) override;
+	virtual string Describe ( ) const override;
+	virtual vector<const COperator *> GetInputs ( ) const override { return { m_Input.get( ) }; }
+	virtual double EstimateRows ( ) const override;
+	virtual const CColumnStats * GetColumnStats ( const size_t & column ) const override;
+};
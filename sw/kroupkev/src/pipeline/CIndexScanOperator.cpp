@@ -0,0 +1,91 @@
+#include "CIndexScanOperator.hpp"
+
+/**
+ * @param[in] table the table
+ * @param[in] name name of the table, for the query plan
+ * @param[in] index index over the condition column
+ * @param[in] condition the condition object (owned by the query)
+ * @param[in] column index of the condition column in the table
+ */
+CIndexScanOperator::CIndexScanOperator ( const CTable & table, const string & name, const CIndex & index, CCondition * condition, const size_t & column )
+: m_Table( table ), m_Name( name ), m_Index( index ), m_Condition( condition ), m_Column( column ) {
+	m_Header = table.GetColumnNames( );
+	for ( size_t i = 0; i < m_Header.size( ); ++ i ) {
+		const CColumn * data = table.GetColumn( i );
+		m_Types.push_back( data ? data->GetType( ) : CColumn::TYPE_STRING );
+	}
+}
+
+/**
+ * Compiles the condition (the errors are reported the same way as by a filter) and looks up the matching rows.
+ * The column is scanned, if the index can't compare by the operator.
+ * @return false if the condition is invalid
+ */
+bool CIndexScanOperator::Lookup ( ) {
+	m_Rows.clear( );
+	unique_ptr<CPredicate> predicate ( CTable::CreatePredicate( m_Condition, m_Types[ m_Column ] ) );
+	if ( ! predicate )
+		return false;
+	unique_ptr<CColumn> constant ( predicate->CreateConstant( ) );
+	if ( ! m_Index.Select( predicate->GetOperator( ), * constant, m_Rows ) )
+		predicate->Select( * m_Table.GetColumn( m_Column ), m_Rows );
+	return true;
+}
+
+bool CIndexScanOperator::Open ( ) {
+	m_Position = 0;
+	return Lookup( );
+}
+
+bool CIndexScanOperator::NextBatch ( CBatch & batch ) {
+	batch.Clear( );
+	if ( m_Position >= m_Rows.size( ) )
+		return false;
+
+	size_t end = min( m_Rows.size( ), m_Position + BATCH_SIZE );
+	vector<size_t> rows ( m_Rows.begin( ) + m_Position, m_Rows.begin( ) + end );
+	m_Position = end;
+	for ( size_t i = 0; i < m_Header.size( ); ++ i )
+		batch.m_Columns.emplace_back( m_Table.GetColumn( i )->Gather( rows ) );
+	return true;
+}
+
+void CIndexScanOperator::Close ( ) {
+	m_Rows.clear( );
+	m_Rows.shrink_to_fit( );
+	m_Position = 0;
+}
+
+/**
+ * The table keeps a selection of the found rows (see CTable::GetSelectedTable), an empty result is reported.
+ */
+bool CIndexScanOperator::Share ( CTable * & output ) {
+	output = nullptr;
+	if ( ! Lookup( ) )
+		return true;
+	output = new CTable { };
+	if ( ! m_Table.GetSelectedTable( make_shared<vector<size_t>>( std::move( m_Rows ) ), output ) ) {
+		delete output;
+		output = nullptr;
+	}
+	m_Rows.clear( );
+	return true;
+}
+
+string CIndexScanOperator::Describe ( ) const {
+	return string( "INDEX SCAN " ).append( CLog::APP_COLOR_RESULT ).append( m_Name ).append( CLog::APP_COLOR_RESET )
+	.append( " USING " ).append( CIndex::GetKindName( m_Index.GetKind( ) ) ).append( " ( " )
+	.append( CLog::APP_COLOR_RESULT ).append( m_Header[ m_Column ] ).append( CLog::APP_COLOR_RESET ).append( " " ).append( m_Condition->m_Operator ).append( " " )
+	.append( CLog::APP_COLOR_RESULT )
+	.append( m_Condition->IsStringConstant ? string( "\"" ).append( m_Condition->m_Constant ).append( "\"" ) : m_Condition->m_Constant )
+	.append( CLog::APP_COLOR_RESET ).append( " )" );
+}
+
+double CIndexScanOperator::EstimateRows ( ) const {
+	const CColumnStats * stats = GetColumnStats( m_Column );
+	return m_Table.GetDataRowCount( ) * ( stats ? stats->Selectivity( * m_Condition ) : CColumnStats::DefaultSelectivity( * m_Condition, m_Table.GetDataRowCount( ) ) );
+}
+
+const CColumnStats * CIndexScanOperator::GetColumnStats ( const size_t & column ) const {
+	return m_Table.GetStatistics( ) ? m_Table.GetStatistics( )->GetColumn( column ) : nullptr;
+}
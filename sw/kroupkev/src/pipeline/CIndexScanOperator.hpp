@@ -0,0 +1,33 @@
+#pragma once
+
+#include "COperator.hpp"
+#include "../database/CPredicate.hpp"
+
+/**
+ * Reads the rows of a table meeting a PRO condition, which are looked up by an index over the condition column
+ * (see CIndex) instead of scanning the whole column. The optimizer replaces a filter over a table scan by this stage
+ * (see COptimizer), the rows keep their order. The table, the index and the condition have to outlive the stage.
+ */
+class CIndexScanOperator : public COperator {
+private:
+	const CTable & m_Table;
+	string m_Name;
+	const CIndex & m_Index;
+	CCondition * m_Condition;
+	size_t m_Column;
+	vector<size_t> m_Rows;
+	size_t m_Position = 0;
+
+	bool Lookup ( );
+
+public:
+	CIndexScanOperator ( const CTable & table, const string & name, const CIndex & index, CCondition * condition, const size_t & column );
+
+	virtual bool Open ( ) override;
+	virtual bool NextBatch ( CBatch & batch ) override;
+	virtual void Close ( ) override;
+	virtual bool Share ( CTable * & output ) override;
+	virtual string Describe ( ) const override;
+	virtual double EstimateRows ( ) const override;
+	virtual const CColumnStats * GetColumnStats ( const size_t & column ) const override;
+};
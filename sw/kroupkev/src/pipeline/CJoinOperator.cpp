@@ -0,0 +1,131 @@
+#include "CJoinOperator.hpp"
+
+/**
+ * @param[in] left left input (owned by the join)
+ * @param[in] right right input (owned by the join)
+ * @param[in] keys names of the key columns (both inputs must have them)
+ * @param[in] columns input columns of the output
+ * @param[in] header names of the output columns
+ */
+CJoinOperator::CJoinOperator ( COperator * left, COperator * right, const vector<string> & keys, const vector<TColumnRef> & columns, const vector<string> & header )
+: m_Left( left ), m_Right( right ), m_Keys( keys ), m_Columns( columns ) {
+	m_Header = header;
+	for ( const TColumnRef & i : columns )
+		m_Types.push_back( ( i.first ? right : left )->GetTypes( )[ i.second ] );
+}
+
+bool CJoinOperator::Open ( ) {
+	// the right input isn't evaluated, if the left one failed
+	m_LeftTable.reset( Materialize( * m_Left ) );
+	if ( ! m_LeftTable )
+		return false;
+	m_RightTable.reset( Materialize( * m_Right ) );
+	if ( ! m_RightTable )
+		return false;
+	if ( ! m_IndexJoin || ! IndexJoin( ) )
+		m_Matches = m_RightTable->FindOccurences( * m_LeftTable, m_Keys );
+	m_Position = 0;
+	return true;
+}
+
+/**
+ * Looks up the rows of an input in the index of the other one (chosen by the optimizer, see COptimizer::IndexJoin).
+ * The pairs found by the index of the left input are ordered by the right row, so they're sorted again.
+ * @return false if the index can't be used (nothing is matched then)
+ */
+bool CJoinOperator::IndexJoin ( ) {
+	size_t left, right;
+	if ( m_Keys.size( ) != 1 || ! m_LeftTable->VerifyColumn( m_Keys.front( ), left ) || ! m_RightTable->VerifyColumn( m_Keys.front( ), right ) )
+		return false;
+	const CColumn * keyLeft = m_LeftTable->GetColumn( left ), * keyRight = m_RightTable->GetColumn( right );
+	if ( ! keyLeft || ! keyRight )
+		return false;
+
+	const CIndex * index = m_IndexRight ? m_Right->GetIndex( right ) : m_Left->GetIndex( left );
+	if ( ! index )
+		return false;
+	if ( m_IndexRight )
+		m_Matches = index->Join( * keyLeft );
+	else {
+		m_Matches = index->Join( * keyRight );
+		for ( auto & i : m_Matches )
+			swap( i.first, i.second );
+		sort( m_Matches.begin( ), m_Matches.end( ) );
+	}
+
+	// header is the row 0
+	for ( auto & i : m_Matches ) {
+		++ i.first;
+		++ i.second;
+	}
+	return true;
+}
+
+bool CJoinOperator::NextBatch ( CBatch & batch ) {
+	batch.Clear( );
+	if ( m_Position >= m_Matches.size( ) )
+		return false;
+
+	// header is the row 0 of the matches
+	vector<size_t> rowsLeft, rowsRight;
+	for ( ; m_Position < m_Matches.size( ) && rowsLeft.size( ) < BATCH_SIZE; ++ m_Position ) {
+		rowsLeft.push_back( m_Matches[ m_Position ].first - 1 );
+		rowsRight.push_back( m_Matches[ m_Position ].second - 1 );
+	}
+	for ( const TColumnRef & i : m_Columns ) {
+		const CTable & table = i.first ? * m_RightTable : * m_LeftTable;
+		batch.m_Columns.emplace_back( table.GetColumn( i.second )->Gather( i.first ? rowsRight : rowsLeft ) );
+	}
+	return true;
+}
+
+/**
+ * Releases the inputs and the pairs. The pairs are handed over instead, if they are kept (zero-based then, see Keep).
+ */
+void CJoinOperator::Close ( ) {
+	m_LeftTable.reset( );
+	m_RightTable.reset( );
+	if ( m_Kept ) {
+		for ( auto & i : m_Matches ) {
+			-- i.first;
+			-- i.second;
+		}
+		m_Kept->swap( m_Matches );
+	}
+	m_Matches.clear( );
+	m_Matches.shrink_to_fit( );
+}
+
+string CJoinOperator::Describe ( ) const {
+	return string( m_IndexJoin ? "INDEX " : "" ) + "JOIN USING ( " + ListColumns( m_Keys ) + " ) ( " + ListColumns( m_Header ) + " )";
+}
+
+/**
+ * Estimates the size of a join - each key divides the product of the inputs by the larger number of its distinct values
+ * (a value of the smaller domain is assumed to be in the larger one, the keys are assumed to be independent).
+ * @param[in] left left input
+ * @param[in] right right input
+ * @param[in] keys names of the key columns
+ */
+double CJoinOperator::Estimate ( const COperator & left, const COperator & right, const vector<string> & keys ) {
+	const vector<string> & headerLeft = left.GetHeader( ), & headerRight = right.GetHeader( );
+	double rows = left.EstimateRows( ) * right.EstimateRows( );
+	for ( const string & i : keys ) {
+		size_t indexLeft = find( headerLeft.begin( ), headerLeft.end( ), i ) - headerLeft.begin( );
+		size_t indexRight = find( headerRight.begin( ), headerRight.end( ), i ) - headerRight.begin( );
+		if ( indexLeft == headerLeft.size( ) || indexRight == headerRight.size( ) )
+			return 0;
+		double distinct = max( left.EstimateDistinct( indexLeft ), right.EstimateDistinct( indexRight ) );
+		if ( distinct >= 1 )
+			rows /= distinct;
+	}
+	return rows;
+}
+
+double CJoinOperator::EstimateRows ( ) const {
+	return Estimate( * m_Left, * m_Right, m_Keys );
+}
+
+const CColumnStats * CJoinOperator::GetColumnStats ( const size_t & column ) const {
+	return column < m_Columns.size( ) ? ( m_Columns[ column ].first ? m_Right : m_Left )->GetColumnStats( m_Columns[ column ].second ) : nullptr;
+}
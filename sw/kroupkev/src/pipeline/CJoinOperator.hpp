@@ -0,0 +1,51 @@
+#pragma once
+
+#include <utility>
+
+#include "COperator.hpp"
+#include "../database/CQuerySett.hpp"
+
+/**
+ * Joins the rows of two inputs with equal values in the key columns (JOIN, NJOIN). The stage is blocking -
+ * both inputs are stored once it's opened, matched by the join algorithm chosen by the query settings (see CTable::FindOccurences)
+ * and the matching pairs are then gathered into the batches. Pairs are ordered by the left row, then by the right one.
+ *
+ * If an input is a table with an index over the (only) key column (see CDatabase::CreateIndex) and the other input is estimated
+ * to be smaller, the optimizer lets the join look up the rows of the other input in the index instead (index nested loop join).
+ *
+ * The matching pairs can be handed over once the stage is closed (see Keep), so a saved join can merge the pairs
+ * of the appended rows into them (see CBinaryQuery::RefreshJoin).
+ */
+class CJoinOperator : public COperator {
+private:
+	unique_ptr<COperator> m_Left;
+	unique_ptr<COperator> m_Right;
+	vector<string> m_Keys;
+	vector<TColumnRef> m_Columns;
+
+	unique_ptr<CTable> m_LeftTable;
+	unique_ptr<CTable> m_RightTable;
+	vector<pair<size_t, size_t>> m_Matches;
+	size_t m_Position = 0;
+	bool m_IndexJoin = false;
+	bool m_IndexRight = false;
+	vector<pair<size_t, size_t>> * m_Kept = nullptr;
+
+	friend class COptimizer;
+
+	bool IndexJoin ( );
+
+public:
+	CJoinOperator ( COperator * left, COperator * right, const vector<string> & keys, const vector<TColumnRef> & columns, const vector<string> & header );
+
+	static double Estimate ( const COperator & left, const COperator & right, const vector<string> & keys );
+	void Keep ( vector<pair<size_t, size_t>> * matches ) { m_Kept = matches; }
+
+	virtual bool Open ( ) override;
+	virtual bool NextBatch ( CBatch & batch ) override;
+	virtual void Close ( ) override;
+	virtual string Describe ( ) const override;
+	virtual vector<const COperator *> GetInputs ( ) const override { return { m_Left.get( ), m_Right.get( ) }; }
+	virtual double EstimateRows ( ) const override;
+	virtual const CColumnStats * GetColumnStats ( const size_t & column ) const override;
+};
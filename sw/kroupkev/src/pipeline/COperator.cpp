@@ -0,0 +1,76 @@
+#include "COperator.hpp"
+
+#include <cmath>
+
+const size_t COperator::BATCH_SIZE = 1024;
+
+/**
+ * Verifies if the stage output has any duplicate columns.
+ */
+bool COperator::HasDuplicateColumns ( ) const {
+	vector<string> header = m_Header;
+	sort( header.begin( ), header.end( ) );
+	return adjacent_find( header.begin( ), header.end( ) ) != header.end( );
+}
+
+/**
+ * Estimates the number of distinct values in an output column, it can't exceed the number of the output rows.
+ * @param[in] column index of the output column
+ */
+double COperator::EstimateDistinct ( const size_t & column ) const {
+	const CColumnStats * stats = GetColumnStats( column );
+	return stats ? min( stats->GetDistinct( ), EstimateRows( ) ) : EstimateRows( );
+}
+
+/**
+ * Describes the stage and its inputs, a line per stage with its estimated number of rows. The inputs are indented below their stage.
+ * @param[out] lines lines of the plan
+ * @param[in] depth depth of the stage in the tree
+ */
+void COperator::Explain ( vector<string> & lines, const size_t & depth ) const {
+	lines.push_back( string( depth * 2, ' ' ).append( Describe( ) ).append( " [~" ).append( to_string( llround( EstimateRows( ) ) ) ).append( " rows]" ) );
+	for ( const COperator * i : GetInputs( ) )
+		i->Explain( lines, depth + 1 );
+}
+
+/**
+ * Lists the column names for the query plan.
+ */
+string COperator::ListColumns ( const vector<string> & names ) {
+	string output;
+	for ( size_t i = 0; i < names.size( ); ++ i )
+		output += string( i ? ", " : "" ).append( CLog::APP_COLOR_RESULT ).append( names[ i ] ).append( CLog::APP_COLOR_RESET );
+	return output;
+}
+
+/**
+ * Evaluates the pipeline and stores its output. The stage is shared if possible, otherwise all its batches are pulled
+ * and appended to the result columns.
+ * @param[in] root root stage of the pipeline
+ * @return the result table (owned by the caller), nullptr if the pipeline failed
+ */
+CTable * COperator::Materialize ( COperator & root ) {
+	CTable * shared;
+	if ( root.Share( shared ) )
+		return shared;
+
+	if ( ! root.Open( ) ) {
+		root.Close( );
+		return nullptr;
+	}
+	vector<CColumn *> columns;
+	CBatch batch;
+	while ( root.NextBatch( batch ) ) {
+		for ( size_t i = 0; i < batch.m_Columns.size( ); ++ i ) {
+			if ( columns.size( ) <= i )
+				columns.push_back( batch.m_Columns[ i ].release( ) );
+			else
+				columns[ i ]->AppendColumn( * batch.m_Columns[ i ] );
+		}
+	}
+	root.Close( );
+
+	if ( columns.empty( ) )
+		return new CTable { root.m_Header };
+	return new CTable { root.m_Header, columns };
+}
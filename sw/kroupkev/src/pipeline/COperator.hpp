@@ -0,0 +1,87 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <utility>
+
+#include "../database/CTable.hpp"
+#include "../database/CColumn.hpp"
+#include "../database/CCondition.hpp"
+#include "../database/CIndex.hpp"
+
+using namespace std;
+
+/**
+ * Rows passed between the pipeline stages - one column per stage output column, each up to COperator::BATCH_SIZE rows long.
+ * The batch owns its columns, a stage may move them on to the next batch instead of copying them.
+ */
+class CBatch {
+public:
+	vector<unique_ptr<CColumn>> m_Columns;
+
+	size_t GetSize ( ) const { return m_Columns.empty( ) ? 0 : m_Columns.front( )->GetSize( ); }
+	void Clear ( ) { m_Columns.clear( ); }
+};
+
+/**
+ * This module is a stage of the query execution pipeline. A query (see CTableQuery) is evaluated as a tree of stages,
+ * the root stage pulls the batches of rows from its inputs (Open, NextBatch, Close) and only the rows of the final result
+ * are stored (Materialize). Blocking stages (join, set operations) store their inputs until they are closed.
+ *
+ * The header and the column types of the stage output are known once the stage is created, so a query can validate
+ * its operands and the tree can be rewritten (see COptimizer) before anything is evaluated. A stage, which is only a view
+ * of an existing table (scan, column selection, filter over a table), can share the column data of that table instead
+ * of producing the batches (Share).
+ */
+class COperator {
+public:
+	static const size_t BATCH_SIZE;
+
+	/** Column of the left ( false ) or the right ( true ) input of a binary stage. */
+	typedef pair<bool, size_t> TColumnRef;
+
+	virtual ~COperator ( ) = default;
+
+	/** Prepares the stage and its inputs. False is returned (and reported) if the stage can't be evaluated. */
+	virtual bool Open ( ) = 0;
+
+	/** Produces the next batch of rows. False is returned once the output is exhausted. */
+	virtual bool NextBatch ( CBatch & batch ) = 0;
+
+	/** Releases everything the stage stored while it was open. */
+	virtual void Close ( ) = 0;
+
+	/** Creates the output as a table sharing the source columns, the output is nullptr if the stage failed. False is returned if the stage can't share its output. */
+	virtual bool Share ( CTable * & output ) { return false; }
+
+	/** Describes the stage in a line of the query plan. */
+	virtual string Describe ( ) const = 0;
+
+	/** Returns the input stages. */
+	virtual vector<const COperator *> GetInputs ( ) const { return { }; }
+
+	/** Estimates the number of output rows by the table statistics (see CStatistics), before the stage is evaluated. */
+	virtual double EstimateRows ( ) const = 0;
+
+	/** Returns the statistics of the table column an output column comes from, nullptr if there are none. */
+	virtual const CColumnStats * GetColumnStats ( const size_t & column ) const { return nullptr; }
+
+	/** Returns an index over an output column, which finds the output rows (a table scan, see CDatabase::CreateIndex), nullptr if there is none. A range index (sorted) may be required. */
+	virtual const CIndex * GetIndex ( const size_t & column, const bool & range = false ) const { return nullptr; }
+
+	double EstimateDistinct ( const size_t & column ) const;
+
+	void Explain ( vector<string> & lines, const size_t & depth = 0 ) const;
+	const vector<string> & GetHeader ( ) const { return m_Header; }
+	const vector<CColumn::EType> & GetTypes ( ) const { return m_Types; }
+	bool HasDuplicateColumns ( ) const;
+
+	static CTable * Materialize ( COperator & root );
+
+protected:
+	vector<string> m_Header;
+	vector<CColumn::EType> m_Types;
+
+	static string ListColumns ( const vector<string> & names );
+};
@@ -0,0 +1,347 @@
+#include "COptimizer.hpp"
+
+const double COptimizer::INDEX_SELECTIVITY = 0.2;
+
+/**
+ * Rewrites the tree of stages.
+ * @param[in] root root stage of the tree (owned by the caller)
+ * @return root stage of the rewritten tree (owned by the caller), the original root may have been deleted
+ */
+COperator * COptimizer::Optimize ( COperator * root ) {
+	root = Rewrite( root );
+	root = ReorderJoins( root );
+	root = UseIndexes( root );
+	Prune( * root, set<string>( root->GetHeader( ).begin( ), root->GetHeader( ).end( ) ) );
+	return root;
+}
+
+/**
+ * Input stages of a stage, so they can be replaced.
+ */
+vector<unique_ptr<COperator> *> COptimizer::GetInputs ( COperator & stage ) {
+	if ( CFilterOperator * filter = dynamic_cast<CFilterOperator *>( & stage ) )
+		return { & filter->m_Input };
+	if ( CSelectOperator * select = dynamic_cast<CSelectOperator *>( & stage ) )
+		return { & select->m_Input };
+	if ( CJoinOperator * join = dynamic_cast<CJoinOperator *>( & stage ) )
+		return { & join->m_Left, & join->m_Right };
+	if ( CProductOperator * product = dynamic_cast<CProductOperator *>( & stage ) )
+		return { & product->m_Left, & product->m_Right };
+	if ( CSetOperator * setOperation = dynamic_cast<CSetOperator *>( & stage ) )
+		return { & setOperation->m_Left, & setOperation->m_Right };
+	if ( CAggregateOperator * aggregate = dynamic_cast<CAggregateOperator *>( & stage ) )
+		return { & aggregate->m_Input };
+	if ( CSortOperator * sort = dynamic_cast<CSortOperator *>( & stage ) )
+		return { & sort->m_Input };
+	return { };
+}
+
+/**
+ * Pushes the filters down the tree, the inputs are rewritten first.
+ */
+COperator * COptimizer::Rewrite ( COperator * root ) {
+	for ( unique_ptr<COperator> * i : GetInputs( * root ) )
+		i->reset( Rewrite( i->release( ) ) );
+	CFilterOperator * filter = dynamic_cast<CFilterOperator *>( root );
+	return filter ? PushFilter( filter ) : root;
+}
+
+/**
+ * Places a filter as low as possible, its input was already rewritten.
+ * @param[in] filter the filter (owned by the caller)
+ * @return the stage replacing the filter (owned by the caller)
+ */
+COperator * COptimizer::PushFilter ( CFilterOperator * filter ) {
+	COperator * input = filter->m_Input.get( );
+
+	// consecutive filters are merged, the inner conditions are evaluated first
+	if ( CFilterOperator * inner = dynamic_cast<CFilterOperator *>( input ) ) {
+		filter->m_Input.release( );
+		inner->m_Conditions.insert( inner->m_Conditions.end( ), filter->m_Conditions.begin( ), filter->m_Conditions.end( ) );
+		inner->m_Columns.insert( inner->m_Columns.end( ), filter->m_Columns.begin( ), filter->m_Columns.end( ) );
+		delete filter;
+		return PushFilter( inner );
+	}
+
+	// a selection keeps the column names, but the filter may only use the selected columns
+	if ( CSelectOperator * select = dynamic_cast<CSelectOperator *>( input ) ) {
+		for ( const vector<string> & i : filter->m_Columns )
+			for ( const string & j : i )
+				if ( find( select->m_Header.begin( ), select->m_Header.end( ), j ) == select->m_Header.end( ) )
+					return filter;
+		filter->m_Input.release( );
+		filter->m_Input.reset( select->m_Input.release( ) );
+		filter->m_Header = filter->m_Input->GetHeader( );
+		filter->m_Types = filter->m_Input->GetTypes( );
+		select->m_Input.reset( PushFilter( filter ) );
+		select->FindColumns( );
+		return select;
+	}
+
+	if ( CJoinOperator * join = dynamic_cast<CJoinOperator *>( input ) )
+		return SplitFilter( filter, join, join->m_Left, join->m_Right, join->m_Columns );
+	CProductOperator * product = dynamic_cast<CProductOperator *>( input );
+	if ( product && ! product->IsPaged( ) )
+		return SplitFilter( filter, product, product->m_Left, product->m_Right, product->m_Columns );
+	return filter;
+}
+
+/**
+ * Moves the conditions of a filter over a binary stage (join, product) to the inputs their columns come from.
+ * A condition over the columns of both inputs (e.g. OR of them) is kept in the filter.
+ * @param[in] filter the filter (owned by the caller)
+ * @param[in] input the binary stage below the filter
+ * @param[in, out] left left input of the binary stage
+ * @param[in, out] right right input of the binary stage
+ * @param[in] columns input columns of the binary stage output
+ * @return the filter with the conditions left, or the binary stage, if all of them were moved
+ */
+COperator * COptimizer::SplitFilter ( CFilterOperator * filter, COperator * input, unique_ptr<COperator> & left, unique_ptr<COperator> & right, const vector<COperator::TColumnRef> & columns ) {
+	vector<CCondition *> kept, leftConditions, rightConditions;
+	vector<vector<string>> keptColumns, leftColumns, rightColumns;
+	for ( size_t i = 0; i < filter->m_Conditions.size( ); ++ i ) {
+		// the condition goes to a side, if all its columns come from it
+		vector<string> names;
+		int side = -1;
+		for ( const string & j : filter->m_Columns[ i ] ) {
+			size_t index = find( filter->m_Header.begin( ), filter->m_Header.end( ), j ) - filter->m_Header.begin( );
+			if ( index == filter->m_Header.size( ) || ( side != -1 && side != columns[ index ].first ) ) {
+				side = -1;
+				break;
+			}
+			side = columns[ index ].first;
+			names.push_back( ( side ? right : left )->GetHeader( )[ columns[ index ].second ] );
+		}
+		if ( side == -1 ) {
+			kept.push_back( filter->m_Conditions[ i ] );
+			keptColumns.push_back( filter->m_Columns[ i ] );
+			continue;
+		}
+		( side ? rightConditions : leftConditions ).push_back( filter->m_Conditions[ i ] );
+		( side ? rightColumns : leftColumns ).push_back( names );
+	}
+
+	if ( ! leftConditions.empty( ) )
+		left.reset( PushFilter( new CFilterOperator( left.release( ), leftConditions, leftColumns ) ) );
+	if ( ! rightConditions.empty( ) )
+		right.reset( PushFilter( new CFilterOperator( right.release( ), rightConditions, rightColumns ) ) );
+	if ( ! kept.empty( ) ) {
+		filter->m_Conditions = kept;
+		filter->m_Columns = keptColumns;
+		return filter;
+	}
+	filter->m_Input.release( );
+	delete filter;
+	return input;
+}
+
+/**
+ * Reorders the chains of joins in the tree, the inputs are reordered first.
+ */
+COperator * COptimizer::ReorderJoins ( COperator * root ) {
+	for ( unique_ptr<COperator> * i : GetInputs( * root ) )
+		i->reset( ReorderJoins( i->release( ) ) );
+	CJoinOperator * join = dynamic_cast<CJoinOperator *>( root );
+	return join ? RotateJoin( join ) : root;
+}
+
+/**
+ * Evaluates ( A join B ) join C as A join ( B join C ), if the keys of the outer join are columns of B
+ * and the join of B and C is estimated to be smaller than the join of A and B.
+ * Both trees pair the rows of A, B and C in the same order, the output header is kept as well.
+ * @param[in] join the outer join (owned by the caller)
+ * @return the stage replacing the join (owned by the caller)
+ */
+COperator * COptimizer::RotateJoin ( CJoinOperator * join ) {
+	CJoinOperator * inner = dynamic_cast<CJoinOperator *>( join->m_Left.get( ) );
+	if ( ! inner )
+		return join;
+	const vector<string> & headerB = inner->m_Right->GetHeader( ), & headerC = join->m_Right->GetHeader( );
+
+	// the outer keys come from B with the same names, the other columns of B and C differ in their names
+	for ( const string & i : join->m_Keys ) {
+		size_t index = find( inner->m_Header.begin( ), inner->m_Header.end( ), i ) - inner->m_Header.begin( );
+		if ( index == inner->m_Header.size( ) || ! inner->m_Columns[ index ].first || headerB[ inner->m_Columns[ index ].second ] != i )
+			return join;
+	}
+	vector<size_t> otherC;
+	for ( size_t i = 0; i < headerC.size( ); ++ i ) {
+		if ( find( join->m_Keys.begin( ), join->m_Keys.end( ), headerC[ i ] ) != join->m_Keys.end( ) )
+			continue;
+		if ( find( headerB.begin( ), headerB.end( ), headerC[ i ] ) != headerB.end( ) )
+			return join;
+		otherC.push_back( i );
+	}
+	if ( CJoinOperator::Estimate( * inner->m_Right, * join->m_Right, join->m_Keys ) >= CJoinOperator::Estimate( * inner->m_Left, * inner->m_Right, inner->m_Keys ) )
+		return join;
+
+	// B join C has all the columns of B, then the other columns of C
+	vector<COperator::TColumnRef> columnsBC, columns;
+	vector<string> headerBC = headerB;
+	for ( size_t i = 0; i < headerB.size( ); ++ i )
+		columnsBC.emplace_back( false, i );
+	for ( const size_t & i : otherC ) {
+		columnsBC.emplace_back( true, i );
+		headerBC.push_back( headerC[ i ] );
+	}
+	for ( const COperator::TColumnRef & i : join->m_Columns ) {
+		if ( ! i.first ) {
+			columns.push_back( inner->m_Columns[ i.second ] );
+			continue;
+		}
+		size_t index = find( otherC.begin( ), otherC.end( ), i.second ) - otherC.begin( );
+		if ( index == otherC.size( ) )
+			return join;
+		columns.emplace_back( true, headerB.size( ) + index );
+	}
+
+	COperator * joinBC = new CJoinOperator( inner->m_Right.release( ), join->m_Right.release( ), join->m_Keys, columnsBC, headerBC );
+	COperator * rotated = new CJoinOperator( inner->m_Left.release( ), RotateJoin( static_cast<CJoinOperator *>( joinBC ) ), inner->m_Keys, columns, join->m_Header );
+	delete join;
+	return RotateJoin( static_cast<CJoinOperator *>( rotated ) );
+}
+
+/**
+ * Replaces the filters over the table scans by the index scans, the inputs are replaced first. Only the first condition
+ * of a filter is looked up (the conditions are evaluated in their order), the rest of them is kept in the filter.
+ * A range can only be found by a sorted index, the inequality and the compound conditions by none.
+ * The joins choose the index of an input as well (see IndexJoin).
+ */
+COperator * COptimizer::UseIndexes ( COperator * root ) {
+	for ( unique_ptr<COperator> * i : GetInputs( * root ) )
+		i->reset( UseIndexes( i->release( ) ) );
+	if ( CJoinOperator * join = dynamic_cast<CJoinOperator *>( root ) ) {
+		IndexJoin( * join );
+		return root;
+	}
+	CFilterOperator * filter = dynamic_cast<CFilterOperator *>( root );
+	CScanOperator * scan = filter ? dynamic_cast<CScanOperator *>( filter->m_Input.get( ) ) : nullptr;
+	if ( ! scan )
+		return root;
+
+	CCondition * condition = filter->m_Conditions.front( );
+	if ( condition->m_Kind != CCondition::COMPARE || condition->IsColumnOperand )
+		return root;
+	const vector<string> & header = scan->GetHeader( );
+	size_t column = find( header.begin( ), header.end( ), filter->m_Columns.front( ).front( ) ) - header.begin( );
+	CKernel::EOperator op;
+	if ( column == header.size( ) || ! CPredicate::ParseOperator( condition->m_Operator, op ) || op == CKernel::OP_NE )
+		return root;
+	const CIndex * index = scan->GetIndex( column, op != CKernel::OP_EQ );
+	const CColumnStats * stats = scan->GetColumnStats( column );
+	if ( ! index || ( stats ? stats->Selectivity( * condition ) : CColumnStats::DefaultSelectivity( * condition, scan->EstimateDistinct( column ) ) ) > INDEX_SELECTIVITY )
+		return root;
+
+	COperator * indexScan = new CIndexScanOperator( scan->m_Table, scan->m_Name, * index, condition, column );
+	if ( filter->m_Conditions.size( ) == 1 ) {
+		delete filter;
+		return indexScan;
+	}
+	filter->m_Conditions.erase( filter->m_Conditions.begin( ) );
+	filter->m_Columns.erase( filter->m_Columns.begin( ) );
+	filter->m_Input.reset( indexScan );
+	return filter;
+}
+
+/**
+ * Removes the columns, which are not needed above the stage, from the output of joins and products in the tree.
+ * @param[in, out] root root stage of the tree
+ * @param[in] required names of the output columns needed above the stage
+ */
+void COptimizer::Prune ( COperator & root, const set<string> & required ) {
+	if ( CFilterOperator * filter = dynamic_cast<CFilterOperator *>( & root ) ) {
+		set<string> needed = required;
+		for ( const vector<string> & i : filter->m_Columns )
+			needed.insert( i.begin( ), i.end( ) );
+		Prune( * filter->m_Input, needed );
+		filter->m_Header = filter->m_Input->GetHeader( );
+		filter->m_Types = filter->m_Input->GetTypes( );
+	} else if ( CSelectOperator * select = dynamic_cast<CSelectOperator *>( & root ) ) {
+		const vector<string> & header = select->m_Input->GetHeader( );
+		bool all = select->m_Selected.size( ) == 1 && select->m_Selected.front( ) == "*";
+		Prune( * select->m_Input, all ? set<string>( header.begin( ), header.end( ) ) : set<string>( select->m_Selected.begin( ), select->m_Selected.end( ) ) );
+		select->FindColumns( );
+	} else if ( CAggregateOperator * aggregate = dynamic_cast<CAggregateOperator *>( & root ) ) {
+		// the input of a single group without any aggregated columns only needs its rows
+		set<string> needed ( aggregate->m_Groups.begin( ), aggregate->m_Groups.end( ) );
+		for ( const CAggregate & i : aggregate->m_Aggregates )
+			if ( ! i.m_Column.empty( ) )
+				needed.insert( i.m_Column );
+		if ( needed.empty( ) )
+			needed.insert( aggregate->m_Input->GetHeader( ).front( ) );
+		Prune( * aggregate->m_Input, needed );
+		aggregate->FindColumns( );
+	} else if ( CSortOperator * sort = dynamic_cast<CSortOperator *>( & root ) ) {
+		set<string> needed = required;
+		needed.insert( sort->m_Keys.begin( ), sort->m_Keys.end( ) );
+		Prune( * sort->m_Input, needed );
+		sort->FindColumns( );
+	} else if ( CJoinOperator * join = dynamic_cast<CJoinOperator *>( & root ) )
+		PruneInputs( root, join->m_Left, join->m_Right, join->m_Columns, join->m_Header, join->m_Types, required, join->m_Keys );
+	else if ( CProductOperator * product = dynamic_cast<CProductOperator *>( & root ) )
+		PruneInputs( root, product->m_Left, product->m_Right, product->m_Columns, product->m_Header, product->m_Types, required, { } );
+}
+
+/**
+ * Lets a join by a single column look up the rows of the input estimated to be smaller in the index of the other one
+ * (see CJoinOperator), unless the join algorithm is forced by the query settings.
+ * @param[in, out] join the join
+ */
+void COptimizer::IndexJoin ( CJoinOperator & join ) {
+	join.m_IndexJoin = false;
+	if ( CQuerySett::m_JoinAlgorithm != CQuerySett::JOIN_AUTO || join.m_Keys.size( ) != 1 )
+		return;
+	const vector<string> & headerLeft = join.m_Left->GetHeader( ), & headerRight = join.m_Right->GetHeader( );
+	size_t left = find( headerLeft.begin( ), headerLeft.end( ), join.m_Keys.front( ) ) - headerLeft.begin( );
+	size_t right = find( headerRight.begin( ), headerRight.end( ), join.m_Keys.front( ) ) - headerRight.begin( );
+	if ( left == headerLeft.size( ) || right == headerRight.size( ) )
+		return;
+
+	double rowsLeft = join.m_Left->EstimateRows( ), rowsRight = join.m_Right->EstimateRows( );
+	if ( rowsLeft < rowsRight && join.m_Right->GetIndex( right ) )
+		join.m_IndexJoin = join.m_IndexRight = true;
+	else if ( rowsRight < rowsLeft && join.m_Left->GetIndex( left ) ) {
+		join.m_IndexJoin = true;
+		join.m_IndexRight = false;
+	}
+}
+
+/**
+ * Keeps the required output columns of a binary stage (join, product) only and prunes its inputs.
+ * The key columns of a join are always needed, each input of a product keeps a column at least (its rows are paired).
+ */
+void COptimizer::PruneInputs ( COperator & stage, unique_ptr<COperator> & left, unique_ptr<COperator> & right, vector<COperator::TColumnRef> & columns,
+                               vector<string> & header, vector<CColumn::EType> & types, const set<string> & required, const vector<string> & keys ) {
+	vector<COperator::TColumnRef> keptColumns;
+	vector<string> keptHeader;
+	vector<CColumn::EType> keptTypes;
+	for ( size_t i = 0; i < header.size( ); ++ i ) {
+		if ( ! required.count( header[ i ] ) )
+			continue;
+		keptColumns.push_back( columns[ i ] );
+		keptHeader.push_back( header[ i ] );
+		keptTypes.push_back( types[ i ] );
+	}
+	if ( keptColumns.empty( ) )
+		return;
+
+	// input columns by their names, the input headers may change
+	vector<string> leftHeader = left->GetHeader( ), rightHeader = right->GetHeader( );
+	set<string> leftNeeded ( keys.begin( ), keys.end( ) ), rightNeeded ( keys.begin( ), keys.end( ) );
+	for ( const COperator::TColumnRef & i : keptColumns )
+		( i.first ? rightNeeded : leftNeeded ).insert( ( i.first ? rightHeader : leftHeader )[ i.second ] );
+	if ( leftNeeded.empty( ) )
+		leftNeeded.insert( leftHeader.front( ) );
+	if ( rightNeeded.empty( ) )
+		rightNeeded.insert( rightHeader.front( ) );
+	Prune( * left, leftNeeded );
+	Prune( * right, rightNeeded );
+
+	for ( COperator::TColumnRef & i : keptColumns ) {
+		const vector<string> & oldHeader = i.first ? rightHeader : leftHeader, & newHeader = ( i.first ? right : left )->GetHeader( );
+		i.second = find( newHeader.begin( ), newHeader.end( ), oldHeader[ i.second ] ) - newHeader.begin( );
+	}
+	columns = keptColumns;
+	header = keptHeader;
+	types = keptTypes;
+}
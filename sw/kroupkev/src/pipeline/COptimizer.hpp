@@ -0,0 +1,50 @@
+#pragma once
+
+#include <set>
+
+#include "COperator.hpp"
+#include "CScanOperator.hpp"
+#include "CIndexScanOperator.hpp"
+#include "CFilterOperator.hpp"
+#include "CSelectOperator.hpp"
+#include "CJoinOperator.hpp"
+#include "CProductOperator.hpp"
+#include "CSetOperator.hpp"
+#include "CAggregateOperator.hpp"
+#include "CSortOperator.hpp"
+
+/**
+ * This module rewrites a tree of pipeline stages (the logical plan of a query, see COperator) before it's evaluated.
+ * Saved queries are expanded into the stages of their definitions (see CTableQuery::CreateOperator), so the rules
+ * apply across them as well:
+ * - consecutive filters (PRO over PRO) are merged into a single filter with all the conditions,
+ * - a filter is placed below a column selection, and split between the inputs of a join or an unpaged cartesian product,
+ *   so each condition is evaluated on the table its column comes from,
+ * - a chain of joins ( A join B ) join C is evaluated as A join ( B join C ), if the second join is estimated
+ *   to produce fewer rows (see COperator::EstimateRows) - the order of the result rows stays the same,
+ * - joins and products only produce the columns needed above them (SEL, AGG), their inputs only the ones needed by them,
+ * - the rows of a table meeting the first condition of a filter are looked up by an index over its column (see CDatabase::CreateIndex),
+ *   if the condition is estimated to keep only a few of them,
+ * - a join looks up the rows of the input estimated to be smaller in the index of the other one (index nested loop join).
+ *
+ * None of the rules changes the result - the rows, their order, or the messages reported by the evaluation.
+ */
+class COptimizer {
+private:
+	static const double INDEX_SELECTIVITY;
+
+	static vector<unique_ptr<COperator> *> GetInputs ( COperator & stage );
+	static COperator * Rewrite ( COperator * root );
+	static COperator * PushFilter ( CFilterOperator * filter );
+	static COperator * SplitFilter ( CFilterOperator * filter, COperator * input, unique_ptr<COperator> & left, unique_ptr<COperator> & right, const vector<COperator::TColumnRef> & columns );
+	static COperator * ReorderJoins ( COperator * root );
+	static COperator * RotateJoin ( CJoinOperator * join );
+	static COperator * UseIndexes ( COperator * root );
+	static void IndexJoin ( CJoinOperator & join );
+	static void Prune ( COperator & root, const set<string> & required );
+	static void PruneInputs ( COperator & stage, unique_ptr<COperator> & left, unique_ptr<COperator> & right, vector<COperator::TColumnRef> & columns,
+	                          vector<string> & header, vector<CColumn::EType> & types, const set<string> & required, const vector<string> & keys );
+
+public:
+	static COperator * Optimize ( COperator * root );
+};
@@ -0,0 +1,80 @@
+#include "CProductOperator.hpp"
+
+/**
+ * @param[in] left left input (owned by the product), its columns come first
+ * @param[in] right right input (owned by the product)
+ * @param[in] header names of the product columns
+ * @param[in] offset number of pairs to skip
+ * @param[in] limit maximum number of pairs (NO_LIMIT for all of them)
+ */
+CProductOperator::CProductOperator ( COperator * left, COperator * right, const vector<string> & header, const size_t & offset, const size_t & limit )
+: m_Left( left ), m_Right( right ), m_Offset( offset ), m_Limit( limit ) {
+	m_Header = header;
+	for ( size_t i = 0; i < left->GetHeader( ).size( ); ++ i ) {
+		m_Columns.emplace_back( false, i );
+		m_Types.push_back( left->GetTypes( )[ i ] );
+	}
+	for ( size_t i = 0; i < right->GetHeader( ).size( ); ++ i ) {
+		m_Columns.emplace_back( true, i );
+		m_Types.push_back( right->GetTypes( )[ i ] );
+	}
+}
+
+/**
+ * @return true if the product is limited to a page
+ */
+bool CProductOperator::IsPaged ( ) const {
+	return m_Offset != 0 || m_Limit != CProduct::NO_LIMIT;
+}
+
+bool CProductOperator::Open ( ) {
+	// the right input isn't evaluated, if the left one failed
+	m_LeftTable.reset( Materialize( * m_Left ) );
+	if ( ! m_LeftTable )
+		return false;
+	m_RightTable.reset( Materialize( * m_Right ) );
+	if ( ! m_RightTable )
+		return false;
+	m_Product.reset( new CProduct ( * m_LeftTable, * m_RightTable ) );
+	m_Product->SetPage( m_Offset, m_Limit );
+	m_Cursor.reset( new CProduct::CCursor ( * m_Product ) );
+	return true;
+}
+
+bool CProductOperator::NextBatch ( CBatch & batch ) {
+	vector<size_t> left, right;
+	batch.Clear( );
+	if ( ! m_Cursor->Next( left, right, BATCH_SIZE ) )
+		return false;
+	for ( const TColumnRef & i : m_Columns ) {
+		const CTable & table = i.first ? * m_RightTable : * m_LeftTable;
+		batch.m_Columns.emplace_back( table.GetColumn( i.second )->Gather( i.first ? right : left ) );
+	}
+	return true;
+}
+
+void CProductOperator::Close ( ) {
+	m_Cursor.reset( );
+	m_Product.reset( );
+	m_LeftTable.reset( );
+	m_RightTable.reset( );
+}
+
+string CProductOperator::Describe ( ) const {
+	string output = "PRODUCT ( " + ListColumns( m_Header ) + " )";
+	if ( m_Limit != CProduct::NO_LIMIT )
+		output += string( " LIMIT " ).append( CLog::APP_COLOR_RESULT ).append( to_string( m_Limit ) ).append( CLog::APP_COLOR_RESET );
+	if ( m_Offset )
+		output += string( " OFFSET " ).append( CLog::APP_COLOR_RESULT ).append( to_string( m_Offset ) ).append( CLog::APP_COLOR_RESET );
+	return output;
+}
+
+double CProductOperator::EstimateRows ( ) const {
+	double rows = m_Left->EstimateRows( ) * m_Right->EstimateRows( );
+	rows = rows > m_Offset ? rows - m_Offset : 0;
+	return m_Limit != CProduct::NO_LIMIT ? min( rows, double( m_Limit ) ) : rows;
+}
+
+const CColumnStats * CProductOperator::GetColumnStats ( const size_t & column ) const {
+	return column < m_Columns.size( ) ? ( m_Columns[ column ].first ? m_Right : m_Left )->GetColumnStats( m_Columns[ column ].second ) : nullptr;
+}
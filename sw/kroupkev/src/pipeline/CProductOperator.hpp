@@ -0,0 +1,38 @@
+#pragma once
+
+#include "COperator.hpp"
+#include "../database/CProduct.hpp"
+
+/**
+ * Generates the pairs of rows of a cartesian product (see CProduct) in batches. Both inputs are stored once the stage
+ * is opened (inputs reading a table share its data), the product itself never is. The product may be limited to a page.
+ * A filter over the columns of one side is placed below the product by the optimizer, so only the matching rows are paired.
+ */
+class CProductOperator : public COperator {
+private:
+	unique_ptr<COperator> m_Left;
+	unique_ptr<COperator> m_Right;
+	vector<TColumnRef> m_Columns;
+	size_t m_Offset;
+	size_t m_Limit;
+
+	unique_ptr<CTable> m_LeftTable;
+	unique_ptr<CTable> m_RightTable;
+	unique_ptr<CProduct> m_Product;
+	unique_ptr<CProduct::CCursor> m_Cursor;
+
+	friend class COptimizer;
+
+public:
+	CProductOperator ( COperator * left, COperator * right, const vector<string> & header, const size_t & offset = 0, const size_t & limit = CProduct::NO_LIMIT );
+
+	bool IsPaged ( ) const;
+
+	virtual bool Open ( ) override;
+	virtual bool NextBatch ( CBatch & batch ) override;
+	virtual void Close ( ) override;
+	virtual string Describe ( ) const override;
+	virtual vector<const COperator *> GetInputs ( ) const override { return { m_Left.get( ), m_Right.get( ) }; }
+	virtual double EstimateRows ( ) const override;
+	virtual const CColumnStats * GetColumnStats ( const size_t & column ) const override;
+};
@@ -0,0 +1,74 @@
+#include "CScanOperator.hpp"
+
+/**
+ * @param[in] table the table
+ * @param[in] name name of the table (or the saved query), for the query plan
+ * @param[in] indexes indexes over the table columns
+ */
+CScanOperator::CScanOperator ( const CTable & table, const string & name, const vector<const CIndex *> & indexes )
+: m_Table( table ), m_Name( name ), m_Indexes( indexes ) {
+	m_Header = table.GetColumnNames( );
+	for ( size_t i = 0; i < m_Header.size( ); ++ i ) {
+		const CColumn * column = table.GetColumn( i );
+		m_Types.push_back( column ? column->GetType( ) : CColumn::TYPE_STRING );
+	}
+}
+
+bool CScanOperator::Open ( ) {
+	m_Position = 0;
+	return true;
+}
+
+bool CScanOperator::NextBatch ( CBatch & batch ) {
+	batch.Clear( );
+	size_t size = m_Table.GetDataRowCount( );
+	if ( m_Position >= size )
+		return false;
+
+	vector<size_t> rows;
+	for ( size_t i = m_Position; i < size && rows.size( ) < BATCH_SIZE; ++ i )
+		rows.push_back( i );
+	m_Position += rows.size( );
+	for ( size_t i = 0; i < m_Header.size( ); ++ i )
+		batch.m_Columns.emplace_back( m_Table.GetColumn( i )->Gather( rows ) );
+	return true;
+}
+
+void CScanOperator::Close ( ) {
+	m_Position = 0;
+}
+
+/**
+ * The scan output is the table itself, its column data is shared.
+ */
+bool CScanOperator::Share ( CTable * & output ) {
+	output = new CTable { };
+	if ( ! m_Table.GetSubTable( { "*" }, output ) ) {
+		delete output;
+		output = nullptr;
+	}
+	return true;
+}
+
+string CScanOperator::Describe ( ) const {
+	return string( "SCAN " ).append( CLog::APP_COLOR_RESULT ).append( m_Name ).append( CLog::APP_COLOR_RESET );
+}
+
+double CScanOperator::EstimateRows ( ) const {
+	return m_Table.GetDataRowCount( );
+}
+
+const CColumnStats * CScanOperator::GetColumnStats ( const size_t & column ) const {
+	return m_Table.GetStatistics( ) ? m_Table.GetStatistics( )->GetColumn( column ) : nullptr;
+}
+
+/**
+ * A hash index is preferred for the equality, only a sorted one can find a range.
+ */
+const CIndex * CScanOperator::GetIndex ( const size_t & column, const bool & range ) const {
+	const CIndex * found = nullptr;
+	for ( const CIndex * i : m_Indexes )
+		if ( i->GetPosition( ) == column && ( ! range || i->GetKind( ) == CIndex::INDEX_SORTED ) && ( ! found || i->GetKind( ) == CIndex::INDEX_HASH ) )
+			found = i;
+	return found;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "COperator.hpp"
+
+/**
+ * Reads the rows of a table (a base table or a saved query result) in batches.
+ * The table (and its indexes) has to outlive the stage.
+ */
+class CScanOperator : public COperator {
+private:
+	const CTable & m_Table;
+	string m_Name;
+	vector<const CIndex *> m_Indexes;
+	size_t m_Position = 0;
+
+	friend class COptimizer;
+
+public:
+	CScanOperator ( const CTable & table, const string & name, const vector<const CIndex *> & indexes = { } );
+
+	virtual bool Open ( ) override;
+	virtual bool NextBatch ( CBatch & batch ) override;
+	virtual void Close ( ) override;
+	virtual bool Share ( CTable * & output ) override;
+	virtual string Describe ( ) const override;
+	virtual double EstimateRows ( ) const override;
+	virtual const CColumnStats * GetColumnStats ( const size_t & column ) const override;
+	virtual const CIndex * GetIndex ( const size_t & column, const bool & range ) const override;
+};
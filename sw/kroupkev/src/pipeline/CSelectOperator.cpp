@@ -0,0 +1,97 @@
+#include "CSelectOperator.hpp"
+
+/**
+ * @param[in] input input stage (owned by the selection)
+ * @param[in] columns names of the selected columns
+ */
+CSelectOperator::CSelectOperator ( COperator * input, const vector<string> & columns ) : m_Input( input ), m_Selected( columns ) {
+	FindColumns( );
+}
+
+/**
+ * Finds the selected columns in the input header, a missing column gets the index past the end of the header.
+ */
+void CSelectOperator::FindColumns ( ) {
+	const vector<string> & header = m_Input->GetHeader( );
+	m_Indexes.clear( );
+	m_Header.clear( );
+	m_Types.clear( );
+	if ( m_Selected.size( ) == 1 && m_Selected.front( ) == "*" )
+		for ( size_t i = 0; i < header.size( ); ++ i )
+			m_Indexes.push_back( i );
+	else
+		for ( const string & i : m_Selected )
+			m_Indexes.push_back( find( header.begin( ), header.end( ), i ) - header.begin( ) );
+	for ( const size_t & i : m_Indexes ) {
+		if ( i == header.size( ) )
+			continue;
+		m_Header.push_back( header[ i ] );
+		m_Types.push_back( m_Input->GetTypes( )[ i ] );
+	}
+}
+
+bool CSelectOperator::Open ( ) {
+	for ( size_t i = 0; i < m_Indexes.size( ); ++ i ) {
+		if ( m_Indexes[ i ] == m_Input->GetHeader( ).size( ) ) {
+			CLog::HighlightedMsg( CLog::QP, m_Selected[ i ], CLog::QP_NO_SUCH_COL );
+			return false;
+		}
+	}
+	return m_Input->Open( );
+}
+
+bool CSelectOperator::NextBatch ( CBatch & batch ) {
+	CBatch input;
+	batch.Clear( );
+	if ( ! m_Input->NextBatch( input ) )
+		return false;
+	for ( size_t i = 0; i < m_Indexes.size( ); ++ i ) {
+		// a column selected more than once is copied
+		size_t first = find( m_Indexes.begin( ), m_Indexes.end( ), m_Indexes[ i ] ) - m_Indexes.begin( );
+		batch.m_Columns.emplace_back( first == i ? input.m_Columns[ m_Indexes[ i ] ].release( ) : batch.m_Columns[ first ]->Clone( ) );
+	}
+	return true;
+}
+
+void CSelectOperator::Close ( ) {
+	m_Input->Close( );
+}
+
+/**
+ * A selection over a shared table shares the selected columns (see CTable::GetSubTable).
+ */
+bool CSelectOperator::Share ( CTable * & output ) {
+	CTable * input;
+	if ( ! m_Input->Share( input ) )
+		return false;
+	output = nullptr;
+	if ( ! input )
+		return true;
+
+	output = new CTable { };
+	if ( ! input->GetSubTable( m_Selected, output ) ) {
+		delete output;
+		output = nullptr;
+	}
+	delete input;
+	return true;
+}
+
+string CSelectOperator::Describe ( ) const {
+	return "SELECT " + ListColumns( m_Selected );
+}
+
+double CSelectOperator::EstimateRows ( ) const {
+	return m_Input->EstimateRows( );
+}
+
+const CColumnStats * CSelectOperator::GetColumnStats ( const size_t & column ) const {
+	return column < m_Indexes.size( ) && m_Indexes[ column ] < m_Input->GetHeader( ).size( ) ? m_Input->GetColumnStats( m_Indexes[ column ] ) : nullptr;
+}
+
+/**
+ * The selection keeps the rows of its input, so the input indexes find them as well.
+ */
+const CIndex * CSelectOperator::GetIndex ( const size_t & column, const bool & range ) const {
+	return column < m_Indexes.size( ) && m_Indexes[ column ] < m_Input->GetHeader( ).size( ) ? m_Input->GetIndex( m_Indexes[ column ], range ) : nullptr;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "COperator.hpp"
+
+/**
+ * Passes on some of the columns of its input (SEL), "*" stands for all of them.
+ * The selected columns are moved from the input batches, nothing is copied.
+ */
+class CSelectOperator : public COperator {
+private:
+	unique_ptr<COperator> m_Input;
+	vector<string> m_Selected;
+	vector<size_t> m_Indexes;
+
+	friend class COptimizer;
+
+	void FindColumns ( );
+
+public:
+	CSelectOperator ( COperator * input, const vector<string> & columns );
+
+	virtual bool Open ( ) override;
+	virtual bool NextBatch ( CBatch & batch ) override;
+	virtual void Close ( ) override;
+	virtual bool Share ( CTable * & output ) override;
+	virtual string Describe ( ) const override;
+	virtual vector<const COperator *> GetInputs ( ) const override { return { m_Input.get( ) }; }
+	virtual double EstimateRows ( ) const override;
+	virtual const CColumnStats * GetColumnStats ( const size_t & column ) const override;
+	virtual const CIndex * GetIndex ( const size_t & column, const bool & range ) const override;
+};
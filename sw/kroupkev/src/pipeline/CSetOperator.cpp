@@ -0,0 +1,123 @@
+#include "CSetOperator.hpp"
+
+/**
+ * @param[in] left left input (owned by the stage)
+ * @param[in] right right input (owned by the stage)
+ * @param[in] operation set operation to be evaluated
+ * @param[in] permutation index of the right input column for each left one (same names and types)
+ */
+CSetOperator::CSetOperator ( COperator * left, COperator * right, const EOperation & operation, const vector<size_t> & permutation )
+: m_Left( left ), m_Right( right ), m_Operation( operation ), m_Algorithm( CQuerySett::m_SetAlgorithm ), m_Permutation( permutation ) {
+	m_Header = left->GetHeader( );
+	m_Types = left->GetTypes( );
+}
+
+bool CSetOperator::Open ( ) {
+	m_Rows.clear( );
+	m_Position = 0;
+	// the right input isn't evaluated, if the left one failed
+	m_LeftTable.reset( Materialize( * m_Left ) );
+	if ( ! m_LeftTable )
+		return false;
+	m_RightTable.reset( Materialize( * m_Right ) );
+	if ( ! m_RightTable )
+		return false;
+
+	m_LeftColumns.clear( );
+	m_RightColumns.clear( );
+	for ( size_t i = 0; i < m_Permutation.size( ); ++ i ) {
+		m_LeftColumns.push_back( m_LeftTable->GetColumn( i ) );
+		m_RightColumns.push_back( m_RightTable->GetColumn( m_Permutation[ i ] ) );
+		if ( ! m_LeftColumns.back( ) || ! m_RightColumns.back( ) )
+			return true;
+	}
+	Evaluate( );
+	return true;
+}
+
+/**
+ * Finds the rows of the result, the inputs are only read.
+ */
+void CSetOperator::Evaluate ( ) {
+	vector<size_t> rows;
+	if ( m_Algorithm == CQuerySett::SETOP_SORT ) {
+		// key columns in the order of their names
+		vector<size_t> order ( m_Header.size( ) );
+		for ( size_t i = 0; i < order.size( ); ++ i )
+			order[ i ] = i;
+		sort( order.begin( ), order.end( ), [ this ] ( const size_t & a, const size_t & b ) { return m_Header[ a ] < m_Header[ b ]; } );
+		vector<const CColumn *> keysA, keysB;
+		for ( const size_t & i : order ) {
+			keysA.push_back( m_LeftColumns[ i ] );
+			keysB.push_back( m_RightColumns[ i ] );
+		}
+
+		if ( m_Operation == SET_UNION ) {
+			m_Rows = CSetEngine::SortedUnion( keysA, keysB );
+			return;
+		}
+		rows = m_Operation == SET_INTERSECT ? CSetEngine::SortedIntersect( keysA, keysB ) : CSetEngine::SortedMinus( keysA, keysB );
+	} else if ( m_Operation == SET_UNION ) {
+		// all the left rows, followed by the right ones missing in the left table
+		for ( size_t i = 0; i < m_LeftTable->GetDataRowCount( ); ++ i )
+			m_Rows.emplace_back( false, i );
+		for ( const size_t & i : CSetEngine::Union( m_LeftColumns, m_RightColumns ) )
+			m_Rows.emplace_back( true, i );
+		return;
+	} else
+		rows = m_Operation == SET_INTERSECT ? CSetEngine::Intersect( m_LeftColumns, m_RightColumns ) : CSetEngine::Minus( m_LeftColumns, m_RightColumns );
+
+	for ( const size_t & i : rows )
+		m_Rows.emplace_back( false, i );
+}
+
+bool CSetOperator::NextBatch ( CBatch & batch ) {
+	batch.Clear( );
+	if ( m_Position >= m_Rows.size( ) )
+		return false;
+
+	size_t end = min( m_Rows.size( ), m_Position + BATCH_SIZE );
+	bool mixed = false;
+	vector<size_t> rows;
+	for ( size_t i = m_Position; i < end; ++ i ) {
+		mixed = mixed || m_Rows[ i ].first != m_Rows[ m_Position ].first;
+		rows.push_back( m_Rows[ i ].second );
+	}
+
+	// rows of a single input are gathered at once, the others one by one
+	bool right = m_Rows[ m_Position ].first;
+	for ( size_t i = 0; i < m_LeftColumns.size( ); ++ i ) {
+		if ( ! mixed ) {
+			batch.m_Columns.emplace_back( ( right ? m_RightColumns : m_LeftColumns )[ i ]->Gather( rows ) );
+			continue;
+		}
+		batch.m_Columns.emplace_back( CColumn::Create( m_Types[ i ] ) );
+		batch.m_Columns.back( )->Reserve( rows.size( ) );
+		for ( size_t j = m_Position; j < end; ++ j )
+			batch.m_Columns.back( )->AppendRow( m_Rows[ j ].first ? * m_RightColumns[ i ] : * m_LeftColumns[ i ], m_Rows[ j ].second );
+	}
+	m_Position = end;
+	return true;
+}
+
+void CSetOperator::Close ( ) {
+	m_LeftColumns.clear( );
+	m_RightColumns.clear( );
+	m_LeftTable.reset( );
+	m_RightTable.reset( );
+	m_Rows.clear( );
+	m_Rows.shrink_to_fit( );
+}
+
+string CSetOperator::Describe ( ) const {
+	string output = m_Operation == SET_UNION ? "UNION" : m_Operation == SET_INTERSECT ? "INTERSECT" : "MINUS";
+	return output.append( m_Algorithm == CQuerySett::SETOP_SORT ? " (sort)" : " (hash)" );
+}
+
+double CSetOperator::EstimateRows ( ) const {
+	if ( m_Operation == SET_UNION )
+		return m_Left->EstimateRows( ) + m_Right->EstimateRows( );
+	if ( m_Operation == SET_INTERSECT )
+		return min( m_Left->EstimateRows( ), m_Right->EstimateRows( ) );
+	return m_Left->EstimateRows( );
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "COperator.hpp"
+#include "../database/CSetEngine.hpp"
+#include "../database/CQuerySett.hpp"
+
+/**
+ * Evaluates a set operation over the rows of two inputs (UNION, INTERSECT, MINUS) with a hash table or by sorting the rows,
+ * the algorithm is taken from the query settings once the stage is created (see CQuerySett::m_SetAlgorithm and CSetEngine).
+ * The stage is blocking - both inputs are stored once it's opened, the result rows are then gathered into the batches.
+ *
+ * The output has the header of the left input, the sorted rows are ordered by the columns in the alphabetical order of their names.
+ */
+class CSetOperator : public COperator {
+public:
+	enum EOperation { SET_UNION, SET_INTERSECT, SET_MINUS };
+
+private:
+	unique_ptr<COperator> m_Left;
+	unique_ptr<COperator> m_Right;
+	EOperation m_Operation;
+	CQuerySett::ESetOp m_Algorithm;
+	vector<size_t> m_Permutation;
+
+	unique_ptr<CTable> m_LeftTable;
+	unique_ptr<CTable> m_RightTable;
+	vector<const CColumn *> m_LeftColumns;
+	vector<const CColumn *> m_RightColumns;
+	vector<CSetEngine::TRowRef> m_Rows;
+	size_t m_Position = 0;
+
+	void Evaluate ( );
+
+	friend class COptimizer;
+
+public:
+	CSetOperator ( COperator * left, COperator * right, const EOperation & operation, const vector<size_t> & permutation );
+
+	virtual bool Open ( ) override;
+	virtual bool NextBatch ( CBatch & batch ) override;
+	virtual void Close ( ) override;
+	virtual string Describe ( ) const override;
+	virtual vector<const COperator *> GetInputs ( ) const override { return { m_Left.get( ), m_Right.get( ) }; }
+	virtual double EstimateRows ( ) const override;
+};
@@ -0,0 +1,312 @@
+#include "CSortOperator.hpp"
+
+#include <numeric>
+
+const size_t CSortOperator::HEAP_RATIO = 8;
+const size_t CSortOperator::PARALLEL_ROWS = 1 << 16;
+
+/**
+ * Prepares the comparison of the rows of a column. The values of a dictionary are ranked by the order of CStringColumn::Less (bytewise).
+ * @param[in] column the key column (has to outlive the key)
+ */
+CSortOperator::CKey::CKey ( const CColumn & column ) : m_Column( & column ) {
+	if ( column.GetType( ) == CColumn::TYPE_INT )
+		m_Integers = static_cast<const CIntColumn &>( column ).GetData( );
+	else if ( column.GetType( ) == CColumn::TYPE_DOUBLE )
+		m_Doubles = static_cast<const CDoubleColumn &>( column ).GetData( );
+	else if ( column.GetType( ) == CColumn::TYPE_STRING && static_cast<const CStringColumn &>( column ).IsEncoded( ) ) {
+		const CStringDictionary & dictionary = * static_cast<const CStringColumn &>( column ).GetDictionary( );
+		vector<uint32_t> codes ( dictionary.GetSize( ) );
+		iota( codes.begin( ), codes.end( ), 0 );
+		sort( codes.begin( ), codes.end( ), [ & dictionary ] ( const uint32_t & a, const uint32_t & b ) { return dictionary.GetValue( a ) < dictionary.GetValue( b ); } );
+		m_Ranks.resize( codes.size( ) );
+		for ( size_t i = 0; i < codes.size( ); ++ i )
+			m_Ranks[ codes[ i ] ] = static_cast<uint32_t>( i );
+		m_Codes = static_cast<const CStringColumn &>( column ).GetCodes( );
+	}
+}
+
+/**
+ * Compares the values of two rows of the column.
+ * @return negative if the row a precedes the row b, zero if they are equal, positive otherwise
+ */
+int CSortOperator::CKey::Compare ( const size_t & a, const size_t & b ) const {
+	if ( m_Integers )
+		return ( m_Integers[ a ] > m_Integers[ b ] ) - ( m_Integers[ a ] < m_Integers[ b ] );
+	if ( m_Doubles )
+		return CDouble::cmpEq( m_Doubles[ a ], m_Doubles[ b ] ) ? 0 : ( CDouble::cmpLt( m_Doubles[ a ], m_Doubles[ b ] ) ? -1 : 1 );
+	if ( m_Codes )
+		return ( m_Ranks[ m_Codes[ a ] ] > m_Ranks[ m_Codes[ b ] ] ) - ( m_Ranks[ m_Codes[ a ] ] < m_Ranks[ m_Codes[ b ] ] );
+	if ( m_Column->Equal( a, * m_Column, b ) )
+		return 0;
+	return m_Column->Less( a, * m_Column, b ) ? -1 : 1;
+}
+
+//
+
+/**
+ * @param[in] input input stage (owned by the stage)
+ * @param[in] keys names of the key columns, the first one decides first
+ * @param[in] descending true for each key ordered from the largest value
+ * @param[in] offset number of the first rows to skip
+ * @param[in] limit maximum number of rows (NO_LIMIT for all of them)
+ */
+CSortOperator::CSortOperator ( COperator * input, const vector<string> & keys, const vector<bool> & descending, const size_t & offset, const size_t & limit )
+: m_Input( input ), m_Keys( keys ), m_Descending( descending ), m_Offset( offset ), m_Limit( limit ) {
+	FindColumns( );
+}
+
+/**
+ * The output has the input header, the key columns are found in it (a missing column gets the index past the end of the header).
+ */
+void CSortOperator::FindColumns ( ) {
+	m_Header = m_Input->GetHeader( );
+	m_Types = m_Input->GetTypes( );
+	m_KeyIndexes.clear( );
+	for ( const string & i : m_Keys )
+		m_KeyIndexes.push_back( find( m_Header.begin( ), m_Header.end( ), i ) - m_Header.begin( ) );
+}
+
+/**
+ * Number of the sorted rows the page needs (NO_LIMIT if the output isn't limited).
+ */
+size_t CSortOperator::GetPageEnd ( ) const {
+	if ( m_Limit == CProduct::NO_LIMIT || m_Offset > CProduct::NO_LIMIT - m_Limit )
+		return CProduct::NO_LIMIT;
+	return m_Offset + m_Limit;
+}
+
+/**
+ * The heap is used if the page is estimated to take a small part of the input only.
+ */
+bool CSortOperator::IsHeapBased ( ) const {
+	size_t end = GetPageEnd( );
+	return end != CProduct::NO_LIMIT && static_cast<double>( end ) * HEAP_RATIO <= m_Input->EstimateRows( );
+}
+
+/**
+ * Compares two rows by the keys, possibly rows of different columns (of the same types).
+ * @return negative if the row a precedes the row b, zero if their keys are equal, positive otherwise
+ */
+int CSortOperator::Compare ( const vector<const CColumn *> & columnsA, const size_t & a, const vector<const CColumn *> & columnsB, const size_t & b ) const {
+	for ( size_t i = 0; i < m_KeyIndexes.size( ); ++ i ) {
+		const CColumn * columnA = columnsA[ m_KeyIndexes[ i ] ], * columnB = columnsB[ m_KeyIndexes[ i ] ];
+		if ( columnA->Equal( a, * columnB, b ) )
+			continue;
+		bool less = columnA->Less( a, * columnB, b );
+		return less != m_Descending[ i ] ? -1 : 1;
+	}
+	return 0;
+}
+
+bool CSortOperator::Open ( ) {
+	Close( );
+	for ( size_t i = 0; i < m_Keys.size( ); ++ i ) {
+		if ( m_KeyIndexes[ i ] == m_Header.size( ) ) {
+			CLog::HighlightedMsg( CLog::QP, m_Keys[ i ], CLog::QP_NO_SUCH_COL );
+			return false;
+		}
+	}
+	return IsHeapBased( ) ? SortHeap( ) : SortTable( );
+}
+
+/**
+ * Keeps the rows of the page in a heap with the last of them on the top. A row, which doesn't precede the top one,
+ * is skipped (the equal one comes later in the input), otherwise it's copied and replaces the top one.
+ */
+bool CSortOperator::SortHeap ( ) {
+	size_t size = GetPageEnd( );
+	if ( ! m_Input->Open( ) ) {
+		m_Input->Close( );
+		return false;
+	}
+	vector<uint32_t> heap;
+	vector<const CColumn *> kept, columns;
+	auto before = [ this, & kept ] ( const uint32_t & a, const uint32_t & b ) {
+		int res = Compare( kept, a, kept, b );
+		return res ? res < 0 : m_Sequence[ a ] < m_Sequence[ b ];
+	};
+
+	CBatch batch;
+	size_t seen = 0;
+	while ( size && m_Input->NextBatch( batch ) ) {
+		columns.clear( );
+		for ( const unique_ptr<CColumn> & i : batch.m_Columns )
+			columns.push_back( i.get( ) );
+		if ( m_Candidates.empty( ) ) {
+			for ( const CColumn * i : columns ) {
+				m_Candidates.emplace_back( CColumn::Create( i->GetType( ) ) );
+				kept.push_back( m_Candidates.back( ).get( ) );
+			}
+		}
+
+		for ( size_t i = 0; i < batch.GetSize( ); ++ i, ++ seen ) {
+			if ( heap.size( ) == size ) {
+				if ( Compare( columns, i, kept, heap.front( ) ) >= 0 )
+					continue;
+				pop_heap( heap.begin( ), heap.end( ), before );
+				heap.pop_back( );
+			}
+			for ( size_t j = 0; j < columns.size( ); ++ j )
+				m_Candidates[ j ]->AppendRow( * columns[ j ], i );
+			m_Sequence.push_back( seen );
+			heap.push_back( static_cast<uint32_t>( m_Sequence.size( ) - 1 ) );
+			push_heap( heap.begin( ), heap.end( ), before );
+		}
+		if ( m_Sequence.size( ) > 2 * size + BATCH_SIZE ) {
+			CompactHeap( heap );
+			for ( size_t j = 0; j < kept.size( ); ++ j )
+				kept[ j ] = m_Candidates[ j ].get( );
+		}
+	}
+	m_Input->Close( );
+
+	sort( heap.begin( ), heap.end( ), before );
+	for ( size_t i = min( m_Offset, heap.size( ) ); i < heap.size( ); ++ i )
+		m_Rows.push_back( heap[ i ] );
+	for ( const unique_ptr<CColumn> & i : m_Candidates )
+		m_Columns.push_back( i.get( ) );
+	return true;
+}
+
+/**
+ * Drops the copied rows, which were evicted from the heap. The heap keeps its shape, only its rows are renumbered.
+ */
+void CSortOperator::CompactHeap ( vector<uint32_t> & heap ) {
+	vector<size_t> rows ( heap.begin( ), heap.end( ) );
+	vector<size_t> sequence;
+	for ( unique_ptr<CColumn> & i : m_Candidates )
+		i.reset( i->Gather( rows ) );
+	for ( size_t i = 0; i < heap.size( ); ++ i ) {
+		sequence.push_back( m_Sequence[ heap[ i ] ] );
+		heap[ i ] = static_cast<uint32_t>( i );
+	}
+	m_Sequence = sequence;
+}
+
+/**
+ * Stores the input and sorts all its rows (see SortRows), the page is then cut out of them.
+ */
+bool CSortOperator::SortTable ( ) {
+	m_Table.reset( Materialize( * m_Input ) );
+	if ( ! m_Table )
+		return false;
+	size_t rows = m_Table->GetDataRowCount( );
+	if ( ! rows )
+		return true;
+
+	vector<CKey> keys;
+	for ( const size_t & i : m_KeyIndexes )
+		keys.emplace_back( * m_Table->GetColumn( i ) );
+	m_Rows.resize( rows );
+	iota( m_Rows.begin( ), m_Rows.end( ), 0 );
+	SortRows( m_Rows, [ this, & keys ] ( const size_t & a, const size_t & b ) {
+		for ( size_t i = 0; i < keys.size( ); ++ i ) {
+			int res = keys[ i ].Compare( a, b );
+			if ( res )
+				return m_Descending[ i ] ? res > 0 : res < 0;
+		}
+		return false;
+	}, CQuerySett::GetThreads( ) );
+
+	size_t begin = min( m_Offset, rows ), end = min( GetPageEnd( ), rows );
+	m_Rows = vector<size_t>( m_Rows.begin( ) + begin, m_Rows.begin( ) + end );
+	for ( size_t i = 0; i < m_Table->GetColumnCount( ); ++ i )
+		m_Columns.push_back( m_Table->GetColumn( i ) );
+	return true;
+}
+
+/**
+ * Sorts the rows stably. Large inputs are split into parts sorted by the threads of a pool, the neighbouring sorted parts
+ * are then merged in rounds (the left part precedes on a tie), each pair by a thread.
+ * @param[in, out] rows the rows to be sorted
+ * @param[in] less order of the rows (called by several threads at once)
+ * @param[in] threads maximum number of threads
+ */
+void CSortOperator::SortRows ( vector<size_t> & rows, const function<bool ( const size_t &, const size_t & )> & less, const size_t & threads ) {
+	size_t parts = min( threads, rows.size( ) / PARALLEL_ROWS );
+	if ( parts < 2 ) {
+		stable_sort( rows.begin( ), rows.end( ), less );
+		return;
+	}
+
+	vector<size_t> bounds;
+	for ( size_t i = 0; i <= parts; ++ i )
+		bounds.push_back( rows.size( ) * i / parts );
+	CThreadPool pool ( parts );
+	vector<future<void>> done;
+	for ( size_t i = 0; i < parts; ++ i )
+		done.push_back( pool.Submit( [ & rows, & bounds, & less, i ] ( ) {
+			stable_sort( rows.begin( ) + bounds[ i ], rows.begin( ) + bounds[ i + 1 ], less );
+		} ) );
+	for ( auto & i : done )
+		i.get( );
+
+	vector<size_t> merged ( rows.size( ) );
+	while ( bounds.size( ) > 2 ) {
+		vector<size_t> next;
+		done.clear( );
+		for ( size_t i = 0; i + 1 < bounds.size( ); i += 2 ) {
+			next.push_back( bounds[ i ] );
+			if ( i + 2 < bounds.size( ) )
+				done.push_back( pool.Submit( [ & rows, & merged, & bounds, & less, i ] ( ) {
+					merge( rows.begin( ) + bounds[ i ], rows.begin( ) + bounds[ i + 1 ], rows.begin( ) + bounds[ i + 1 ], rows.begin( ) + bounds[ i + 2 ],
+					       merged.begin( ) + bounds[ i ], less );
+				} ) );
+			else
+				copy( rows.begin( ) + bounds[ i ], rows.begin( ) + bounds[ i + 1 ], merged.begin( ) + bounds[ i ] );
+		}
+		next.push_back( bounds.back( ) );
+		for ( auto & i : done )
+			i.get( );
+		rows.swap( merged );
+		bounds = next;
+	}
+}
+
+bool CSortOperator::NextBatch ( CBatch & batch ) {
+	batch.Clear( );
+	if ( m_Position >= m_Rows.size( ) )
+		return false;
+
+	size_t end = min( m_Rows.size( ), m_Position + BATCH_SIZE );
+	vector<size_t> rows ( m_Rows.begin( ) + m_Position, m_Rows.begin( ) + end );
+	m_Position = end;
+	for ( const CColumn * i : m_Columns )
+		batch.m_Columns.emplace_back( i->Gather( rows ) );
+	return true;
+}
+
+void CSortOperator::Close ( ) {
+	m_Candidates.clear( );
+	m_Sequence.clear( );
+	m_Table.reset( );
+	m_Columns.clear( );
+	m_Rows.clear( );
+	m_Rows.shrink_to_fit( );
+	m_Position = 0;
+}
+
+string CSortOperator::Describe ( ) const {
+	vector<string> keys;
+	for ( size_t i = 0; i < m_Keys.size( ); ++ i )
+		keys.push_back( m_Descending[ i ] ? m_Keys[ i ] + " DESC" : m_Keys[ i ] );
+	string output = "ORDER BY " + ListColumns( keys );
+	if ( m_Limit != CProduct::NO_LIMIT )
+		output.append( " LIMIT " ).append( to_string( m_Limit ) );
+	if ( m_Offset )
+		output.append( " OFFSET " ).append( to_string( m_Offset ) );
+	return output.append( IsHeapBased( ) ? " (heap)" : " (sort)" );
+}
+
+double CSortOperator::EstimateRows ( ) const {
+	double rows = max( m_Input->EstimateRows( ) - static_cast<double>( m_Offset ), 0.0 );
+	return m_Limit == CProduct::NO_LIMIT ? rows : min( rows, static_cast<double>( m_Limit ) );
+}
+
+/**
+ * The page keeps some of the input rows, the statistics of the input columns are an estimate.
+ */
+const CColumnStats * CSortOperator::GetColumnStats ( const size_t & column ) const {
+	return m_Input->GetColumnStats( column );
+}
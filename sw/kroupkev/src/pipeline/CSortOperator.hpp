@@ -0,0 +1,73 @@
+#pragma once
+
+#include <functional>
+
+#include "COperator.hpp"
+#include "../database/CProduct.hpp"
+#include "../tool/CThreadPool.hpp"
+
+/**
+ * Orders the rows of its input by the key columns (ORDER), each key ascending or descending. Rows with equal keys
+ * keep their input order. The output may be limited to a page of rows (offset, limit).
+ *
+ * The top rows of a small page are kept in a bounded heap while the input batches are read - only the rows, which
+ * make it into the heap, are copied, and the heap is compacted once the evicted rows outnumber it. Otherwise the input
+ * is stored and its rows are sorted by parts on a pool of threads, the sorted parts are then merged (see SortRows).
+ * The stage is blocking - the output is produced once it's opened.
+ */
+class CSortOperator : public COperator {
+private:
+	/** Order of a single key column, numbers and dictionary encoded strings (by the order of their values) are compared directly. */
+	class CKey {
+	private:
+		const CColumn * m_Column;
+		const int32_t * m_Integers = nullptr;
+		const double * m_Doubles = nullptr;
+		const uint32_t * m_Codes = nullptr;
+		vector<uint32_t> m_Ranks;
+
+	public:
+		CKey ( const CColumn & column );
+		int Compare ( const size_t & a, const size_t & b ) const;
+	};
+
+	static const size_t HEAP_RATIO;
+	static const size_t PARALLEL_ROWS;
+
+	unique_ptr<COperator> m_Input;
+	vector<string> m_Keys;
+	vector<bool> m_Descending;
+	vector<size_t> m_KeyIndexes;
+	size_t m_Offset;
+	size_t m_Limit;
+
+	vector<unique_ptr<CColumn>> m_Candidates;
+	vector<size_t> m_Sequence;
+	unique_ptr<CTable> m_Table;
+	vector<const CColumn *> m_Columns;
+	vector<size_t> m_Rows;
+	size_t m_Position = 0;
+
+	friend class COptimizer;
+
+	void FindColumns ( );
+	size_t GetPageEnd ( ) const;
+	bool IsHeapBased ( ) const;
+	int Compare ( const vector<const CColumn *> & columnsA, const size_t & a, const vector<const CColumn *> & columnsB, const size_t & b ) const;
+	bool SortHeap ( );
+	bool SortTable ( );
+	void CompactHeap ( vector<uint32_t> & heap );
+
+public:
+	CSortOperator ( COperator * input, const vector<string> & keys, const vector<bool> & descending, const size_t & offset = 0, const size_t & limit = CProduct::NO_LIMIT );
+
+	static void SortRows ( vector<size_t> & rows, const function<bool ( const size_t &, const size_t & )> & less, const size_t & threads );
+
+	virtual bool Open ( ) override;
+	virtual bool NextBatch ( CBatch & batch ) override;
+	virtual void Close ( ) override;
+	virtual string Describe ( ) const override;
+	virtual vector<const COperator *> GetInputs ( ) const override { return { m_Input.get( ) }; }
+	virtual double EstimateRows ( ) const override;
+	virtual const CColumnStats * GetColumnStats ( const size_t & column ) const override;
+};
@@ -0,0 +1,85 @@
+#include "CAggregation.hpp"
+
+CAggregation::CAggregation ( CDatabase & ref, vector<string> groups, vector<CAggregate> aggregates, string tableName )
+: m_Database( ref ), m_Groups( std::move( groups ) ), m_Aggregates( std::move( aggregates ) ), m_TableName( std::move( tableName ) ) { }
+
+CAggregation::~CAggregation ( ) {
+	delete m_QueryResult;
+}
+
+/**
+ * Evaluates the query and saves the result.
+ * @return true if all query prerequisities were fulfilled and this object holds the query result.
+ */
+bool CAggregation::Evaluate ( ) {
+	CTable * tableRef;
+	CTableQuery * queryRef;
+	COperator * input;
+	if ( ( tableRef = m_Database.GetTable( m_TableName ) ) != nullptr )
+		input = m_Database.CreateOperator( m_TableName );
+	else if ( ( queryRef = m_Database.GetTableQ( m_TableName ) ) != nullptr ) {
+		m_Derived = true;
+		m_Origin = queryRef;
+		input = queryRef->CreateOperator( m_TableName );
+	} else {
+		CLog::HighlightedMsg( CLog::QP, m_TableName, CLog::QP_NO_SUCH_TABLE );
+		return false;
+	}
+
+	m_SchemaVersion = m_Database.GetSchemaVersion( );
+	return ( m_QueryResult = Execute( new CAggregateOperator( input, m_Groups, m_Aggregates ) ) ) != nullptr;
+}
+
+CTable * CAggregation::GetQueryResult ( ) {
+	return m_QueryResult;
+}
+
+void CAggregation::ArchiveQueryName ( const string & name ) {
+	if ( m_QuerySaveName != name )
+		m_QuerySaveName = name;
+}
+
+string CAggregation::GetSQL ( ) const {
+	if ( ! m_QueryResult )
+		return "";
+
+	vector<string> columns = m_Groups;
+	for ( const CAggregate & i : m_Aggregates )
+		columns.push_back( i.GetSQL( ) );
+	string output = "( SELECT ";
+	for ( size_t i = 0; i < columns.size( ); ++ i )
+		output += string( i ? ", " : "" ).append( CLog::APP_COLOR_RESULT ).append( columns[ i ] ).append( CLog::APP_COLOR_RESET );
+	output += " FROM " + string( m_Derived ? "" : string( CLog::APP_COLOR_RESULT ).append( m_TableName ).append( CLog::APP_COLOR_RESET ) );
+
+	if ( m_Origin )
+		output += m_Origin->GetSQL( );
+	for ( size_t i = 0; i < m_Groups.size( ); ++ i )
+		output += string( i ? ", " : " GROUP BY " ).append( CLog::APP_COLOR_RESULT ).append( m_Groups[ i ] ).append( CLog::APP_COLOR_RESET );
+	output += " )";
+	return output;
+}
+
+bool CAggregation::IsDerived ( ) const {
+	return m_Derived;
+}
+
+vector<string> CAggregation::GetOperands ( ) const {
+	return { m_TableName };
+}
+
+/**
+ * The appended rows may belong to the existing groups, the aggregation is evaluated again.
+ */
+size_t CAggregation::Refresh ( const TChanges & changes ) {
+	return Recompute( m_QueryResult );
+}
+
+/**
+ * Other queries read the aggregation by the stages of its definition, so its input is optimized with their plan.
+ * The result table is scanned instead if a column was renamed since the query was evaluated.
+ */
+COperator * CAggregation::CreateOperator ( const string & name ) {
+	if ( m_SchemaVersion != m_Database.GetSchemaVersion( ) )
+		return CTableQuery::CreateOperator( name );
+	return new CAggregateOperator( m_Database.CreateOperator( m_TableName ), m_Groups, m_Aggregates );
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "CTableQuery.hpp"
+#include "../database/CDatabase.hpp"
+#include "../pipeline/CAggregateOperator.hpp"
+
+/*
+ * This query groups the rows of a table by the given columns and aggregates each group (COUNT, SUM, MIN, MAX, AVG).
+ */
+class CAggregation : public CTableQuery {
+private:
+	CDatabase & m_Database;
+	vector<string> m_Groups;
+	vector<CAggregate> m_Aggregates;
+	string m_TableName;
+
+	CTable * m_QueryResult = nullptr;
+	CTableQuery * m_Origin = nullptr;
+	string m_QuerySaveName;
+	bool m_Derived = false;
+
+public:
+	explicit CAggregation ( CDatabase & ref, vector<string> groups, vector<CAggregate> aggregates, string tableName );
+	virtual ~CAggregation ( ) override;
+
+	virtual bool Evaluate ( ) override;
+	virtual CTable * GetQueryResult ( ) override;
+	virtual void ArchiveQueryName ( const string & name ) override;
+	virtual string GetSQL ( ) const override;
+	virtual bool IsDerived ( ) const override;
+	virtual vector<string> GetOperands ( ) const override;
+	virtual size_t Refresh ( const TChanges & changes ) override;
+	virtual COperator * CreateOperator ( const string & name ) override;
+};
\ No newline at end of file
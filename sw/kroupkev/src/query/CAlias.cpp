@@ -35,6 +35,7 @@ bool CAlias::Evaluate ( ) {
 
 	if ( ! tableRef->ChangeColumnName( colIndex, m_Columns.second ) )
 		return false;
+	m_Database.ChangeSchema( );
 
 	string output = "( ALTER TABLE ";
 	if ( queryRef != nullptr )
@@ -65,4 +66,11 @@ string CAlias::GetSQL ( ) const {
 
 bool CAlias::IsDerived ( ) const {
 	return false;
-}
\ No newline at end of file
+}
+vector<string> CAlias::GetOperands ( ) const {
+	return { };
+}
+
+size_t CAlias::Refresh ( const TChanges & changes ) {
+	return REWRITTEN;
+}
@@ -1,31 +1,34 @@
 #include "CBinaryQuery.hpp"
 
 /*
- * Searches trough the database and saves the table references.
+ * Searches trough the database and creates the operand stages.
  * If any error occurs (table not found, invalid columns, data types), false is returned.
  */
 bool CBinaryQuery::SaveTableReferences ( ) {
-	if ( ( m_Operands.first.m_TRef = m_Database.GetTable( m_TableNames.first ) ) != nullptr ) { }
+	CTable * table;
+	if ( ( table = m_Database.GetTable( m_TableNames.first ) ) != nullptr )
+		m_Operands.first.m_Plan.reset( m_Database.CreateOperator( m_TableNames.first ) );
 	else if ( ( m_Operands.first.m_QRef = m_Database.GetTableQ( m_TableNames.first ) ) != nullptr ) {
 		m_Operands.first.m_Origin = m_Operands.first.m_QRef;
-		m_Operands.first.m_TRef = m_Operands.first.m_QRef->GetQueryResult( );
+		m_Operands.first.m_Plan.reset( m_Operands.first.m_QRef->CreateOperator( m_TableNames.first ) );
 	} else {
 		CLog::HighlightedMsg( CLog::QP, m_TableNames.first, CLog::QP_NO_SUCH_TABLE );
 		return false;
 	}
-	if ( m_Operands.first.m_TRef->HasDuplicateColumns( ) ) {
+	if ( m_Operands.first.m_Plan->HasDuplicateColumns( ) ) {
 		CLog::Msg( CLog::QP, CLog::QP_DUP_COL );
 		return false;
 	}
-	if ( ( m_Operands.second.m_TRef = m_Database.GetTable( m_TableNames.second ) ) != nullptr ) { }
+	if ( ( table = m_Database.GetTable( m_TableNames.second ) ) != nullptr )
+		m_Operands.second.m_Plan.reset( m_Database.CreateOperator( m_TableNames.second ) );
 	else if ( ( m_Operands.second.m_QRef = m_Database.GetTableQ( m_TableNames.second ) ) != nullptr ) {
 		m_Operands.second.m_Origin = m_Operands.second.m_QRef;
-		m_Operands.second.m_TRef = m_Operands.second.m_QRef->GetQueryResult( );
+		m_Operands.second.m_Plan.reset( m_Operands.second.m_QRef->CreateOperator( m_TableNames.second ) );
 	} else {
 		CLog::HighlightedMsg( CLog::QP, m_TableNames.first, CLog::QP_NO_SUCH_TABLE );
 		return false;
 	}
-	if ( m_Operands.second.m_TRef->HasDuplicateColumns( ) ) {
+	if ( m_Operands.second.m_Plan->HasDuplicateColumns( ) ) {
 		CLog::Msg( CLog::QP, CLog::QP_DUP_COL );
 		return false;
 	}
@@ -33,20 +36,177 @@ bool CBinaryQuery::SaveTableReferences ( ) {
 }
 
 /*
- * Validates individual columns types of two operands.
- * Method returns true if all columns have same data types.
+ * Matches the columns of the second operand to the columns of the first one by their names.
+ * The operands must have the same column names (in any order) with the same data types.
+ * @param[out] permutation index of the second operand column for each column of the first one
+ * @return true if the headers match
  */
-bool CBinaryQuery::ValidateColumnTypes ( ) const {
-	if ( ! m_Operands.first.m_TRef || ! m_Operands.second.m_TRef )
-		return false;
+bool CBinaryQuery::AlignColumns ( vector<size_t> & permutation ) const {
+	const vector<string> & headerA = m_Operands.first.m_Plan->GetHeader( );
+	const vector<string> & headerB = m_Operands.second.m_Plan->GetHeader( );
+	permutation.clear( );
+	for ( const string & i : headerA ) {
+		size_t index = find( headerB.begin( ), headerB.end( ), i ) - headerB.begin( );
+		if ( headerA.size( ) != headerB.size( ) || index == headerB.size( ) ) {
+			CLog::Msg( CLog::QP, CLog::QP_DIFF_HEADER );
+			return false;
+		}
+		permutation.push_back( index );
+	}
 
-	size_t tmp = m_Operands.first.m_TRef->GetColumnCount( );
-	for ( size_t j = 0; j < tmp; ++ j ) {
-		if ( m_Operands.first.m_TRef->GetColumnType( j ) != m_Operands.second.m_TRef->GetColumnType( j ) ) {
+	for ( size_t i = 0; i < permutation.size( ); ++ i ) {
+		if ( m_Operands.first.m_Plan->GetTypes( )[ i ] != m_Operands.second.m_Plan->GetTypes( )[ permutation[ i ] ] ) {
 			CLog::Msg( CLog::QP, CLog::QP_DIFF_TYPE );
 			return false;
 		}
 	}
+	return true;
+}
+
+/*
+ * Creates the stage of a set operation, evaluated with a hash table or by sorting the rows (see CSetOperator).
+ * The operands are only read, the result has the header of the first operand.
+ * @param[in] operation set operation to be evaluated
+ * @param[in] permutation aligned columns of the second operand (see CBinaryQuery::AlignColumns)
+ * @return the stage over both operand stages (owned by the caller)
+ */
+COperator * CBinaryQuery::CreateSetOperation ( const CSetOperator::EOperation & operation, const vector<size_t> & permutation ) {
+	return new CSetOperator( m_Operands.first.m_Plan.release( ), m_Operands.second.m_Plan.release( ), operation, permutation );
+}
+
+/**
+ * Matches two ranges of the operand rows by the key columns (see CTable::FindOccurences). If an operand is matched
+ * as a whole and it has an index over the key column, the rows of the other range are looked up in the index instead.
+ * @param[in] left the left operand
+ * @param[in] leftRows range of the left operand data rows ( first, past the last )
+ * @param[in] right the right operand
+ * @param[in] rightRows range of the right operand data rows
+ * @param[in] keys names of the key columns
+ * @return pairs of the matching data rows of the operands ( left, right ), ordered
+ */
+CJoinEngine::TMatches CBinaryQuery::MatchRows ( const CTable & left, const pair<size_t, size_t> & leftRows, const CTable & right, const pair<size_t, size_t> & rightRows, const vector<string> & keys ) const {
+	CJoinEngine::TMatches matches;
+	CTable leftPart, rightPart;
+	bool leftWhole = leftRows.first == 0 && leftRows.second == left.GetDataRowCount( );
+	bool rightWhole = rightRows.first == 0 && rightRows.second == right.GetDataRowCount( );
+	if ( ( ! leftWhole && ! left.GetRowRange( leftRows.first, leftRows.second, & leftPart ) )
+	     || ( ! rightWhole && ! right.GetRowRange( rightRows.first, rightRows.second, & rightPart ) ) )
+		return matches;
+	const CTable & tableLeft = leftWhole ? left : leftPart, & tableRight = rightWhole ? right : rightPart;
+
+	const CIndex * index = nullptr;
+	size_t keyLeft, keyRight;
+	if ( CQuerySett::m_JoinAlgorithm == CQuerySett::JOIN_AUTO && keys.size( ) == 1 && tableLeft.VerifyColumn( keys.front( ), keyLeft )
+	     && tableRight.VerifyColumn( keys.front( ), keyRight ) && tableLeft.GetColumn( keyLeft ) && tableRight.GetColumn( keyRight ) ) {
+		for ( const CIndex * i : m_Database.GetIndexes( m_TableNames.second ) )
+			if ( rightWhole && i->GetPosition( ) == keyRight )
+				index = i;
+		if ( index )
+			matches = index->Join( * tableLeft.GetColumn( keyLeft ) );
+		else {
+			for ( const CIndex * i : m_Database.GetIndexes( m_TableNames.first ) )
+				if ( leftWhole && i->GetPosition( ) == keyLeft )
+					index = i;
+			if ( index ) {
+				matches = index->Join( * tableRight.GetColumn( keyRight ) );
+				for ( auto & i : matches )
+					swap( i.first, i.second );
+			}
+		}
+	}
+	if ( ! index ) {
+		// header is the row 0
+		matches = tableRight.FindOccurences( tableLeft, keys );
+		for ( auto & i : matches ) {
+			-- i.first;
+			-- i.second;
+		}
+	}
 
+	for ( auto & i : matches ) {
+		i.first += leftRows.first;
+		i.second += rightRows.first;
+	}
+	sort( matches.begin( ), matches.end( ) );
+	return matches;
+}
+
+/**
+ * Refreshes the result of a join after rows were appended to its operands, only the new rows are matched
+ * (the new left rows with all the right rows, the old left rows with the new right rows) and their result rows are appended.
+ *
+ * The result rows stay ordered by the left row, as if the join was evaluated again (the queries reading the join rely on it).
+ * The pairs of the new left rows follow the old ones, so they're just appended. The pairs of the new right rows belong
+ * among the pairs of their left rows though - they're merged into the pairs kept from the evaluation (see CJoinOperator::Keep)
+ * and the new result rows are moved to their positions, the result then has to be reported as rewritten.
+ * If the pairs weren't kept (the optimizer replaced the join), the join is evaluated again instead.
+ * @param[in, out] result the join result
+ * @param[in] keys names of the key columns
+ * @param[in] columns operand columns of the result (see CJoinOperator)
+ * @param[in] header header of the result
+ * @param[in] changes changed tables and saved queries (see CTableQuery::Refresh)
+ * @param[out] rows the number of result rows before the refresh, REWRITTEN if the new rows were merged into the old ones
+ * @return false if the join has to be evaluated again
+ */
+bool CBinaryQuery::RefreshJoin ( CTable * & result, const vector<string> & keys, const vector<COperator::TColumnRef> & columns,
+                                 const vector<string> & header, const CTableQuery::TChanges & changes, size_t & rows ) {
+	auto changeLeft = changes.find( m_TableNames.first ), changeRight = changes.find( m_TableNames.second );
+	const CTable * left = m_Database.GetContents( m_TableNames.first ), * right = m_Database.GetContents( m_TableNames.second );
+	if ( ! result || ! left || ! right || ( changeLeft != changes.end( ) && changeLeft->second == CTableQuery::REWRITTEN )
+	     || ( changeRight != changes.end( ) && changeRight->second == CTableQuery::REWRITTEN ) )
+		return false;
+	pair<size_t, size_t> rowsLeft { changeLeft == changes.end( ) ? left->GetDataRowCount( ) : changeLeft->second, left->GetDataRowCount( ) };
+	pair<size_t, size_t> rowsRight { changeRight == changes.end( ) ? right->GetDataRowCount( ) : changeRight->second, right->GetDataRowCount( ) };
+	if ( rowsRight.first != rowsRight.second && ! m_Matched )
+		return false;
+
+	CJoinEngine::TMatches added = MatchRows( * left, rowsLeft, * right, { 0, rowsRight.first }, keys );
+	if ( rowsRight.first != rowsRight.second ) {
+		CJoinEngine::TMatches addedRight = MatchRows( * left, { 0, rowsLeft.second }, * right, rowsRight, keys ), merged;
+		merged.reserve( added.size( ) + addedRight.size( ) );
+		merge( added.begin( ), added.end( ), addedRight.begin( ), addedRight.end( ), back_inserter( merged ) );
+		added.swap( merged );
+	}
+
+	vector<size_t> gatherLeft, gatherRight;
+	for ( const auto & i : added ) {
+		gatherLeft.push_back( i.first );
+		gatherRight.push_back( i.second );
+	}
+	vector<unique_ptr<CColumn>> gathered;
+	for ( const COperator::TColumnRef & i : columns ) {
+		const CColumn * column = ( i.first ? right : left )->GetColumn( i.second );
+		if ( ! column )
+			return false;
+		gathered.emplace_back( column->Gather( i.first ? gatherRight : gatherLeft ) );
+	}
+	rows = result->GetDataRowCount( );
+	if ( ! result->AppendRows( gathered ) )
+		return false;
+
+	// the new pairs follow the old ones
+	if ( added.empty( ) || m_Matches.empty( ) || m_Matches.back( ) < added.front( ) ) {
+		if ( m_Matched )
+			m_Matches.insert( m_Matches.end( ), added.begin( ), added.end( ) );
+		return true;
+	}
+
+	// the appended result rows are moved among the old ones (the old rows come first in the result)
+	CJoinEngine::TMatches merged;
+	vector<size_t> order;
+	merged.reserve( m_Matches.size( ) + added.size( ) );
+	order.reserve( m_Matches.size( ) + added.size( ) );
+	for ( size_t i = 0, j = 0; i < m_Matches.size( ) || j < added.size( ); ) {
+		bool old = j == added.size( ) || ( i < m_Matches.size( ) && m_Matches[ i ] < added[ j ] );
+		merged.push_back( old ? m_Matches[ i ] : added[ j ] );
+		order.push_back( old ? i ++ : rows + j ++ );
+	}
+	vector<CColumn *> data;
+	for ( size_t i = 0; i < result->GetColumnCount( ); ++ i )
+		data.push_back( result->GetColumn( i )->Gather( order ) );
+	delete result;
+	result = new CTable { header, data };
+	m_Matches.swap( merged );
+	rows = CTableQuery::REWRITTEN;
 	return true;
 }
@@ -1,9 +1,16 @@
 #pragma once
 
 #include "../database/CDatabase.hpp"
+#include "../database/CJoinEngine.hpp"
+#include "../database/CQuerySett.hpp"
+#include "../pipeline/CSetOperator.hpp"
 
 /*
  * Stores binary query operand data, and provides methods to validate them.
+ * Each operand is read by a pipeline stage - a scan of a table, or the stage of a saved query (see CTableQuery::CreateOperator).
+ * Set operations are evaluated here as well. The operands are never modified (they may be shared base tables),
+ * their headers are matched by a column permutation instead of reordering their columns.
+ * A saved join is refreshed by matching only the rows appended to its operands (RefreshJoin).
  */
 class CBinaryQuery {
 public:
@@ -13,7 +20,13 @@ protected:
 	CDatabase & m_Database;
 	pair<CQueryOperand, CQueryOperand> m_Operands;
 	pair<string, string> m_TableNames;
+	CJoinEngine::TMatches m_Matches;
+	bool m_Matched = false;
 
 	bool SaveTableReferences ( );
-	bool ValidateColumnTypes ( ) const;
+	bool AlignColumns ( vector<size_t> & permutation ) const;
+	COperator * CreateSetOperation ( const CSetOperator::EOperation & operation, const vector<size_t> & permutation );
+	vector<string> GetOperandNames ( ) const { return { m_TableNames.first, m_TableNames.second }; }
+	CJoinEngine::TMatches MatchRows ( const CTable & left, const pair<size_t, size_t> & leftRows, const CTable & right, const pair<size_t, size_t> & rightRows, const vector<string> & keys ) const;
+	bool RefreshJoin ( CTable * & result, const vector<string> & keys, const vector<COperator::TColumnRef> & columns, const vector<string> & header, const CTableQuery::TChanges & changes, size_t & rows );
 };
@@ -1,19 +1,22 @@
 #include "CCartesian.hpp"
 
-CCartesian::CCartesian ( CDatabase & ref, const pair<string, string> & tableNames ) : CBinaryQuery( ref, std::make_pair( tableNames.first, tableNames.second ) ) { }
+CCartesian::CCartesian ( CDatabase & ref, const pair<string, string> & tableNames, const size_t & offset, const size_t & limit )
+: CBinaryQuery( ref, std::make_pair( tableNames.first, tableNames.second ) ), m_Offset( offset ), m_Limit( limit ) { }
 
 CCartesian::~CCartesian ( ) {
 	delete m_QueryResult;
+	delete m_Product;
+	delete m_Left;
+	delete m_Right;
 }
 
 bool CCartesian::Evaluate ( ) {
 	if ( ! SaveTableReferences( ) )
 		return false;
 
-	CTable * a = m_Operands.first.m_TRef;
-	CTable * b = m_Operands.second.m_TRef;
-	vector<string> colsA = a->GetColumnNames( );
-	vector<string> colsB = b->GetColumnNames( );
+	vector<string> colsA = m_Operands.first.m_Plan->GetHeader( );
+	vector<string> colsB = m_Operands.second.m_Plan->GetHeader( );
+	size_t countA = colsA.size( ), countB = colsB.size( );
 
 	size_t tmp = 0;
 	vector<string>::iterator it;
@@ -27,38 +30,96 @@ bool CCartesian::Evaluate ( ) {
 	}
 
 	colsA.insert( colsA.end( ), colsB.begin( ), colsB.end( ) );
-	if ( ( a->GetColumnCount( ) + b->GetColumnCount( ) ) != colsA.size( ) )
+	if ( ( countA + countB ) != colsA.size( ) )
 		return false;
 
-	m_QueryResult = new CTable ( colsA );
-
-	vector<CCell *> x, y;
-	size_t amax = a->GetRowCount( );
-	size_t bmax = b->GetRowCount( );
-	for ( size_t i = 1; i < amax; ++i ) {
-		for ( size_t j = 1; j < bmax; ++j ) {
-			if ( ! a->GetDeepRow( i, x ) || ! b->GetDeepRow( j, y ) )
-				return false;
-			m_QueryResult->InsertShallowRow( CTable::MergeRows( x, y ) );
-			x.clear( );
-			y.clear( );
-		}
+	// a planned product isn't evaluated, its plan reads the operands
+	m_SchemaVersion = m_Database.GetSchemaVersion( );
+	if ( m_PlanOnly ) {
+		m_Header = colsA;
+		delete Execute( new CProductOperator( m_Operands.first.m_Plan.release( ), m_Operands.second.m_Plan.release( ), m_Header, m_Offset, m_Limit ) );
+		return true;
 	}
 
+	// operands share the data of the tables (a saved product is created though), the pairs of rows are generated once they are needed
+	vector<string> planA, planB;
+	m_Operands.first.m_Plan.reset( COptimizer::Optimize( m_Operands.first.m_Plan.release( ) ) );
+	m_Operands.second.m_Plan.reset( COptimizer::Optimize( m_Operands.second.m_Plan.release( ) ) );
+	m_Left = COperator::Materialize( * m_Operands.first.m_Plan );
+	m_Right = COperator::Materialize( * m_Operands.second.m_Plan );
+	m_Operands.first.m_Plan->Explain( planA, 1 );
+	m_Operands.second.m_Plan->Explain( planB, 1 );
+	m_Operands.first.m_Plan.reset( );
+	m_Operands.second.m_Plan.reset( );
+	if ( ! m_Left || ! m_Right )
+		return false;
+	m_Header = colsA;
+	m_Plan = { unique_ptr<COperator>( CreateOperator( m_QuerySaveName ) )->Describe( ) };
+	m_Plan.insert( m_Plan.end( ), planA.begin( ), planA.end( ) );
+	m_Plan.insert( m_Plan.end( ), planB.begin( ), planB.end( ) );
+	m_Product = new CProduct ( * m_Left, * m_Right );
+	m_Product->SetPage( m_Offset, m_Limit );
+	if ( ! m_Product->GetSize( ) ) {
+		CLog::Msg( CLog::QP, CLog::QP_EMPTY_RESULTS );
+		return false;
+	}
 	return true;
 }
 
+vector<string> CCartesian::GetOperands ( ) const {
+	return GetOperandNames( );
+}
+
+/**
+ * The product is created again over the current operands, it stays lazy (the pairs aren't generated until they're needed).
+ * If the product can't be created, the result is an empty table.
+ * @param[in] changes changed tables and saved queries
+ * @return REWRITTEN
+ */
+size_t CCartesian::Refresh ( const TChanges & changes ) {
+	delete m_QueryResult;
+	delete m_Product;
+	delete m_Left;
+	delete m_Right;
+	m_QueryResult = nullptr;
+	m_Product = nullptr;
+	m_Left = m_Right = nullptr;
+	if ( ! Evaluate( ) && ! m_Product ) {
+		delete m_QueryResult;
+		m_QueryResult = new CTable { m_Header };
+	}
+	return REWRITTEN;
+}
+
 CTable * CCartesian::GetQueryResult ( ) {
+	if ( ! m_QueryResult && m_Product )
+		m_QueryResult = m_Product->Materialize( m_Header );
 	return m_QueryResult;
 }
 
+/**
+ * The lazy product only keeps its operands.
+ */
+size_t CCartesian::GetResultSize ( ) {
+	if ( m_QueryResult )
+		return m_QueryResult->GetMemorySize( );
+	return ( m_Left ? m_Left->GetMemorySize( ) : 0 ) + ( m_Right ? m_Right->GetMemorySize( ) : 0 );
+}
+
+void CCartesian::RenderResult ( ostream & ost ) {
+	if ( m_QueryResult || ! m_Product )
+		ost << * GetQueryResult( );
+	else
+		m_Product->Render( m_Header, ost );
+}
+
 void CCartesian::ArchiveQueryName ( const string & name ) {
 	if ( m_QuerySaveName != name )
 		m_QuerySaveName = name;
 }
 
 string CCartesian::GetSQL ( ) const {
-	if ( ! m_QueryResult )
+	if ( m_Header.empty( ) )
 		return "";
 
 	CTableQuery * origin;
@@ -69,10 +130,26 @@ string CCartesian::GetSQL ( ) const {
 	output += origin ? origin->GetSQL() : string( CLog::APP_COLOR_RESULT ).append( m_TableNames.first ).append( CLog::APP_COLOR_RESET );
 	output += " CROSS JOIN ";
 	origin = m_Operands.second.m_Origin;
-	output += origin ? origin->GetSQL() : string( CLog::APP_COLOR_RESULT ).append( m_TableNames.second ).append( CLog::APP_COLOR_RESET ).append( " )");
+	output += origin ? origin->GetSQL() : string( CLog::APP_COLOR_RESULT ).append( m_TableNames.second ).append( CLog::APP_COLOR_RESET );
+	if ( m_Limit != CProduct::NO_LIMIT )
+		output += string( " LIMIT " ).append( CLog::APP_COLOR_RESULT ).append( to_string( m_Limit ) ).append( CLog::APP_COLOR_RESET );
+	if ( m_Offset )
+		output += string( " OFFSET " ).append( CLog::APP_COLOR_RESULT ).append( to_string( m_Offset ) ).append( CLog::APP_COLOR_RESET );
+	if ( ! origin )
+		output += " )";
 	return output;
 }
 
 bool CCartesian::IsDerived ( ) const {
 	return false;
 }
+
+/**
+ * Other queries read the product by its pairs of rows, unless the result table was already created (and possibly renamed by ALIAS).
+ * The product stage reads the evaluated operands, so the filters of those queries can be moved to its sides (see COptimizer).
+ */
+COperator * CCartesian::CreateOperator ( const string & name ) {
+	if ( m_QueryResult )
+		return CTableQuery::CreateOperator( name );
+	return new CProductOperator( new CScanOperator( * m_Left, m_TableNames.first ), new CScanOperator( * m_Right, m_TableNames.second ), m_Header, m_Offset, m_Limit );
+}
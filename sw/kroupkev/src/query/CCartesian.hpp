@@ -2,22 +2,40 @@
 
 #include "CBinaryQuery.hpp"
 #include "../database/CDatabase.hpp"
+#include "../database/CCondition.hpp"
+#include "../database/CProduct.hpp"
+#include "../pipeline/CProductOperator.hpp"
+#include "../pipeline/COptimizer.hpp"
 
 /*
  * This query will create a table based on cartesian product of tables A and B.
+ * The product is lazy (see CProduct), the result table is only created once it's needed as a whole (e.g. ALIAS, EXPORT).
+ * Other queries read the product by a pipeline stage (see CProductOperator), so a filter over the product (PRO) is evaluated on one side of it.
+ * The product can be limited to a page of rows.
  */
 class CCartesian : public CBinaryQuery, public CTableQuery {
 private:
 	CTable * m_QueryResult = nullptr;
+	CTable * m_Left = nullptr;
+	CTable * m_Right = nullptr;
+	CProduct * m_Product = nullptr;
+	vector<string> m_Header;
+	size_t m_Offset;
+	size_t m_Limit;
 	string m_QuerySaveName;
 
 public:
-	explicit CCartesian ( CDatabase & ref, const pair<string, string> & tableNames );
+	explicit CCartesian ( CDatabase & ref, const pair<string, string> & tableNames, const size_t & offset = 0, const size_t & limit = CProduct::NO_LIMIT );
 	virtual ~CCartesian ( ) override;
 
 	virtual bool Evaluate ( ) override;
 	virtual CTable * GetQueryResult ( ) override;
+	virtual void RenderResult ( ostream & ost = cout ) override;
+	virtual size_t GetResultSize ( ) override;
 	virtual void ArchiveQueryName ( const string & name ) override;
 	virtual string GetSQL ( ) const override;
 	virtual bool IsDerived ( ) const override;
+	virtual vector<string> GetOperands ( ) const override;
+	virtual size_t Refresh ( const TChanges & changes ) override;
+	virtual COperator * CreateOperator ( const string & name ) override;
 };
@@ -10,79 +10,50 @@ CJoin::~CJoin ( ) {
 }
 
 bool CJoin::Evaluate ( ) {
+	m_Columns.clear( );
+	m_Header.clear( );
+	m_Matches.clear( );
+	m_Matched = false;
 	if ( ! SaveTableReferences( ) )
 		return false;
 
-	size_t tmp;
-	if ( ! m_Operands.first.m_TRef->VerifyColumn( m_CommonCol, tmp ) || ! m_Operands.second.m_TRef->VerifyColumn( m_CommonCol, tmp ) )
+	const vector<string> & headerA = m_Operands.first.m_Plan->GetHeader( );
+	const vector<string> & headerB = m_Operands.second.m_Plan->GetHeader( );
+	if ( find( headerA.begin( ), headerA.end( ), m_CommonCol ) == headerA.end( ) || find( headerB.begin( ), headerB.end( ), m_CommonCol ) == headerB.end( ) )
 		return false;
 
-	vector<pair<string, int>> newHeaderColumns { };
-	newHeaderColumns.emplace_back( m_CommonCol, 2 );
-	for ( const auto & i : m_Operands.first.m_TRef->GetColumnNames( ) )
-		if ( i != m_CommonCol )
-			newHeaderColumns.emplace_back( i, 1 );
-
-	for ( const auto & i : m_Operands.second.m_TRef->GetColumnNames( ) )
-		if ( i != m_CommonCol )
-			newHeaderColumns.emplace_back( i, 0 );
-
-	vector<CCell *> tmpColumn;
-	if ( ! m_Operands.first.m_TRef->GetShallowCol( newHeaderColumns.at( 0 ).first, tmpColumn ) )
-		return false;
-	m_QueryResult = new CTable ( newHeaderColumns );
-
-	vector<pair<size_t, size_t>> tableIndexes = m_Operands.second.m_TRef->FindOccurences( tmpColumn );
-
-	if ( tableIndexes.empty( ) ) {
-		CLog::Msg( CLog::QP, CLog::QP_EMPTY_RESULTS );
-		return false;
-	}
-
-	vector<string> colsA, colsB;
-	for ( const auto & i : newHeaderColumns )
-		if ( i.second == 2 || i.second == 1 )
-			colsA.emplace_back( i.first );
-		else
-			colsB.emplace_back( i.first );
-
-	tmpColumn.clear( );
-	vector<CCell *> aPar, bPar;
-	for ( const auto & i : tableIndexes ) {
-		if ( colsB.empty( ) ) {
-			if ( ! m_Operands.first.m_TRef->GetDeepRow( i.first, colsA, aPar ) ) {
-				for ( const auto & y : aPar ) delete y;
-				for ( const auto & y : bPar ) delete y;
-			}
-		} else {
-			if ( ! m_Operands.first.m_TRef->GetDeepRow( i.first, colsA, aPar ) || ! m_Operands.second.m_TRef->GetDeepRow( i.second, colsB, bPar ) ) {
-				for ( const auto & y : aPar ) delete y;
-				for ( const auto & y : bPar ) delete y;
-				return false;
-			}
+	// the common column, then the other left columns, then the other right ones
+	m_Columns.emplace_back( false, find( headerA.begin( ), headerA.end( ), m_CommonCol ) - headerA.begin( ) );
+	m_Header.push_back( m_CommonCol );
+	for ( size_t i = 0; i < headerA.size( ); ++ i )
+		if ( headerA[ i ] != m_CommonCol ) {
+			m_Columns.emplace_back( false, i );
+			m_Header.push_back( headerA[ i ] );
 		}
-		tmpColumn = CTable::MergeRows( aPar, bPar );
-		if ( ! m_QueryResult->InsertShallowRow( tmpColumn ) )
-			return false;
-	}
-
-	tmp = 0;
-	for ( const auto & i : newHeaderColumns ) {
-		if ( i.second == 1 || i.second == 2 ) {
-			for ( const auto & j : newHeaderColumns ) {
-				if ( j.second == 0 && i.first == j.first ) {
-					m_QueryResult->VerifyColumn( i.first, tmp );
-					m_QueryResult->ChangeColumnName( tmp, string( m_TableNames.first ).append( "." ).append( i.first ) );
-					m_QueryResult->VerifyColumn( j.first, tmp );
-					m_QueryResult->ChangeColumnName( tmp, string( m_TableNames.second ).append( "." ).append( i.first ) );
-				}
-			}
-		} else {
-			break;
+	size_t leftCount = m_Header.size( );
+	for ( size_t i = 0; i < headerB.size( ); ++ i )
+		if ( headerB[ i ] != m_CommonCol ) {
+			m_Columns.emplace_back( true, i );
+			m_Header.push_back( headerB[ i ] );
 		}
+
+	// columns present in both tables are prefixed by their table names
+	for ( size_t i = 0; i < leftCount; ++ i ) {
+		size_t j = find( m_Header.begin( ) + leftCount, m_Header.end( ), m_Header[ i ] ) - m_Header.begin( );
+		if ( j == m_Header.size( ) )
+			continue;
+		m_Header[ j ] = string( m_TableNames.second ).append( "." ).append( m_Header[ i ] );
+		m_Header[ i ] = string( m_TableNames.first ).append( "." ).append( m_Header[ i ] );
 	}
 
-	return true;
+	m_SchemaVersion = m_Database.GetSchemaVersion( );
+	// the pairs are kept for the refresh, unless the optimizer replaced the join (see CBinaryQuery::RefreshJoin)
+	auto * join = new CJoinOperator( m_Operands.first.m_Plan.release( ), m_Operands.second.m_Plan.release( ), { m_CommonCol }, m_Columns, m_Header );
+	join->Keep( & m_Matches );
+	if ( ! ( m_QueryResult = Execute( join ) ) )
+		return false;
+	m_Matched = m_Matches.size( ) == m_QueryResult->GetDataRowCount( );
+	return CheckRows( * m_QueryResult );
 }
 
 CTable * CJoin::GetQueryResult ( ) {
@@ -115,3 +86,30 @@ string CJoin::GetSQL ( ) const {
 bool CJoin::IsDerived ( ) const {
 	return false;
 }
+
+vector<string> CJoin::GetOperands ( ) const {
+	return GetOperandNames( );
+}
+
+/**
+ * Only the rows appended to the operands are matched (see CBinaryQuery::RefreshJoin), the query is evaluated again
+ * if an operand was rewritten.
+ * @param[in] changes changed tables and saved queries
+ * @return the number of result rows before the refresh, REWRITTEN if the result was replaced
+ */
+size_t CJoin::Refresh ( const TChanges & changes ) {
+	size_t rows;
+	if ( RefreshJoin( m_QueryResult, { m_CommonCol }, m_Columns, m_Header, changes, rows ) )
+		return rows;
+	return Recompute( m_QueryResult );
+}
+
+/**
+ * Other queries read the join by the stages of its definition, so their filters can be moved below it.
+ * The result table is scanned instead if a column was renamed since the query was evaluated.
+ */
+COperator * CJoin::CreateOperator ( const string & name ) {
+	if ( m_SchemaVersion != m_Database.GetSchemaVersion( ) )
+		return CTableQuery::CreateOperator( name );
+	return new CJoinOperator( m_Database.CreateOperator( m_TableNames.first ), m_Database.CreateOperator( m_TableNames.second ), { m_CommonCol }, m_Columns, m_Header );
+}
@@ -3,6 +3,7 @@
 #include <utility>
 
 #include "CBinaryQuery.hpp"
+#include "../pipeline/CJoinOperator.hpp"
 #include "../database/CDatabase.hpp"
 
 /*
@@ -14,6 +15,8 @@ private:
 	CTable * m_QueryResult = nullptr;
 	string m_QuerySaveName;
 	string m_CommonCol;
+	vector<COperator::TColumnRef> m_Columns;
+	vector<string> m_Header;
 
 public:
 	explicit CJoin ( CDatabase & ref, string column, const pair<string, string> & tableNames );
@@ -24,4 +27,7 @@ public:
 	virtual void ArchiveQueryName ( const string & name ) override;
 	virtual string GetSQL ( ) const override;
 	virtual bool IsDerived ( ) const override;
+	virtual vector<string> GetOperands ( ) const override;
+	virtual size_t Refresh ( const TChanges & changes ) override;
+	virtual COperator * CreateOperator ( const string & name ) override;
 };
\ No newline at end of file
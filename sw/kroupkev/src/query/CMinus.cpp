@@ -10,69 +10,16 @@ bool CMinus::Evaluate ( ) {
 	if ( ! SaveTableReferences( ) )
 		return false;
 
-	vector<string> tmpHeader = m_Operands.first.m_TRef->GetColumnNames( );
-
-	// save current indexes and their column values
-	vector<pair<size_t, size_t>> columnOrders;
-	vector<string> headerUnsorted;
-	size_t max = tmpHeader.size( );
-	for ( size_t i = 0; i < max; ++i ) {
-		columnOrders.emplace_back( i, 0 );
-		headerUnsorted.emplace_back( tmpHeader.at( i ) );
-	}
-	tmpHeader.clear( );
-
-	// sort both table headers
-	m_Operands.first.m_TRef->SortColumns( );
-	m_Operands.second.m_TRef->SortColumns( );
-	tmpHeader = m_Operands.first.m_TRef->GetColumnNames( );
-
-	if ( ! m_Operands.first.m_TRef->HasIdenticalHeader( m_Operands.second.m_TRef ) ) {
-		CLog::Msg( CLog::QP, CLog::QP_DIFF_HEADER );
-		return false;
-	}
-
-	// correct data type check
-	if ( ! ValidateColumnTypes( ) )
+	// the operand columns are matched by their names, the operands themselves stay untouched
+	vector<size_t> permutation;
+	if ( ! AlignColumns( permutation ) )
 		return false;
 
-	// save current indexes and their column values IN the new order
-	size_t index = 0, tmp = 0;
-	for ( const auto & i : headerUnsorted ) {
-		tmp = find( tmpHeader.begin(), tmpHeader.end(), i ) - tmpHeader.begin( );
-		if ( tmp >= headerUnsorted.size( ) )
-			return false;
-		columnOrders.at( index++ ).second = tmp;
-	}
-
-	m_QueryResult = new CTable ( m_Operands.first.m_TRef->GetColumnNames( ) );
-
-	// transformation for easier row access
-	vector<vector<CCell *>> tA, tB;
-	CTable::SortRows( ( tA = m_Operands.first.m_TRef->Transform( ) ) );
-	CTable::SortRows( ( tB = m_Operands.second.m_TRef->Transform( ) ) );
-	vector<vector<CCell *>> res ( tA.size( ) + tB.size( ) );
-	set_difference( tA.begin( ), tA.end( ), tB.begin( ), tB.end( ), res.begin( ), CTable::RowComparator( ) );
-
-	size_t resCnt = 0;
-	for ( const auto & i : res ) {
-		if ( i.empty( ) )
-			continue;
-		if ( ! m_QueryResult->InsertShallowRow( CTable::GetDeepRow( i ) ) )
-			return false;
-		++resCnt;
-	}
-
-	if ( ! resCnt ) {
-		CLog::Msg( CLog::QP, CLog::QP_EMPTY_RESULTS );
+	m_SchemaVersion = m_Database.GetSchemaVersion( );
+	m_QueryResult = Execute( CreateSetOperation( CSetOperator::SET_MINUS, permutation ) );
+	if ( ! m_QueryResult )
 		return false;
-	}
-
-	m_QueryResult->SortColumns( columnOrders );
-	m_Operands.first.m_TRef->SortColumns( columnOrders );
-	m_Operands.second.m_TRef->SortColumns( columnOrders );
-
-	return true;
+	return CheckRows( * m_QueryResult );
 }
 
 CTable * CMinus::GetQueryResult ( ) {
@@ -104,3 +51,14 @@ string CMinus::GetSQL ( ) const {
 bool CMinus::IsDerived ( ) const {
 	return false;
 }
+
+vector<string> CMinus::GetOperands ( ) const {
+	return GetOperandNames( );
+}
+
+/**
+ * The set operation is evaluated again.
+ */
+size_t CMinus::Refresh ( const TChanges & changes ) {
+	return Recompute( m_QueryResult );
+}
@@ -20,4 +20,6 @@ public:
 	virtual void ArchiveQueryName ( const string & name ) override;
 	virtual string GetSQL ( ) const override;
 	virtual bool IsDerived ( ) const override;
+	virtual vector<string> GetOperands ( ) const override;
+	virtual size_t Refresh ( const TChanges & changes ) override;
 };
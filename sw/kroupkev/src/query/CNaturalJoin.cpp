@@ -8,11 +8,16 @@ CNaturalJoin::~CNaturalJoin ( ) {
 }
 
 bool CNaturalJoin::Evaluate ( ) {
+	m_Keys.clear( );
+	m_Columns.clear( );
+	m_Header.clear( );
+	m_Matches.clear( );
+	m_Matched = false;
 	if ( ! SaveTableReferences( ) )
 		return false;
 
-	vector<string> colsA = m_Operands.first.m_TRef->GetColumnNames( );
-	vector<string> colsB = m_Operands.second.m_TRef->GetColumnNames( );
+	vector<string> colsA = m_Operands.first.m_Plan->GetHeader( );
+	vector<string> colsB = m_Operands.second.m_Plan->GetHeader( );
 
 	// search for common columns
 	// 0 for independent right columns
@@ -55,55 +60,30 @@ bool CNaturalJoin::Evaluate ( ) {
 			newHeaderColumns.emplace_back( pair<string, int> { i, 0 } );
 		foundCommon = false;
 	}
-	m_QueryResult = new CTable ( newHeaderColumns );
-
-	vector<vector<CCell *>> requiredColumns;
-	vector<CCell *> tmp;
-	for ( const auto & i : newHeaderColumns ) {
-		if ( i.second == 2 ) {
-			if ( ! m_Operands.first.m_TRef->GetShallowCol( i.first, tmp ) )
-				return false;
-			requiredColumns.emplace_back( tmp );
+	for ( const auto & i : newHeaderColumns )
+		if ( i.second == 2 )
+			m_Keys.emplace_back( i.first );
+
+	// the common and the left columns come from the left table, the rest from the right one
+	for ( const auto & i : newHeaderColumns )
+		if ( i.second == 2 || i.second == 1 ) {
+			m_Columns.emplace_back( false, find( colsA.begin( ), colsA.end( ), i.first ) - colsA.begin( ) );
+			m_Header.push_back( i.first );
 		}
-	}
-
-	tmp.clear( );
-	colsA.clear( );
-	colsB.clear( );
-
-	vector<pair<size_t, size_t>> tableIndexes = m_Operands.second.m_TRef->FindOccurences( requiredColumns );
-	if ( tableIndexes.empty( ) ) {
-		CLog::Msg( CLog::QP, CLog::QP_EMPTY_RESULTS );
-		return false;
-	}
-
-	for ( const auto & i : newHeaderColumns ) {
-		if ( i.second == 2 || i.second == 1 )
-			colsA.emplace_back( i.first );
-		else
-			colsB.emplace_back( i.first );
-	}
-
-	vector<CCell *> aPar, bPar;
-	for ( const auto & i : tableIndexes ) {
-		if ( colsB.empty( ) ) {
-			if ( ! m_Operands.first.m_TRef->GetDeepRow( i.first, colsA, aPar ) ) {
-				for ( const auto & y : aPar ) delete y;
-				for ( const auto & y : bPar ) delete y;
-			}
-		} else {
-			if ( ! m_Operands.first.m_TRef->GetDeepRow( i.first, colsA, aPar ) || ! m_Operands.second.m_TRef->GetDeepRow( i.second, colsB, bPar ) ) {
-				for ( const auto & y : aPar ) delete y;
-				for ( const auto & y : bPar ) delete y;
-				return false;
-			}
+	for ( const auto & i : newHeaderColumns )
+		if ( i.second == 0 ) {
+			m_Columns.emplace_back( true, find( colsB.begin( ), colsB.end( ), i.first ) - colsB.begin( ) );
+			m_Header.push_back( i.first );
 		}
-		tmp = CTable::MergeRows( aPar, bPar );
-		if ( ! m_QueryResult->InsertShallowRow( tmp ) )
-			return false;
-	}
 
-	return true;
+	m_SchemaVersion = m_Database.GetSchemaVersion( );
+	// the pairs are kept for the refresh, unless the optimizer replaced the join (see CBinaryQuery::RefreshJoin)
+	auto * join = new CJoinOperator( m_Operands.first.m_Plan.release( ), m_Operands.second.m_Plan.release( ), m_Keys, m_Columns, m_Header );
+	join->Keep( & m_Matches );
+	if ( ! ( m_QueryResult = Execute( join ) ) )
+		return false;
+	m_Matched = m_Matches.size( ) == m_QueryResult->GetDataRowCount( );
+	return CheckRows( * m_QueryResult );
 }
 
 CTable * CNaturalJoin::GetQueryResult ( ) {
@@ -134,4 +114,31 @@ string CNaturalJoin::GetSQL ( ) const {
 
 bool CNaturalJoin::IsDerived ( ) const {
 	return false;
+}
+
+vector<string> CNaturalJoin::GetOperands ( ) const {
+	return GetOperandNames( );
+}
+
+/**
+ * Only the rows appended to the operands are matched (see CBinaryQuery::RefreshJoin), the query is evaluated again
+ * if an operand was rewritten.
+ * @param[in] changes changed tables and saved queries
+ * @return the number of result rows before the refresh, REWRITTEN if the result was replaced
+ */
+size_t CNaturalJoin::Refresh ( const TChanges & changes ) {
+	size_t rows;
+	if ( RefreshJoin( m_QueryResult, m_Keys, m_Columns, m_Header, changes, rows ) )
+		return rows;
+	return Recompute( m_QueryResult );
+}
+
+/**
+ * Other queries read the join by the stages of its definition, so their filters can be moved below it.
+ * The result table is scanned instead if a column was renamed since the query was evaluated.
+ */
+COperator * CNaturalJoin::CreateOperator ( const string & name ) {
+	if ( m_SchemaVersion != m_Database.GetSchemaVersion( ) )
+		return CTableQuery::CreateOperator( name );
+	return new CJoinOperator( m_Database.CreateOperator( m_TableNames.first ), m_Database.CreateOperator( m_TableNames.second ), m_Keys, m_Columns, m_Header );
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "CBinaryQuery.hpp"
+#include "../pipeline/CJoinOperator.hpp"
 #include "../database/CDatabase.hpp"
 
 /*
@@ -10,6 +11,9 @@ class CNaturalJoin : public CBinaryQuery, public CTableQuery {
 private:
 	CTable * m_QueryResult = nullptr;
 	string m_QuerySaveName;
+	vector<string> m_Keys;
+	vector<COperator::TColumnRef> m_Columns;
+	vector<string> m_Header;
 
 public:
 	explicit CNaturalJoin ( CDatabase & ref, const pair<string, string> & tableNames );
@@ -20,4 +24,7 @@ public:
 	virtual void ArchiveQueryName ( const string & name ) override;
 	virtual string GetSQL ( ) const override;
 	virtual bool IsDerived ( ) const override;
+	virtual vector<string> GetOperands ( ) const override;
+	virtual size_t Refresh ( const TChanges & changes ) override;
+	virtual COperator * CreateOperator ( const string & name ) override;
 };
\ No newline at end of file
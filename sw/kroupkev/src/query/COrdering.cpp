@@ -0,0 +1,87 @@
+#include "COrdering.hpp"
+
+COrdering::COrdering ( CDatabase & ref, vector<string> keys, vector<bool> descending, const size_t & offset, const size_t & limit, string tableName )
+: m_Database( ref ), m_Keys( std::move( keys ) ), m_Descending( std::move( descending ) ), m_Offset( offset ), m_Limit( limit ), m_TableName( std::move( tableName ) ) { }
+
+COrdering::~COrdering ( ) {
+	delete m_QueryResult;
+}
+
+/**
+ * Evaluates the query and saves the result.
+ * @return true if all query prerequisities were fulfilled and this object holds the query result.
+ */
+bool COrdering::Evaluate ( ) {
+	CTable * tableRef;
+	CTableQuery * queryRef;
+	COperator * input;
+	if ( ( tableRef = m_Database.GetTable( m_TableName ) ) != nullptr )
+		input = m_Database.CreateOperator( m_TableName );
+	else if ( ( queryRef = m_Database.GetTableQ( m_TableName ) ) != nullptr ) {
+		m_Derived = true;
+		m_Origin = queryRef;
+		input = queryRef->CreateOperator( m_TableName );
+	} else {
+		CLog::HighlightedMsg( CLog::QP, m_TableName, CLog::QP_NO_SUCH_TABLE );
+		return false;
+	}
+
+	m_SchemaVersion = m_Database.GetSchemaVersion( );
+	if ( ! ( m_QueryResult = Execute( new CSortOperator( input, m_Keys, m_Descending, m_Offset, m_Limit ) ) ) )
+		return false;
+	return CheckRows( * m_QueryResult );
+}
+
+CTable * COrdering::GetQueryResult ( ) {
+	return m_QueryResult;
+}
+
+void COrdering::ArchiveQueryName ( const string & name ) {
+	if ( m_QuerySaveName != name )
+		m_QuerySaveName = name;
+}
+
+string COrdering::GetSQL ( ) const {
+	if ( ! m_QueryResult )
+		return "";
+
+	string output = "( SELECT ";
+	output += string( CLog::APP_COLOR_RESULT ).append( "*" ).append( CLog::APP_COLOR_RESET );
+	output += " FROM " + string( m_Derived ? "" : string( CLog::APP_COLOR_RESULT ).append( m_TableName ).append( CLog::APP_COLOR_RESET ) );
+
+	if ( m_Origin )
+		output += m_Origin->GetSQL( );
+	for ( size_t i = 0; i < m_Keys.size( ); ++ i )
+		output += string( i ? ", " : " ORDER BY " ).append( CLog::APP_COLOR_RESULT ).append( m_Keys[ i ] ).append( CLog::APP_COLOR_RESET ).append( m_Descending[ i ] ? " DESC" : "" );
+	if ( m_Limit != CProduct::NO_LIMIT )
+		output += " LIMIT " + to_string( m_Limit );
+	if ( m_Offset )
+		output += " OFFSET " + to_string( m_Offset );
+	output += " )";
+	return output;
+}
+
+bool COrdering::IsDerived ( ) const {
+	return m_Derived;
+}
+
+vector<string> COrdering::GetOperands ( ) const {
+	return { m_TableName };
+}
+
+/**
+ * The appended rows may belong anywhere in the order, the query is evaluated again.
+ */
+size_t COrdering::Refresh ( const TChanges & changes ) {
+	return Recompute( m_QueryResult );
+}
+
+/**
+ * Other queries read the ordering by the stages of its definition, so its input is optimized with their plan.
+ * The result table is scanned instead if a column was renamed since the query was evaluated.
+ */
+COperator * COrdering::CreateOperator ( const string & name ) {
+	if ( m_SchemaVersion != m_Database.GetSchemaVersion( ) )
+		return CTableQuery::CreateOperator( name );
+	return new CSortOperator( m_Database.CreateOperator( m_TableName ), m_Keys, m_Descending, m_Offset, m_Limit );
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "CTableQuery.hpp"
+#include "../database/CDatabase.hpp"
+#include "../pipeline/CSortOperator.hpp"
+
+/*
+ * This query orders the rows of a table by the given columns, the result may be limited to a page of the first rows.
+ */
+class COrdering : public CTableQuery {
+private:
+	CDatabase & m_Database;
+	vector<string> m_Keys;
+	vector<bool> m_Descending;
+	size_t m_Offset;
+	size_t m_Limit;
+	string m_TableName;
+
+	CTable * m_QueryResult = nullptr;
+	CTableQuery * m_Origin = nullptr;
+	string m_QuerySaveName;
+	bool m_Derived = false;
+
+public:
+	explicit COrdering ( CDatabase & ref, vector<string> keys, vector<bool> descending, const size_t & offset, const size_t & limit, string tableName );
+	virtual ~COrdering ( ) override;
+
+	virtual bool Evaluate ( ) override;
+	virtual CTable * GetQueryResult ( ) override;
+	virtual void ArchiveQueryName ( const string & name ) override;
+	virtual string GetSQL ( ) const override;
+	virtual bool IsDerived ( ) const override;
+	virtual vector<string> GetOperands ( ) const override;
+	virtual size_t Refresh ( const TChanges & changes ) override;
+	virtual COperator * CreateOperator ( const string & name ) override;
+};
\ No newline at end of file
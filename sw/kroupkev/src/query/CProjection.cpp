@@ -8,23 +8,31 @@ CProjection::~CProjection ( ) {
 	delete m_QueryCondition;
 }
 
+/**
+ * Evaluates the query and saves the result. The filter over a table keeps a selection of its rows,
+ * the filter over a saved query is moved into the stages of that query (e.g. on one side of a cartesian product, see COptimizer).
+ * @return true if all query prerequisities were fulfilled and this object holds the query result.
+ */
 bool CProjection::Evaluate ( ) {
 	CTable * tableRef;
 	CTableQuery * queryRef;
-	if ( ( tableRef = m_Database.GetTable( m_TableName ) ) != nullptr ) {
-		m_QueryResult = new CTable { tableRef->GetDeepHeader( ) };
-		return tableRef->GetDeepTable( m_QueryCondition, m_QueryResult );
-	}
+	COperator * input;
+	if ( ( tableRef = m_Database.GetTable( m_TableName ) ) != nullptr )
+		input = m_Database.CreateOperator( m_TableName );
 	else if ( ( queryRef = m_Database.GetTableQ( m_TableName ) ) != nullptr ) {
 		m_Derived = true;
 		m_Origin = queryRef;
-		m_QueryResult = new CTable { queryRef->GetQueryResult( )->GetDeepHeader( ) };
-		return queryRef->GetQueryResult( )->GetDeepTable( m_QueryCondition, m_QueryResult );
+		input = queryRef->CreateOperator( m_TableName );
 	}
 	else {
 		CLog::HighlightedMsg( CLog::QP, m_TableName, CLog::QP_NO_SUCH_TABLE );
 		return false;
 	}
+
+	m_SchemaVersion = m_Database.GetSchemaVersion( );
+	if ( ! ( m_QueryResult = Execute( new CFilterOperator( input, m_QueryCondition ) ) ) )
+		return false;
+	return CheckRows( * m_QueryResult );
 }
 
 CTable * CProjection::GetQueryResult ( ) {
@@ -55,16 +63,38 @@ string CProjection::GetSQL ( ) const {
 bool CProjection::IsDerived ( ) const {
 	return false;
 }
-string CProjection::AppendWhereClause ( ) const {
-	return string( " WHERE " )
-	.append( CLog::APP_COLOR_RESULT )
-	.append( m_QueryCondition->m_Column )
-	.append( CLog::APP_COLOR_RESET )
-	.append( " " )
-	.append( m_QueryCondition->m_Operator )
-	.append( " " )
-	.append( CLog::APP_COLOR_RESULT )
-	.append( m_QueryCondition->IsStringConstant ? string( "\"" ).append( m_QueryCondition->m_Constant ).append( "\"" ) : m_QueryCondition->m_Constant )
-	.append( CLog::APP_COLOR_RESET )
-	.append( " )");
+
+vector<string> CProjection::GetOperands ( ) const {
+	return { m_TableName };
 }
+
+/**
+ * Only the rows appended to the operand are filtered, the result rows are appended to the old ones.
+ * The query is evaluated again if its operand was rewritten.
+ * @param[in] changes changed tables and saved queries
+ * @return the number of result rows before the refresh, REWRITTEN if the query was evaluated again
+ */
+size_t CProjection::Refresh ( const TChanges & changes ) {
+	auto change = changes.find( m_TableName );
+	const CTable * source;
+	if ( ! m_QueryResult || change == changes.end( ) || change->second == REWRITTEN || ! ( source = m_Database.GetContents( m_TableName ) ) )
+		return Recompute( m_QueryResult );
+	CTable appended;
+	if ( ! source->GetRowRange( change->second, source->GetDataRowCount( ), & appended ) )
+		return m_QueryResult->GetDataRowCount( );
+	return AppendResult( m_QueryResult, new CFilterOperator( new CScanOperator( appended, m_TableName ), m_QueryCondition ) );
+}
+
+/**
+ * Other queries read the projection by the stages of its definition, so its condition can be merged with theirs
+ * or moved below a join. The result table is scanned instead if a column was renamed since the query was evaluated.
+ */
+COperator * CProjection::CreateOperator ( const string & name ) {
+	if ( m_SchemaVersion != m_Database.GetSchemaVersion( ) )
+		return CTableQuery::CreateOperator( name );
+	return new CFilterOperator( m_Database.CreateOperator( m_TableName ), m_QueryCondition );
+}
+
+string CProjection::AppendWhereClause ( ) const {
+	return " WHERE " + m_QueryCondition->GetSQL( ) + " )";
+}
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "CTableQuery.hpp"
 #include "../database/CDatabase.hpp"
 #include "../database/CCondition.hpp"
+#include "../pipeline/CFilterOperator.hpp"
 
 /*
  * This query will filter rows of a table based on given condition.
@@ -29,4 +30,7 @@ public:
 	virtual void ArchiveQueryName ( const string & name ) override;
 	virtual string GetSQL ( ) const override;
 	virtual bool IsDerived ( ) const override;
+	virtual vector<string> GetOperands ( ) const override;
+	virtual size_t Refresh ( const TChanges & changes ) override;
+	virtual COperator * CreateOperator ( const string & name ) override;
 };
\ No newline at end of file
@@ -1,12 +1,15 @@
+#include <memory>
+
 #include "../database/CTable.hpp"
+#include "../pipeline/COperator.hpp"
 #include "CTableQuery.hpp"
 
 /*
- * Encapsulates binary operator queries.
+ * Encapsulates binary operator queries. The operand is read by a pipeline stage (see COperator) until the query is evaluated.
  */
 class CQueryOperand {
 public:
-	CTable * m_TRef          = nullptr;
+	unique_ptr<COperator> m_Plan;
 	CTableQuery * m_QRef     = nullptr;
 	CTableQuery * m_Origin   = nullptr;
 };
\ No newline at end of file
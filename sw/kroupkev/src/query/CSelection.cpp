@@ -13,17 +13,21 @@ CSelection::~CSelection ( ) {
  */
 bool CSelection::Evaluate ( ) {
 	CTable * tableRef;
-	if ( ( tableRef = m_Database.GetTable( m_TableName ) ) != nullptr ) {
-		return tableRef->GetSubTable( m_SelectedCols, ( m_QueryResult = new CTable { } ) );
-	}
 	CTableQuery * queryRef;
-	if ( ( queryRef = m_Database.GetTableQ( m_TableName ) ) != nullptr ) {
+	COperator * input;
+	if ( ( tableRef = m_Database.GetTable( m_TableName ) ) != nullptr )
+		input = m_Database.CreateOperator( m_TableName );
+	else if ( ( queryRef = m_Database.GetTableQ( m_TableName ) ) != nullptr ) {
 		m_Derived = true;
 		m_Origin = queryRef;
-		return queryRef->GetQueryResult( )->GetSubTable( m_SelectedCols, ( m_QueryResult = new CTable { } ) );
+		input = queryRef->CreateOperator( m_TableName );
+	} else {
+		CLog::HighlightedMsg( CLog::QP, m_TableName, CLog::QP_NO_SUCH_TABLE );
+		return false;
 	}
-	CLog::HighlightedMsg( CLog::QP, m_TableName, CLog::QP_NO_SUCH_TABLE );
-	return false;
+
+	m_SchemaVersion = m_Database.GetSchemaVersion( );
+	return ( m_QueryResult = Execute( new CSelectOperator( input, m_SelectedCols ) ) ) != nullptr;
 }
 
 CTable * CSelection::GetQueryResult ( ) {
@@ -59,4 +63,35 @@ string CSelection::GetSQL ( ) const {
 
 bool CSelection::IsDerived ( ) const {
 	return m_Derived;
+}
+
+vector<string> CSelection::GetOperands ( ) const {
+	return { m_TableName };
+}
+
+/**
+ * Only the rows appended to the operand are selected, the result rows are appended to the old ones.
+ * The query is evaluated again if its operand was rewritten.
+ * @param[in] changes changed tables and saved queries
+ * @return the number of result rows before the refresh, REWRITTEN if the query was evaluated again
+ */
+size_t CSelection::Refresh ( const TChanges & changes ) {
+	auto change = changes.find( m_TableName );
+	const CTable * source;
+	if ( ! m_QueryResult || change == changes.end( ) || change->second == REWRITTEN || ! ( source = m_Database.GetContents( m_TableName ) ) )
+		return Recompute( m_QueryResult );
+	CTable appended;
+	if ( ! source->GetRowRange( change->second, source->GetDataRowCount( ), & appended ) )
+		return m_QueryResult->GetDataRowCount( );
+	return AppendResult( m_QueryResult, new CSelectOperator( new CScanOperator( appended, m_TableName ), m_SelectedCols ) );
+}
+
+/**
+ * Other queries read the selection by the stages of its definition, so their plan is optimized as a whole.
+ * The result table is scanned instead if a column was renamed since the query was evaluated.
+ */
+COperator * CSelection::CreateOperator ( const string & name ) {
+	if ( m_SchemaVersion != m_Database.GetSchemaVersion( ) )
+		return CTableQuery::CreateOperator( name );
+	return new CSelectOperator( m_Database.CreateOperator( m_TableName ), m_SelectedCols );
 }
\ No newline at end of file
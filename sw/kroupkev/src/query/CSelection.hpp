@@ -2,6 +2,7 @@
 
 #include "CTableQuery.hpp"
 #include "../database/CDatabase.hpp"
+#include "../pipeline/CSelectOperator.hpp"
 
 /*
  * This query filters the existing columns to ones that the user provide.
@@ -26,4 +27,7 @@ public:
 	virtual void ArchiveQueryName ( const string & name ) override;
 	virtual string GetSQL ( ) const override;
 	virtual bool IsDerived ( ) const override;
+	virtual vector<string> GetOperands ( ) const override;
+	virtual size_t Refresh ( const TChanges & changes ) override;
+	virtual COperator * CreateOperator ( const string & name ) override;
 };
\ No newline at end of file
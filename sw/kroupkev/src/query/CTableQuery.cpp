@@ -0,0 +1,81 @@
+#include "CTableQuery.hpp"
+#include "../pipeline/COptimizer.hpp"
+
+const size_t CTableQuery::REWRITTEN = SIZE_MAX;
+
+/**
+ * Optimizes the plan, evaluates it and keeps its description. While the query is only planned (see Plan),
+ * no stage is opened and the result is an empty table with the header of the plan.
+ * @param[in] plan root stage of the plan (taken over by the query)
+ * @return the result table (owned by the caller), nullptr if the plan failed
+ */
+CTable * CTableQuery::Execute ( COperator * plan ) {
+	unique_ptr<COperator> root ( COptimizer::Optimize( plan ) );
+	CTable * result = m_PlanOnly ? new CTable { root->GetHeader( ) } : COperator::Materialize( * root );
+	m_Plan.clear( );
+	root->Explain( m_Plan );
+	return result;
+}
+
+/**
+ * Builds and optimizes the plan of the query without evaluating it (EXPLAIN), the plan is then described by GetPlan.
+ * The query is left without its result rows, so it can't be used afterwards.
+ * @return false if the query is invalid
+ */
+bool CTableQuery::Plan ( ) {
+	m_PlanOnly = true;
+	bool planned = Evaluate( );
+	m_PlanOnly = false;
+	return planned;
+}
+
+/**
+ * Refuses an empty query result. The result of a planned query (see Plan) has no rows yet, it's always accepted.
+ * @param[in] result the query result
+ * @return false if the result is empty
+ */
+bool CTableQuery::CheckRows ( const CTable & result ) const {
+	if ( m_PlanOnly || result.GetDataRowCount( ) )
+		return true;
+	CLog::Msg( CLog::QP, CLog::QP_EMPTY_RESULTS );
+	return false;
+}
+
+/**
+ * Evaluates the query again, the old result is replaced. If the query fails (e.g. its result is empty),
+ * the result is an empty table with the old header.
+ * @param[in, out] result the query result
+ * @return REWRITTEN
+ */
+size_t CTableQuery::Recompute ( CTable * & result ) {
+	vector<string> header = result ? result->GetColumnNames( ) : vector<string>( );
+	delete result;
+	result = nullptr;
+	if ( ! Evaluate( ) ) {
+		delete result;
+		result = new CTable { header };
+	}
+	return REWRITTEN;
+}
+
+/**
+ * Evaluates the plan over the new operand rows and appends its output to the result. The query is evaluated again
+ * if the plan fails.
+ * @param[in, out] result the query result
+ * @param[in] plan root stage of the plan (taken over by the query)
+ * @return the number of result rows before the update (REWRITTEN if the query was evaluated again)
+ */
+size_t CTableQuery::AppendResult ( CTable * & result, COperator * plan ) {
+	unique_ptr<COperator> root ( COptimizer::Optimize( plan ) );
+	size_t rows = result->GetDataRowCount( );
+	if ( ! root->Open( ) ) {
+		root->Close( );
+		return Recompute( result );
+	}
+	CBatch batch;
+	bool appended = true;
+	while ( appended && root->NextBatch( batch ) )
+		appended = result->AppendRows( batch.m_Columns );
+	root->Close( );
+	return appended ? rows : Recompute( result );
+}
@@ -2,12 +2,24 @@
 
 #include "../console/CLog.hpp"
 #include "../database/CTable.hpp"
+#include "../pipeline/COperator.hpp"
+#include "../pipeline/CScanOperator.hpp"
+
+#include <map>
+#include <cstdint>
 
 /*
  * This abstract class is the template for every existing query.
+ * A query is evaluated by a tree of pipeline stages (see COperator), which is optimized first (see COptimizer).
+ * A saved query keeps its result up to date with its operands (see CDatabase::AppendRows). If rows were only appended
+ * to an operand, the query evaluates the new rows and appends its new result rows (Refresh), otherwise it's evaluated again.
  */
 class CTableQuery {
 public:
+	/** Changed tables and saved queries by their names, with their number of rows before the change (REWRITTEN if the rows weren't only appended). */
+	typedef map<string, size_t> TChanges;
+	static const size_t REWRITTEN;
+
 	virtual ~CTableQuery ( ) = default;
 
 	/** Processes the query operands. Initializes the data and creates the result. */
@@ -19,9 +31,42 @@ public:
 	/** Generates a SQL syntax string, based on query result data. */
 	virtual string GetSQL ( ) const = 0;
 
+	/** Creates a pipeline stage producing the query result, for the queries using this one (saved as name) as an operand. The result table is scanned by default. */
+	virtual COperator * CreateOperator ( const string & name ) { return new CScanOperator( * GetQueryResult( ), name ); }
+
+	/** Returns the number of bytes the query result takes (see CResultCache). Queries with a lazy result count what they keep. */
+	virtual size_t GetResultSize ( ) { return GetQueryResult( ) ? GetQueryResult( )->GetMemorySize( ) : 0; }
+
+	/** Renders the query result. Queries with a lazy result may print it without creating the result table. */
+	virtual void RenderResult ( ostream & ost = cout ) { ost << * GetQueryResult( ); }
+
 	/** Generates a SQL syntax string, based on query result data. */
 	virtual void ArchiveQueryName ( const string & name ) = 0;
 
 	/** Returns true, if current query is based on another saved query */
 	virtual bool IsDerived ( ) const = 0;
+
+	/** Returns the names of the tables and saved queries the query reads. */
+	virtual vector<string> GetOperands ( ) const = 0;
+
+	/** Updates the result after its operands changed. The number of result rows before the update is returned if rows were only appended, REWRITTEN otherwise. */
+	virtual size_t Refresh ( const TChanges & changes ) = 0;
+
+	size_t GetSchemaVersion ( ) const { return m_SchemaVersion; }
+
+	/** Returns the optimized plan the query was evaluated by, a line per stage (see COperator::Explain). */
+	const vector<string> & GetPlan ( ) const { return m_Plan; }
+
+	/** Builds the optimized plan of the query without evaluating it (EXPLAIN), see GetPlan. */
+	bool Plan ( );
+
+protected:
+	vector<string> m_Plan;
+	size_t m_SchemaVersion = 0;
+	bool m_PlanOnly = false;
+
+	CTable * Execute ( COperator * plan );
+	bool CheckRows ( const CTable & result ) const;
+	size_t Recompute ( CTable * & result );
+	size_t AppendResult ( CTable * & result, COperator * plan );
 };
\ No newline at end of file
@@ -10,61 +10,14 @@ bool CUnion::Evaluate ( ) {
 	if ( ! SaveTableReferences( ) )
 		return false;
 
-	vector<string> tmpHeader = m_Operands.first.m_TRef->GetColumnNames( );
-
-	// save current indexes and their column values
-	vector<pair<size_t, size_t>> columnOrders;
-	vector<string> headerUnsorted;
-	size_t max = tmpHeader.size( );
-	for ( size_t i = 0; i < max; ++i ) {
-		columnOrders.emplace_back( i, 0 );
-		headerUnsorted.emplace_back( tmpHeader.at( i ) );
-	}
-	tmpHeader.clear( );
-
-	// sort both table headers
-	m_Operands.first.m_TRef->SortColumns( );
-	m_Operands.second.m_TRef->SortColumns( );
-	tmpHeader = m_Operands.first.m_TRef->GetColumnNames( );
-
-	if ( ! m_Operands.first.m_TRef->HasIdenticalHeader( m_Operands.second.m_TRef ) ) {
-		CLog::Msg( CLog::QP, CLog::QP_DIFF_HEADER );
+	// the operand columns are matched by their names, the operands themselves stay untouched
+	vector<size_t> permutation;
+	if ( ! AlignColumns( permutation ) )
 		return false;
-	}
-
-	// correct data type check
-	if ( ! ValidateColumnTypes( ) )
-		return false;
-
-	// save current indexes and their column values IN the new order
-	size_t index = 0, tmp = 0;
-	for ( const auto & i : headerUnsorted ) {
-		tmp = find( tmpHeader.begin(), tmpHeader.end(), i ) - tmpHeader.begin( );
-		if ( tmp >= headerUnsorted.size( ) )
-			return false;
-		columnOrders.at( index++ ).second = tmp;
-	}
-
-	m_QueryResult = new CTable ( m_Operands.first.m_TRef->GetColumnNames( ) );
 
-	// transformation for easier row access
-	vector<vector<CCell *>> tA, tB;
-	CTable::SortRows( ( tA = m_Operands.first.m_TRef->Transform( ) ) );
-	CTable::SortRows( ( tB = m_Operands.second.m_TRef->Transform( ) ) );
-	vector<vector<CCell *>> res ( tA.size( ) + tB.size( ) );
-	set_union( tA.begin( ), tA.end( ), tB.begin( ), tB.end( ), res.begin( ), CTable::RowComparator( ) );
-	for ( const auto & i : res ) {
-		if ( i.empty( ) )
-			continue;
-		if ( ! m_QueryResult->InsertShallowRow( CTable::GetDeepRow( i ) ) )
-			return false;
-	}
-
-	m_QueryResult->SortColumns( columnOrders );
-	m_Operands.first.m_TRef->SortColumns( columnOrders );
-	m_Operands.second.m_TRef->SortColumns( columnOrders );
-
-	return true;
+	m_SchemaVersion = m_Database.GetSchemaVersion( );
+	m_QueryResult = Execute( CreateSetOperation( CSetOperator::SET_UNION, permutation ) );
+	return m_QueryResult != nullptr;
 }
 
 CTable * CUnion::GetQueryResult ( ) {
@@ -96,3 +49,14 @@ string CUnion::GetSQL ( ) const {
 bool CUnion::IsDerived ( ) const {
 	return false;
 }
+
+vector<string> CUnion::GetOperands ( ) const {
+	return GetOperandNames( );
+}
+
+/**
+ * The set operation is evaluated again.
+ */
+size_t CUnion::Refresh ( const TChanges & changes ) {
+	return Recompute( m_QueryResult );
+}
@@ -1,5 +1,9 @@
 #include "CDataParser.hpp"
 
+#include <cstring>
+#include <cerrno>
+#include <cstdint>
+
 /*
  * Trims whitespaces to the left of the text.
  * @param[in, out] s string that is to be trimmed
@@ -86,6 +90,39 @@ CDataParser::Split ( string & s, const char & delim = ',' ) {
 	return tokenizedStr;
 }
 
+/**
+ * Parses a row of values (INSERT), the values are tokenized by CDataParser::Split and the numbers are parsed the same way
+ * as in the CSV files.
+ * @param[in] values values separated by commas, strings may be enclosed in quotes
+ * @param[in] types data types of the table columns
+ * @param[out] out a single row column per value
+ * @return false if the number of values or their types don't match the columns
+ */
+bool CDataParser::ParseRow ( string & values, const vector<CColumn::EType> & types, vector<unique_ptr<CColumn>> & out ) {
+	vector<string> tokens = Split( values, true, true );
+	out.clear( );
+	if ( tokens.size( ) != types.size( ) )
+		return false;
+	for ( size_t i = 0; i < tokens.size( ); ++ i ) {
+		const char * begin = tokens[ i ].data( ), * end = begin + tokens[ i ].size( );
+		out.emplace_back( CColumn::Create( types[ i ] ) );
+		if ( types[ i ] == CColumn::TYPE_STRING )
+			static_cast<CStringColumn *>( out.back( ).get( ) )->Append( tokens[ i ] );
+		else if ( types[ i ] == CColumn::TYPE_INT ) {
+			int32_t val;
+			if ( ! ParseInt( begin, end, val ) )
+				return false;
+			static_cast<CIntColumn *>( out.back( ).get( ) )->Append( val );
+		} else {
+			double val;
+			if ( ! ParseDouble( begin, end, val ) )
+				return false;
+			static_cast<CDoubleColumn *>( out.back( ).get( ) )->Append( val );
+		}
+	}
+	return true;
+}
+
 /**
  * Extracts file name from the path.
  * @param[in, out] filePath path to the given file.
@@ -113,126 +150,309 @@ string CDataParser::GetFileExtension ( const string & input ) {
 }
 
 /**
- * Selects the corrent parsing format and passes the stream.
- * @param[in, out] db database to be inserted to
- * @param[in, out] ifs input filestream
+ * Selects the corrent parsing format and passes the file.
+ * @param[in] db database the table is going to be inserted to (checked for the existing tables)
+ * @param[in] file mapped input file
  * @param[in, out] filePath path to input file with the table
- * @return false if appropriate parsing format was not found, delegated otherwise
+ * @param[in, out] log output stream for the parsing errors
+ * @param[in] threads number of threads to parse the file with
+ * @return nullptr if appropriate parsing format was not found, delegated otherwise
  */
-bool CDataParser::ParseTable ( CDatabase & db, ifstream & ifs, string & filePath ) {
+CTable * CDataParser::ParseTable ( const CDatabase & db, const shared_ptr<CMappedFile> & file, string & filePath,
+                                   ostream & log, const size_t & threads ) {
 	string extension = GetFileExtension( filePath );
 	if ( extension == "csv" || extension == "CSV" )
-		return ParseCSV( db, ifs, filePath );
-	return false;
+		return ParseCSV( db, file, filePath, log, threads );
+	return nullptr;
+}
+
+size_t CDataParser::m_ImportThreads = CThreadPool::GetDefaultSize( );
+
+/**
+ * Same characters as std::isspace in the classic locale.
+ */
+bool CDataParser::IsSpace ( const char & c ) {
+	return c == ' ' || ( c >= '\t' && c <= '\r' );
+}
+
+/**
+ * Parses a decimal integer the same way as stoi does (leading sign, the rest behind the digits is ignored).
+ * @param[in] begin beginning of the token
+ * @param[in] end end of the token
+ * @param[out] out parsed number
+ * @return false if there are no digits or the number doesn't fit into the int
+ */
+bool CDataParser::ParseInt ( const char * begin, const char * end, int32_t & out ) {
+	bool negative = false;
+	if ( begin != end && ( * begin == '+' || * begin == '-' ) ) {
+		negative = * begin == '-';
+		++ begin;
+	}
+	if ( begin == end || * begin < '0' || * begin > '9' )
+		return false;
+	int64_t val = 0;
+	for ( ; begin != end && * begin >= '0' && * begin <= '9'; ++ begin ) {
+		val = val * 10 + ( * begin - '0' );
+		if ( val > static_cast<int64_t>( INT32_MAX ) + 1 )
+			return false;
+	}
+	if ( negative )
+		val = - val;
+	if ( val > INT32_MAX )
+		return false;
+	out = static_cast<int32_t>( val );
+	return true;
+}
+
+/**
+ * Parses a floating point number the same way as stod does.
+ * The token is copied into a local buffer, because strtod requires a terminated string.
+ * @param[in] begin beginning of the token
+ * @param[in] end end of the token
+ * @param[out] out parsed number
+ * @return false if there is no number or it's out of range
+ */
+bool CDataParser::ParseDouble ( const char * begin, const char * end, double & out ) {
+	char buffer[ 64 ];
+	string longToken;
+	const char * str = buffer;
+	size_t len = static_cast<size_t>( end - begin );
+	if ( len < sizeof( buffer ) ) {
+		memcpy( buffer, begin, len );
+		buffer[ len ] = '\0';
+	} else {
+		longToken.assign( begin, end );
+		str = longToken.c_str( );
+	}
+	char * parsedEnd;
+	errno = 0;
+	out = strtod( str, & parsedEnd );
+	return parsedEnd != str && errno != ERANGE;
+}
+
+/**
+ * Tokenizes a CSV line the same way as CDataParser::Split (with allowed spaces) does, without copying it.
+ * Quotes are kept in the tokens, the tokens containing them are marked.
+ * @param[in] begin beginning of the line
+ * @param[in] end end of the line (without the newline)
+ * @param[out] out tokens of the line
+ */
+void CDataParser::SplitCSVLine ( const char * begin, const char * end, vector<CCsvField> & out ) {
+	out.clear( );
+	bool quoteFlag = false;
+	CCsvField field { begin, begin, false };
+	for ( const char * i = begin; i != end; ++ i ) {
+		if ( * i == '\"' ) {
+			quoteFlag = ! quoteFlag;
+			field.m_Quoted = true;
+		} else if ( * i == ',' && ! quoteFlag ) {
+			field.m_End = i;
+			out.push_back( field );
+			field = CCsvField { i + 1, i + 1, false };
+		}
+	}
+	field.m_End = end;
+	out.push_back( field );
+}
+
+/**
+ * Parses the rows of a CSV chunk into its own typed columns. Parsing stops at the first invalid line.
+ * String values reference the mapped file, unless the quotes split them.
+ * @param[in] file mapped input file
+ * @param[in] begin start of the chunk (first character of a line)
+ * @param[in] end end of the chunk (behind a newline or the end of the file)
+ * @param[in] columnTypes data types of the columns
+ * @param[out] out chunk columns, number of the parsed lines and the error
+ */
+void CDataParser::ParseCSVChunk ( const shared_ptr<CMappedFile> & file, const size_t & begin, const size_t & end, const vector<string> & columnTypes, CCsvChunk & out ) {
+	const char * data = file->GetData( );
+	shared_ptr<const char> external ( file, data );
+	vector<CColumn::EType> types;
+	for ( const string & i : columnTypes ) {
+		types.push_back( i == CLog::TYPE_STRING ? CColumn::TYPE_STRING : ( i == CLog::TYPE_INT ? CColumn::TYPE_INT : CColumn::TYPE_DOUBLE ) );
+		out.m_Columns.push_back( CColumn::Create( types.back( ) ) );
+		if ( types.back( ) == CColumn::TYPE_STRING )
+			static_cast<CStringColumn *>( out.m_Columns.back( ) )->BindExternal( external, file->GetSize( ) );
+	}
+
+	vector<CCsvField> fields;
+	string unquoted;
+	for ( size_t pos = begin, next; pos < end; pos = next ) {
+		// same line splitting as getline
+		const char * newline = static_cast<const char *>( memchr( data + pos, '\n', end - pos ) );
+		size_t lineEnd = newline ? static_cast<size_t>( newline - data ) : end;
+		next = newline ? lineEnd + 1 : end;
+
+		// empty lines..
+		if ( lineEnd == pos ) {
+			out.m_Error = CSV_EMPTY_LINE;
+			return;
+		}
+
+		// wrong formatting
+		if ( data[ lineEnd - 1 ] == ',' ) {
+			out.m_Error = CSV_LINE_MISMATCH;
+			return;
+		}
+
+		// checks for number of columns to insert
+		SplitCSVLine( data + pos, data + lineEnd, fields );
+		if ( fields.size( ) != types.size( ) ) {
+			out.m_Error = CSV_LINE_MISMATCH;
+			return;
+		}
+
+		// parse to appropriate data types
+		for ( size_t i = 0; i < fields.size( ); ++ i ) {
+			const char * tokenBegin = fields[ i ].m_Begin, * tokenEnd = fields[ i ].m_End;
+			while ( tokenBegin != tokenEnd && IsSpace( * tokenBegin ) )
+				++ tokenBegin;
+			while ( tokenBegin != tokenEnd && IsSpace( * ( tokenEnd - 1 ) ) )
+				-- tokenEnd;
+			if ( fields[ i ].m_Quoted ) {
+				// a token enclosed in quotes stays in place, any other quotes have to be removed from a copy
+				if ( tokenEnd - tokenBegin >= 2 && * tokenBegin == '\"' && * ( tokenEnd - 1 ) == '\"'
+				     && ! memchr( tokenBegin + 1, '\"', tokenEnd - tokenBegin - 2 ) ) {
+					++ tokenBegin;
+					-- tokenEnd;
+				} else {
+					unquoted.clear( );
+					for ( const char * c = fields[ i ].m_Begin; c != fields[ i ].m_End; ++ c )
+						if ( * c != '\"' )
+							unquoted += * c;
+					TrimSurroundingSpace( unquoted );
+					tokenBegin = unquoted.data( );
+					tokenEnd = tokenBegin + unquoted.size( );
+				}
+				while ( tokenBegin != tokenEnd && IsSpace( * tokenBegin ) )
+					++ tokenBegin;
+				while ( tokenBegin != tokenEnd && IsSpace( * ( tokenEnd - 1 ) ) )
+					-- tokenEnd;
+			}
+
+			bool parsed = true;
+			if ( types[ i ] == CColumn::TYPE_STRING )
+				static_cast<CStringColumn *>( out.m_Columns[ i ] )->AppendExternal( tokenBegin, tokenEnd - tokenBegin );
+			else if ( types[ i ] == CColumn::TYPE_INT ) {
+				int32_t val;
+				if ( ( parsed = ParseInt( tokenBegin, tokenEnd, val ) ) )
+					static_cast<CIntColumn *>( out.m_Columns[ i ] )->Append( val );
+			} else {
+				double val;
+				if ( ( parsed = ParseDouble( tokenBegin, tokenEnd, val ) ) )
+					static_cast<CDoubleColumn *>( out.m_Columns[ i ] )->Append( val );
+			}
+			if ( ! parsed ) {
+				out.m_Error = CSV_PARSE_ERROR;
+				return;
+			}
+		}
+		++ out.m_Lines;
+	}
 }
 
 /**
  * CSV import.
  * Parameters are same as CDataParser::ParseTable, since they are delegated directly here.
- * @return true, if table was parsed and added to the database
+ * @return parsed table (owned by the caller), nullptr if the file is invalid or has no rows
  */
-bool CDataParser::ParseCSV ( CDatabase & db, ifstream & ifs, string & filePath ) {
-	string tmp;
+CTable * CDataParser::ParseCSV ( const CDatabase & db, const shared_ptr<CMappedFile> & file, string & filePath,
+                                 ostream & log, const size_t & threads ) {
+	const char * data = file->GetData( );
+	size_t size = file->GetSize( ), pos = 0;
 
 	// table existence check
 	SplitFileName( filePath );
 	if ( db.TableExists( filePath ) )
-		return false;
+		return nullptr;
 
 	// first row - table column data types
-	getline( ifs, tmp );
+	const char * newline = size ? static_cast<const char *>( memchr( data, '\n', size ) ) : nullptr;
+	string tmp ( data, newline ? newline - data : size );
 	if ( tmp.empty( ) || * ( tmp.end( ) - 1 ) == ',' )
-		return false;
+		return nullptr;
 	vector<string> columnTypes = Split( tmp, false, false );
 	for ( const string & i : columnTypes ) {
 		if ( i.empty( ) )
-			return false;
+			return nullptr;
 		if ( i != CLog::TYPE_STRING && i != CLog::TYPE_INT && i != CLog::TYPE_DOUBLE ) {
-			CLog::HighlightedMsg( CLog::DP, filePath, string( "" ).append( CLog::DP_NO_DATATYPES ).append( "\u001b[0m" ) );
-			return false;
+			CLog::HighlightedMsg( CLog::DP, filePath, string( "" ).append( CLog::DP_NO_DATATYPES ).append( "\u001b[0m" ), CLog::APP_LINE_HEIGHT, log );
+			return nullptr;
 		}
 	}
-	if ( ifs.eof( ) )
-		return false;
-	tmp.clear( );
+	if ( ! newline )
+		return nullptr;
+	pos = newline - data + 1;
 
 	// second row - table column data types
 	size_t requiredColumns = columnTypes.size( );
-	getline( ifs, tmp );
+	newline = static_cast<const char *>( memchr( data + pos, '\n', size - pos ) );
+	tmp.assign( data + pos, newline ? newline - data - pos : size - pos );
 	if ( tmp.empty( ) || * ( tmp.end( ) - 1 ) == ',' )
-		return false;
+		return nullptr;
 
 	vector<string> columnNames = Split( tmp, false, false );
 	for ( const string & i : columnNames )
 		if ( i.empty( ) )
-			return false;
-	if ( ifs.eof( ) || columnNames.size( ) != requiredColumns )
-		return false;
-	tmp.clear( );
-
-	// save the column header information
-	vector<CCell *> header;
-	header.reserve( requiredColumns );
-	for ( string & i : columnNames )
-		header.push_back( new CString( std::move( i ) ) );
-	auto * parsedResult = new CTable { header };
-	int lines = 2;
-
-	// table rows
-	while ( getline( ifs, tmp ) ) {
-		// empty lines..
-		if ( tmp.empty( ) ) {
-			CLog::BoldMsg( CLog::DP, filePath, string( "" ).append( CLog::DP_EMPTY_LINE ).append( to_string( lines ) ).append( ".\u001b[0m" ) );
-			delete parsedResult;
-			return false;
-		}
+			return nullptr;
+	if ( ! newline || columnNames.size( ) != requiredColumns )
+		return nullptr;
+	pos = newline - data + 1;
 
-		// wrong formatting
-		if ( * ( tmp.end( ) - 1 ) == ',' ) {
-			CLog::BoldMsg( CLog::DP, filePath, string( "" ).append( CLog::DP_LINE_MISMATCH ).append( to_string( lines ) ).append( ".\u001b[0m" ) );
-			delete parsedResult;
-			return false;
-		}
+	// the rows are split into newline-aligned chunks (small files make a single chunk)
+	vector<pair<size_t, size_t>> ranges;
+	size_t chunkSize = threads > 1 ? CSV_CHUNK_SIZE : size;
+	for ( size_t begin = pos, end; begin < size; begin = end ) {
+		size_t from = min( begin + chunkSize, size - 1 );
+		newline = static_cast<const char *>( memchr( data + from, '\n', size - from ) );
+		end = newline ? newline - data + 1 : size;
+		ranges.emplace_back( begin, end );
+	}
 
-		// checks for number of columns to insert
-		vector<string> newRow = Split( tmp, false, true );
-		if ( newRow.size( ) != requiredColumns ) {
-			CLog::BoldMsg( CLog::DP, filePath, string( "" ).append( CLog::DP_LINE_MISMATCH ).append( to_string( lines ) ).append( ".\u001b[0m" ) );
-			delete parsedResult;
-			return false;
-		}
+	vector<CCsvChunk> chunks ( ranges.size( ) );
+	if ( chunks.size( ) > 1 ) {
+		CThreadPool pool ( min( threads, chunks.size( ) ) );
+		vector<future<void>> parsed;
+		for ( size_t i = 0; i < chunks.size( ); ++ i )
+			parsed.push_back( pool.Submit( [ & file, & ranges, & columnTypes, & chunks, i ] ( ) {
+				ParseCSVChunk( file, ranges[ i ].first, ranges[ i ].second, columnTypes, chunks[ i ] );
+			} ) );
+		for ( auto & i : parsed )
+			i.get( );
+	} else if ( chunks.size( ) == 1 )
+		ParseCSVChunk( file, ranges[ 0 ].first, ranges[ 0 ].second, columnTypes, chunks[ 0 ] );
 
-		// parse to appropriate data types
-		int cnt = 0;
-		vector<CCell *> newTypedRow;
-		try {
-			for ( const string & i : newRow ) {
-				if ( columnTypes[ cnt ] == CLog::TYPE_STRING ) {
-					newTypedRow.push_back( new CString( i ) );
-				}
-				else if ( columnTypes[ cnt ] == CLog::TYPE_INT ) {
-					int x = stoi( i );
-					newTypedRow.push_back( new CInt( x ) );
-				}
-				else {
-					double x = stod( i );
-					newTypedRow.push_back( new CDouble( x ) );
-				}
-				++ cnt;
-			}
-		} catch ( std::logic_error const & e ) {
-			delete parsedResult;
-			for ( const auto & i : newTypedRow )
-				delete i;
-			 return false;
+	// chunks are merged in order, the first error stops the import (line numbers continue across the chunks)
+	vector<CColumn *> columns;
+	for ( const string & i : columnTypes ) {
+		if ( i == CLog::TYPE_STRING )
+			columns.push_back( new CStringColumn );
+		else if ( i == CLog::TYPE_INT )
+			columns.push_back( new CIntColumn );
+		else
+			columns.push_back( new CDoubleColumn );
+	}
+	auto * parsedResult = new CTable { columnNames, columns };
+	size_t lines = 2;
+	bool failed = false;
+	for ( auto & chunk : chunks ) {
+		if ( ! failed ) {
+			for ( size_t i = 0; i < requiredColumns; ++ i )
+				columns[ i ]->AppendColumn( * chunk.m_Columns[ i ] );
+			if ( chunk.m_Error == CSV_EMPTY_LINE )
+				CLog::BoldMsg( CLog::DP, filePath, string( "" ).append( CLog::DP_EMPTY_LINE ).append( to_string( lines + chunk.m_Lines ) ).append( ".\u001b[0m" ), CLog::APP_LINE_HEIGHT, log );
+			else if ( chunk.m_Error == CSV_LINE_MISMATCH )
+				CLog::BoldMsg( CLog::DP, filePath, string( "" ).append( CLog::DP_LINE_MISMATCH ).append( to_string( lines + chunk.m_Lines ) ).append( ".\u001b[0m" ), CLog::APP_LINE_HEIGHT, log );
+			failed = chunk.m_Error != CSV_OK;
+			lines += chunk.m_Lines;
 		}
-		if ( ! parsedResult->InsertShallowRow( newTypedRow ) )
-			return false;
-		++ lines;
+		for ( auto & i : chunk.m_Columns )
+			delete i;
 	}
 
-	if ( lines == 2 )
-		return false;
-	db.InsertTable( filePath, parsedResult );
-	return true;
-}
\ No newline at end of file
+	if ( failed || lines == 2 ) {
+		delete parsedResult;
+		return nullptr;
+	}
+	return parsedResult;
+}
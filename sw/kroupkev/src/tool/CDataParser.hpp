@@ -9,6 +9,8 @@
 
 #include "../database/CDatabase.hpp"
 #include "../console/CLog.hpp"
+#include "CThreadPool.hpp"
+#include "CMappedFile.hpp"
 
 using namespace std;
 
@@ -16,9 +18,47 @@ using namespace std;
  * This module parses raw text from the sources into logical cells which are then saved tables (and then to the database).
  * It mostly contains static members, because they might be useful for outter modules.
  * The module also provides an interface for data importing/exporting.
+ * Parsed tables are returned to the caller instead of being inserted, so more files can be parsed at once.
+ *
+ * Big CSV files are imported in parallel - the rows are split into newline-aligned chunks,
+ * the chunks are parsed on a thread pool and their columns are merged in the file order.
+ *
+ * The files are memory mapped and the rows are tokenized in place (no line or token strings are created),
+ * string columns reference the mapped file directly. The tokenizing follows CDataParser::Split
+ * and the number parsing follows stoi/stod, so the imported data are the same as of the string based parsing.
  */
 class CDataParser {
+private:
+	enum ECsvError { CSV_OK, CSV_EMPTY_LINE, CSV_LINE_MISMATCH, CSV_PARSE_ERROR };
+
+	/**
+	 * Typed columns of a single chunk with the number of lines parsed before an error (if any).
+	 */
+	struct CCsvChunk {
+		vector<CColumn *> m_Columns;
+		size_t m_Lines = 0;
+		ECsvError m_Error = CSV_OK;
+	};
+
+	/**
+	 * Token of a CSV line, points into the parsed data.
+	 */
+	struct CCsvField {
+		const char * m_Begin;
+		const char * m_End;
+		bool m_Quoted;
+	};
+
+	static bool IsSpace ( const char & c );
+	static bool ParseInt ( const char * begin, const char * end, int32_t & out );
+	static bool ParseDouble ( const char * begin, const char * end, double & out );
+	static void SplitCSVLine ( const char * begin, const char * end, vector<CCsvField> & out );
+	static void ParseCSVChunk ( const shared_ptr<CMappedFile> & file, const size_t & begin, const size_t & end, const vector<string> & columnTypes, CCsvChunk & out );
+
 public:
+	static size_t m_ImportThreads;
+	static const size_t CSV_CHUNK_SIZE = 1 << 20;
+
 	static string & TrimSpaceLeft ( string & s );
 	static string & TrimSpaceRight ( string & s );
 	static string & TrimSurroundingSpace ( string & s );
@@ -26,9 +66,12 @@ public:
 	static void TrimAllSpaces ( string & token, const char & delimiter );
 	static vector<string> Split ( string & s, const bool & allowQuotes, const bool & allowSpaces, const char & delim = ',' );
 	static vector<string> Split ( string & s, const char & delimiter );
+	static bool ParseRow ( string & values, const vector<CColumn::EType> & types, vector<unique_ptr<CColumn>> & out );
 	static string & SplitFileName ( string & filePath );
 	static string GetFileExtension ( const string & input );
 
-	static bool ParseTable ( CDatabase & db, ifstream & ifs, string & filePath );
-	static bool ParseCSV ( CDatabase & db, ifstream & ifs, string & filePath );
+	static CTable * ParseTable ( const CDatabase & db, const shared_ptr<CMappedFile> & file, string & filePath,
+	                             ostream & log = cout, const size_t & threads = m_ImportThreads );
+	static CTable * ParseCSV ( const CDatabase & db, const shared_ptr<CMappedFile> & file, string & filePath,
+	                           ostream & log = cout, const size_t & threads = m_ImportThreads );
 };
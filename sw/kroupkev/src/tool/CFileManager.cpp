@@ -1,7 +1,8 @@
 #include "CFileManager.hpp"
 
 /**
- * Constructor that creates a stream based on the config file path.
+ * Constructor that creates a stream based on the config file path. The config lists the table files, it may also change
+ * the query settings.
  * @param[in, out] configFile path to the configuration file
  * @param[in, out] database reference to the database we're going to load to
  */
@@ -14,29 +15,90 @@ CFileManager::CFileManager ( const string & configFile, CDatabase & database ) :
 			throw logic_error( CLog::FM_CFG_FAILED );
 		}
 		CLog::Msg( CLog::FM, CLog::FM_CFG_FOUND );
+		string tableFilePath;
+		while ( m_ConfigStream >> tableFilePath ) {
+			// query settings are written as KEY=VALUE (see CQuerySett::Set), other lines are paths (which may contain '=' too)
+			size_t separator = tableFilePath.find( '=' );
+			if ( separator == string::npos || ! CQuerySett::IsSetting( tableFilePath.substr( 0, separator ) ) )
+				m_TablePaths.push_back( tableFilePath );
+			else if ( ! CQuerySett::Set( tableFilePath.substr( 0, separator ), tableFilePath.substr( separator + 1 ) ) )
+				CLog::HighlightedMsg( CLog::FM, tableFilePath, CLog::QP_INVALID_SETT );
+		}
 	} catch ( const logic_error & er ) {
 		return;
 	}
 }
 
+/**
+ * Restores the tables from the snapshot, if it was made of the current state of the configured files.
+ * @param[out] queries saved query definitions to be evaluated again (see CQueryParser::RestoreQuery)
+ * @return true if the tables were restored
+ */
+bool CFileManager::LoadSnapshot ( vector<pair<string, string>> & queries ) {
+	vector<CDatabase::CSource> sources;
+	for ( const string & i : m_TablePaths )
+		sources.push_back( CSnapshot::Stamp( i ) );
+	if ( ! CSnapshot::Load( m_Database, CLog::APP_SNAPSHOT_PATH, sources, queries ) )
+		return false;
+	if ( m_Database.GetTableNames( ).empty( ) ) {
+		queries.clear( );
+		return false;
+	}
+	CLog::Msg( CLog::FM, CLog::FM_SNAPSHOT_LOADED );
+	return true;
+}
+
 /**
  * This method serves tasks to the parser module, validates correct number of imported tables.
+ * The files are parsed concurrently on a pool of CDataParser::m_ImportThreads workers, the parsed tables
+ * are then inserted and reported in the config order (the first of the tables with the same name is kept).
  */
 bool CFileManager::LoadTables ( ) {
 	CLog::Msg( CLog::FM, CLog::FM_LOADING );
-	string tableFilePath;
-	ifstream tableFileStream { };
+	vector<CTableImport> imports;
+	vector<CDatabase::CSource> sources;
 	size_t loadedTablesCnt = 0;
 
-	while ( m_ConfigStream >> tableFilePath ) {
-		tableFileStream.open( tableFilePath, ios::in );
-		if ( tableFileStream && CDataParser::ParseTable( m_Database, tableFileStream, tableFilePath ) ) {
-			CLog::BoldMsg( CLog::FM, tableFilePath, CLog::FM_IMPORT_OK );
+	// the files are stamped before they're parsed, so a later change makes the snapshot outdated
+	for ( const string & i : m_TablePaths ) {
+		sources.push_back( CSnapshot::Stamp( i ) );
+		imports.emplace_back( );
+		imports.back( ).m_Path = i;
+	}
+	m_Database.SetSources( sources );
+	if ( imports.empty( ) )
+		return false;
+
+	// the threads are split between the files and their chunks
+	size_t workers = min( CDataParser::m_ImportThreads, imports.size( ) );
+	size_t fileThreads = max( CDataParser::m_ImportThreads / workers, static_cast<size_t>( 1 ) );
+	{
+		CThreadPool pool ( workers );
+		vector<future<void>> parsed;
+		for ( auto & i : imports )
+			parsed.push_back( pool.Submit( [ this, & i, fileThreads ] ( ) {
+				auto tableFile = make_shared<CMappedFile>( i.m_Path );
+				if ( tableFile->IsOpen( ) )
+					i.m_Table = CDataParser::ParseTable( m_Database, tableFile, i.m_Path, i.m_Log, fileThreads );
+			} ) );
+		for ( auto & i : parsed )
+			i.get( );
+	}
+
+	for ( auto & i : imports ) {
+		// a table with the same name was imported earlier in the config
+		if ( i.m_Table && m_Database.TableExists( i.m_Path ) ) {
+			delete i.m_Table;
+			i.m_Table = nullptr;
+		} else
+			cout << i.m_Log.str( );
+
+		if ( i.m_Table && m_Database.InsertTable( i.m_Path, i.m_Table ) ) {
+			CLog::BoldMsg( CLog::FM, i.m_Path, CLog::FM_IMPORT_OK );
 			++ loadedTablesCnt;
 		} else
-			CLog::BoldMsg( CLog::FM, tableFilePath, CLog::FM_IMPORT_FAIL );
-		tableFileStream.close( );
+			CLog::BoldMsg( CLog::FM, i.m_Path, CLog::FM_IMPORT_FAIL );
 	}
 
 	return loadedTablesCnt != 0;
-}
\ No newline at end of file
+}
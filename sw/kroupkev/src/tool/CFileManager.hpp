@@ -3,9 +3,14 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <sstream>
 
 #include "../database/CDatabase.hpp"
+#include "../database/CQuerySett.hpp"
 #include "CDataParser.hpp"
+#include "CThreadPool.hpp"
+#include "CMappedFile.hpp"
+#include "CSnapshot.hpp"
 #include "../console/CLog.hpp"
 
 using namespace std;
@@ -16,10 +21,21 @@ using namespace std;
  */
 class CFileManager {
 private:
+	/**
+	 * Table file being imported, its parsed table and the messages of the parser.
+	 */
+	struct CTableImport {
+		string m_Path;
+		CTable * m_Table = nullptr;
+		ostringstream m_Log;
+	};
+
 	CDatabase & m_Database;
 	ifstream m_ConfigStream;
+	vector<string> m_TablePaths;
 
 public:
 	explicit CFileManager ( const string & configFile, CDatabase & database );
+	bool LoadSnapshot ( vector<pair<string, string>> & queries );
 	bool LoadTables( );
 };
@@ -0,0 +1,54 @@
+#include "CMappedFile.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * Maps the file. An empty file (or not a regular one) is opened without a mapping.
+ * @param[in] filePath path to the file
+ */
+CMappedFile::CMappedFile ( const string & filePath ) {
+	int fd = open( filePath.c_str( ), O_RDONLY );
+	if ( fd < 0 )
+		return;
+	struct stat info;
+	if ( fstat( fd, & info ) != 0 ) {
+		close( fd );
+		return;
+	}
+	// only regular files have data to map, the other ones are opened empty
+	m_Size = S_ISREG( info.st_mode ) ? static_cast<size_t>( info.st_size ) : 0;
+	if ( m_Size > 0 ) {
+		void * data = mmap( nullptr, m_Size, PROT_READ, MAP_PRIVATE, fd, 0 );
+		if ( data == MAP_FAILED ) {
+			m_Size = 0;
+			close( fd );
+			return;
+		}
+		// the file is read from the beginning to the end
+		madvise( data, m_Size, MADV_SEQUENTIAL );
+		m_Data = static_cast<const char *>( data );
+	}
+	// the mapping stays valid after the descriptor is closed
+	close( fd );
+	m_Open = true;
+}
+
+CMappedFile::~CMappedFile ( ) {
+	if ( m_Data )
+		munmap( const_cast<char *>( m_Data ), m_Size );
+}
+
+bool CMappedFile::IsOpen ( ) const {
+	return m_Open;
+}
+
+const char * CMappedFile::GetData ( ) const {
+	return m_Data;
+}
+
+size_t CMappedFile::GetSize ( ) const {
+	return m_Size;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * This module maps a whole file into the memory (read only).
+ * The parsed data can then point directly into the file instead of copying it,
+ * the mapping stays valid as long as the object lives (shared columns keep it alive, see CStringColumn).
+ *
+ * The file must not be shrunk by anyone else while it's mapped.
+ */
+class CMappedFile {
+private:
+	const char * m_Data = nullptr;
+	size_t m_Size = 0;
+	bool m_Open = false;
+
+public:
+	explicit CMappedFile ( const string & filePath );
+	CMappedFile ( const CMappedFile & src ) = delete;
+	CMappedFile & operator = ( const CMappedFile & src ) = delete;
+	~CMappedFile ( );
+
+	bool IsOpen ( ) const;
+	const char * GetData ( ) const;
+	size_t GetSize ( ) const;
+};
@@ -0,0 +1,462 @@
+#include "CSnapshot.hpp"
+
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <tuple>
+#include <sys/stat.h>
+
+const char CSnapshot::MAGIC[ 8 ] = { 'K', 'R', 'O', 'U', 'P', 'D', 'B', 'S' };
+const uint32_t CSnapshot::VERSION;
+const uint32_t CSnapshot::ENDIAN_MARK;
+const uint32_t CSnapshot::TYPE_EMPTY;
+const uint32_t CSnapshot::FLAG_SORTED;
+const uint32_t CSnapshot::FLAG_ENCODED;
+
+/**
+ * Returns the pointer to the next part of the snapshot and moves behind it (to the next aligned position).
+ * @param[in] size size of the part
+ * @return nullptr if the snapshot ends too soon
+ */
+const char * CSnapshot::CReader::Take ( const size_t & size ) {
+	size_t aligned = ( size + 7 ) & ~ static_cast<size_t>( 7 );
+	if ( aligned < size || aligned > m_Size - m_Pos )
+		return nullptr;
+	const char * out = m_Data + m_Pos;
+	m_Pos += aligned;
+	return out;
+}
+
+template <typename T>
+bool CSnapshot::CReader::Read ( T & out ) {
+	const char * data = Take( sizeof( T ) );
+	if ( ! data )
+		return false;
+	memcpy( & out, data, sizeof( T ) );
+	return true;
+}
+
+bool CSnapshot::CReader::ReadString ( string & out ) {
+	uint64_t len;
+	const char * data;
+	if ( ! Read( len ) || ! ( data = Take( len ) ) )
+		return false;
+	out.assign( data, len );
+	return true;
+}
+
+//
+
+/**
+ * Pads a part of the snapshot of a given size to 8 bytes.
+ */
+void CSnapshot::Pad ( ostream & ost, const size_t & size ) {
+	static const char padding[ 8 ] = { };
+	ost.write( padding, ( 8 - size % 8 ) % 8 );
+}
+
+/**
+ * Writes a part of the snapshot, padded to 8 bytes.
+ */
+void CSnapshot::Write ( ostream & ost, const void * data, const size_t & size ) {
+	ost.write( static_cast<const char *>( data ), size );
+	Pad( ost, size );
+}
+
+template <typename T>
+void CSnapshot::Write ( ostream & ost, const T & val ) {
+	Write( ost, & val, sizeof( T ) );
+}
+
+void CSnapshot::WriteString ( ostream & ost, const string & str ) {
+	Write( ost, static_cast<uint64_t>( str.size( ) ) );
+	Write( ost, str.data( ), str.size( ) );
+}
+
+/**
+ * Writes the data page of a column - its flags, the raw values of a number column, the dictionary and the row codes
+ * of an encoded string column or the lengths, the blob and the offsets (into the snapshot) of a plain string column.
+ * @param[in, out] ost snapshot stream
+ * @param[in] col column to be written
+ * @param[in] rows number of rows
+ */
+void CSnapshot::WriteColumn ( ostream & ost, const CColumn * col, const size_t & rows ) {
+	const auto * strings = col->GetType( ) == CColumn::TYPE_STRING ? static_cast<const CStringColumn *>( col ) : nullptr;
+	Write( ost, static_cast<uint32_t>( ( col->IsSorted( ) ? FLAG_SORTED : 0 ) | ( strings && strings->IsEncoded( ) ? FLAG_ENCODED : 0 ) ) );
+	if ( col->GetType( ) == CColumn::TYPE_INT )
+		Write( ost, static_cast<const CIntColumn *>( col )->GetData( ), rows * sizeof( int32_t ) );
+	else if ( col->GetType( ) == CColumn::TYPE_DOUBLE )
+		Write( ost, static_cast<const CDoubleColumn *>( col )->GetData( ), rows * sizeof( double ) );
+	else if ( strings->IsEncoded( ) ) {
+		const CStringDictionary * dictionary = strings->GetDictionary( );
+		size_t values = dictionary->GetSize( );
+		vector<uint64_t> hashes ( values );
+		vector<uint32_t> lengths ( values );
+		uint64_t blobSize = 0;
+		for ( uint32_t i = 0; i < values; ++ i ) {
+			hashes[ i ] = dictionary->GetHash( i );
+			blobSize += lengths[ i ] = static_cast<uint32_t>( dictionary->GetValue( i ).size( ) );
+		}
+		Write( ost, static_cast<uint64_t>( values ) );
+		Write( ost, hashes.data( ), values * sizeof( uint64_t ) );
+		Write( ost, lengths.data( ), values * sizeof( uint32_t ) );
+		Write( ost, blobSize );
+		for ( uint32_t i = 0; i < values; ++ i )
+			ost.write( dictionary->GetValue( i ).data( ), lengths[ i ] );
+		Pad( ost, blobSize );
+		Write( ost, strings->GetCodes( ), rows * sizeof( uint32_t ) );
+	} else {
+		vector<uint32_t> lengths ( rows );
+		uint64_t blobSize = 0;
+		for ( size_t i = 0; i < rows; ++ i )
+			blobSize += lengths[ i ] = static_cast<uint32_t>( strings->GetStrLen( i ) );
+		Write( ost, lengths.data( ), rows * sizeof( uint32_t ) );
+		Write( ost, blobSize );
+		vector<uint64_t> offsets ( rows );
+		uint64_t offset = static_cast<uint64_t>( ost.tellp( ) );
+		for ( size_t i = 0; i < rows; ++ i ) {
+			ost.write( strings->GetStr( i ), lengths[ i ] );
+			offsets[ i ] = offset;
+			offset += lengths[ i ];
+		}
+		Pad( ost, blobSize );
+		Write( ost, offsets.data( ), rows * sizeof( uint64_t ) );
+	}
+}
+
+/**
+ * Writes the statistics of a table (see CStatistics), a table without them is marked by a zero.
+ */
+void CSnapshot::WriteStatistics ( ostream & ost, const CStatistics * statistics ) {
+	Write( ost, static_cast<uint32_t>( statistics != nullptr ) );
+	if ( ! statistics )
+		return;
+	Write( ost, static_cast<uint64_t>( statistics->m_Rows ) );
+	Write( ost, static_cast<uint64_t>( statistics->m_Columns.size( ) ) );
+	for ( const CColumnStats & i : statistics->m_Columns ) {
+		vector<uint64_t> histogram ( i.m_Histogram.begin( ), i.m_Histogram.end( ) );
+		Write( ost, i.m_Distinct );
+		Write( ost, static_cast<uint32_t>( i.m_Numeric ) );
+		Write( ost, i.m_Min );
+		Write( ost, i.m_Max );
+		Write( ost, static_cast<uint64_t>( i.m_Count ) );
+		Write( ost, static_cast<uint64_t>( histogram.size( ) ) );
+		Write( ost, histogram.data( ), histogram.size( ) * sizeof( uint64_t ) );
+	}
+}
+
+/**
+ * Size and modification time of a source file. A missing file has the size -1.
+ */
+CDatabase::CSource CSnapshot::Stamp ( const string & filePath ) {
+	CDatabase::CSource out { filePath, -1, 0 };
+	struct stat info;
+	if ( stat( filePath.c_str( ), & info ) == 0 ) {
+		out.m_Size = static_cast<int64_t>( info.st_size );
+		out.m_Modified = static_cast<int64_t>( info.st_mtim.tv_sec ) * 1000000000 + info.st_mtim.tv_nsec;
+	}
+	return out;
+}
+
+/**
+ * Saves the tables, the saved query and index definitions and the source stamps of the database.
+ * The snapshot is written to a temporary file which then replaces the old one,
+ * so the tables still referencing the old snapshot keep their data.
+ * @param[in] db database to be saved
+ * @param[in] filePath path to the snapshot
+ * @return true if the snapshot was written
+ */
+bool CSnapshot::Save ( const CDatabase & db, const string & filePath ) {
+	string tmpPath = filePath + ".tmp";
+	ofstream ofs ( tmpPath, ios::out | ios::binary | ios::trunc );
+	if ( ! ofs )
+		return false;
+
+	ofs.write( MAGIC, sizeof( MAGIC ) );
+	Write( ofs, VERSION );
+	Write( ofs, ENDIAN_MARK );
+
+	Write( ofs, static_cast<uint64_t>( db.GetSources( ).size( ) ) );
+	for ( const auto & i : db.GetSources( ) ) {
+		WriteString( ofs, i.m_Path );
+		Write( ofs, i.m_Size );
+		Write( ofs, i.m_Modified );
+	}
+
+	vector<string> tables = db.GetTableNames( );
+	Write( ofs, static_cast<uint64_t>( tables.size( ) ) );
+	for ( const string & i : tables ) {
+		const CTable * table = db.GetTable( i );
+		vector<string> columnNames = table->GetColumnNames( );
+		uint64_t rows = table->GetDataRowCount( );
+		WriteString( ofs, i );
+		Write( ofs, static_cast<uint64_t>( columnNames.size( ) ) );
+		Write( ofs, rows );
+		for ( size_t j = 0; j < columnNames.size( ); ++ j ) {
+			const CColumn * col = table->GetColumn( j );
+			WriteString( ofs, columnNames[ j ] );
+			Write( ofs, col ? static_cast<uint32_t>( col->GetType( ) ) : TYPE_EMPTY );
+		}
+		for ( size_t j = 0; j < columnNames.size( ); ++ j )
+			if ( table->GetColumn( j ) )
+				WriteColumn( ofs, table->GetColumn( j ), rows );
+		WriteStatistics( ofs, table->GetStatistics( ) );
+	}
+
+	Write( ofs, static_cast<uint64_t>( db.GetQueryDefinitions( ).size( ) ) );
+	for ( const auto & i : db.GetQueryDefinitions( ) ) {
+		WriteString( ofs, i.first );
+		WriteString( ofs, i.second );
+	}
+
+	vector<tuple<string, uint64_t, uint32_t>> indexes;
+	for ( const string & i : tables )
+		for ( const CIndex * j : db.GetIndexes( i ) )
+			indexes.emplace_back( i, j->GetPosition( ), static_cast<uint32_t>( j->GetKind( ) ) );
+	Write( ofs, static_cast<uint64_t>( indexes.size( ) ) );
+	for ( const auto & i : indexes ) {
+		WriteString( ofs, get<0>( i ) );
+		Write( ofs, get<1>( i ) );
+		Write( ofs, get<2>( i ) );
+	}
+
+	ofs.close( );
+	if ( ! ofs || rename( tmpPath.c_str( ), filePath.c_str( ) ) != 0 ) {
+		remove( tmpPath.c_str( ) );
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Checks that the snapshot was made from the same sources (same files in the same state).
+ */
+bool CSnapshot::ReadSources ( CReader & reader, const vector<CDatabase::CSource> & sources ) {
+	uint64_t count;
+	if ( ! reader.Read( count ) || count != sources.size( ) )
+		return false;
+	CDatabase::CSource source;
+	for ( const auto & i : sources )
+		if ( ! reader.ReadString( source.m_Path ) || ! reader.Read( source.m_Size ) || ! reader.Read( source.m_Modified )
+		     || source.m_Path != i.m_Path || source.m_Size != i.m_Size || source.m_Modified != i.m_Modified )
+			return false;
+	return true;
+}
+
+/**
+ * Reads the data page of a column. The number pages are copied at once, the plain string columns reference
+ * the mapped snapshot and the encoded ones get their dictionary back, so no value is parsed or hashed again.
+ * Only the offsets and the codes are checked to lie inside of the snapshot and the dictionary.
+ * @param[in, out] reader snapshot reader
+ * @param[in] file mapped snapshot
+ * @param[in] type type of the column
+ * @param[in] rows number of rows
+ * @return restored column, nullptr if the snapshot is damaged
+ */
+CColumn * CSnapshot::ReadColumn ( CReader & reader, const shared_ptr<CMappedFile> & file, const CColumn::EType & type, const uint64_t & rows ) {
+	uint32_t flags;
+	const char * page;
+	if ( ! reader.Read( flags ) )
+		return nullptr;
+	bool sorted = flags & FLAG_SORTED;
+	if ( type == CColumn::TYPE_INT ) {
+		if ( ! ( page = reader.Take( rows * sizeof( int32_t ) ) ) )
+			return nullptr;
+		auto * col = new CIntColumn;
+		col->Assign( reinterpret_cast<const int32_t *>( page ), rows, sorted );
+		return col;
+	}
+	if ( type == CColumn::TYPE_DOUBLE ) {
+		if ( ! ( page = reader.Take( rows * sizeof( double ) ) ) )
+			return nullptr;
+		auto * col = new CDoubleColumn;
+		col->Assign( reinterpret_cast<const double *>( page ), rows, sorted );
+		return col;
+	}
+
+	uint64_t values = 0, blobSize;
+	const char * hashes = nullptr, * lengths, * blob, * offsets;
+	bool encoded = flags & FLAG_ENCODED;
+	if ( encoded && ( ! reader.Read( values ) || values > UINT32_MAX || ! ( hashes = reader.Take( values * sizeof( uint64_t ) ) ) ) )
+		return nullptr;
+	if ( ! ( lengths = reader.Take( ( encoded ? values : rows ) * sizeof( uint32_t ) ) ) || ! reader.Read( blobSize )
+	     || ! ( blob = reader.Take( blobSize ) ) || ! ( offsets = reader.Take( rows * ( encoded ? sizeof( uint32_t ) : sizeof( uint64_t ) ) ) ) )
+		return nullptr;
+	const auto * lengthData = reinterpret_cast<const uint32_t *>( lengths );
+
+	auto * col = new CStringColumn;
+	if ( encoded ) {
+		auto dictionary = make_shared<CStringDictionary>( );
+		const auto * codes = reinterpret_cast<const uint32_t *>( offsets );
+		uint64_t offset = 0;
+		bool valid = true;
+		for ( uint32_t i = 0; i < values && valid; ++ i ) {
+			valid = lengthData[ i ] <= blobSize - offset;
+			if ( valid )
+				dictionary->Insert( blob + offset, lengthData[ i ], reinterpret_cast<const uint64_t *>( hashes )[ i ] );
+			offset += lengthData[ i ];
+		}
+		for ( size_t i = 0; i < rows && valid; ++ i )
+			valid = codes[ i ] < values;
+		if ( valid ) {
+			col->AssignEncoded( dictionary, codes, rows, sorted );
+			return col;
+		}
+	} else {
+		const auto * offsetData = reinterpret_cast<const uint64_t *>( offsets );
+		uint64_t begin = static_cast<uint64_t>( blob - file->GetData( ) ), end = begin + blobSize;
+		bool valid = true;
+		for ( size_t i = 0; i < rows && valid; ++ i )
+			valid = offsetData[ i ] >= begin && offsetData[ i ] <= end && lengthData[ i ] <= end - offsetData[ i ];
+		if ( valid ) {
+			col->BindExternal( shared_ptr<const char>( file, file->GetData( ) ), file->GetSize( ) );
+			col->AssignExternal( offsetData, lengthData, rows, sorted );
+			return col;
+		}
+	}
+	delete col;
+	return nullptr;
+}
+
+/**
+ * Reads the statistics of a table and hands them over to it, so they don't have to be collected again.
+ * @param[in, out] reader snapshot reader
+ * @param[in, out] table restored table
+ * @return false if the snapshot is damaged
+ */
+bool CSnapshot::ReadStatistics ( CReader & reader, CTable * table ) {
+	uint32_t present;
+	uint64_t rows, columnCnt;
+	if ( ! reader.Read( present ) )
+		return false;
+	if ( ! present )
+		return true;
+	if ( ! reader.Read( rows ) || ! reader.Read( columnCnt ) || columnCnt > table->GetColumnCount( ) )
+		return false;
+	shared_ptr<CStatistics> statistics ( new CStatistics );
+	statistics->m_Rows = rows;
+	for ( uint64_t i = 0; i < columnCnt; ++ i ) {
+		CColumnStats column;
+		uint32_t numeric;
+		uint64_t count, buckets;
+		const char * histogram;
+		if ( ! reader.Read( column.m_Distinct ) || ! reader.Read( numeric ) || ! reader.Read( column.m_Min ) || ! reader.Read( column.m_Max )
+		     || ! reader.Read( count ) || ! reader.Read( buckets ) || ( buckets && buckets != CColumnStats::BUCKETS )
+		     || ! ( histogram = reader.Take( buckets * sizeof( uint64_t ) ) ) )
+			return false;
+		column.m_Numeric = numeric;
+		column.m_Count = count;
+		column.m_Histogram.assign( reinterpret_cast<const uint64_t *>( histogram ), reinterpret_cast<const uint64_t *>( histogram ) + buckets );
+		statistics->m_Columns.push_back( column );
+	}
+	table->SetStatistics( statistics );
+	return true;
+}
+
+/**
+ * Reads a table with its statistics.
+ * @param[in, out] reader snapshot reader
+ * @param[in] file mapped snapshot
+ * @return restored table, nullptr if the snapshot is damaged
+ */
+CTable * CSnapshot::ReadTable ( CReader & reader, const shared_ptr<CMappedFile> & file ) {
+	uint64_t columnCnt, rows;
+	if ( ! reader.Read( columnCnt ) || ! reader.Read( rows ) || columnCnt > file->GetSize( ) || rows > file->GetSize( ) )
+		return nullptr;
+	vector<string> columnNames ( columnCnt );
+	vector<uint32_t> types ( columnCnt );
+	bool empty = false;
+	for ( size_t i = 0; i < columnCnt; ++ i ) {
+		if ( ! reader.ReadString( columnNames[ i ] ) || ! reader.Read( types[ i ] ) )
+			return nullptr;
+		if ( types[ i ] == TYPE_EMPTY )
+			empty = true;
+		else if ( types[ i ] > CColumn::TYPE_STRING )
+			return nullptr;
+	}
+
+	vector<CColumn *> columns;
+	for ( size_t i = 0; i < columnCnt && ! empty; ++ i ) {
+		CColumn * col = ReadColumn( reader, file, static_cast<CColumn::EType>( types[ i ] ), rows );
+		if ( ! col ) {
+			for ( auto & j : columns )
+				delete j;
+			return nullptr;
+		}
+		columns.push_back( col );
+	}
+	CTable * table = empty ? new CTable { columnNames } : new CTable { columnNames, columns };
+	if ( ! ReadStatistics( reader, table ) ) {
+		delete table;
+		return nullptr;
+	}
+	return table;
+}
+
+/**
+ * Restores the tables from a snapshot into an empty database.
+ * @param[in, out] db database to be restored
+ * @param[in] filePath path to the snapshot
+ * @param[in] sources current stamps of the source files, the snapshot has to be made of the same ones
+ * @param[out] queries saved query names with their definitions (in the order of saving)
+ * @return false if there is no valid snapshot of the sources (nothing is restored then)
+ */
+bool CSnapshot::Load ( CDatabase & db, const string & filePath, const vector<CDatabase::CSource> & sources,
+                       vector<pair<string, string>> & queries ) {
+	auto file = make_shared<CMappedFile>( filePath );
+	if ( ! file->IsOpen( ) )
+		return false;
+	CReader reader ( file->GetData( ), file->GetSize( ) );
+	const char * magic = reader.Take( sizeof( MAGIC ) );
+	uint32_t version, endianMark;
+	if ( ! magic || memcmp( magic, MAGIC, sizeof( MAGIC ) ) != 0 || ! reader.Read( version ) || version != VERSION
+	     || ! reader.Read( endianMark ) || endianMark != ENDIAN_MARK || ! ReadSources( reader, sources ) )
+		return false;
+
+	uint64_t tableCnt;
+	if ( ! reader.Read( tableCnt ) )
+		return false;
+	vector<pair<string, CTable *>> tables;
+	bool valid = true;
+	for ( uint64_t i = 0; i < tableCnt && valid; ++ i ) {
+		string name;
+		CTable * table = nullptr;
+		valid = reader.ReadString( name ) && ( table = ReadTable( reader, file ) );
+		if ( valid )
+			tables.emplace_back( name, table );
+	}
+
+	uint64_t queryCnt = 0;
+	queries.clear( );
+	valid = valid && reader.Read( queryCnt );
+	for ( uint64_t i = 0; i < queryCnt && valid; ++ i ) {
+		string name, definition;
+		valid = reader.ReadString( name ) && reader.ReadString( definition );
+		queries.emplace_back( name, definition );
+	}
+
+	uint64_t indexCnt = 0;
+	vector<tuple<string, uint64_t, uint32_t>> indexes;
+	valid = valid && reader.Read( indexCnt );
+	for ( uint64_t i = 0; i < indexCnt && valid; ++ i ) {
+		string table;
+		uint64_t position;
+		uint32_t kind;
+		valid = reader.ReadString( table ) && reader.Read( position ) && reader.Read( kind );
+		indexes.emplace_back( table, position, kind );
+	}
+
+	if ( ! valid ) {
+		for ( auto & i : tables )
+			delete i.second;
+		queries.clear( );
+		return false;
+	}
+	for ( auto & i : tables )
+		if ( ! db.InsertTable( i.first, i.second ) )
+			delete i.second;
+	for ( const auto & i : indexes )
+		db.InsertIndex( get<0>( i ), get<1>( i ), get<2>( i ) == CIndex::INDEX_HASH ? CIndex::INDEX_HASH : CIndex::INDEX_SORTED );
+	db.SetSources( sources );
+	return true;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include "../database/CDatabase.hpp"
+#include "../console/CLog.hpp"
+#include "CMappedFile.hpp"
+
+using namespace std;
+
+/**
+ * This module saves the whole database into a binary snapshot and restores it, so the tables don't have to be parsed again.
+ *
+ * The snapshot starts with a magic string, a format version and a byte order mark, followed by the stamps
+ * of the source files (path, size, modification time), the tables, the saved query definitions and the index definitions
+ * (table, column position, kind).
+ * A table is stored as its column names, types and row count followed by a data page per column and the table statistics.
+ * A page holds the raw values of a number column, the dictionary with the row codes of an encoded string column
+ * or the value lengths, the blob and the value offsets of a plain string column. All parts are 8 byte aligned.
+ *
+ * The snapshot is memory mapped on load - the number pages are copied as a whole, the plain string columns reference
+ * the mapped file directly (see CStringColumn) and the encoding and the statistics are restored as they were saved,
+ * so a restored table isn't scanned again.
+ * A snapshot of other sources, another version or a damaged one is refused and the tables are imported as usual.
+ * The saved queries are only stored as their definitions, so they're evaluated again over the restored tables,
+ * the indexes are built again as well.
+ */
+class CSnapshot {
+private:
+	static const char MAGIC[ 8 ];
+	static const uint32_t VERSION = 3;
+	static const uint32_t ENDIAN_MARK = 0x01020304;
+	static const uint32_t TYPE_EMPTY = 0xFF;
+	static const uint32_t FLAG_SORTED = 1;
+	static const uint32_t FLAG_ENCODED = 2;
+
+	/**
+	 * Bounds checked sequential reader of the mapped snapshot.
+	 */
+	class CReader {
+	private:
+		const char * m_Data;
+		size_t m_Size;
+		size_t m_Pos = 0;
+
+	public:
+		CReader ( const char * data, const size_t & size ) : m_Data( data ), m_Size( size ) { }
+		const char * Take ( const size_t & size );
+		template <typename T> bool Read ( T & out );
+		bool ReadString ( string & out );
+	};
+
+	static void Pad ( ostream & ost, const size_t & size );
+	static void Write ( ostream & ost, const void * data, const size_t & size );
+	template <typename T> static void Write ( ostream & ost, const T & val );
+	static void WriteString ( ostream & ost, const string & str );
+	static void WriteColumn ( ostream & ost, const CColumn * col, const size_t & rows );
+	static void WriteStatistics ( ostream & ost, const CStatistics * statistics );
+
+	static bool ReadSources ( CReader & reader, const vector<CDatabase::CSource> & sources );
+	static CColumn * ReadColumn ( CReader & reader, const shared_ptr<CMappedFile> & file, const CColumn::EType & type, const uint64_t & rows );
+	static bool ReadStatistics ( CReader & reader, CTable * table );
+	static CTable * ReadTable ( CReader & reader, const shared_ptr<CMappedFile> & file );
+
+public:
+	static CDatabase::CSource Stamp ( const string & filePath );
+	static bool Save ( const CDatabase & db, const string & filePath );
+	static bool Load ( CDatabase & db, const string & filePath, const vector<CDatabase::CSource> & sources,
+	                   vector<pair<string, string>> & queries );
+};
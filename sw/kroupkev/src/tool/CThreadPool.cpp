@@ -0,0 +1,68 @@
+#include "CThreadPool.hpp"
+
+/**
+ * Starts the worker threads.
+ * @param[in] threads number of workers (at least one is started)
+ */
+CThreadPool::CThreadPool ( const size_t & threads ) {
+	size_t count = threads ? threads : 1;
+	m_Workers.reserve( count );
+	for ( size_t i = 0; i < count; ++ i )
+		m_Workers.emplace_back( & CThreadPool::Work, this );
+}
+
+CThreadPool::~CThreadPool ( ) {
+	{
+		lock_guard<mutex> lock ( m_Mutex );
+		m_Stop = true;
+	}
+	m_Condition.notify_all( );
+	for ( auto & i : m_Workers )
+		i.join( );
+}
+
+/**
+ * Number of threads the hardware runs concurrently (1 if unknown).
+ */
+size_t CThreadPool::GetDefaultSize ( ) {
+	size_t threads = thread::hardware_concurrency( );
+	return threads ? threads : 1;
+}
+
+size_t CThreadPool::GetSize ( ) const {
+	return m_Workers.size( );
+}
+
+/**
+ * Queues a task. Exceptions thrown by the task are passed to the future.
+ * @param[in] task task to run
+ * @return future of the task
+ */
+future<void> CThreadPool::Submit ( const function<void ( )> & task ) {
+	auto packaged = make_shared<packaged_task<void ( )>>( task );
+	future<void> result = packaged->get_future( );
+	{
+		lock_guard<mutex> lock ( m_Mutex );
+		m_Tasks.emplace( [ packaged ] ( ) { ( * packaged )( ); } );
+	}
+	m_Condition.notify_one( );
+	return result;
+}
+
+/**
+ * Worker loop - takes the tasks until the pool is stopped and the queue is empty.
+ */
+void CThreadPool::Work ( ) {
+	while ( true ) {
+		function<void ( )> task;
+		{
+			unique_lock<mutex> lock ( m_Mutex );
+			m_Condition.wait( lock, [ this ] ( ) { return m_Stop || ! m_Tasks.empty( ); } );
+			if ( m_Tasks.empty( ) )
+				return;
+			task = std::move( m_Tasks.front( ) );
+			m_Tasks.pop( );
+		}
+		task( );
+	}
+}
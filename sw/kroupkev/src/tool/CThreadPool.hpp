@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+
+using namespace std;
+
+/**
+ * This module runs tasks on a fixed number of worker threads.
+ * Tasks are started in the order of submission, each one returns a future to wait for it.
+ * The destructor finishes all the submitted tasks before the workers are joined.
+ */
+class CThreadPool {
+private:
+	vector<thread> m_Workers;
+	queue<function<void ( )>> m_Tasks;
+	mutex m_Mutex;
+	condition_variable m_Condition;
+	bool m_Stop = false;
+
+	void Work ( );
+
+public:
+	explicit CThreadPool ( const size_t & threads );
+	CThreadPool ( const CThreadPool & src ) = delete;
+	CThreadPool & operator = ( const CThreadPool & src ) = delete;
+	~CThreadPool ( );
+
+	static size_t GetDefaultSize ( );
+
+	size_t GetSize ( ) const;
+	future<void> Submit ( const function<void ( )> & task );
+};